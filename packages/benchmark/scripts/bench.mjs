@@ -0,0 +1,148 @@
+#!/usr/bin/env node
+/**
+ * Run the benchmark page in headless Chrome and write its JSON report.
+ *
+ *   node scripts/bench.mjs [--out report.json] [--iterations 5] [--max-pages 50]
+ *     [--scale 1.5] [--build auto|scalar|simd|lite] [--only a.pdf,b.pdf] [--quick]
+ *     [--chrome /path/to/chrome] [--timeout 1800]
+ *
+ * Chrome is found through --chrome, $CHROME_PATH or the usual install names. Every run
+ * uses a fresh profile, so the engine start is a cold one (no Cache Storage entry).
+ */
+import { spawn } from 'node:child_process';
+import { existsSync } from 'node:fs';
+import { mkdtemp, rm, writeFile } from 'node:fs/promises';
+import { tmpdir } from 'node:os';
+import path from 'node:path';
+import { fileURLToPath } from 'node:url';
+import { parseArgs } from 'node:util';
+
+import { createServer } from 'vite';
+
+const packageDir = path.dirname(path.dirname(fileURLToPath(import.meta.url)));
+
+const { values: args } = parseArgs({
+  options: {
+    out: { type: 'string' },
+    iterations: { type: 'string', default: '5' },
+    'max-pages': { type: 'string', default: '50' },
+    scale: { type: 'string', default: '1.5' },
+    build: { type: 'string', default: 'auto' },
+    only: { type: 'string' },
+    quick: { type: 'boolean', default: false },
+    chrome: { type: 'string' },
+    timeout: { type: 'string', default: '1800' },
+  },
+});
+
+const CHROME_CANDIDATES = [
+  'google-chrome-stable',
+  'google-chrome',
+  'chromium',
+  'chromium-browser',
+  '/Applications/Google Chrome.app/Contents/MacOS/Google Chrome',
+  'C:\\Program Files\\Google\\Chrome\\Application\\chrome.exe',
+];
+
+/** Spawn the first Chrome that starts */
+async function launchChrome(url, profileDir) {
+  const flags = [
+    '--headless=new',
+    '--no-first-run',
+    '--no-default-browser-check',
+    '--disable-extensions',
+    '--disable-background-timer-throttling',
+    '--disable-renderer-backgrounding',
+    `--user-data-dir=${profileDir}`,
+    url,
+  ];
+  const candidates = [args.chrome ?? process.env.CHROME_PATH].filter(Boolean);
+  const installed = CHROME_CANDIDATES.filter((name) => !path.isAbsolute(name) || existsSync(name));
+  candidates.push(...installed);
+  for (const command of candidates) {
+    const child = spawn(command, flags, { stdio: 'ignore' });
+    const started = await new Promise((resolve) => {
+      child.once('spawn', () => resolve(true));
+      child.once('error', () => resolve(false));
+    });
+    if (started) return child;
+  }
+  throw new Error('Chrome not found; pass --chrome or set CHROME_PATH');
+}
+
+/** Vite plugin that hands the page's POSTed report to onResult */
+function resultPlugin(onResult) {
+  return {
+    name: 'benchmark-result',
+    configureServer(server) {
+      server.middlewares.use('/__bench/result', (req, res) => {
+        let body = '';
+        req.setEncoding('utf8');
+        req.on('data', (chunk) => (body += chunk));
+        req.on('end', () => {
+          res.writeHead(204);
+          res.end();
+          onResult(JSON.parse(body));
+        });
+      });
+    },
+  };
+}
+
+async function main() {
+  let resolveResult;
+  const result = new Promise((resolve) => (resolveResult = resolve));
+  const server = await createServer({
+    root: packageDir,
+    configFile: path.join(packageDir, 'vite.config.ts'),
+    plugins: [resultPlugin((body) => resolveResult(body))],
+    logLevel: 'warn',
+  });
+  await server.listen();
+
+  const query = new URLSearchParams({
+    iterations: args.iterations,
+    maxPages: args['max-pages'],
+    scale: args.scale,
+    build: args.build,
+  });
+  if (args.only) query.set('only', args.only);
+  if (args.quick) query.set('quick', '1');
+  const url = `${server.resolvedUrls.local[0]}?${query}`;
+
+  const profileDir = await mkdtemp(path.join(tmpdir(), 'pdflite-bench-'));
+  const chrome = await launchChrome(url, profileDir);
+  let timer;
+  const timeout = new Promise((_, reject) => {
+    timer = setTimeout(
+      () => reject(new Error(`No report after ${args.timeout} s`)),
+      Number(args.timeout) * 1000,
+    );
+  });
+  const chromeExit = new Promise((_, reject) => {
+    chrome.once('exit', (code) => reject(new Error(`Chrome exited early (code ${code})`)));
+  });
+
+  try {
+    const report = await Promise.race([result, timeout, chromeExit]);
+    if (report.error) throw new Error(`Benchmark page failed:\n${report.error}`);
+    const json = `${JSON.stringify(report, null, 2)}\n`;
+    if (args.out) {
+      await writeFile(args.out, json);
+      console.error(`Wrote ${args.out}`);
+    } else {
+      process.stdout.write(json);
+    }
+  } finally {
+    clearTimeout(timer);
+    chrome.removeAllListeners('exit');
+    chrome.kill();
+    await server.close();
+    await rm(profileDir, { recursive: true, force: true }).catch(() => undefined);
+  }
+}
+
+main().catch((error) => {
+  console.error(error instanceof Error ? error.message : error);
+  process.exit(1);
+});
@@ -0,0 +1,86 @@
+#!/usr/bin/env node
+/**
+ * Compare two benchmark reports case by case on their median times.
+ *
+ *   node scripts/compare.mjs base.json head.json [--threshold 10] [--fail-on-regression]
+ *
+ * A case is a regression when its median grew by more than --threshold percent
+ * (default 10).
+ */
+import { readFile } from 'node:fs/promises';
+import { parseArgs } from 'node:util';
+
+const { values: args, positionals } = parseArgs({
+  allowPositionals: true,
+  options: {
+    threshold: { type: 'string', default: '10' },
+    'fail-on-regression': { type: 'boolean', default: false },
+  },
+});
+
+if (positionals.length !== 2) {
+  console.error('Usage: compare.mjs base.json head.json [--threshold 10] [--fail-on-regression]');
+  process.exit(2);
+}
+
+const [base, head] = await Promise.all(
+  positionals.map(async (file) => JSON.parse(await readFile(file, 'utf8'))),
+);
+const threshold = Number(args.threshold);
+
+/** Median times by "document / case", plus the engine start */
+function medians(report) {
+  const out = new Map([
+    ['(engine) / coldStart', report.engine.coldStart.wallMs],
+    ['(engine) / warmStart', report.engine.warmStart.wallMs],
+  ]);
+  for (const doc of report.documents) {
+    for (const [name, result] of Object.entries(doc.cases)) {
+      if (typeof result !== 'string') out.set(`${doc.name} / ${name}`, result.medianMs);
+    }
+  }
+  return out;
+}
+
+const baseMedians = medians(base);
+const headMedians = medians(head);
+const rows = [];
+let regressions = 0;
+for (const [key, headMs] of headMedians) {
+  const baseMs = baseMedians.get(key);
+  if (baseMs === undefined) {
+    rows.push([key, '-', headMs.toFixed(2), 'new']);
+    continue;
+  }
+  const change = baseMs > 0 ? ((headMs - baseMs) / baseMs) * 100 : 0;
+  const regressed = change > threshold;
+  if (regressed) regressions++;
+  const sign = change > 0 ? '+' : '';
+  rows.push([
+    key,
+    baseMs.toFixed(2),
+    headMs.toFixed(2),
+    `${sign}${change.toFixed(1)}%${regressed ? '  REGRESSION' : ''}`,
+  ]);
+}
+for (const key of baseMedians.keys()) {
+  if (!headMedians.has(key)) rows.push([key, baseMedians.get(key).toFixed(2), '-', 'missing']);
+}
+
+const header = ['case', 'base ms', 'head ms', 'change'];
+const widths = header.map((title, column) =>
+  Math.max(title.length, ...rows.map((row) => row[column].length)),
+);
+const format = (row) =>
+  row
+    .map((cell, column) => cell.padEnd(widths[column]))
+    .join('  ')
+    .trimEnd();
+console.log(format(header));
+console.log(format(widths.map((width) => '-'.repeat(width))));
+for (const row of rows) console.log(format(row));
+if (base.engine.build !== head.engine.build) {
+  console.log(`\nNote: builds differ (${base.engine.build} vs ${head.engine.build})`);
+}
+console.log(`\n${regressions} case(s) slower by more than ${threshold}%`);
+if (args['fail-on-regression'] && regressions > 0) process.exit(1);
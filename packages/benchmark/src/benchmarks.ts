@@ -0,0 +1,327 @@
+/**
+ * Benchmark cases. Each document goes through PdfController the way the viewer uses it
+ * (load, first page, every page, text, search, annotations, forms, save) and through a
+ * bare module instance (document load and RGBA renders without a canvas), so a
+ * regression can be placed in PDFium itself or in the controller and canvas around it.
+ */
+import { type IPerfCounters, type IStartupTimings, PdfController } from '@pdfviewer/controller';
+import {
+  type IPDFiumModule,
+  type PDFIUM_BUILD,
+  createPdfiumModule,
+  getLoadedPdfiumBuild,
+  supportsWasmSimd,
+} from '@pdfviewer/pdfium-wasm';
+
+import type { ICorpusDocument } from './corpus';
+
+export interface IBenchmarkConfig {
+  /** Timed runs per case, after one untimed warm-up run */
+  iterations: number;
+  /** Pages covered by the whole-document cases */
+  maxPages: number;
+  /** Render scale (1 = 72 dpi), with a device pixel ratio of 1 */
+  scale: number;
+  /** Binary of the bare module instance; the controller always uses its default */
+  build: PDFIUM_BUILD | 'auto';
+}
+
+export interface ITimingSummary {
+  runs: number;
+  medianMs: number;
+  meanMs: number;
+  minMs: number;
+  maxMs: number;
+}
+
+/** A case's timings plus the counts it produced (pages, matches, bytes) */
+export type ICaseResult = ITimingSummary & Record<string, number>;
+
+export interface IDocumentReport {
+  name: string;
+  generated: boolean;
+  bytes: number;
+  pages: number;
+  /** By case name; a string is the error that case failed with */
+  cases: Record<string, ICaseResult | string>;
+  /** Controller performance counters over all of the document's cases */
+  perfCounters: IPerfCounters | null;
+}
+
+export interface IStartupReport {
+  /** Wall time of controller.ensureInitialized() */
+  wallMs: number;
+  timings: IStartupTimings | null;
+}
+
+export interface IBenchmarkReport {
+  /** Bumped when the shape of the report changes */
+  schemaVersion: 1;
+  createdAt: string;
+  userAgent: string;
+  config: IBenchmarkConfig;
+  engine: {
+    /** Binary the controller loaded */
+    build: PDFIUM_BUILD | null;
+    simd: boolean;
+    /** First start in a fresh browser profile, then a second controller in the same page */
+    coldStart: IStartupReport;
+    warmStart: IStartupReport;
+  };
+  documents: IDocumentReport[];
+}
+
+/** Render flags of the bare module cases (FPDF_ANNOT; RGBA order is always added) */
+const RAW_RENDER_FLAGS = 0x01;
+const RAW_BACKGROUND = 0xffffffff;
+
+export function summarize(samples: number[]): ITimingSummary {
+  const sorted = [...samples].sort((a, b) => a - b);
+  const middle = sorted.length >> 1;
+  const medianMs = sorted.length % 2 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2;
+  return {
+    runs: sorted.length,
+    medianMs,
+    meanMs: sorted.reduce((total, ms) => total + ms, 0) / sorted.length,
+    minMs: sorted[0],
+    maxMs: sorted[sorted.length - 1],
+  };
+}
+
+/** Let the page paint and collect garbage between runs */
+const settle = () => new Promise<void>((resolve) => setTimeout(resolve, 0));
+
+/**
+ * Run setup and body iterations + 1 times, timing body only; the first run warms caches
+ * and JIT and is discarded.
+ * @returns The summary, with the counts of the last run's result merged in
+ */
+async function runCase(
+  iterations: number,
+  setup: () => Promise<void> | void,
+  body: () => Promise<Record<string, number> | void> | Record<string, number> | void,
+): Promise<ICaseResult> {
+  const samples: number[] = [];
+  let counts: Record<string, number> = {};
+  for (let run = 0; run <= iterations; run++) {
+    await setup();
+    await settle();
+    const start = performance.now();
+    counts = (await body()) ?? {};
+    const elapsed = performance.now() - start;
+    if (run > 0) samples.push(elapsed);
+  }
+  return { ...summarize(samples), ...counts };
+}
+
+async function measureStart(controller: PdfController): Promise<IStartupReport> {
+  const start = performance.now();
+  await controller.ensureInitialized();
+  return { wallMs: performance.now() - start, timings: controller.getStartupTimings() };
+}
+
+function pageRange(pageCount: number, maxPages: number): number[] {
+  return Array.from({ length: Math.min(pageCount, maxPages) }, (_, index) => index);
+}
+
+async function benchmarkController(
+  controller: PdfController,
+  doc: ICorpusDocument,
+  config: IBenchmarkConfig,
+  cases: Record<string, ICaseResult | string>,
+): Promise<number> {
+  const file = new File([doc.bytes], doc.name, { type: 'application/pdf' });
+  const load = () => controller.loadFile(file, { password: doc.password });
+  const canvas = document.createElement('canvas');
+  const render = (pageIndex: number) =>
+    controller.renderPdf(canvas, { pageIndex, scale: config.scale, pixelRatio: 1 });
+
+  const run = async (
+    name: string,
+    setup: () => Promise<void> | void,
+    body: () => Promise<Record<string, number> | void> | Record<string, number> | void,
+  ) => {
+    try {
+      cases[name] = await runCase(config.iterations, setup, body);
+    } catch (error) {
+      cases[name] = error instanceof Error ? error.message : String(error);
+    }
+  };
+
+  await load();
+  const pages = pageRange(controller.getPageCount(), config.maxPages);
+
+  await run('loadFile', () => controller.destroy(), load);
+  // Each run starts from a fresh load, so the page is parsed as well as rendered
+  await run('firstPageRender', load, () => render(0));
+  await run('renderAll', load, async () => {
+    for (const pageIndex of pages) await render(pageIndex);
+    return { pages: pages.length };
+  });
+  const renderAll = cases.renderAll;
+  if (typeof renderAll !== 'string') {
+    renderAll.pagesPerSecond = (pages.length * 1000) / renderAll.medianMs;
+  }
+  await run('getPageTextContent', load, () => {
+    let textRects = 0;
+    for (const pageIndex of pages) {
+      textRects += controller.getPageTextContent(pageIndex)?.textRects.length ?? 0;
+    }
+    return { pages: pages.length, textRects };
+  });
+  await run('searchText', load, () => ({
+    matches: controller.searchText(doc.query, { scale: config.scale }).length,
+  }));
+  await run('listNativeAnnotations', load, () => {
+    let annotations = 0;
+    for (const pageIndex of pages) {
+      annotations += controller.listNativeAnnotations(pageIndex, { scale: config.scale }).length;
+    }
+    return { pages: pages.length, annotations };
+  });
+  await run('listFormFields', load, () => {
+    let fields = 0;
+    for (const pageIndex of pages) {
+      fields += controller.listFormFields(pageIndex, { scale: config.scale }).length;
+    }
+    return { pages: pages.length, fields };
+  });
+  await run(
+    'exportPdfBytes',
+    () => undefined,
+    () => ({ bytes: controller.exportPdfBytes().length }),
+  );
+  return controller.getPageCount();
+}
+
+/** Document load and canvas-free RGBA renders on a bare module instance */
+async function benchmarkRawModule(
+  pdfium: IPDFiumModule,
+  doc: ICorpusDocument,
+  config: IBenchmarkConfig,
+  cases: Record<string, ICaseResult | string>,
+): Promise<void> {
+  const dataPtr = pdfium._malloc(doc.bytes.length);
+  pdfium.HEAPU8.set(doc.bytes, dataPtr);
+  const password = doc.password ?? '';
+  const passwordSize = password.length * 4 + 1;
+  const passwordPtr = pdfium._malloc(passwordSize);
+  pdfium.stringToUTF8(password, passwordPtr, passwordSize);
+  let docPtr = 0;
+  const closeDoc = () => {
+    if (docPtr) pdfium._PDFium_CloseDocument(docPtr);
+    docPtr = 0;
+  };
+  const openDoc = () => {
+    closeDoc();
+    docPtr = pdfium._PDFium_LoadMemDocument(dataPtr, doc.bytes.length, passwordPtr);
+    if (!docPtr) throw new Error(`PDFium could not open ${doc.name}`);
+  };
+  const renderPage = (pageIndex: number) => {
+    const pagePtr = pdfium._PDFium_LoadPage(docPtr, pageIndex);
+    if (!pagePtr) throw new Error(`PDFium could not load page ${pageIndex + 1}`);
+    const width = Math.max(1, Math.round(pdfium._PDFium_GetPageWidth(pagePtr) * config.scale));
+    const height = Math.max(1, Math.round(pdfium._PDFium_GetPageHeight(pagePtr) * config.scale));
+    pdfium._PDFium_ClosePage(pagePtr);
+    const bufferPtr = pdfium._PDFium_RenderPageRGBA?.(
+      docPtr,
+      pageIndex,
+      width,
+      height,
+      0,
+      RAW_RENDER_FLAGS,
+      RAW_BACKGROUND,
+    );
+    if (!bufferPtr) throw new Error(`PDFium could not render page ${pageIndex + 1}`);
+    pdfium._PDFium_FreeBuffer(bufferPtr);
+  };
+
+  const run = async (
+    name: string,
+    setup: () => void,
+    body: () => Record<string, number> | void,
+  ) => {
+    try {
+      cases[name] = await runCase(config.iterations, setup, body);
+    } catch (error) {
+      cases[name] = error instanceof Error ? error.message : String(error);
+    }
+  };
+
+  try {
+    await run('rawLoadDocument', closeDoc, openDoc);
+    await run('rawFirstPageRender', openDoc, () => renderPage(0));
+    await run('rawRenderAll', openDoc, () => {
+      const pages = pageRange(pdfium._PDFium_GetPageCount(docPtr), config.maxPages);
+      for (const pageIndex of pages) renderPage(pageIndex);
+      return { pages: pages.length };
+    });
+  } finally {
+    closeDoc();
+    pdfium._free(passwordPtr);
+    pdfium._free(dataPtr);
+  }
+}
+
+/**
+ * Run every case over the corpus.
+ * @param onProgress Called before each document with its name
+ */
+export async function runBenchmarks(
+  corpus: ICorpusDocument[],
+  config: IBenchmarkConfig,
+  onProgress: (message: string) => void = () => undefined,
+): Promise<IBenchmarkReport> {
+  onProgress('Starting engine');
+  const controller = new PdfController();
+  // Every render is a real one, not a raster cache hit
+  controller.setRasterCacheBudget(0);
+  controller.setPerfCountersEnabled(true);
+  const coldStart = await measureStart(controller);
+  const warmStart = await measureStart(new PdfController());
+  const build = getLoadedPdfiumBuild();
+
+  const rawModule = await createPdfiumModule({ build: config.build });
+  rawModule._PDFium_Init();
+
+  const documents: IDocumentReport[] = [];
+  for (const doc of corpus) {
+    onProgress(`Benchmarking ${doc.name}`);
+    const cases: Record<string, ICaseResult | string> = {};
+    controller.resetPerfCounters();
+    let pages = 0;
+    try {
+      pages = await benchmarkController(controller, doc, config, cases);
+    } catch (error) {
+      cases.open = error instanceof Error ? error.message : String(error);
+    }
+    const perfCounters = controller.getPerfCounters();
+    controller.destroy();
+    await benchmarkRawModule(rawModule, doc, config, cases).catch((error: unknown) => {
+      cases.rawOpen = error instanceof Error ? error.message : String(error);
+    });
+    documents.push({
+      name: doc.name,
+      generated: doc.generated,
+      bytes: doc.bytes.length,
+      pages,
+      cases,
+      perfCounters,
+    });
+  }
+  rawModule._PDFium_Destroy();
+
+  return {
+    schemaVersion: 1,
+    createdAt: new Date().toISOString(),
+    userAgent: navigator.userAgent,
+    config,
+    engine: {
+      build,
+      simd: supportsWasmSimd(),
+      coldStart,
+      warmStart,
+    },
+    documents,
+  };
+}
@@ -0,0 +1,309 @@
+/**
+ * Benchmark corpus: the PDFs in test_files/ plus documents generated in the page, so
+ * every run covers the same large, dense, scanned and form-heavy inputs without
+ * checking multi-megabyte fixtures into the repo. Generation is seeded and therefore
+ * byte-identical between runs and builds.
+ */
+import { PdfWriter, type PdfBytes } from './pdfWriter';
+
+export interface ICorpusDocument {
+  name: string;
+  /** Generated in the page rather than read from test_files/ */
+  generated: boolean;
+  bytes: PdfBytes;
+  password?: string;
+  /** Term searched for by the searchText case */
+  query: string;
+}
+
+export interface ICorpusOptions {
+  /** Shrink the generated documents (about a tenth of the pages) for a fast smoke run */
+  quick?: boolean;
+}
+
+/** Served by the benchmark's Vite config from test_files/ */
+const TEST_FILES_INDEX = '/corpus/index.json';
+/** Open passwords of the encrypted fixtures (see test_files/password.md) */
+const TEST_FILE_PASSWORDS: Record<string, string> = {
+  'libreoffice-writer-password.pdf': 'openpassword',
+};
+const TEST_FILE_QUERY = 'the';
+
+/** US Letter in points */
+const PAGE_WIDTH = 612;
+const PAGE_HEIGHT = 792;
+
+const WORDS = (
+  'render text search load save page glyph stream object font image annotation form field ' +
+  'layout cache budget scale tile raster vector path heap module worker frame canvas buffer ' +
+  'document outline bookmark thumbnail cursor index query match range offset'
+).split(' ');
+const GENERATED_QUERY = 'render';
+
+/** mulberry32: small seeded PRNG so generated documents are reproducible */
+function createRandom(seed: number): () => number {
+  let state = seed >>> 0;
+  return () => {
+    state = (state + 0x6d2b79f5) >>> 0;
+    let t = state;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+function sentence(random: () => number, words: number): string {
+  const out: string[] = [];
+  for (let i = 0; i < words; i++) {
+    out.push(WORDS[Math.floor(random() * WORDS.length)]);
+  }
+  return out.join(' ');
+}
+
+const fixed = (value: number) => value.toFixed(2);
+const refs = (ids: number[]) => ids.map((id) => `${id} 0 R`).join(' ');
+
+/** Catalog and page tree around already written page objects */
+function finishDocument(
+  writer: PdfWriter,
+  pagesId: number,
+  pageIds: number[],
+  catalogExtra = '',
+): PdfBytes {
+  writer.set(pagesId, `<< /Type /Pages /Kids [${refs(pageIds)}] /Count ${pageIds.length} >>`);
+  const catalogId = writer.add(`<< /Type /Catalog /Pages ${pagesId} 0 R${catalogExtra} >>`);
+  return writer.build(catalogId);
+}
+
+function helvetica(writer: PdfWriter): number {
+  return writer.add(
+    '<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica /Encoding /WinAnsiEncoding >>',
+  );
+}
+
+/** Many pages of running text, with a highlight and a note every few pages */
+async function generateLargeDocument(pageCount: number): Promise<PdfBytes> {
+  const random = createRandom(1);
+  const writer = new PdfWriter();
+  const pagesId = writer.reserve();
+  const fontId = helvetica(writer);
+  const pageIds: number[] = [];
+  for (let p = 0; p < pageCount; p++) {
+    let content = `BT /F1 10 Tf 13 TL 72 740 Td (Page ${p + 1}) Tj\n`;
+    for (let line = 0; line < 50; line++) {
+      content += `(${sentence(random, 12)}) '\n`;
+    }
+    content += 'ET\n';
+    const contentId = await writer.addStream('', content);
+
+    const annots: number[] = [];
+    if (p % 5 === 0) {
+      const [x0, y0, x1, y1] = [72, 714, 320, 726];
+      annots.push(
+        writer.add(
+          `<< /Type /Annot /Subtype /Highlight /Rect [${x0} ${y0} ${x1} ${y1}] /C [1 1 0] ` +
+            `/QuadPoints [${x0} ${y1} ${x1} ${y1} ${x0} ${y0} ${x1} ${y0}] /F 4 >>`,
+        ),
+        writer.add(
+          '<< /Type /Annot /Subtype /Text /Rect [540 740 560 760] /Name /Comment ' +
+            `/Contents (Note on page ${p + 1}) /F 4 >>`,
+        ),
+      );
+    }
+    const annotsEntry = annots.length ? ` /Annots [${refs(annots)}]` : '';
+    pageIds.push(
+      writer.add(
+        `<< /Type /Page /Parent ${pagesId} 0 R /MediaBox [0 0 ${PAGE_WIDTH} ${PAGE_HEIGHT}] ` +
+          `/Resources << /Font << /F1 ${fontId} 0 R >> >> ` +
+          `/Contents ${contentId} 0 R${annotsEntry} >>`,
+      ),
+    );
+  }
+  return finishDocument(writer, pagesId, pageIds);
+}
+
+/** Few pages packed with small filled paths, strokes and scattered text runs */
+async function generateDenseDocument(pageCount: number): Promise<PdfBytes> {
+  const random = createRandom(2);
+  const writer = new PdfWriter();
+  const pagesId = writer.reserve();
+  const fontId = helvetica(writer);
+  const pageIds: number[] = [];
+  for (let p = 0; p < pageCount; p++) {
+    let content = '';
+    for (let i = 0; i < 4000; i++) {
+      const x = random() * PAGE_WIDTH;
+      const y = random() * PAGE_HEIGHT;
+      content +=
+        `${fixed(random())} ${fixed(random())} ${fixed(random())} rg ` +
+        `${fixed(x)} ${fixed(y)} ${fixed(2 + random() * 10)} ${fixed(2 + random() * 10)} re f\n`;
+    }
+    content += '0.5 w 0 0 0 RG\n';
+    for (let i = 0; i < 2000; i++) {
+      content +=
+        `${fixed(random() * PAGE_WIDTH)} ${fixed(random() * PAGE_HEIGHT)} m ` +
+        `${fixed(random() * PAGE_WIDTH)} ${fixed(random() * PAGE_HEIGHT)} l S\n`;
+    }
+    content += '0 g\n';
+    for (let i = 0; i < 3000; i++) {
+      content +=
+        `BT /F1 ${fixed(4 + random() * 8)} Tf ${fixed(random() * PAGE_WIDTH)} ` +
+        `${fixed(random() * PAGE_HEIGHT)} Td (${sentence(random, 2)}) Tj ET\n`;
+    }
+    const contentId = await writer.addStream('', content);
+    pageIds.push(
+      writer.add(
+        `<< /Type /Page /Parent ${pagesId} 0 R /MediaBox [0 0 ${PAGE_WIDTH} ${PAGE_HEIGHT}] ` +
+          `/Resources << /Font << /F1 ${fontId} 0 R >> >> /Contents ${contentId} 0 R >>`,
+      ),
+    );
+  }
+  return finishDocument(writer, pagesId, pageIds);
+}
+
+/** 150 dpi grayscale page images: noisy paper with dark blocks where text lines would be */
+async function generateScannedDocument(pageCount: number): Promise<PdfBytes> {
+  const random = createRandom(3);
+  const width = 1275;
+  const height = 1650;
+  const writer = new PdfWriter();
+  const pagesId = writer.reserve();
+  const pageIds: number[] = [];
+  const pixels = new Uint8Array(width * height);
+  for (let p = 0; p < pageCount; p++) {
+    for (let i = 0; i < pixels.length; i++) {
+      pixels[i] = 225 + Math.floor(random() * 30);
+    }
+    for (let top = 150; top + 24 < height - 150; top += 36) {
+      let x = 150;
+      while (x < width - 150) {
+        const wordWidth = 20 + Math.floor(random() * 90);
+        for (let y = top; y < top + 24; y++) {
+          for (let dx = 0; dx < wordWidth && x + dx < width - 150; dx++) {
+            if (random() < 0.6) pixels[y * width + x + dx] = Math.floor(random() * 80);
+          }
+        }
+        x += wordWidth + 12 + Math.floor(random() * 10);
+      }
+    }
+    const imageId = await writer.addStream(
+      `/Type /XObject /Subtype /Image /Width ${width} /Height ${height} ` +
+        '/ColorSpace /DeviceGray /BitsPerComponent 8',
+      pixels.slice(),
+    );
+    const contentId = await writer.addStream(
+      '',
+      `q ${PAGE_WIDTH} 0 0 ${PAGE_HEIGHT} 0 0 cm /Im1 Do Q\n`,
+    );
+    pageIds.push(
+      writer.add(
+        `<< /Type /Page /Parent ${pagesId} 0 R /MediaBox [0 0 ${PAGE_WIDTH} ${PAGE_HEIGHT}] ` +
+          `/Resources << /XObject << /Im1 ${imageId} 0 R >> >> /Contents ${contentId} 0 R >>`,
+      ),
+    );
+  }
+  return finishDocument(writer, pagesId, pageIds);
+}
+
+/** Pages of labelled text fields with a checkbox every fourth row */
+async function generateFormDocument(pageCount: number): Promise<PdfBytes> {
+  const random = createRandom(4);
+  const rows = 20;
+  const writer = new PdfWriter();
+  const pagesId = writer.reserve();
+  const fontId = helvetica(writer);
+  const pageIds: number[] = [];
+  const fieldIds: number[] = [];
+  for (let p = 0; p < pageCount; p++) {
+    const pageId = writer.reserve();
+    const widgets: number[] = [];
+    let content = 'BT /F1 9 Tf\n';
+    for (let row = 0; row < rows; row++) {
+      for (let column = 0; column < 2; column++) {
+        const x = 72 + column * 250;
+        const y = 720 - row * 32;
+        const name = `p${p + 1}_r${row + 1}_c${column + 1}`;
+        content += `1 0 0 1 ${x} ${y + 20} Tm (${name}) Tj\n`;
+        const common =
+          `/Type /Annot /Subtype /Widget /P ${pageId} 0 R /F 4 /T (${name}) ` +
+          '/MK << /BC [0 0 0] >> /Border [0 0 1]';
+        if (row % 4 === 3) {
+          widgets.push(
+            writer.add(
+              `<< ${common} /FT /Btn /Rect [${x} ${y} ${x + 14} ${y + 14}] /V /Off /AS /Off >>`,
+            ),
+          );
+        } else {
+          widgets.push(
+            writer.add(
+              `<< ${common} /FT /Tx /Rect [${x} ${y} ${x + 200} ${y + 18}] ` +
+                `/DA (/Helv 10 Tf 0 g) /V (${sentence(random, 3)}) >>`,
+            ),
+          );
+        }
+      }
+    }
+    content += 'ET\n';
+    fieldIds.push(...widgets);
+    const contentId = await writer.addStream('', content);
+    writer.set(
+      pageId,
+      `<< /Type /Page /Parent ${pagesId} 0 R /MediaBox [0 0 ${PAGE_WIDTH} ${PAGE_HEIGHT}] ` +
+        `/Resources << /Font << /F1 ${fontId} 0 R >> >> /Contents ${contentId} 0 R ` +
+        `/Annots [${refs(widgets)}] >>`,
+    );
+    pageIds.push(pageId);
+  }
+  const acroForm =
+    ` /AcroForm << /Fields [${refs(fieldIds)}] ` +
+    `/DA (/Helv 0 Tf 0 g) /DR << /Font << /Helv ${fontId} 0 R >> >> /NeedAppearances true >>`;
+  return finishDocument(writer, pagesId, pageIds, acroForm);
+}
+
+async function loadTestFiles(): Promise<ICorpusDocument[]> {
+  const response = await fetch(TEST_FILES_INDEX);
+  if (!response.ok) {
+    throw new Error(`Failed to list test files: HTTP ${response.status}`);
+  }
+  const names = (await response.json()) as string[];
+  return Promise.all(
+    names.map(async (name): Promise<ICorpusDocument> => {
+      const file = await fetch(`/corpus/${encodeURIComponent(name)}`);
+      if (!file.ok) {
+        throw new Error(`Failed to fetch test file ${name}: HTTP ${file.status}`);
+      }
+      return {
+        name,
+        generated: false,
+        bytes: new Uint8Array(await file.arrayBuffer()),
+        password: TEST_FILE_PASSWORDS[name],
+        query: TEST_FILE_QUERY,
+      };
+    }),
+  );
+}
+
+/**
+ * The full corpus, test files first.
+ * @param only Document names to keep (all when empty)
+ */
+export async function loadCorpus(
+  options: ICorpusOptions = {},
+  only: string[] = [],
+): Promise<ICorpusDocument[]> {
+  const pages = (full: number) => (options.quick ? Math.max(1, Math.round(full / 10)) : full);
+  const wanted = (name: string) => only.length === 0 || only.includes(name);
+  const generators: [string, () => Promise<PdfBytes>][] = [
+    ['generated-large.pdf', () => generateLargeDocument(pages(500))],
+    ['generated-dense.pdf', () => generateDenseDocument(pages(20))],
+    ['generated-scanned.pdf', () => generateScannedDocument(pages(20))],
+    ['generated-forms.pdf', () => generateFormDocument(pages(30))],
+  ];
+
+  const documents = (await loadTestFiles()).filter((doc) => wanted(doc.name));
+  for (const [name, generate] of generators) {
+    if (!wanted(name)) continue;
+    documents.push({ name, generated: true, bytes: await generate(), query: GENERATED_QUERY });
+  }
+  return documents;
+}
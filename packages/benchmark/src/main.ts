@@ -0,0 +1,59 @@
+import { PDFIUM_BUILD } from '@pdfviewer/pdfium-wasm';
+
+import { type IBenchmarkConfig, runBenchmarks } from './benchmarks';
+import { loadCorpus } from './corpus';
+
+/** Where the page posts its report when started by scripts/bench.mjs */
+const RESULT_ENDPOINT = '/__bench/result';
+
+const params = new URLSearchParams(location.search);
+const output = document.getElementById('output') as HTMLPreElement;
+const status = document.getElementById('status') as HTMLParagraphElement;
+
+function numberParam(name: string, fallback: number): number {
+  const value = Number(params.get(name));
+  return Number.isFinite(value) && value > 0 ? value : fallback;
+}
+
+function buildParam(): IBenchmarkConfig['build'] {
+  const value = params.get('build');
+  return Object.values(PDFIUM_BUILD).includes(value as PDFIUM_BUILD)
+    ? (value as PDFIUM_BUILD)
+    : 'auto';
+}
+
+async function postResult(body: object): Promise<void> {
+  // Answered only when a runner is listening; a manual run just shows the report
+  await fetch(RESULT_ENDPOINT, {
+    method: 'POST',
+    headers: { 'Content-Type': 'application/json' },
+    body: JSON.stringify(body),
+  }).catch(() => undefined);
+}
+
+async function main(): Promise<void> {
+  const config: IBenchmarkConfig = {
+    iterations: Math.round(numberParam('iterations', 5)),
+    maxPages: Math.round(numberParam('maxPages', 50)),
+    scale: numberParam('scale', 1.5),
+    build: buildParam(),
+  };
+  const only = params.get('only')?.split(',').filter(Boolean) ?? [];
+
+  status.textContent = 'Preparing corpus';
+  const corpus = await loadCorpus({ quick: params.has('quick') }, only);
+  const report = await runBenchmarks(corpus, config, (message) => {
+    status.textContent = message;
+  });
+  const json = JSON.stringify(report, null, 2);
+  output.textContent = json;
+  status.textContent = 'Done';
+  await postResult(report);
+}
+
+main().catch(async (error: unknown) => {
+  const message = error instanceof Error ? (error.stack ?? error.message) : String(error);
+  status.textContent = 'Failed';
+  output.textContent = message;
+  await postResult({ error: message });
+});
@@ -0,0 +1,94 @@
+/**
+ * Minimal PDF writer for the generated part of the corpus: numbered objects,
+ * optionally Flate-compressed streams and a classic cross-reference table.
+ * Object bodies are ASCII; stream data may be binary.
+ */
+const encoder = new TextEncoder();
+
+/** Bytes backed by a plain ArrayBuffer, as Blob and File accept */
+export type PdfBytes = Uint8Array<ArrayBuffer>;
+
+/** zlib-wrapped deflate, which is what /FlateDecode expects */
+export async function deflate(data: PdfBytes): Promise<PdfBytes> {
+  const stream = new Blob([data]).stream().pipeThrough(new CompressionStream('deflate'));
+  return new Uint8Array(await new Response(stream).arrayBuffer());
+}
+
+export class PdfWriter {
+  /** Serialized objects by number - 1; null until set() */
+  private objects: (Uint8Array[] | null)[] = [];
+
+  /** Reserve an object number, e.g. for a parent that is written after its kids. */
+  public reserve(): number {
+    this.objects.push(null);
+    return this.objects.length;
+  }
+
+  public add(body: string): number {
+    const id = this.reserve();
+    this.set(id, body);
+    return id;
+  }
+
+  public set(id: number, body: string): void {
+    this.objects[id - 1] = [encoder.encode(body)];
+  }
+
+  /**
+   * Add a stream object. dict holds its entries other than /Length and /Filter.
+   * @param compress Deflate the data and mark it /FlateDecode
+   */
+  public async addStream(dict: string, data: PdfBytes | string, compress = true): Promise<number> {
+    let bytes = typeof data === 'string' ? encoder.encode(data) : data;
+    let filter = '';
+    if (compress) {
+      bytes = await deflate(bytes);
+      filter = ' /Filter /FlateDecode';
+    }
+    const id = this.reserve();
+    this.objects[id - 1] = [
+      encoder.encode(`<< ${dict}${filter} /Length ${bytes.length} >>\nstream\n`),
+      bytes,
+      encoder.encode('\nendstream'),
+    ];
+    return id;
+  }
+
+  /** Serialize the file with rootId as the /Root catalog. */
+  public build(rootId: number): PdfBytes {
+    // Binary comment after the header marks the file as 8-bit
+    const chunks: Uint8Array[] = [
+      encoder.encode('%PDF-1.7\n'),
+      new Uint8Array([0x25, 0xe2, 0xe3, 0xcf, 0xd3, 0x0a]),
+    ];
+    let offset = chunks[0].length + chunks[1].length;
+    const offsets: number[] = [];
+    this.objects.forEach((parts, index) => {
+      if (!parts) throw new Error(`PDF object ${index + 1} was reserved but never set`);
+      offsets.push(offset);
+      const objectParts = [encoder.encode(`${index + 1} 0 obj\n`), ...parts];
+      objectParts.push(encoder.encode('\nendobj\n'));
+      for (const part of objectParts) {
+        chunks.push(part);
+        offset += part.length;
+      }
+    });
+
+    // Each xref entry is exactly 20 bytes, including the two-byte end of line
+    const size = this.objects.length + 1;
+    let xref = `xref\n0 ${size}\n0000000000 65535 f \n`;
+    for (const objectOffset of offsets) {
+      xref += `${String(objectOffset).padStart(10, '0')} 00000 n \n`;
+    }
+    xref += `trailer\n<< /Size ${size} /Root ${rootId} 0 R >>\nstartxref\n${offset}\n%%EOF\n`;
+    chunks.push(encoder.encode(xref));
+
+    const out = new Uint8Array(chunks.reduce((total, chunk) => total + chunk.length, 0));
+    let position = 0;
+    for (const chunk of chunks) {
+      out.set(chunk, position);
+      position += chunk.length;
+    }
+    return out;
+  }
+}
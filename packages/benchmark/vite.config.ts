@@ -0,0 +1,56 @@
+import fs from 'fs';
+import path from 'path';
+import { fileURLToPath } from 'url';
+import { defineConfig } from 'vite';
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+
+const testFilesPath = path.resolve(__dirname, '../../test_files');
+
+// https://vite.dev/config/
+export default defineConfig({
+  plugins: [
+    {
+      name: 'serve-test-files',
+      configureServer(server) {
+        // GET /corpus/index.json lists the PDFs in test_files/, /corpus/<name> serves one
+        server.middlewares.use('/corpus', (req, res, next) => {
+          const name = decodeURIComponent((req.url ?? '/').slice(1).split('?')[0]);
+          if (name === 'index.json') {
+            const names = fs.readdirSync(testFilesPath).filter((file) => file.endsWith('.pdf'));
+            res.writeHead(200, { 'Content-Type': 'application/json' });
+            res.end(JSON.stringify(names.sort()));
+            return;
+          }
+          if (!name.endsWith('.pdf') || path.basename(name) !== name) {
+            next();
+            return;
+          }
+          const filePath = path.join(testFilesPath, name);
+          if (!fs.existsSync(filePath)) {
+            next();
+            return;
+          }
+          res.writeHead(200, { 'Content-Type': 'application/pdf' });
+          fs.createReadStream(filePath).pipe(res);
+        });
+      },
+    },
+  ],
+  resolve: {
+    // Run against the sources, so a rebuilt wasm/ is measured without a TypeScript build
+    alias: {
+      '@pdfviewer/controller': path.resolve(__dirname, '../controller/src/index.ts'),
+      '@pdfviewer/pdfium-wasm': path.resolve(__dirname, '../pdfium-wasm/src/index.ts'),
+    },
+  },
+  optimizeDeps: {
+    exclude: ['@pdfviewer/pdfium-wasm'],
+  },
+  assetsInclude: ['**/*.wasm'],
+  server: {
+    host: '127.0.0.1',
+    port: 5180,
+    strictPort: false,
+  },
+});
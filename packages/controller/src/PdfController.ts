@@ -1,14 +1,49 @@
 /// <reference lib="dom" />
 import {
   type IPDFiumModule,
+  type IPdfiumStartupTimings,
   createPdfiumModule,
+  getPdfiumStartupTimings,
+  preloadPdfiumModule,
   FPDF_ANNOTATION_SUBTYPE,
   FPDF_ANNOT_APPEARANCEMODE,
   FPDF_ANNOT_FLAG,
   FPDFANNOT_COLORTYPE,
   FPDF_ERR,
+  ASYNC_RENDER_STATUS,
+  TEXT_LAYOUT_OPTION,
+  HIT_TEST_KIND,
+  THUMBNAIL_OPTION,
+  THUMBNAIL_SOURCE,
+  PDF_DATA_STATUS,
+  ANNOT_SERIALIZE_OPTION,
+  ANNOT_RECORD_FIELD,
+  EDIT_OP,
+  EDIT_STATUS,
+  ENCRYPT_ALGORITHM,
+  PDF_PERMISSION,
+  PERF_COUNTER,
+  MEMORY_TRIM,
+  OUTLINE_NODE_FLAG,
+  OUTLINE_DEST,
 } from '@pdfviewer/pdfium-wasm';
 import type { IPdfOutlineNode } from './outlineTypes';
+import { createBlobByteSource, type IPdfByteSource } from './byteSource';
+import { RasterCache } from './rasterCache';
+import { TimingStats, type IPerfTiming } from './perfCounters';
+import {
+  batchPageIndices,
+  type IBatchOptions,
+  type IPageImage,
+  type IPageImageOptions,
+  type IPageRange,
+  type IPageText,
+} from './batchJob';
+import {
+  RenderScheduler,
+  type IRenderViewport,
+  type IScheduledRenderOptions,
+} from './renderScheduler';
 
 /**
  * PDFium render flags for FPDF_RenderPageBitmap
@@ -19,10 +54,342 @@ const FPDF_RENDER_FLAGS = {
   ANNOT: 0x01,
   /** Use LCD text rendering for crisper text on LCD displays */
   LCD_TEXT: 0x02,
+  /** Write RGBA instead of PDFium's native BGRA, so no JS swizzle is needed */
+  REVERSE_BYTE_ORDER: 0x10,
+  /** Render for printing: annotations are drawn as printed */
+  PRINTING: 0x800,
   /** Combined flags for high-quality screen rendering */
   DEFAULT: 0x01 | 0x02, // ANNOT + LCD_TEXT
 };
 
+/**
+ * Time slice (ms) a progressive render may run before yielding to the event
+ * loop. The async render queue shares one slice between all in-flight renders.
+ */
+const RENDER_SLICE_MS = 8;
+
+type IAsyncRenderModule = IPDFiumModule &
+  Required<
+    Pick<
+      IPDFiumModule,
+      | '_PDFium_RenderLoadedPageAsync'
+      | '_PDFium_RenderAsyncPump'
+      | '_PDFium_RenderAsyncPoll'
+      | '_PDFium_RenderAsyncGetBuffer'
+      | '_PDFium_RenderAsyncCancel'
+      | '_PDFium_RenderAsyncRelease'
+    >
+  >;
+
+type IRenderJobModule = IPDFiumModule &
+  Required<
+    Pick<
+      IPDFiumModule,
+      | '_PDFium_RenderJobCreate'
+      | '_PDFium_RenderJobCancel'
+      | '_PDFium_RenderJobStart'
+      | '_PDFium_RenderJobContinue'
+      | '_PDFium_RenderJobDestroy'
+    >
+  >;
+
+type IFileLoaderModule = IPDFiumModule &
+  Required<
+    Pick<
+      IPDFiumModule,
+      | '_PDFium_LoaderCreate'
+      | '_PDFium_LoaderDestroy'
+      | '_PDFium_LoaderSupply'
+      | '_PDFium_LoaderTakeRequests'
+      | '_PDFium_LoaderNextMissing'
+      | '_PDFium_LoaderIsComplete'
+      | '_PDFium_LoaderIsDocAvail'
+      | '_PDFium_LoaderGetDocument'
+      | '_PDFium_LoaderGetFirstPageNum'
+      | '_PDFium_LoaderIsPageAvail'
+    >
+  >;
+
+/** Files at least this large open through the progressive loader instead of one heap copy */
+const PROGRESSIVE_LOAD_MIN_BYTES = 16 * 1024 * 1024;
+/** Chunk size of the progressive loader; every read is aligned to it */
+const LOADER_CHUNK_BYTES = 256 * 1024;
+/** Largest single read of the background prefetch */
+const LOADER_PREFETCH_BYTES = 4 * 1024 * 1024;
+/**
+ * Bytes the background read pulls into the heap ahead of use. Past that, pages are read
+ * when first shown, and the rest of the file only when whenFullyLoaded() asks for it.
+ */
+const LOADER_BACKGROUND_LIMIT_BYTES = 64 * 1024 * 1024;
+/** Ranges taken from _PDFium_LoaderTakeRequests per round */
+const LOADER_MAX_RANGES = 64;
+
+/** A progressively loading document: its native loader and where its bytes come from */
+interface IFileLoaderState {
+  ptr: number;
+  source: IPdfByteSource;
+  firstPage: number;
+  /** Set once the native loader is destroyed; pending reads must not supply it */
+  closed: boolean;
+  /** Set once every byte has been supplied */
+  complete: boolean;
+  /** File offset the next in-order read starts from, shared by every reader */
+  cursor: number;
+  /** Background read of the first LOADER_BACKGROUND_LIMIT_BYTES missing bytes */
+  prefetch: Promise<void>;
+  /** Read of everything still missing, started by whenFullyLoaded() */
+  fullRead: Promise<void> | null;
+}
+
+type ISearchCursorModule = IPDFiumModule &
+  Required<
+    Pick<
+      IPDFiumModule,
+      '_PDFium_SearchCursorStart' | '_PDFium_SearchCursorContinue' | '_PDFium_SearchCursorClose'
+    >
+  >;
+
+type IStreamingSaveModule = IPDFiumModule &
+  Required<Pick<IPDFiumModule, '_PDFium_SaveToSink'>>;
+
+/** File System Access API save dialog; Chromium only, so typed locally */
+type ISaveFilePicker = (options: {
+  suggestedName?: string;
+  types?: { description?: string; accept: Record<string, string[]> }[];
+}) => Promise<{ createWritable(): Promise<WritableStream<Uint8Array>> }>;
+
+type IIncrementalSaveModule = IPDFiumModule &
+  Required<Pick<IPDFiumModule, '_PDFium_SaveIncrementalToSink'>>;
+
+/** Kind of edit that made a page dirty */
+type DirtyKind = 'annotations' | 'forms' | 'content';
+
+/** What changed in the open document since it was opened */
+export interface IDirtyState {
+  /** Changed pages, ascending */
+  pages: number[];
+  /** Annotations were added or hidden */
+  annotations: boolean;
+  /** Form field values were set */
+  forms: boolean;
+  /** Page objects were added or edited, i.e. content streams regenerate */
+  content: boolean;
+}
+
+type IEncryptedSaveModule = IPDFiumModule &
+  Required<Pick<IPDFiumModule, '_PDFium_SaveEncryptedToBuffer'>>;
+
+/** Password protection applied by exportEncryptedPdfBytes */
+export interface IPdfEncryptionOptions {
+  userPassword: string;
+  /** Password that lifts the permission restrictions; defaults to userPassword */
+  ownerPassword?: string;
+  /** PDF_PERMISSION bits granted with the user password (default PDF_PERMISSION.ALL) */
+  permissions?: number;
+  /** Default ENCRYPT_ALGORITHM.AES_128 */
+  algorithm?: ENCRYPT_ALGORITHM;
+  /** PDF version as in exportPdfBytes; raised to what the algorithm requires */
+  version?: number;
+}
+
+type IEditTransactionModule = IPDFiumModule &
+  Required<Pick<IPDFiumModule, '_PDFium_EditBegin' | '_PDFium_EditApply' | '_PDFium_EditCommit'>>;
+
+/** Status of an edit command _PDFium_EditApply never reached (it trapped first) */
+const EDIT_NOT_RUN = -1;
+
+/** One command of a native edit transaction; objects are indexed as of _PDFium_EditBegin */
+type IEditCommand =
+  | { op: EDIT_OP.SET_TEXT; objectIndex: number; text: string }
+  | { op: EDIT_OP.MOVE_TO; objectIndex: number; x: number; y: number }
+  | { op: EDIT_OP.SET_FILL_COLOR; objectIndex: number; color: IRgbaColor }
+  | { op: EDIT_OP.REMOVE; objectIndex: number }
+  | {
+      op: EDIT_OP.INSERT_TEXT;
+      /** Object whose font the new text uses (-1 = Helvetica) */
+      fontObjectIndex: number;
+      fontSize: number;
+      color: IRgbaColor;
+      x: number;
+      y: number;
+      text: string;
+    };
+
+type IRgbaColor = IReflowLineUpdate['color'];
+
+type IPageCacheModule = IPDFiumModule &
+  Required<
+    Pick<
+      IPDFiumModule,
+      | '_PDFium_PageCacheCreate'
+      | '_PDFium_PageCacheDestroy'
+      | '_PDFium_PageCacheSetBudget'
+      | '_PDFium_PageCacheAcquire'
+      | '_PDFium_PageCacheAcquireText'
+      | '_PDFium_PageCacheRelease'
+      | '_PDFium_PageCacheReleaseText'
+      | '_PDFium_PageCacheInvalidate'
+      | '_PDFium_PageCacheGetStats'
+    >
+  >;
+
+type IThumbnailModule = IPDFiumModule &
+  Required<
+    Pick<IPDFiumModule, '_PDFium_RenderThumbnailRGBA' | '_PDFium_RenderThumbnailAtlas'>
+  >;
+
+/** Most pages drawn into one thumbnail atlas by prefetchThumbnails */
+const THUMBNAIL_ATLAS_MAX_PAGES = 16;
+
+type ISpatialIndexModule = IPageCacheModule &
+  Required<Pick<IPDFiumModule, '_PDFium_HitTest' | '_PDFium_QueryRange'>>;
+
+type IPerfCounterModule = IPDFiumModule &
+  Required<
+    Pick<
+      IPDFiumModule,
+      '_PDFium_SetPerfEnabled' | '_PDFium_ResetPerfCounters' | '_PDFium_GetPerfCounters'
+    >
+  >;
+
+/** Native counter names, indexed by PERF_COUNTER */
+const NATIVE_PERF_COUNTERS = {
+  [PERF_COUNTER.LOAD_DOCUMENT]: 'loadDocument',
+  [PERF_COUNTER.LOAD_PAGE]: 'loadPage',
+  [PERF_COUNTER.LOAD_TEXT_PAGE]: 'loadTextPage',
+  [PERF_COUNTER.RENDER]: 'render',
+  [PERF_COUNTER.RENDER_SLICE]: 'renderSlice',
+  [PERF_COUNTER.SEARCH]: 'search',
+  [PERF_COUNTER.SAVE]: 'save',
+} as const;
+/** float64 fields of the _PDFium_GetPerfCounters header and of each counter row */
+const PERF_HEADER_FIELDS = 8;
+const PERF_COUNTER_FIELDS = 8;
+
+type IOutlineModule = IPDFiumModule & Required<Pick<IPDFiumModule, '_PDFium_SerializeOutline'>>;
+
+/** int32 header words of a _PDFium_SerializeOutline buffer */
+const OUTLINE_HEADER_WORDS = 4;
+
+type IMemoryTrimModule = IPDFiumModule & Required<Pick<IPDFiumModule, '_PDFium_MemoryTrim'>>;
+
+/** float64 fields of the _PDFium_MemoryTrim report */
+const MEMORY_TRIM_REPORT_FIELDS = 9;
+/** Default heap size past which cached engine memory is trimmed (MAXIMUM_MEMORY is 512 MiB) */
+const MEMORY_BUDGET_BYTES = 384 * 1024 * 1024;
+/** Automatic trims release memory until this fraction of the budget is in use */
+const MEMORY_TRIM_TARGET = 0.75;
+/** Least time between two automatic trims */
+const MEMORY_TRIM_INTERVAL_MS = 1000;
+/** Growth in use past what the last automatic trim could not release before trimming again */
+const MEMORY_TRIM_REGROWTH_BYTES = 16 * 1024 * 1024;
+
+/** Default budget of the native page cache: parsed pages kept alive between calls */
+const PAGE_CACHE_MAX_PAGES = 8;
+/** Default budget of the native page cache's estimated size */
+const PAGE_CACHE_MAX_BYTES = 32 * 1024 * 1024;
+/** Default hit slop of hitTest, in canvas pixels */
+const HIT_TEST_TOLERANCE_PX = 2;
+/** Default pixel budget of the raster cache (RGBA bytes of all cached renders) */
+const RASTER_CACHE_MAX_BYTES = 96 * 1024 * 1024;
+
+/** Chunk size of streaming saves; the heap holds at most one chunk of output */
+const SAVE_CHUNK_BYTES = 1024 * 1024;
+/** Extra room reserved over the source length for _PDFium_SaveToBuffer */
+const SAVE_RESERVE_SLACK_BYTES = 256 * 1024;
+/** Next id to register in pdfiumSaveSinks */
+let nextSaveSinkId = 1;
+/** FPDF_INCREMENTAL save flag: append changes to the original file */
+const FPDF_SAVE_INCREMENTAL = 1;
+
+/**
+ * Time slice (ms) one step of searchTextStream may run before its results are
+ * yielded and the event loop gets control back.
+ */
+const SEARCH_SLICE_MS = 8;
+
+/** Default resolution of exportPageImage and renderPages */
+const BATCH_DEFAULT_DPI = 150;
+/**
+ * Pages renderPages renders ahead while earlier ones are still encoding; bounds the
+ * pixels held at once
+ */
+const BATCH_RENDER_WINDOW = 4;
+/** Time slice (ms) one step of extractText may run before its pages are yielded */
+const BATCH_TEXT_SLICE_MS = 12;
+/** Header size (int32 words) of the _PDFium_ExtractPagesText buffer */
+const TEXT_BATCH_HEADER_WORDS = 4;
+
+/** Header size (int32 words) of the _PDFium_ExtractTextLayout buffer */
+const TEXT_LAYOUT_HEADER_WORDS = 8;
+
+/** Packed _PDFium_SearchIndexQuery buffer: int32 header and per-result record sizes */
+const SEARCH_HEADER_WORDS = 4;
+const SEARCH_RESULT_WORDS = 5;
+
+/** Header size (int32 words) of the _PDFium_SerializePageAnnotations buffer */
+const ANNOT_HEADER_WORDS = 4;
+
+/** Header size (int32 words) of the _PDFium_EnumerateTextObjects buffer */
+const TEXT_OBJECT_HEADER_WORDS = 8;
+
+/** A page text object, decoded from a _PDFium_EnumerateTextObjects record */
+interface IEnumeratedTextObject {
+  objectIndex: number;
+  content: string;
+  /** Font base name, or undefined when the object has no font */
+  fontName?: string;
+  fontSize: number;
+  renderMode: number;
+  fillColor: { r: number; g: number; b: number; a: number };
+  /** Page-space bounds */
+  bounds: { left: number; bottom: number; right: number; top: number };
+  /** Device rect at the requested scale */
+  deviceRect: { left: number; top: number; width: number; height: number };
+  /** Object matrix [a, b, c, d, e, f] */
+  matrix: number[];
+}
+
+/** Packed _PDFium_SnapshotFormFields buffer: int32 header and per-option record sizes */
+const FORM_HEADER_WORDS = 4;
+const FORM_OPTION_WORDS = 3;
+
+/** One annotation decoded from a _PDFium_SerializePageAnnotations record (device coordinates) */
+interface ISerializedAnnotation {
+  annotIndex: number;
+  subtype: FPDF_ANNOTATION_SUBTYPE;
+  fields: number;
+  color: { r: number; g: number; b: number; a: number };
+  interiorColor: { r: number; g: number; b: number; a: number };
+  /** Device (left, top) and (right, bottom) corners */
+  rect: [number, number, number, number];
+  borderWidth: number;
+  /** Quads as flat FS_QUADPOINTSF coordinates (x1, y1 .. x4, y4) */
+  quads: Float32Array[];
+  /** Ink paths as flat x, y coordinates */
+  inkPaths: Float32Array[];
+  uri?: string;
+  destPageIndex?: number;
+}
+
+/** Text layout of a char range, copied out of a _PDFium_ExtractTextLayout buffer */
+interface ITextLayout {
+  count: number;
+  deviceLeft: Float32Array;
+  deviceTop: Float32Array;
+  deviceWidth: Float32Array;
+  deviceHeight: Float32Array;
+  charIndex: Int32Array;
+  textStart: Int32Array;
+  textLength: Int32Array;
+  fontSize: Float32Array;
+  /** Packed bytes R, G, B, A */
+  fillColor: Uint32Array;
+  fontIndex: Int32Array;
+  text: Uint16Array;
+  fonts: string[];
+}
+
 const FPDF_PAGE_OBJECT_TYPE = {
   UNKNOWN: 0,
   TEXT: 1,
@@ -78,6 +445,19 @@ export interface IRenderOptions {
   pixelRatio?: number;
   /** AbortSignal for cancelling progressive rendering */
   signal?: AbortSignal;
+  /**
+   * Thumbnail quality: the page's embedded /Thumb image when it fits, else a draft render
+   * without anti-aliasing. Cached apart from full-quality renders.
+   */
+  draft?: boolean;
+}
+
+/** A rectangle in device pixels of the page rendered at a given scale (top-left origin) */
+export interface ITileRect {
+  x: number;
+  y: number;
+  width: number;
+  height: number;
 }
 
 export interface IPageDimension {
@@ -140,9 +520,27 @@ export interface ITextEditResult {
   usedFallbackFont: boolean;
 }
 
+/** What lies under a point of a page; each index is -1 when nothing of that kind is hit */
+export interface IHitTestResult {
+  /** Char index in the page's text */
+  charIndex: number;
+  /** Annotation index of a LINK annotation (as in listNativeAnnotations ids) */
+  linkAnnotIndex: number;
+  /** Annotation index of any other visible annotation, topmost first */
+  annotIndex: number;
+}
+
+/** A run of consecutive chars of a page's text */
+export interface ICharRange {
+  start: number;
+  count: number;
+}
+
 export interface ISearchResult {
   pageIndex: number;
   matchIndex: number;
+  /** Index of the first matched char in the page's text */
+  charIndex: number;
   rects: { left: number; top: number; width: number; height: number }[];
   text: string;
 }
@@ -185,14 +583,147 @@ export interface IFormField {
   controlIndex?: number;
 }
 
+/** Counters of the native page cache since the document was opened */
+export interface IPageCacheStats {
+  hits: number;
+  misses: number;
+  evictions: number;
+  /** Pages currently cached */
+  pages: number;
+  /** Estimated size of the cached pages in bytes */
+  estimatedBytes: number;
+}
+
+export type NativePerfCounterName = (typeof NATIVE_PERF_COUNTERS)[PERF_COUNTER];
+
+/** Calls, durations and heap growth of one group of native entry points */
+export interface INativePerfCounter extends IPerfTiming {
+  /** Linear memory newly claimed by the allocator during the calls */
+  heapGrowthBytes: number;
+}
+
+/** WASM heap use in bytes */
+export interface IHeapStats {
+  /** Bytes the allocator has handed out and not yet freed */
+  usedBytes: number;
+  /** Highest heap break seen since the counters were reset */
+  peakBytes: number;
+  /** Current size of linear memory */
+  sizeBytes: number;
+  /** MAXIMUM_MEMORY, the size linear memory may grow to */
+  maxBytes: number;
+  /** maxBytes - peakBytes */
+  headroomBytes: number;
+}
+
+/** Profiling counters, collected while enabled with setPerfCountersEnabled(true) */
+export interface IPerfCounters {
+  enabled: boolean;
+  /** Native entry points by counter; null when the WASM binary has no counters */
+  native: Record<NativePerfCounterName, INativePerfCounter> | null;
+  heap: IHeapStats | null;
+  /** JS side of drawing a render: RGBA copy out of the heap, and putImageData */
+  js: { rgbaCopy: IPerfTiming; putImageData: IPerfTiming };
+}
+
+/**
+ * How much trimMemory() releases. moderate keeps parsed pages; critical drops everything
+ * that is rebuilt on demand.
+ */
+export type MemoryTrimLevel = 'moderate' | 'critical';
+
+/** What _PDFium_MemoryTrim released, and the heap afterwards (bytes) */
+export interface INativeMemoryTrim {
+  usedBeforeBytes: number;
+  usedAfterBytes: number;
+  /** Bytes the heap can still hand out without growing */
+  freeBytes: number;
+  heapSizeBytes: number;
+  heapMaxBytes: number;
+  poolBytesFreed: number;
+  spatialIndexesFreed: number;
+  textPagesClosed: number;
+  pagesClosed: number;
+}
+
+export interface IMemoryTrimReport {
+  level: MemoryTrimLevel;
+  /** null when the WASM binary has no memory governor */
+  native: INativeMemoryTrim | null;
+  /** RGBA bytes of cached renders released */
+  rasterBytesFreed: number;
+  searchIndexReleased: boolean;
+  /** Pages kept because they hold in-memory edits that are not saved yet */
+  editPagesRetained: number;
+}
+
+/** Engine startup breakdown in milliseconds, for cold versus warm open telemetry */
+export interface IStartupTimings extends IPdfiumStartupTimings {
+  /** PDFium_Init (FPDF_InitLibraryWithConfig) */
+  initMs: number;
+}
+
 export interface IPdfController {
   ensureInitialized(): Promise<void>;
+  /** Fetch and compile the engine binary ahead of ensureInitialized(), e.g. at idle time. */
+  preload(): Promise<void>;
+  /** Startup timings of this controller's engine, once initialized. */
+  getStartupTimings(): IStartupTimings | null;
   loadFile(file: File, opts?: { signal?: AbortSignal; password?: string }): Promise<void>;
+  /** Open a document from a random-access byte source, reading blocks on demand. */
+  loadSource(
+    source: IPdfByteSource,
+    opts?: { signal?: AbortSignal; password?: string },
+  ): Promise<void>;
+  /** Wait until a progressively loading page's data has arrived. */
+  ensurePageAvailable(pageIndex: number, signal?: AbortSignal): Promise<void>;
+  /**
+   * Read the rest of a progressively loaded document; resolves once every byte has
+   * arrived. The background read stops after its budget, so saving and the outline wait
+   * for this.
+   */
+  whenFullyLoaded(): Promise<void>;
+  /** Pages and kinds of edits changed since the document was opened. */
+  getDirtyState(): IDirtyState;
+  /**
+   * The file or blob the open document was loaded from, without the edits made since;
+   * null when it was opened from bytes alone.
+   */
+  getSourceBlob(): Blob | null;
   /** Render a PDF page to canvas. Supports AbortSignal for cancellation when using progressive rendering. */
   renderPdf(canvas: HTMLCanvasElement, options?: IRenderOptions): Promise<void>;
+  /** renderPdf through the shared priority queue; ranked against the viewport. */
+  scheduleRender(canvas: HTMLCanvasElement, options?: IScheduledRenderOptions): Promise<void>;
+  /** Tell the render queue which pages are focused and visible. */
+  setRenderViewport(viewport: IRenderViewport): void;
+  /**
+   * Draw draft thumbnails of a page range in one engine call and keep them in the raster
+   * cache, so draft renders of those pages at this scale draw from memory.
+   */
+  prefetchThumbnails(
+    firstPage: number,
+    count: number,
+    opts: { scale: number; pixelRatio?: number },
+  ): Promise<void>;
+  /** Render only a device-space tile of a page (for deep zoom); returns RGBA pixels. */
+  renderTile(pageIndex: number, scale: number, tileRect: ITileRect): ImageData;
+  /**
+   * Size of a page in points. A progressively loading page whose data has not arrived
+   * reports the first page's size; onPageSizesChanged announces when its own is known.
+   */
   getPageDimension(pageIndex: number): IPageDimension;
+  /**
+   * Call listener with the pages (ascending) whose data arrived after getPageDimension
+   * gave them the first page's size, so they can be measured again.
+   * @returns Stops listening
+   */
+  onPageSizesChanged(listener: (pageIndices: number[]) => void): () => void;
+  /** Empty while a progressively loading page is missing data (see ensurePageAvailable). */
   listNativeAnnotations(pageIndex: number, opts: { scale: number }): INativeAnnotation[];
+  /** Empty while a progressively loading page is missing data (see ensurePageAvailable). */
   listFormFields(pageIndex: number, opts: { scale: number }): IFormField[];
+  /** Form fields of every page, read in one native pass when available. */
+  listAllFormFields(opts: { scale: number }): IFormField[];
   hideAnnotation(pageIndex: number, annotIndex: number): void;
   setFormFieldValue(field: IFormField, value: string | boolean): void;
   addInkHighlight(pageIndex: number, opts: { scale: number; canvasPoints: IPoint[] }): void;
@@ -222,7 +753,23 @@ export interface IPdfController {
     },
   ): void;
   exportPdfBytes(options?: { flags?: number; version?: number }): Uint8Array;
-  downloadPdf(filename?: string, options?: { flags?: number; version?: number }): void;
+  /**
+   * Save as the original file plus an incremental update with only the changed objects;
+   * cost scales with the edit rather than the document.
+   */
+  exportIncrementalPdf(): Promise<Blob>;
+  /** Whether the WASM binary can encrypt while saving (see exportEncryptedPdfBytes). */
+  supportsNativeEncryption(): boolean;
+  /**
+   * Export the document password-protected in a single save. Returns null when the binary
+   * lacks encrypted save or could not encrypt this document; callers then fall back.
+   */
+  exportEncryptedPdfBytes(options: IPdfEncryptionOptions): Uint8Array | null;
+  downloadPdf(filename?: string, options?: { flags?: number; version?: number }): Promise<void>;
+  savePdfToStream(
+    stream: WritableStream<Uint8Array>,
+    options?: { flags?: number; version?: number },
+  ): Promise<void>;
   addImageObject(
     pageIndex: number,
     opts: {
@@ -231,11 +778,37 @@ export interface IPdfController {
       imageRgbaBytes: Uint8Array;
       imageWidthPx: number;
       imageHeightPx: number;
+      /** Source JPEG of the pixels, embedded as is when the WASM binary supports it */
+      imageJpegBytes?: Uint8Array;
     },
   ): void;
   getPageCount(): number;
+  /** Empty until a progressively loaded document has fully arrived (see whenFullyLoaded). */
   getOutline(): IPdfOutlineNode[];
+  /**
+   * Children of an outline node by its id, maxDepth levels deep (<= 0 = all), e.g. to
+   * expand a node flagged hasMoreChildren. Empty for an id that getOutline() or this
+   * method did not return for the open document.
+   */
+  getOutlineChildren(id: number, maxDepth?: number): IPdfOutlineNode[];
+  /** Null while a progressively loading page is missing data (see ensurePageAvailable). */
   getPageTextContent(pageIndex: number): IPageTextContent | null;
+  /**
+   * Char, link and annotation under a canvas point, in one engine call per pointer event.
+   * Null when the WASM binary has no spatial index or the page is being edited.
+   */
+  hitTest(
+    pageIndex: number,
+    opts: { scale: number; canvasPoint: IPoint; kinds?: HIT_TEST_KIND; tolerance?: number },
+  ): IHitTestResult | null;
+  /** Chars inside a canvas rect as ascending index ranges; null like hitTest. */
+  getCharRangesInRect(
+    pageIndex: number,
+    opts: {
+      scale: number;
+      canvasRect: { left: number; top: number; width: number; height: number };
+    },
+  ): ICharRange[] | null;
   listEditableTextObjects(pageIndex: number, opts: { scale: number }): IEditableTextObject[];
   updateEditableTextObjects(
     pageIndex: number,
@@ -257,9 +830,43 @@ export interface IPdfController {
     },
   ): ITextEditResult;
   releaseEditPages(): void;
+  /** Limit how many parsed pages (and their estimated bytes) the native page cache keeps. */
+  setPageCacheBudget(maxPages: number, maxBytes: number): void;
+  /** Native page cache counters, or null when the WASM binary has no page cache. */
+  getPageCacheStats(): IPageCacheStats | null;
+  /** Start or stop collecting profiling counters (off by default). */
+  setPerfCountersEnabled(enabled: boolean): void;
+  /** Zero the profiling counters. */
+  resetPerfCounters(): void;
+  /** Native call counts, durations and heap use, plus the JS timings of drawing renders. */
+  getPerfCounters(): IPerfCounters;
+  /** Limit the RGBA bytes of rendered pages kept for redraws (0 disables the cache). */
+  setRasterCacheBudget(maxBytes: number): void;
+  /** Heap size past which renders trim cached engine memory (0 disables the trims). */
+  setMemoryBudget(maxHeapBytes: number): void;
+  /** Release cached memory now, e.g. when the page is hidden or about to be frozen. */
+  trimMemory(level: MemoryTrimLevel): IMemoryTrimReport;
   destroy(): void;
   setFontMap(map: Record<string, string>): void;
   searchText(text: string, opts?: { scale?: number }): ISearchResult[];
+  searchTextStream(
+    text: string,
+    opts?: { scale?: number; startPage?: number; signal?: AbortSignal },
+  ): AsyncGenerator<ISearchResult[], void, undefined>;
+  /** Render one whole page to an image, with any in-memory edits. */
+  exportPageImage(pageIndex: number, opts?: IPageImageOptions): Promise<IPageImage>;
+  /** Plain text of count pages from firstPage, waiting for pages still downloading. */
+  getPagesText(firstPage: number, count: number): Promise<IPageText[]>;
+  /** Render a range of pages to images, yielded in page order. */
+  renderPages(
+    range?: IPageRange,
+    opts?: IPageImageOptions & IBatchOptions,
+  ): AsyncGenerator<IPageImage, void, undefined>;
+  /** Plain text of a range of pages, yielded in page order a time slice at a time. */
+  extractText(
+    range?: IPageRange,
+    opts?: IBatchOptions,
+  ): AsyncGenerator<IPageText[], void, undefined>;
 }
 
 export class PdfPasswordError extends Error {
@@ -278,6 +885,16 @@ export class PdfController implements IPdfController {
   private docPtr: number | null = null;
   private dataPtr: number | null = null;
   private initPromise: Promise<void> | null = null;
+  private startupTimings: IStartupTimings | null = null;
+  /** Profiling switch, applied to the engine once it is initialized */
+  private perfEnabled = false;
+  private rgbaCopyTiming = new TimingStats();
+  /** Heap size that triggers an automatic trim (0 = never) */
+  private memoryBudget = MEMORY_BUDGET_BYTES;
+  private lastMemoryTrim = -Infinity;
+  /** Bytes in use the last automatic trim could not get below its target (0 = it did) */
+  private memoryTrimFloor = 0;
+  private putImageDataTiming = new TimingStats();
   private loadSeq = 0;
   private fontMap = new Map<string, string>();
   private static utf8Decoder = new TextDecoder('utf-8');
@@ -307,6 +924,71 @@ export class PdfController implements IPdfController {
    * For those pages we switch to replacement mode (remove old object, insert new text object).
    */
   private editPageReplaceOnly = new Set<number>();
+  /**
+   * Pending native async renders (job id -> resolver). A single pump loop
+   * advances all of them together, so visible pages and sidebar thumbnails
+   * render side by side instead of one after another.
+   */
+  private asyncRenderWaiters = new Map<number, (status: number) => void>();
+  private asyncRenderPumpScheduled = false;
+  /**
+   * Native search index for the open document (0 = not created yet). Keeps
+   * each page's folded text after the first query so later keystrokes do not
+   * reload every page; pages are invalidated when their content is regenerated.
+   */
+  private searchIndexPtr = 0;
+  /** Open native search cursors; they read from searchIndexPtr and close with it. */
+  private searchCursors = new Set<number>();
+  /** Progressive loader of the open document (null when it was loaded from memory). */
+  private fileLoader: IFileLoaderState | null = null;
+  /**
+   * Bookmark handles handed out as outline node ids for the open document. Only these
+   * reach PDFium from getOutlineChildren(), so an id kept from an earlier document (its
+   * handle freed with it) is refused instead of dereferenced.
+   */
+  private outlineIds = new Set<number>();
+  /** Pages getPageDimension sized as the first page while their data was missing */
+  private placeholderSizedPages = new Set<number>();
+  private pageSizeListeners = new Set<(pageIndices: number[]) => void>();
+  /**
+   * Native font name table of the open document (0 = not created yet) and the
+   * names read from it so far, indexed by font id.
+   */
+  private fontTablePtr = 0;
+  private fontTableNames: string[] = [];
+  /** Byte length of the open document's source; sizes the save buffer up front. */
+  private sourceSize = 0;
+  /** The open document's source file, when it came from one (see exportIncrementalPdf) */
+  private sourceBlob: Blob | null = null;
+  /** Pages changed since the document was opened, and the kinds of change */
+  private dirtyPages = new Set<number>();
+  private dirtyKinds = new Set<DirtyKind>();
+  /**
+   * Native page cache of the open document (0 = not created yet). Read paths
+   * borrow parsed pages and text pages from it instead of loading and closing
+   * them per call; pages are invalidated when their content is regenerated.
+   */
+  private pageCachePtr = 0;
+  /** Scratch int32[3] for hitTest results, kept for the module's lifetime */
+  private hitTestOutPtr = 0;
+  private pageCacheBudget = { maxPages: PAGE_CACHE_MAX_PAGES, maxBytes: PAGE_CACHE_MAX_BYTES };
+  /**
+   * Finished renders of the open document as ImageBitmaps, keyed by page, rotation,
+   * scale bucket and content generation. A remounted canvas or a zoom level shown
+   * before is drawn from here; other scales of the same page serve as placeholders.
+   */
+  private rasterCache = new RasterCache(RASTER_CACHE_MAX_BYTES);
+  /** Raster cache writes still copying the canvas, by key; each settles once stored or dropped */
+  private pendingRasters = new Map<string, Promise<void>>();
+  /**
+   * Content generation per page, bumped whenever a page renders differently
+   * (edits, annotations, form values). Absent = 0.
+   */
+  private pageGenerations = new Map<number, number>();
+  /** Orders scheduleRender() requests: focused, visible, prefetch, thumbnails, rest. */
+  private renderScheduler = new RenderScheduler((canvas, options, signal) =>
+    this.renderPdf(canvas, { ...options, signal }),
+  );
   private static toImagePdfium(pdfium: IPDFiumModule): IPDFiumModule & {
     _FPDFImageObj_SetBitmap_W: (
       pagesPtr: number,
@@ -473,6 +1155,103 @@ export class PdfController implements IPdfController {
     }
   }
 
+  /**
+   * Read every text object of a page with _PDFium_EnumerateTextObjects, or
+   * return null when the WASM binary lacks it.
+   */
+  private enumerateTextObjects(
+    pdfium: IPDFiumModule,
+    pageIndex: number,
+    pagePtr: number,
+    scale: number,
+  ): IEnumeratedTextObject[] | null {
+    if (!pdfium._PDFium_EnumerateTextObjects || !pdfium._PDFium_FontTableCreate) return null;
+    if (!this.fontTablePtr) {
+      this.fontTablePtr = pdfium._PDFium_FontTableCreate();
+      if (!this.fontTablePtr) return null;
+    }
+
+    const textPagePtr = this.acquireTextPage(pdfium, pageIndex, pagePtr);
+    let ptr: number;
+    try {
+      ptr = pdfium._PDFium_EnumerateTextObjects(
+        pagePtr,
+        textPagePtr,
+        this.fontTablePtr,
+        this.fontTableNames.length,
+        scale,
+      );
+    } finally {
+      this.releaseTextPage(pdfium, pageIndex, pagePtr, textPagePtr);
+    }
+    if (!ptr) return null;
+
+    try {
+      const heap32 = pdfium.HEAP32;
+      const heapF32 = pdfium.HEAPF32;
+      const base = ptr >> 2;
+      const [count, textUnits, firstNewFont, newFontCount, newFontBytes, recordWords] =
+        heap32.subarray(base, base + 6);
+
+      const recordsAt = base + TEXT_OBJECT_HEADER_WORDS;
+      const textPtr = (recordsAt + count * recordWords) * 4;
+      const fontsPtr = textPtr + ((textUnits * 2 + 3) & ~3);
+
+      // Names of fonts first seen on this page; later pages refer to them by id
+      const names = this.fontTableNames;
+      names.length = firstNewFont;
+      if (newFontCount > 0) {
+        const block = PdfController.utf8Decoder.decode(
+          pdfium.HEAPU8.subarray(fontsPtr, fontsPtr + newFontBytes),
+        );
+        names.push(...block.split('\0').slice(0, newFontCount));
+      }
+
+      const out: IEnumeratedTextObject[] = [];
+      for (let i = 0; i < count; i++) {
+        const at = recordsAt + i * recordWords;
+        const fontId = heap32[at + 1];
+        const color = heap32[at + 3];
+        const textStart = textPtr + heap32[at + 19] * 2;
+        const textLength = heap32[at + 20];
+        out.push({
+          objectIndex: heap32[at],
+          content:
+            textLength > 0
+              ? PdfController.utf16Decoder.decode(
+                  pdfium.HEAPU8.subarray(textStart, textStart + textLength * 2),
+                )
+              : '',
+          fontName: fontId >= 0 ? names[fontId] : undefined,
+          fontSize: heapF32[at + 4],
+          renderMode: heap32[at + 2],
+          fillColor: {
+            r: color & 0xff,
+            g: (color >>> 8) & 0xff,
+            b: (color >>> 16) & 0xff,
+            a: (color >>> 24) & 0xff,
+          },
+          bounds: {
+            left: heapF32[at + 5],
+            bottom: heapF32[at + 6],
+            right: heapF32[at + 7],
+            top: heapF32[at + 8],
+          },
+          deviceRect: {
+            left: heapF32[at + 9],
+            top: heapF32[at + 10],
+            width: heapF32[at + 11],
+            height: heapF32[at + 12],
+          },
+          matrix: Array.from(heapF32.subarray(at + 13, at + 19)),
+        });
+      }
+      return out;
+    } finally {
+      pdfium._PDFium_FreeBuffer(ptr);
+    }
+  }
+
   private readTextObjectFontInfo(
     pdfium: IPDFiumModule,
     textObjectPtr: number,
@@ -551,15 +1330,306 @@ export class PdfController implements IPdfController {
 
   private withPage<T>(pageIndex: number, fn: (pdfium: IPDFiumModule, pagePtr: number) => T): T {
     const { pdfium, docPtr } = this.requireDoc();
-    const pagePtr = pdfium._PDFium_LoadPage(docPtr, pageIndex);
+    const pagePtr = this.acquireCachedPage(pdfium, docPtr, pageIndex);
     if (!pagePtr) throw new Error(`Failed to load page ${pageIndex}`);
     try {
       return fn(pdfium, pagePtr);
     } finally {
-      pdfium._PDFium_ClosePage(pagePtr);
+      this.releasePage(pdfium, pageIndex, pagePtr);
+    }
+  }
+
+  /**
+   * Borrow a page: the edit-mode pointer while the page is being edited (so reads
+   * see in-memory edits), else a handle from the native page cache, else a freshly
+   * loaded page. Return it with releasePage(); the handle may be shared, so it
+   * must not be held across an await.
+   */
+  private acquirePage(pdfium: IPDFiumModule, docPtr: number, pageIndex: number): number {
+    return this.editPageCache.get(pageIndex) ?? this.acquireCachedPage(pdfium, docPtr, pageIndex);
+  }
+
+  /** acquirePage() without the edit-mode pointer */
+  private acquireCachedPage(pdfium: IPDFiumModule, docPtr: number, pageIndex: number): number {
+    if (PdfController.hasPageCache(pdfium)) {
+      const cache = this.ensurePageCache(pdfium, docPtr);
+      return cache ? pdfium._PDFium_PageCacheAcquire(cache, pageIndex) : 0;
+    }
+    return pdfium._PDFium_LoadPage(docPtr, pageIndex);
+  }
+
+  /** The native page cache of the open document, created on first use (0 on failure) */
+  private ensurePageCache(pdfium: IPageCacheModule, docPtr: number): number {
+    if (!this.pageCachePtr) {
+      const { maxPages, maxBytes } = this.pageCacheBudget;
+      this.pageCachePtr = pdfium._PDFium_PageCacheCreate(docPtr, maxPages, maxBytes);
+    }
+    return this.pageCachePtr;
+  }
+
+  private releasePage(pdfium: IPDFiumModule, pageIndex: number, pagePtr: number): void {
+    // Edit-mode pointers are released explicitly via releaseEditPages()
+    if (this.editPageCache.get(pageIndex) === pagePtr) return;
+    if (PdfController.hasPageCache(pdfium)) {
+      // A destroyed cache has already closed its handles
+      if (this.pageCachePtr) pdfium._PDFium_PageCacheRelease(this.pageCachePtr, pagePtr);
+      return;
+    }
+    pdfium._PDFium_ClosePage(pagePtr);
+  }
+
+  /** Borrow the text page of a page from acquirePage(); return it with releaseTextPage(). */
+  private acquireTextPage(pdfium: IPDFiumModule, pageIndex: number, pagePtr: number): number {
+    if (this.editPageCache.get(pageIndex) === pagePtr || !PdfController.hasPageCache(pdfium)) {
+      return pdfium._PDFium_LoadPageText(pagePtr);
+    }
+    return this.pageCachePtr
+      ? pdfium._PDFium_PageCacheAcquireText(this.pageCachePtr, pageIndex)
+      : 0;
+  }
+
+  private releaseTextPage(
+    pdfium: IPDFiumModule,
+    pageIndex: number,
+    pagePtr: number,
+    textPagePtr: number,
+  ): void {
+    if (!textPagePtr) return;
+    if (this.editPageCache.get(pageIndex) === pagePtr || !PdfController.hasPageCache(pdfium)) {
+      pdfium._PDFium_ClosePageText(textPagePtr);
+      return;
+    }
+    if (this.pageCachePtr) pdfium._PDFium_PageCacheReleaseText(this.pageCachePtr, textPagePtr);
+  }
+
+  /**
+   * Drop pages from the native page cache after their content changed
+   * (-1 = all pages), so the next read parses the new content.
+   */
+  private invalidatePageCache(pageIndex: number): void {
+    if (!this.pageCachePtr) return;
+    this.pdfiumModule?._PDFium_PageCacheInvalidate?.(this.pageCachePtr, pageIndex);
+  }
+
+  public setPageCacheBudget(maxPages: number, maxBytes: number): void {
+    this.pageCacheBudget = {
+      maxPages: Math.max(1, Math.floor(maxPages)),
+      maxBytes: Math.max(0, Math.floor(maxBytes)),
+    };
+    if (this.pageCachePtr) {
+      const { maxPages: pages, maxBytes: bytes } = this.pageCacheBudget;
+      this.pdfiumModule?._PDFium_PageCacheSetBudget?.(this.pageCachePtr, pages, bytes);
+    }
+  }
+
+  public getPageCacheStats(): IPageCacheStats | null {
+    const pdfium = this.pdfiumModule;
+    if (!pdfium || !PdfController.hasPageCache(pdfium)) return null;
+    if (!this.pageCachePtr) {
+      return { hits: 0, misses: 0, evictions: 0, pages: 0, estimatedBytes: 0 };
+    }
+    const outPtr = pdfium._malloc(5 * 4);
+    try {
+      pdfium._PDFium_PageCacheGetStats(this.pageCachePtr, outPtr);
+      const [hits, misses, evictions, pages, estimatedBytes] = pdfium.HEAP32.subarray(
+        outPtr >> 2,
+        (outPtr >> 2) + 5,
+      );
+      return { hits, misses, evictions, pages, estimatedBytes: estimatedBytes >>> 0 };
+    } finally {
+      pdfium._free(outPtr);
+    }
+  }
+
+  public setPerfCountersEnabled(enabled: boolean): void {
+    this.perfEnabled = enabled;
+    const pdfium = this.pdfiumModule;
+    if (pdfium && PdfController.hasPerfCounters(pdfium)) {
+      pdfium._PDFium_SetPerfEnabled(enabled ? 1 : 0);
+    }
+  }
+
+  public resetPerfCounters(): void {
+    this.rgbaCopyTiming.reset();
+    this.putImageDataTiming.reset();
+    const pdfium = this.pdfiumModule;
+    if (pdfium && PdfController.hasPerfCounters(pdfium)) {
+      pdfium._PDFium_ResetPerfCounters();
+    }
+  }
+
+  public getPerfCounters(): IPerfCounters {
+    const js = {
+      rgbaCopy: this.rgbaCopyTiming.snapshot(),
+      putImageData: this.putImageDataTiming.snapshot(),
+    };
+    const pdfium = this.pdfiumModule;
+    if (!pdfium || !PdfController.hasPerfCounters(pdfium)) {
+      return { enabled: this.perfEnabled, native: null, heap: null, js };
+    }
+    const total = pdfium._PDFium_GetPerfCounters(0);
+    const outPtr = pdfium._malloc(total * 8);
+    try {
+      pdfium._PDFium_GetPerfCounters(outPtr);
+      // Read after the call: a heap growth inside it would detach an earlier view
+      const out = new Float64Array(pdfium.HEAPU8.buffer, outPtr, total);
+      const native = {} as Record<NativePerfCounterName, INativePerfCounter>;
+      const count = Math.min(out[0], Object.keys(NATIVE_PERF_COUNTERS).length);
+      for (let c = 0; c < count; c++) {
+        const row = PERF_HEADER_FIELDS + c * PERF_COUNTER_FIELDS;
+        native[NATIVE_PERF_COUNTERS[c as PERF_COUNTER]] = {
+          calls: out[row],
+          totalMs: out[row + 1],
+          p50Ms: out[row + 2],
+          p99Ms: out[row + 3],
+          maxMs: out[row + 4],
+          heapGrowthBytes: out[row + 5],
+        };
+      }
+      const heap: IHeapStats = {
+        usedBytes: out[2],
+        peakBytes: out[3],
+        sizeBytes: out[4],
+        maxBytes: out[5],
+        headroomBytes: Math.max(0, out[5] - out[3]),
+      };
+      return { enabled: out[1] !== 0, native, heap, js };
+    } finally {
+      pdfium._free(outPtr);
+    }
+  }
+
+  public setMemoryBudget(maxHeapBytes: number): void {
+    this.memoryBudget = Math.max(0, Math.floor(maxHeapBytes));
+    this.memoryTrimFloor = 0;
+  }
+
+  /**
+   * Release memory that is rebuilt on demand. moderate frees idle bitmap buffers, spatial
+   * indexes, text pages and half of the raster cache; critical also closes cached pages,
+   * empties the raster cache and drops the search index unless a search is in progress.
+   * Pages with unsaved in-memory edits are never released.
+   */
+  public trimMemory(level: MemoryTrimLevel): IMemoryTrimReport {
+    const critical = level === 'critical';
+    const rasterBytesFreed = this.rasterCache.evict(
+      critical ? 0 : Math.floor(this.rasterCache.byteSize / 2),
+    );
+    let searchIndexReleased = false;
+    if (critical && this.searchIndexPtr && this.searchCursors.size === 0) {
+      this.pdfiumModule?._PDFium_SearchIndexDestroy?.(this.searchIndexPtr);
+      this.searchIndexPtr = 0;
+      searchIndexReleased = true;
+    }
+    const kinds = critical
+      ? MEMORY_TRIM.ALL
+      : MEMORY_TRIM.POOL | MEMORY_TRIM.SPATIAL | MEMORY_TRIM.TEXT_PAGES;
+    return {
+      level,
+      native: this.runMemoryTrim(0, kinds),
+      rasterBytesFreed,
+      searchIndexReleased,
+      editPagesRetained: this.editPageCache.size,
+    };
+  }
+
+  /**
+   * Trim the engine's caches once the bytes in use have grown past the memory budget, at
+   * most once per MEMORY_TRIM_INTERVAL_MS. Called after renders, with their pages released.
+   * The heap itself never shrinks, so its size only gates the check. Memory a trim cannot
+   * release (the in-heap document and pages with unsaved edits) is added to the target,
+   * and when a trim still falls short, the next one waits until the bytes in use have
+   * grown MEMORY_TRIM_REGROWTH_BYTES past what it left.
+   */
+  private maybeTrimMemory(pdfium: IPDFiumModule): void {
+    if (!this.memoryBudget || pdfium.HEAPU8.buffer.byteLength <= this.memoryBudget) return;
+    const now = performance.now();
+    if (now - this.lastMemoryTrim < MEMORY_TRIM_INTERVAL_MS) return;
+    this.lastMemoryTrim = now;
+    const goal = Math.min(
+      this.memoryBudget,
+      this.memoryBudget * MEMORY_TRIM_TARGET + this.pinnedMemoryBytes(pdfium),
+    );
+    if (this.memoryTrimFloor) {
+      // Selecting no kinds only measures: one allocator walk
+      const probe = this.runMemoryTrim(0, 0);
+      const threshold = Math.max(goal, this.memoryTrimFloor + MEMORY_TRIM_REGROWTH_BYTES);
+      if (!probe || probe.usedBeforeBytes <= threshold) return;
+    }
+    // The engine returns after one allocator walk when the bytes in use are within goal
+    const report = this.runMemoryTrim(goal, MEMORY_TRIM.ALL);
+    if (report && report.usedBeforeBytes > goal) {
+      this.memoryTrimFloor = report.usedAfterBytes > goal ? report.usedAfterBytes : 0;
+    }
+  }
+
+  /** Estimated heap bytes no trim can release: the document copy and edited pages */
+  private pinnedMemoryBytes(pdfium: IPDFiumModule): number {
+    let bytes = this.dataPtr ? this.sourceSize : 0;
+    for (const pagePtr of this.editPageCache.values()) {
+      bytes +=
+        pdfium._PDFium_EstimatePageBytes?.(pagePtr) ?? PAGE_CACHE_MAX_BYTES / PAGE_CACHE_MAX_PAGES;
+    }
+    return bytes;
+  }
+
+  private runMemoryTrim(targetBytes: number, kinds: number): INativeMemoryTrim | null {
+    const pdfium = this.pdfiumModule;
+    if (!pdfium || !PdfController.hasMemoryTrim(pdfium)) return null;
+    const outPtr = pdfium._malloc(MEMORY_TRIM_REPORT_FIELDS * 8);
+    try {
+      pdfium._PDFium_MemoryTrim(this.pageCachePtr, targetBytes, kinds, outPtr);
+      const out = new Float64Array(pdfium.HEAPU8.buffer, outPtr, MEMORY_TRIM_REPORT_FIELDS);
+      return {
+        usedBeforeBytes: out[0],
+        usedAfterBytes: out[1],
+        freeBytes: out[2],
+        heapSizeBytes: out[3],
+        heapMaxBytes: out[4],
+        poolBytesFreed: out[5],
+        spatialIndexesFreed: out[6],
+        textPagesClosed: out[7],
+        pagesClosed: out[8],
+      };
+    } finally {
+      pdfium._free(outPtr);
     }
   }
 
+  private static hasMemoryTrim(pdfium: IPDFiumModule): pdfium is IMemoryTrimModule {
+    return typeof pdfium._PDFium_MemoryTrim === 'function';
+  }
+
+  private static hasPerfCounters(pdfium: IPDFiumModule): pdfium is IPerfCounterModule {
+    return (
+      typeof pdfium._PDFium_SetPerfEnabled === 'function' &&
+      typeof pdfium._PDFium_ResetPerfCounters === 'function' &&
+      typeof pdfium._PDFium_GetPerfCounters === 'function'
+    );
+  }
+
+  private static hasSpatialIndex(pdfium: IPDFiumModule): pdfium is ISpatialIndexModule {
+    return (
+      PdfController.hasPageCache(pdfium) &&
+      typeof pdfium._PDFium_HitTest === 'function' &&
+      typeof pdfium._PDFium_QueryRange === 'function'
+    );
+  }
+
+  private static hasPageCache(pdfium: IPDFiumModule): pdfium is IPageCacheModule {
+    return (
+      typeof pdfium._PDFium_PageCacheCreate === 'function' &&
+      typeof pdfium._PDFium_PageCacheDestroy === 'function' &&
+      typeof pdfium._PDFium_PageCacheSetBudget === 'function' &&
+      typeof pdfium._PDFium_PageCacheAcquire === 'function' &&
+      typeof pdfium._PDFium_PageCacheAcquireText === 'function' &&
+      typeof pdfium._PDFium_PageCacheRelease === 'function' &&
+      typeof pdfium._PDFium_PageCacheReleaseText === 'function' &&
+      typeof pdfium._PDFium_PageCacheInvalidate === 'function' &&
+      typeof pdfium._PDFium_PageCacheGetStats === 'function'
+    );
+  }
+
   private pageToCanvasPoint(
     pagePtr: number,
     pageW: number,
@@ -640,12 +1710,33 @@ export class PdfController implements IPdfController {
   public ensureInitialized(): Promise<void> {
     if (this.pdfiumModule) return Promise.resolve();
     this.initPromise ??= (async () => {
-      this.pdfiumModule = await createPdfiumModule();
-      this.pdfiumModule._PDFium_Init();
+      const pdfium = await createPdfiumModule();
+      const initStart = performance.now();
+      pdfium._PDFium_Init();
+      const initMs = performance.now() - initStart;
+      if (this.perfEnabled && PdfController.hasPerfCounters(pdfium)) {
+        pdfium._PDFium_SetPerfEnabled(1);
+      }
+      this.pdfiumModule = pdfium;
+      const timings = getPdfiumStartupTimings();
+      this.startupTimings = timings ? { ...timings, initMs } : null;
     })();
+    // Let a failed start be retried instead of caching the rejection
+    this.initPromise.catch(() => {
+      this.initPromise = null;
+    });
     return this.initPromise;
   }
 
+  public async preload(): Promise<void> {
+    if (this.pdfiumModule || this.initPromise) return;
+    await preloadPdfiumModule();
+  }
+
+  public getStartupTimings(): IStartupTimings | null {
+    return this.startupTimings;
+  }
+
   private ensureFormFillHandle(): number | null {
     const { pdfium, docPtr } = this.requireDoc();
     if (this.formHandle) return this.formHandle;
@@ -679,18 +1770,57 @@ export class PdfController implements IPdfController {
 
   private closeCurrentDocument(): void {
     if (!this.pdfiumModule) return;
+    // In-flight async renders reference pages of this document; cancel them
+    // so the pump resolves their waiters before the handles go away.
+    this.renderScheduler.cancelAll();
+    for (const jobId of this.asyncRenderWaiters.keys()) {
+      this.pdfiumModule._PDFium_RenderAsyncCancel?.(jobId);
+    }
     this.releaseEditPages();
     this.editPageReplaceOnly.clear();
     this.generatedPages.clear();
+    this.rasterCache.clear();
+    this.pageGenerations.clear();
+    for (const cursor of this.searchCursors) {
+      this.pdfiumModule._PDFium_SearchCursorClose?.(cursor);
+    }
+    this.searchCursors.clear();
+    if (this.searchIndexPtr) {
+      this.pdfiumModule._PDFium_SearchIndexDestroy?.(this.searchIndexPtr);
+      this.searchIndexPtr = 0;
+    }
     this.closeFormFillEnvironment();
+    if (this.pageCachePtr) {
+      this.pdfiumModule._PDFium_PageCacheDestroy?.(this.pageCachePtr);
+      this.pageCachePtr = 0;
+    }
+    if (this.fontTablePtr) {
+      this.pdfiumModule._PDFium_FontTableDestroy?.(this.fontTablePtr);
+      this.fontTablePtr = 0;
+    }
+    this.fontTableNames = [];
+    this.outlineIds.clear();
+    this.placeholderSizedPages.clear();
     if (this.docPtr) {
       this.pdfiumModule._PDFium_CloseDocument(this.docPtr);
       this.docPtr = null;
     }
+    // The loader backs the document's reads, so it goes after the document
+    if (this.fileLoader) {
+      PdfController.destroyFileLoader(this.pdfiumModule, this.fileLoader);
+      this.fileLoader = null;
+    }
     if (this.dataPtr) {
       this.pdfiumModule._free(this.dataPtr);
       this.dataPtr = null;
     }
+    this.memoryTrimFloor = 0;
+    this.sourceSize = 0;
+    this.sourceBlob = null;
+    this.dirtyPages.clear();
+    this.dirtyKinds.clear();
+    // Page sizes change with the document; drop idle render buffers
+    this.pdfiumModule._PDFium_BitmapPoolTrim?.();
   }
 
   /**
@@ -699,8 +1829,10 @@ export class PdfController implements IPdfController {
    */
   public releaseEditPages(): void {
     if (!this.pdfiumModule) return;
-    for (const [, ptr] of this.editPageCache) {
+    for (const [pageIndex, ptr] of this.editPageCache) {
       this.pdfiumModule._PDFium_ClosePage(ptr);
+      // Edits that were never generated into the content stream go away with the page
+      this.markPageChanged(pageIndex);
     }
     this.editPageCache.clear();
   }
@@ -721,6 +1853,11 @@ export class PdfController implements IPdfController {
       throw new Error('PDFium module not initialized');
     }
 
+    // Large files open progressively, without a full in-heap copy
+    if (PdfController.hasFileLoader(pdfium) && file.size >= PROGRESSIVE_LOAD_MIN_BYTES) {
+      return this.loadSource(createBlobByteSource(file), opts);
+    }
+
     const mySeq = ++this.loadSeq;
     const signal = opts?.signal;
     if (signal?.aborted) {
@@ -731,29 +1868,138 @@ export class PdfController implements IPdfController {
     const arrayBuffer = await file.arrayBuffer();
     const data = new Uint8Array(arrayBuffer);
 
-    // If a newer load started while we were awaiting, ignore this one.
-    if (signal?.aborted) {
-      throw new DOMException('Aborted', 'AbortError');
-    }
-    if (mySeq !== this.loadSeq) {
-      return;
-    }
-
-    // Close any previously loaded document before loading a new one.
-    this.closeCurrentDocument();
+    this.openMemoryDocument(pdfium, data, mySeq, opts, file);
+  }
+
+  /**
+   * Open a document from a random-access byte source (Blob slices, HTTP Range requests).
+   * The returned promise resolves once PDFium can open the document and show its first
+   * page - for a linearized file that is the header, first page and hint tables - rather
+   * than after the last byte. The rest is read in the background; pages that are still
+   * missing data are fetched first when rendered (see ensurePageAvailable). Each block is
+   * stored in the WASM heap once.
+   */
+  public async loadSource(
+    source: IPdfByteSource,
+    opts?: { signal?: AbortSignal; password?: string },
+  ): Promise<void> {
+    await this.ensureInitialized();
+    const pdfium = this.pdfiumModule;
+    if (!pdfium) {
+      throw new Error('PDFium module not initialized');
+    }
+
+    const mySeq = ++this.loadSeq;
+    const signal = opts?.signal;
+    if (signal?.aborted) {
+      throw new DOMException('Aborted', 'AbortError');
+    }
+
+    if (!PdfController.hasFileLoader(pdfium)) {
+      // Binary without the loader: read everything and open it from memory
+      const data = await source.read(0, source.size, signal);
+      this.openMemoryDocument(pdfium, data, mySeq, opts, source.blob);
+      return;
+    }
+
+    // Close any previously loaded document before loading a new one.
+    this.closeCurrentDocument();
+
+    const loaderPtr = pdfium._PDFium_LoaderCreate(source.size, LOADER_CHUNK_BYTES);
+    if (!loaderPtr) {
+      throw new Error('Failed to load PDF: could not create a progressive loader');
+    }
+    const loader: IFileLoaderState = {
+      ptr: loaderPtr,
+      source,
+      firstPage: 0,
+      closed: false,
+      complete: false,
+      cursor: 0,
+      prefetch: Promise.resolve(),
+      fullRead: null,
+    };
+    let docPtr = 0;
+
+    try {
+      const docReady = await this.fetchUntilAvailable(
+        pdfium,
+        loader,
+        () => pdfium._PDFium_LoaderIsDocAvail(loaderPtr),
+        mySeq,
+        signal,
+      );
+      if (!docReady) {
+        PdfController.destroyFileLoader(pdfium, loader);
+        return;
+      }
+
+      const passwordPtr = this.allocPassword(pdfium, opts?.password ?? '');
+      docPtr = pdfium._PDFium_LoaderGetDocument(loaderPtr, passwordPtr);
+      pdfium._free(passwordPtr);
+      if (!docPtr) {
+        PdfController.throwLoadError(pdfium, !!opts?.password);
+      }
+
+      // Linearized files can show their first page before the rest has arrived
+      loader.firstPage = pdfium._PDFium_LoaderGetFirstPageNum(docPtr);
+      const pageReady = await this.fetchUntilAvailable(
+        pdfium,
+        loader,
+        () => pdfium._PDFium_LoaderIsPageAvail(loaderPtr, loader.firstPage),
+        mySeq,
+        signal,
+      );
+      if (!pageReady) {
+        pdfium._PDFium_CloseDocument(docPtr);
+        PdfController.destroyFileLoader(pdfium, loader);
+        return;
+      }
+    } catch (error) {
+      if (docPtr) pdfium._PDFium_CloseDocument(docPtr);
+      PdfController.destroyFileLoader(pdfium, loader);
+      throw error;
+    }
+
+    // Store pointers for later use (commit last, to avoid race conditions).
+    this.docPtr = docPtr;
+    this.fileLoader = loader;
+    this.sourceSize = loader.source.size;
+    this.sourceBlob = loader.source.blob ?? null;
+    loader.prefetch = this.readAhead(pdfium, loader, LOADER_BACKGROUND_LIMIT_BYTES).catch(
+      (error: unknown) => {
+        console.warn('[PdfController] Background document read stopped:', error);
+      },
+    );
+  }
+
+  /** Copy a whole file into the heap and open it with FPDF_LoadMemDocument. */
+  private openMemoryDocument(
+    pdfium: IPDFiumModule,
+    data: Uint8Array,
+    mySeq: number,
+    opts?: { signal?: AbortSignal; password?: string },
+    sourceBlob?: Blob,
+  ): void {
+    const signal = opts?.signal;
+
+    // If a newer load started while we were awaiting, ignore this one.
+    if (signal?.aborted) {
+      throw new DOMException('Aborted', 'AbortError');
+    }
+    if (mySeq !== this.loadSeq) {
+      return;
+    }
+
+    // Close any previously loaded document before loading a new one.
+    this.closeCurrentDocument();
 
     // Allocate memory and copy PDF data
     const dataPtr = pdfium._malloc(data.length);
     pdfium.HEAPU8.set(data, dataPtr);
 
     const password = opts?.password ?? '';
-    const hasPassword = password.length > 0;
-    const encoder = new TextEncoder();
-    const passwordBytes = encoder.encode(password);
-    const passwordBytesSize = passwordBytes.length + 1; // +1 for null terminator
-    const passwordPtr = pdfium._malloc(passwordBytesSize);
-    pdfium.HEAPU8.set(passwordBytes, passwordPtr);
-    pdfium.HEAPU8[passwordPtr + passwordBytes.length] = 0; // null terminator
+    const passwordPtr = this.allocPassword(pdfium, password);
 
     // Load the document
     const docPtr = pdfium._PDFium_LoadMemDocument(dataPtr, data.length, passwordPtr);
@@ -761,14 +2007,7 @@ export class PdfController implements IPdfController {
 
     if (!docPtr) {
       pdfium._free(dataPtr);
-      const errorCode = pdfium._PDFium_GetLastError() as FPDF_ERR;
-      if (errorCode === FPDF_ERR.PASSWORD) {
-        const message = hasPassword
-          ? 'Incorrect password. Please try again.'
-          : 'Password required to open this PDF.';
-        throw new PdfPasswordError(message, errorCode);
-      }
-      throw new Error(`Failed to load PDF: ${PdfController.getLoadErrorMessage(errorCode)}`);
+      PdfController.throwLoadError(pdfium, password.length > 0);
     }
 
     // If aborted or superseded after we loaded docPtr, cleanup and exit.
@@ -781,7 +2020,207 @@ export class PdfController implements IPdfController {
     // Store pointers for later use (commit last, to avoid race conditions).
     this.docPtr = docPtr;
     this.dataPtr = dataPtr;
-    return;
+    this.sourceSize = data.length;
+    this.sourceBlob = sourceBlob ?? null;
+  }
+
+  /** Allocate a null-terminated UTF-8 password in WASM memory. Caller must free. */
+  private allocPassword(pdfium: IPDFiumModule, password: string): number {
+    const encoder = new TextEncoder();
+    const passwordBytes = encoder.encode(password);
+    const passwordBytesSize = passwordBytes.length + 1; // +1 for null terminator
+    const passwordPtr = pdfium._malloc(passwordBytesSize);
+    pdfium.HEAPU8.set(passwordBytes, passwordPtr);
+    pdfium.HEAPU8[passwordPtr + passwordBytes.length] = 0; // null terminator
+    return passwordPtr;
+  }
+
+  /** Throw the error matching PDFium's last load failure. */
+  private static throwLoadError(pdfium: IPDFiumModule, hasPassword: boolean): never {
+    const errorCode = pdfium._PDFium_GetLastError() as FPDF_ERR;
+    if (errorCode === FPDF_ERR.PASSWORD) {
+      const message = hasPassword
+        ? 'Incorrect password. Please try again.'
+        : 'Password required to open this PDF.';
+      throw new PdfPasswordError(message, errorCode);
+    }
+    throw new Error(`Failed to load PDF: ${PdfController.getLoadErrorMessage(errorCode)}`);
+  }
+
+  private static hasFileLoader(pdfium: IPDFiumModule): pdfium is IFileLoaderModule {
+    return (
+      typeof pdfium._PDFium_LoaderCreate === 'function' &&
+      typeof pdfium._PDFium_LoaderIsDocAvail === 'function'
+    );
+  }
+
+  private static destroyFileLoader(pdfium: IPDFiumModule, loader: IFileLoaderState): void {
+    if (loader.closed) return;
+    loader.closed = true;
+    pdfium._PDFium_LoaderDestroy?.(loader.ptr);
+  }
+
+  /**
+   * Fetch the ranges PDFium asks for until `isAvailable` reports PDF_DATA_STATUS.AVAIL.
+   * Returns false if another document was loaded meanwhile.
+   */
+  private async fetchUntilAvailable(
+    pdfium: IFileLoaderModule,
+    loader: IFileLoaderState,
+    isAvailable: () => number,
+    loadSeq: number,
+    signal?: AbortSignal,
+  ): Promise<boolean> {
+    const rangesPtr = pdfium._malloc(LOADER_MAX_RANGES * 8);
+    try {
+      for (;;) {
+        if (loader.closed || loadSeq !== this.loadSeq) return false;
+        if (signal?.aborted) throw new DOMException('Aborted', 'AbortError');
+
+        const status = isAvailable();
+        if (status === PDF_DATA_STATUS.AVAIL) return true;
+        if (status === PDF_DATA_STATUS.ERROR) {
+          throw new Error('Failed to load PDF: File not in PDF format or corrupted');
+        }
+
+        let count = pdfium._PDFium_LoaderTakeRequests(loader.ptr, rangesPtr, LOADER_MAX_RANGES);
+        if (count === 0) {
+          // Nothing hinted: keep reading the file in order
+          count = PdfController.takeNextMissing(pdfium, loader, rangesPtr);
+          if (count === 0) {
+            throw new Error('Failed to load PDF: File not in PDF format or corrupted');
+          }
+        }
+        const ranges = new Uint32Array(pdfium.HEAPU8.buffer, rangesPtr, count * 2).slice();
+        const reads: Promise<void>[] = [];
+        for (let i = 0; i < count; i++) {
+          reads.push(this.supplyRange(pdfium, loader, ranges[i * 2], ranges[i * 2 + 1], signal));
+        }
+        await Promise.all(reads);
+      }
+    } finally {
+      pdfium._free(rangesPtr);
+    }
+  }
+
+  /** Read one chunk-aligned range from the source and hand it to the native loader. */
+  private async supplyRange(
+    pdfium: IFileLoaderModule,
+    loader: IFileLoaderState,
+    offset: number,
+    size: number,
+    signal?: AbortSignal,
+  ): Promise<void> {
+    const bytes = await loader.source.read(offset, size, signal);
+    if (loader.closed) return;
+    const ptr = pdfium._malloc(bytes.length);
+    try {
+      pdfium.HEAPU8.set(bytes, ptr);
+      pdfium._PDFium_LoaderSupply(loader.ptr, offset, ptr, bytes.length);
+    } finally {
+      pdfium._free(ptr);
+    }
+    if (!loader.complete && pdfium._PDFium_LoaderIsComplete(loader.ptr)) {
+      loader.complete = true;
+      // Drop any search text read while the file was partial
+      if (loader === this.fileLoader) this.invalidateSearchIndex(-1);
+    }
+    if (loader === this.fileLoader) this.announcePageSizes();
+  }
+
+  /**
+   * Take the next missing range at or after the loader's read cursor (wrapping to the start
+   * of the file) into rangePtr and move the cursor past it. The cursor is shared, so
+   * concurrent readers continue from each other instead of all asking for the first gap.
+   * Returns 0 when nothing is missing.
+   */
+  private static takeNextMissing(
+    pdfium: IFileLoaderModule,
+    loader: IFileLoaderState,
+    rangePtr: number,
+  ): number {
+    let count = pdfium._PDFium_LoaderNextMissing(
+      loader.ptr,
+      loader.cursor,
+      LOADER_PREFETCH_BYTES,
+      rangePtr,
+    );
+    if (count === 0 && loader.cursor > 0) {
+      count = pdfium._PDFium_LoaderNextMissing(loader.ptr, 0, LOADER_PREFETCH_BYTES, rangePtr);
+    }
+    if (count > 0) {
+      const [offset, size] = new Uint32Array(pdfium.HEAPU8.buffer, rangePtr, 2);
+      loader.cursor = offset + size;
+    }
+    return count;
+  }
+
+  /** Read up to limitBytes of a progressively loaded file's missing data, in file order. */
+  private async readAhead(
+    pdfium: IFileLoaderModule,
+    loader: IFileLoaderState,
+    limitBytes: number,
+  ): Promise<void> {
+    const rangePtr = pdfium._malloc(8);
+    try {
+      for (let read = 0; read < limitBytes && !loader.closed; ) {
+        if (!PdfController.takeNextMissing(pdfium, loader, rangePtr)) return;
+        const [offset, size] = new Uint32Array(pdfium.HEAPU8.buffer, rangePtr, 2);
+        await this.supplyRange(pdfium, loader, offset, size);
+        read += size;
+      }
+    } finally {
+      pdfium._free(rangePtr);
+    }
+  }
+
+  /**
+   * Wait until a page's data has arrived while the document is still loading
+   * progressively, fetching its ranges ahead of the background read. Resolves at once
+   * for documents opened from memory or already complete.
+   */
+  public async ensurePageAvailable(pageIndex: number, signal?: AbortSignal): Promise<void> {
+    const pdfium = this.pdfiumModule;
+    const loader = this.fileLoader;
+    if (!pdfium || !loader || !PdfController.hasFileLoader(pdfium)) return;
+    if (pdfium._PDFium_LoaderIsComplete(loader.ptr)) return;
+    const available = await this.fetchUntilAvailable(
+      pdfium,
+      loader,
+      () => pdfium._PDFium_LoaderIsPageAvail(loader.ptr, pageIndex),
+      this.loadSeq,
+      signal,
+    );
+    if (available) this.announcePageSizes(pageIndex);
+  }
+
+  public whenFullyLoaded(): Promise<void> {
+    const pdfium = this.pdfiumModule;
+    const loader = this.fileLoader;
+    if (!pdfium || !loader || !PdfController.hasFileLoader(pdfium)) return Promise.resolve();
+    if (!loader.fullRead) {
+      const fullRead = loader.prefetch.then(() => this.readAhead(pdfium, loader, Infinity));
+      loader.fullRead = fullRead;
+      // A failed read is retried by the next call
+      fullRead.catch(() => {
+        if (loader.fullRead === fullRead) loader.fullRead = null;
+      });
+    }
+    return loader.fullRead;
+  }
+
+  /** False while a progressively loaded document is still missing data. */
+  private isFullyLoaded(): boolean {
+    return !this.fileLoader || this.fileLoader.complete;
+  }
+
+  /** False while a progressively loading page is still missing data. */
+  private isPageDataAvailable(pageIndex: number): boolean {
+    const pdfium = this.pdfiumModule;
+    const loader = this.fileLoader;
+    if (!pdfium || !loader || !PdfController.hasFileLoader(pdfium)) return true;
+    if (loader.complete) return true;
+    return pdfium._PDFium_LoaderIsPageAvail(loader.ptr, pageIndex) === PDF_DATA_STATUS.AVAIL;
   }
 
   public getPageCount(): number {
@@ -792,22 +2231,121 @@ export class PdfController implements IPdfController {
   }
 
   public getOutline(): IPdfOutlineNode[] {
-    if (!this.pdfiumModule || !this.docPtr) {
+    // The outline can live anywhere in the file, so a partial one is never read
+    if (!this.pdfiumModule || !this.docPtr || !this.isFullyLoaded()) {
       return [];
     }
+    const pdfium = this.pdfiumModule;
+    if (PdfController.hasOutlineSerialization(pdfium)) {
+      return this.rememberOutlineIds(PdfController.readOutline(pdfium, this.docPtr, 0, 0));
+    }
+    const first = pdfium._PDFium_GetFirstBookmark(this.docPtr);
+    return first ? this.rememberOutlineIds(this.walkOutline(pdfium, this.docPtr, first)) : [];
+  }
 
+  public getOutlineChildren(id: number, maxDepth = 1): IPdfOutlineNode[] {
+    if (!this.pdfiumModule || !this.docPtr || !this.isFullyLoaded()) {
+      return [];
+    }
+    if (!this.outlineIds.has(id)) {
+      return [];
+    }
     const pdfium = this.pdfiumModule;
-    const docPtr = this.docPtr;
+    if (PdfController.hasOutlineSerialization(pdfium)) {
+      return this.rememberOutlineIds(PdfController.readOutline(pdfium, this.docPtr, id, maxDepth));
+    }
+    const first = pdfium._PDFium_GetFirstChildBookmark(this.docPtr, id);
+    return first ? this.rememberOutlineIds(this.walkOutline(pdfium, this.docPtr, first)) : [];
+  }
+
+  /** Record the ids of outline nodes (and their loaded children) as handed out. */
+  private rememberOutlineIds(nodes: IPdfOutlineNode[]): IPdfOutlineNode[] {
+    for (const node of nodes) {
+      if (node.id) this.outlineIds.add(node.id);
+      if (node.children) this.rememberOutlineIds(node.children);
+    }
+    return nodes;
+  }
+
+  /**
+   * Serialize the outline under parent (0 = all of it) natively and rebuild the tree
+   * from its pre-order nodes.
+   */
+  private static readOutline(
+    pdfium: IOutlineModule,
+    docPtr: number,
+    parent: number,
+    maxDepth: number,
+  ): IPdfOutlineNode[] {
+    const ptr = pdfium._PDFium_SerializeOutline(docPtr, parent, maxDepth);
+    if (!ptr) return [];
+    try {
+      const heap32 = pdfium.HEAP32;
+      const base = ptr >> 2;
+      const nodeCount = heap32[base];
+      const nodeWords = heap32[base + 2];
+      const nodesAt = base + OUTLINE_HEADER_WORDS;
+      const textPtr = (nodesAt + nodeCount * nodeWords) * 4;
+
+      const roots: IPdfOutlineNode[] = [];
+      // Last node seen at each depth, i.e. the parent of the next deeper node
+      const path: IPdfOutlineNode[] = [];
+      for (let i = 0; i < nodeCount; i++) {
+        const at = nodesAt + i * nodeWords;
+        const depth = heap32[at + 1];
+        const pageIndex = heap32[at + 2];
+        const flags = heap32[at + 3];
+        const titleLength = heap32[at + 5];
+        const from = textPtr + heap32[at + 4] * 2;
+        const title =
+          titleLength > 0
+            ? PdfController.utf16Decoder.decode(
+                pdfium.HEAPU8.subarray(from, from + titleLength * 2),
+              )
+            : '';
 
+        const node: IPdfOutlineNode = { title, id: heap32[at] };
+        if (pageIndex >= 0) {
+          node.dest = { pageIndex };
+        } else {
+          node.unsupported =
+            pageIndex === OUTLINE_DEST.UNRESOLVED ? 'dest-unresolved' : 'dest-missing';
+        }
+        if (flags & OUTLINE_NODE_FLAG.CHILDREN_OMITTED) node.hasMoreChildren = true;
+
+        const parentNode = depth > 0 ? path[depth - 1] : undefined;
+        if (parentNode) {
+          (parentNode.children ??= []).push(node);
+        } else {
+          roots.push(node);
+        }
+        path[depth] = node;
+        path.length = depth + 1;
+      }
+      return roots;
+    } finally {
+      pdfium._PDFium_FreeBuffer(ptr);
+    }
+  }
+
+  /** Build the outline from firstBookmarkPtr and its siblings one bookmark export at a time. */
+  private walkOutline(
+    pdfium: IPDFiumModule,
+    docPtr: number,
+    firstBookmarkPtr: number,
+  ): IPdfOutlineNode[] {
     const readTitle = (bookmarkPtr: number): string =>
       this.readFormFieldString((buffer, bufferLen) =>
         pdfium._PDFium_GetBookmarkTitle(bookmarkPtr, buffer, bufferLen),
       );
+    // Bookmarks already listed; a malformed /First or /Next chain may loop back
+    const visited = new Set<number>();
 
-    const buildList = (firstBookmarkPtr: number): IPdfOutlineNode[] => {
+    const buildList = (firstPtr: number): IPdfOutlineNode[] => {
       const nodes: IPdfOutlineNode[] = [];
-      let current = firstBookmarkPtr;
-      while (current) {
+      let current = firstPtr;
+      while (current && !visited.has(current)) {
+        visited.add(current);
         const title = readTitle(current);
         const destPtr = pdfium._PDFium_GetBookmarkDest(docPtr, current);
         let dest: IPdfOutlineNode['dest'];
@@ -826,7 +2364,7 @@ export class PdfController implements IPdfController {
         const firstChild = pdfium._PDFium_GetFirstChildBookmark(docPtr, current);
         const children = firstChild ? buildList(firstChild) : undefined;
 
-        const node: IPdfOutlineNode = { title };
+        const node: IPdfOutlineNode = { title, id: current };
         if (dest) node.dest = dest;
         if (unsupported && !dest) node.unsupported = unsupported;
         if (children?.length) node.children = children;
@@ -837,11 +2375,11 @@ export class PdfController implements IPdfController {
       return nodes;
     };
 
-    const first = pdfium._PDFium_GetFirstBookmark(docPtr);
-    if (!first) {
-      return [];
-    }
-    return buildList(first);
+    return buildList(firstBookmarkPtr);
+  }
+
+  private static hasOutlineSerialization(pdfium: IPDFiumModule): pdfium is IOutlineModule {
+    return typeof pdfium._PDFium_SerializeOutline === 'function';
   }
 
   public getPageDimension(pageIndex: number): IPageDimension {
@@ -849,19 +2387,58 @@ export class PdfController implements IPdfController {
       throw new Error('PDF not loaded. Call loadFile() first.');
     }
 
-    return this.withPage(pageIndex, (pdfium, pagePtr) => {
+    // A page still downloading is laid out with the first page's size until it arrives
+    const sizedPage = this.isPageDataAvailable(pageIndex)
+      ? pageIndex
+      : (this.fileLoader?.firstPage ?? pageIndex);
+    if (sizedPage !== pageIndex) this.placeholderSizedPages.add(pageIndex);
+    return this.withPage(sizedPage, (pdfium, pagePtr) => {
       const width = pdfium._PDFium_GetPageWidth(pagePtr);
       const height = pdfium._PDFium_GetPageHeight(pagePtr);
       return { width, height };
     });
   }
 
+  public onPageSizesChanged(listener: (pageIndices: number[]) => void): () => void {
+    this.pageSizeListeners.add(listener);
+    return () => {
+      this.pageSizeListeners.delete(listener);
+    };
+  }
+
+  /**
+   * Announce the placeholder-sized pages whose data has arrived. Pages mostly arrive in
+   * order, so the scan stops at the first one still missing (the loader's completion or
+   * ensurePageAvailable pick up any that arrive out of order).
+   */
+  private announcePageSizes(pageIndex?: number): void {
+    if (this.placeholderSizedPages.size === 0) return;
+    const candidates =
+      pageIndex === undefined
+        ? [...this.placeholderSizedPages].sort((a, b) => a - b)
+        : [pageIndex].filter((page) => this.placeholderSizedPages.has(page));
+    const arrived: number[] = [];
+    for (const page of candidates) {
+      if (!this.isPageDataAvailable(page)) break;
+      this.placeholderSizedPages.delete(page);
+      arrived.push(page);
+    }
+    if (arrived.length === 0) return;
+    for (const listener of this.pageSizeListeners) {
+      try {
+        listener(arrived);
+      } catch (error) {
+        console.warn('[PdfController] Page size listener failed:', error);
+      }
+    }
+  }
+
   public async renderPdf(canvas: HTMLCanvasElement, options: IRenderOptions = {}): Promise<void> {
     if (!this.pdfiumModule || !this.docPtr) {
       throw new Error('PDF not loaded. Call loadFile() first.');
     }
 
-    const { pageIndex = 0, scale = 1.0, pixelRatio = 1.0, signal } = options;
+    const { pageIndex = 0, scale = 1.0, pixelRatio = 1.0, signal, draft = false } = options;
     const pdfium = this.pdfiumModule;
 
     // Check if already aborted
@@ -869,10 +2446,52 @@ export class PdfController implements IPdfController {
       throw new DOMException('Render aborted', 'AbortError');
     }
 
-    // Use cached edit-mode page pointer if available (has in-memory text edits),
-    // otherwise load a fresh page.
+    // A progressively loading page is fetched ahead of the background read
+    if (this.fileLoader) {
+      await this.ensurePageAvailable(pageIndex, signal);
+      if (!this.docPtr) {
+        throw new DOMException('Render aborted', 'AbortError');
+      }
+    }
+
+    // A render of the same raster that just finished may still be copying into the cache;
+    // waiting for it turns this render into a cache hit
+    const pendingRaster = this.pendingRasters.get(
+      RasterCache.key(pageIndex, 0, scale * pixelRatio, this.pageGeneration(pageIndex), draft),
+    );
+    if (pendingRaster) {
+      await pendingRaster;
+      if (signal?.aborted || !this.docPtr) {
+        throw new DOMException('Render aborted', 'AbortError');
+      }
+    }
+
+    // Draw from the raster cache when this page content was rendered at this scale before
+    const generation = this.pageGeneration(pageIndex);
+    const rasterKey = RasterCache.key(pageIndex, 0, scale * pixelRatio, generation, draft);
+    if (this.rasterCache.has(rasterKey)) {
+      const { width: pageWidth, height: pageHeight } = this.getPageDimension(pageIndex);
+      const width = Math.max(1, Math.round(pageWidth * scale * pixelRatio));
+      const height = Math.max(1, Math.round(pageHeight * scale * pixelRatio));
+      const cached = this.rasterCache.get(rasterKey, width, height);
+      const ctx = cached ? canvas.getContext('2d') : null;
+      if (cached && ctx) {
+        canvas.width = width;
+        canvas.height = height;
+        ctx.drawImage(cached.bitmap, 0, 0);
+        return;
+      }
+    }
+
+    // Use cached edit-mode page pointer if available (has in-memory text edits).
+    // Synchronous renders borrow from the page cache; interruptible ones hold the
+    // page across awaits, so they load a private one.
     const cachedEditPage = this.editPageCache.get(pageIndex);
-    const pagePtr = cachedEditPage ?? pdfium._PDFium_LoadPage(this.docPtr, pageIndex);
+    const pagePtr =
+      cachedEditPage ??
+      (signal
+        ? pdfium._PDFium_LoadPage(this.docPtr, pageIndex)
+        : this.acquirePage(pdfium, this.docPtr, pageIndex));
     if (!pagePtr) {
       throw new Error(`Failed to load page ${pageIndex} - docPtr: ${this.docPtr}`);
     }
@@ -891,98 +2510,850 @@ export class PdfController implements IPdfController {
       const width = Math.max(1, Math.round(logicalWidth * pixelRatio));
       const height = Math.max(1, Math.round(logicalHeight * pixelRatio));
 
-      // Set canvas size (physical pixels)
-      canvas.width = width;
-      canvas.height = height;
+      // Set canvas size (physical pixels)
+      canvas.width = width;
+      canvas.height = height;
+
+      const ctx = canvas.getContext('2d');
+      if (!ctx) {
+        throw new Error('Failed to get canvas 2D context');
+      }
+      // Disable image smoothing for crisp pixel-perfect rendering
+      ctx.imageSmoothingEnabled = false;
+
+      // Show the same page at another scale (e.g. its thumbnail) until the render lands
+      const placeholder = this.rasterCache.findPlaceholder(pageIndex, 0, generation, width);
+      if (placeholder) {
+        ctx.imageSmoothingEnabled = true;
+        ctx.drawImage(placeholder.bitmap, 0, 0, width, height);
+        ctx.imageSmoothingEnabled = false;
+      }
+
+      // Thumbnails are small enough to draw synchronously even when interruptible.
+      // The page's /Thumb image is stale once the page was edited.
+      if (draft && PdfController.hasThumbnails(pdfium)) {
+        const thumbOptions =
+          generation > 0 || cachedEditPage
+            ? THUMBNAIL_OPTION.SKIP_EMBEDDED
+            : THUMBNAIL_OPTION.NONE;
+        const rgbaPtr = pdfium._PDFium_RenderThumbnailRGBA(
+          pagePtr,
+          width,
+          height,
+          thumbOptions,
+          0,
+        );
+        if (rgbaPtr) {
+          try {
+            this.putRgbaImage(ctx, pdfium, rgbaPtr, width * 4, width, height);
+          } finally {
+            pdfium._PDFium_FreeBuffer(rgbaPtr);
+          }
+          this.cacheRaster(canvas, rasterKey, pageIndex, generation);
+          return;
+        }
+      }
+
+      // One-shot native render straight to packed RGBA (synchronous path only;
+      // progressive rendering needs the bitmap handle to resume between cycles).
+      if (!signal && pdfium._PDFium_RenderLoadedPageRGBA) {
+        const rgbaPtr = pdfium._PDFium_RenderLoadedPageRGBA(
+          pagePtr,
+          width,
+          height,
+          0,
+          FPDF_RENDER_FLAGS.DEFAULT,
+          0xffffffff,
+        );
+        if (!rgbaPtr) {
+          throw new Error('Failed to render page');
+        }
+        try {
+          this.putRgbaImage(ctx, pdfium, rgbaPtr, width * 4, width, height);
+        } finally {
+          pdfium._PDFium_FreeBuffer(rgbaPtr);
+        }
+        this.cacheRaster(canvas, rasterKey, pageIndex, generation);
+        return;
+      }
+
+      // Interruptible renders go through the native async queue when available
+      // (edit-cached pages keep the bitmap path: their handle is shared).
+      if (signal && !cachedEditPage && PdfController.hasAsyncRender(pdfium)) {
+        await this.renderPageAsync(pdfium, ctx, pagePtr, width, height, signal);
+        this.cacheRaster(canvas, rasterKey, pageIndex, generation);
+        return;
+      }
+
+      // Create bitmap (reused from the native pool when available)
+      const bitmapPtr = PdfController.acquireBitmap(pdfium, width, height);
+      if (!bitmapPtr) {
+        throw new Error('Failed to create bitmap');
+      }
+
+      try {
+        // Fill with white background (BGRA format: 0xffffffff)
+        pdfium._PDFium_BitmapFillRect(bitmapPtr, 0, 0, width, height, 0xffffffff);
+
+        // Render in RGBA byte order so the buffer can be copied to the canvas as-is
+        const flags = FPDF_RENDER_FLAGS.DEFAULT | FPDF_RENDER_FLAGS.REVERSE_BYTE_ORDER;
+
+        // Use progressive rendering if AbortSignal is provided
+        if (signal) {
+          await this.renderPageProgressive(
+            pdfium,
+            bitmapPtr,
+            pagePtr,
+            width,
+            height,
+            flags,
+            signal,
+          );
+        } else {
+          // Synchronous render (original behavior for backwards compatibility)
+          pdfium._PDFium_RenderPageBitmap(bitmapPtr, pagePtr, 0, 0, width, height, 0, flags);
+        }
+
+        // Check if aborted before copying to canvas
+        if (signal?.aborted) {
+          throw new DOMException('Render aborted', 'AbortError');
+        }
+
+        const bufferPtr = pdfium._PDFium_BitmapGetBuffer(bitmapPtr);
+        const stride = pdfium._PDFium_BitmapGetStride(bitmapPtr);
+        this.putRgbaImage(ctx, pdfium, bufferPtr, stride, width, height);
+        this.cacheRaster(canvas, rasterKey, pageIndex, generation);
+      } finally {
+        PdfController.releaseBitmap(pdfium, bitmapPtr);
+      }
+    } finally {
+      // Close the private page of an interruptible render; borrowed pages go back
+      // to the cache (edit-mode pointers stay until releaseEditPages()).
+      if (signal && !cachedEditPage) {
+        pdfium._PDFium_ClosePage(pagePtr);
+      } else {
+        this.releasePage(pdfium, pageIndex, pagePtr);
+      }
+      this.maybeTrimMemory(pdfium);
+    }
+  }
+
+  public scheduleRender(
+    canvas: HTMLCanvasElement,
+    options: IScheduledRenderOptions = {},
+  ): Promise<void> {
+    return this.renderScheduler.schedule(canvas, options);
+  }
+
+  public setRenderViewport(viewport: IRenderViewport): void {
+    this.renderScheduler.setViewport(viewport);
+  }
+
+  /**
+   * Sidebar thumbnails draw page by page otherwise: a scheduled render, a page load and
+   * a canvas upload each. This draws up to THUMBNAIL_ATLAS_MAX_PAGES pages per engine
+   * call into one atlas and caches each page's cell under its draft raster key. Pages in
+   * edit mode or already cached are skipped.
+   */
+  public async prefetchThumbnails(
+    firstPage: number,
+    count: number,
+    opts: { scale: number; pixelRatio?: number },
+  ): Promise<void> {
+    const pdfium = this.pdfiumModule;
+    if (!pdfium || !this.docPtr || !PdfController.hasThumbnails(pdfium)) return;
+    if (typeof createImageBitmap !== 'function') return;
+    const deviceScale = opts.scale * (opts.pixelRatio ?? 1);
+    const loadSeq = this.loadSeq;
+    const start = Math.max(0, Math.floor(firstPage));
+    const end = Math.min(this.getPageCount(), start + Math.max(0, Math.floor(count)));
+
+    const isWanted = (pageIndex: number) =>
+      !this.editPageCache.has(pageIndex) &&
+      !this.rasterCache.has(
+        RasterCache.key(pageIndex, 0, deviceScale, this.pageGeneration(pageIndex), true),
+      );
+    if (this.fileLoader) {
+      for (let pageIndex = start; pageIndex < end; pageIndex++) {
+        if (isWanted(pageIndex)) await this.ensurePageAvailable(pageIndex);
+        if (loadSeq !== this.loadSeq) return;
+      }
+    }
+
+    // Runs of consecutive wanted pages, one atlas each
+    const drawn: Promise<void>[] = [];
+    let runStart = start;
+    while (runStart < end) {
+      if (!isWanted(runStart)) {
+        runStart++;
+        continue;
+      }
+      let runEnd = runStart + 1;
+      while (runEnd < end && runEnd - runStart < THUMBNAIL_ATLAS_MAX_PAGES && isWanted(runEnd)) {
+        runEnd++;
+      }
+      drawn.push(this.drawThumbnailAtlas(pdfium, runStart, runEnd - runStart, deviceScale));
+      runStart = runEnd;
+    }
+    await Promise.all(drawn);
+  }
+
+  /** Render one atlas and move its cells into the raster cache */
+  private drawThumbnailAtlas(
+    pdfium: IThumbnailModule,
+    firstPage: number,
+    count: number,
+    deviceScale: number,
+  ): Promise<void> {
+    if (!this.docPtr) return Promise.resolve();
+    const generations: number[] = [];
+    for (let i = 0; i < count; i++) generations.push(this.pageGeneration(firstPage + i));
+    const options = generations.some((g) => g > 0)
+      ? THUMBNAIL_OPTION.SKIP_EMBEDDED
+      : THUMBNAIL_OPTION.NONE;
+
+    const rendered = PdfController.renderThumbnailAtlas(
+      pdfium,
+      this.docPtr,
+      firstPage,
+      count,
+      deviceScale,
+      options,
+    );
+    if (!rendered) return Promise.resolve();
+    const { atlas, cells } = rendered;
+
+    const loadSeq = this.loadSeq;
+    const cached: Promise<void>[] = [];
+    for (let i = 0; i < count; i++) {
+      const [top, width, height, source] = cells.subarray(2 + i * 4, 6 + i * 4);
+      if (source === THUMBNAIL_SOURCE.NONE) continue;
+      const pageIndex = firstPage + i;
+      const generation = generations[i];
+      const key = RasterCache.key(pageIndex, 0, deviceScale, generation, true);
+      cached.push(
+        createImageBitmap(atlas, 0, top, width, height).then((bitmap) => {
+          if (loadSeq !== this.loadSeq || generation !== this.pageGeneration(pageIndex)) {
+            bitmap.close();
+            return;
+          }
+          this.rasterCache.set(key, { pageIndex, rotation: 0, generation, bitmap, width, height });
+        }),
+      );
+    }
+    return Promise.all(cached).then(() => undefined);
+  }
+
+  /**
+   * Render a single tile of a page. `scale` is device pixels per PDF point
+   * (include devicePixelRatio), and `tileRect` is in device pixels of the
+   * whole page at that scale. Memory use is bounded by the tile size, so the
+   * viewer can fetch and cache e.g. 512x512 tiles at any zoom level.
+   */
+  public renderTile(pageIndex: number, scale: number, tileRect: ITileRect): ImageData {
+    const { pdfium, docPtr } = this.requireDoc();
+    const x = Math.floor(tileRect.x);
+    const y = Math.floor(tileRect.y);
+    const width = Math.max(1, Math.round(tileRect.width));
+    const height = Math.max(1, Math.round(tileRect.height));
+    const flags = FPDF_RENDER_FLAGS.DEFAULT;
+
+    const pagePtr = this.acquirePage(pdfium, docPtr, pageIndex);
+    if (!pagePtr) {
+      throw new Error(`Failed to load page ${pageIndex}`);
+    }
+
+    try {
+      const imageData = new ImageData(width, height);
+
+      if (pdfium._PDFium_RenderPageTileRGBA) {
+        const rgbaPtr = pdfium._PDFium_RenderPageTileRGBA(
+          pagePtr,
+          scale,
+          x,
+          y,
+          width,
+          height,
+          flags,
+          0xffffffff,
+        );
+        if (!rgbaPtr) {
+          throw new Error('Failed to render tile');
+        }
+        try {
+          imageData.data.set(pdfium.HEAPU8.subarray(rgbaPtr, rgbaPtr + width * height * 4));
+        } finally {
+          pdfium._PDFium_FreeBuffer(rgbaPtr);
+        }
+        return imageData;
+      }
+
+      // Older builds: render the full page extent offset into a tile-sized
+      // bitmap; PDFium clips everything outside the bitmap.
+      const pageWidth = Math.round(pdfium._PDFium_GetPageWidth(pagePtr) * scale);
+      const pageHeight = Math.round(pdfium._PDFium_GetPageHeight(pagePtr) * scale);
+      const bitmapPtr = PdfController.acquireBitmap(pdfium, width, height);
+      if (!bitmapPtr) {
+        throw new Error('Failed to create bitmap');
+      }
+      try {
+        pdfium._PDFium_BitmapFillRect(bitmapPtr, 0, 0, width, height, 0xffffffff);
+        pdfium._PDFium_RenderPageBitmap(
+          bitmapPtr,
+          pagePtr,
+          -x,
+          -y,
+          pageWidth,
+          pageHeight,
+          0,
+          flags | FPDF_RENDER_FLAGS.REVERSE_BYTE_ORDER,
+        );
+        const bufferPtr = pdfium._PDFium_BitmapGetBuffer(bitmapPtr);
+        const stride = pdfium._PDFium_BitmapGetStride(bitmapPtr);
+        const rowBytes = width * 4;
+        for (let row = 0; row < height; row++) {
+          const rowPtr = bufferPtr + row * stride;
+          imageData.data.set(pdfium.HEAPU8.subarray(rowPtr, rowPtr + rowBytes), row * rowBytes);
+        }
+      } finally {
+        PdfController.releaseBitmap(pdfium, bitmapPtr);
+      }
+      return imageData;
+    } finally {
+      this.releasePage(pdfium, pageIndex, pagePtr);
+    }
+  }
+
+  public async exportPageImage(
+    pageIndex: number,
+    opts: IPageImageOptions = {},
+  ): Promise<IPageImage> {
+    const { dpi = BATCH_DEFAULT_DPI, format = 'png', quality, print = false } = opts;
+    if (this.fileLoader) await this.ensurePageAvailable(pageIndex);
+    const pixels = this.renderPageImageData(pageIndex, dpi / 72, print);
+    const image = { pageIndex, width: pixels.width, height: pixels.height, dpi };
+    if (format === 'rgba') return { ...image, blob: null, pixels };
+
+    const canvas = new OffscreenCanvas(pixels.width, pixels.height);
+    const ctx = canvas.getContext('2d');
+    if (!ctx) {
+      throw new Error('Failed to get OffscreenCanvas 2D context');
+    }
+    ctx.putImageData(pixels, 0, 0);
+    const blob = await canvas.convertToBlob({ type: `image/${format}`, quality });
+    return { ...image, blob, pixels: null };
+  }
+
+  /**
+   * Render pages to images in page order. Up to BATCH_RENDER_WINDOW pages render ahead
+   * while earlier ones are still being encoded, which the browser does off the main
+   * thread. The stream ends early when `signal` aborts or another document is loaded.
+   */
+  public async *renderPages(
+    range?: IPageRange,
+    opts: IPageImageOptions & IBatchOptions = {},
+  ): AsyncGenerator<IPageImage, void, undefined> {
+    const { signal, onProgress, ...imageOptions } = opts;
+    const pages = batchPageIndices(range, this.getPageCount());
+    const loadSeq = this.loadSeq;
+    const isStale = () => signal?.aborted === true || loadSeq !== this.loadSeq;
+
+    const inFlight: Promise<IPageImage>[] = [];
+    let next = 0;
+    for (let done = 0; done < pages.length && !isStale(); done++) {
+      while (next < pages.length && inFlight.length < BATCH_RENDER_WINDOW) {
+        const pending = this.exportPageImage(pages[next++], imageOptions);
+        // Pages still in flight when the stream ends are dropped, errors included
+        pending.catch(() => undefined);
+        inFlight.push(pending);
+      }
+      const head = inFlight.shift();
+      if (!head) return;
+      const image = await head;
+      if (isStale()) return;
+      onProgress?.({ done: done + 1, total: pages.length, pageIndex: image.pageIndex });
+      yield image;
+    }
+  }
+
+  /**
+   * Render a whole page to ImageData. Pages other than edit-mode ones are loaded and
+   * closed here rather than borrowed from the page cache, so a pass over the document
+   * does not evict the pages on screen.
+   */
+  private renderPageImageData(pageIndex: number, scale: number, print: boolean): ImageData {
+    const { pdfium, docPtr } = this.requireDoc();
+    const editPage = this.editPageCache.get(pageIndex);
+    const pagePtr = editPage ?? pdfium._PDFium_LoadPage(docPtr, pageIndex);
+    if (!pagePtr) {
+      throw new Error(`Failed to load page ${pageIndex}`);
+    }
+    try {
+      const width = Math.max(1, Math.round(pdfium._PDFium_GetPageWidth(pagePtr) * scale));
+      const height = Math.max(1, Math.round(pdfium._PDFium_GetPageHeight(pagePtr) * scale));
+      const flags = print
+        ? FPDF_RENDER_FLAGS.ANNOT | FPDF_RENDER_FLAGS.PRINTING
+        : FPDF_RENDER_FLAGS.DEFAULT;
+      const imageData = new ImageData(width, height);
+
+      if (pdfium._PDFium_RenderLoadedPageRGBA) {
+        const rgbaPtr = pdfium._PDFium_RenderLoadedPageRGBA(
+          pagePtr,
+          width,
+          height,
+          0,
+          flags,
+          0xffffffff,
+        );
+        if (!rgbaPtr) {
+          throw new Error(`Failed to render page ${pageIndex}`);
+        }
+        try {
+          imageData.data.set(pdfium.HEAPU8.subarray(rgbaPtr, rgbaPtr + width * height * 4));
+        } finally {
+          pdfium._PDFium_FreeBuffer(rgbaPtr);
+        }
+        return imageData;
+      }
+
+      const bitmapPtr = PdfController.acquireBitmap(pdfium, width, height);
+      if (!bitmapPtr) {
+        throw new Error('Failed to create bitmap');
+      }
+      try {
+        pdfium._PDFium_BitmapFillRect(bitmapPtr, 0, 0, width, height, 0xffffffff);
+        pdfium._PDFium_RenderPageBitmap(
+          bitmapPtr,
+          pagePtr,
+          0,
+          0,
+          width,
+          height,
+          0,
+          flags | FPDF_RENDER_FLAGS.REVERSE_BYTE_ORDER,
+        );
+        const bufferPtr = pdfium._PDFium_BitmapGetBuffer(bitmapPtr);
+        const stride = pdfium._PDFium_BitmapGetStride(bitmapPtr);
+        const rowBytes = width * 4;
+        for (let row = 0; row < height; row++) {
+          const rowPtr = bufferPtr + row * stride;
+          imageData.data.set(pdfium.HEAPU8.subarray(rowPtr, rowPtr + rowBytes), row * rowBytes);
+        }
+      } finally {
+        PdfController.releaseBitmap(pdfium, bitmapPtr);
+      }
+      return imageData;
+    } finally {
+      if (!editPage) pdfium._PDFium_ClosePage(pagePtr);
+    }
+  }
+
+  public async getPagesText(firstPage: number, count: number): Promise<IPageText[]> {
+    const end = Math.min(this.getPageCount(), firstPage + count);
+    const out: IPageText[] = [];
+    for (let pageIndex = Math.max(0, firstPage); pageIndex < end; ) {
+      if (!this.isPageDataAvailable(pageIndex)) await this.ensurePageAvailable(pageIndex);
+      const { pdfium, docPtr } = this.requireDoc();
+      const texts = this.readPagesText(pdfium, docPtr, pageIndex, end - pageIndex, 0);
+      if (!texts.length) break;
+      out.push(...texts);
+      pageIndex = texts[texts.length - 1].pageIndex + 1;
+    }
+    return out;
+  }
+
+  /**
+   * Plain text of a range of pages, yielded in page order in BATCH_TEXT_SLICE_MS slices.
+   * The stream ends early when `signal` aborts or another document is loaded.
+   */
+  public async *extractText(
+    range?: IPageRange,
+    opts: IBatchOptions = {},
+  ): AsyncGenerator<IPageText[], void, undefined> {
+    const { signal, onProgress } = opts;
+    const pages = batchPageIndices(range, this.getPageCount());
+    if (!pages.length) return;
+    const loadSeq = this.loadSeq;
+    const isStale = () => signal?.aborted === true || loadSeq !== this.loadSeq;
+    const nextSlice = () => new Promise((resolve) => setTimeout(resolve, 0));
+
+    const first = pages[0];
+    const end = first + pages.length;
+    for (let pageIndex = first; pageIndex < end; ) {
+      if (!this.isPageDataAvailable(pageIndex)) {
+        await this.ensurePageAvailable(pageIndex, signal);
+      }
+      if (isStale()) return;
+      const { pdfium, docPtr } = this.requireDoc();
+      const chunk: IPageText[] = [];
+      const deadline = performance.now() + BATCH_TEXT_SLICE_MS;
+      while (pageIndex < end && this.isPageDataAvailable(pageIndex)) {
+        const budgetMs = Math.max(1, deadline - performance.now());
+        const texts = this.readPagesText(pdfium, docPtr, pageIndex, end - pageIndex, budgetMs);
+        if (!texts.length) return;
+        chunk.push(...texts);
+        pageIndex = texts[texts.length - 1].pageIndex + 1;
+        if (performance.now() >= deadline) break;
+      }
+      if (!chunk.length) return;
+      onProgress?.({ done: pageIndex - first, total: pages.length, pageIndex: pageIndex - 1 });
+      yield chunk;
+      if (pageIndex < end) await nextSlice();
+      if (isStale()) return;
+    }
+  }
+
+  /**
+   * Text of pages from firstPage, at most maxPages and roughly budgetMs (0 = no limit),
+   * in one engine call when the binary has _PDFium_ExtractPagesText. Edit-mode pages and
+   * pages of a progressive load not downloaded yet end the native run; an edit-mode page
+   * is read on its own from its in-memory handle.
+   */
+  private readPagesText(
+    pdfium: IPDFiumModule,
+    docPtr: number,
+    firstPage: number,
+    maxPages: number,
+    budgetMs: number,
+  ): IPageText[] {
+    let run = 0;
+    while (
+      run < maxPages &&
+      !this.editPageCache.has(firstPage + run) &&
+      this.isPageDataAvailable(firstPage + run)
+    ) {
+      run++;
+    }
+    if (!run || !pdfium._PDFium_ExtractPagesText) {
+      return [this.readPageText(pdfium, docPtr, firstPage)];
+    }
+
+    const ptr = pdfium._PDFium_ExtractPagesText(docPtr, firstPage, run, budgetMs);
+    if (!ptr) return [];
+    try {
+      const heap32 = pdfium.HEAP32;
+      const base = ptr >> 2;
+      const pageCount = heap32[base];
+      const pageWords = heap32[base + 3];
+      const pagesAt = base + TEXT_BATCH_HEADER_WORDS;
+      const textPtr = (pagesAt + pageCount * pageWords) * 4;
+      const out: IPageText[] = [];
+      for (let i = 0; i < pageCount; i++) {
+        const at = pagesAt + i * pageWords;
+        const length = heap32[at + 3];
+        const from = textPtr + heap32[at + 2] * 2;
+        out.push({
+          pageIndex: heap32[at],
+          text:
+            length > 0
+              ? PdfController.utf16Decoder.decode(pdfium.HEAPU8.subarray(from, from + length * 2))
+              : '',
+          ok: heap32[at + 1] === 1,
+        });
+      }
+      return out;
+    } finally {
+      pdfium._PDFium_FreeBuffer(ptr);
+    }
+  }
+
+  /** Text of one page through its borrowed text page (the edit-mode one while editing) */
+  private readPageText(pdfium: IPDFiumModule, docPtr: number, pageIndex: number): IPageText {
+    const failed = { pageIndex, text: '', ok: false };
+    const pagePtr = this.acquirePage(pdfium, docPtr, pageIndex);
+    if (!pagePtr) return failed;
+    try {
+      const textPagePtr = this.acquireTextPage(pdfium, pageIndex, pagePtr);
+      if (!textPagePtr) return failed;
+      try {
+        const count = pdfium._PDFium_GetPageCharCount(textPagePtr);
+        if (count <= 0) return { pageIndex, text: '', ok: true };
+        // FPDFText_GetText writes count units plus a NUL
+        const bufferPtr = pdfium._malloc((count + 1) * 2);
+        try {
+          const written = pdfium._PDFium_GetPageText(textPagePtr, bufferPtr, count + 1);
+          const units = Math.max(0, Math.min(written - 1, count));
+          const text = PdfController.utf16Decoder.decode(
+            pdfium.HEAPU8.subarray(bufferPtr, bufferPtr + units * 2),
+          );
+          return { pageIndex, text, ok: true };
+        } finally {
+          pdfium._free(bufferPtr);
+        }
+      } finally {
+        this.releaseTextPage(pdfium, pageIndex, pagePtr, textPagePtr);
+      }
+    } finally {
+      this.releasePage(pdfium, pageIndex, pagePtr);
+    }
+  }
+
+  /**
+   * Acquire a 32-bit render bitmap. Uses the native bitmap pool when the WASM
+   * build exports it, so scroll/zoom renders recycle buffers instead of
+   * allocating a fresh one per frame.
+   */
+  private static acquireBitmap(pdfium: IPDFiumModule, width: number, height: number): number {
+    if (pdfium._PDFium_BitmapPoolAcquire) {
+      return pdfium._PDFium_BitmapPoolAcquire(width, height);
+    }
+    return pdfium._PDFium_BitmapCreate(width, height, 1);
+  }
+
+  /** Release a bitmap obtained from acquireBitmap(). */
+  private static releaseBitmap(pdfium: IPDFiumModule, bitmapPtr: number): void {
+    if (pdfium._PDFium_BitmapPoolRelease) {
+      pdfium._PDFium_BitmapPoolRelease(bitmapPtr);
+    } else {
+      pdfium._PDFium_BitmapDestroy(bitmapPtr);
+    }
+  }
+
+  /**
+   * Copy an RGBA buffer from WASM memory onto the canvas. Rows are copied with
+   * a single memcpy when tightly packed, otherwise row by row to drop padding.
+   * Both steps are timed while profiling counters are enabled.
+   */
+  private putRgbaImage(
+    ctx: CanvasRenderingContext2D,
+    pdfium: IPDFiumModule,
+    bufferPtr: number,
+    stride: number,
+    width: number,
+    height: number,
+  ): void {
+    const copyStart = this.perfEnabled ? performance.now() : 0;
+    const imageData = ctx.createImageData(width, height);
+    const rowBytes = width * 4;
+    if (stride === rowBytes) {
+      imageData.data.set(pdfium.HEAPU8.subarray(bufferPtr, bufferPtr + rowBytes * height));
+    } else {
+      for (let y = 0; y < height; y++) {
+        const rowPtr = bufferPtr + y * stride;
+        imageData.data.set(pdfium.HEAPU8.subarray(rowPtr, rowPtr + rowBytes), y * rowBytes);
+      }
+    }
+    if (!this.perfEnabled) {
+      ctx.putImageData(imageData, 0, 0);
+      return;
+    }
+    const putStart = performance.now();
+    this.rgbaCopyTiming.record(putStart - copyStart);
+    ctx.putImageData(imageData, 0, 0);
+    this.putImageDataTiming.record(performance.now() - putStart);
+  }
+
+  /** Content generation of a page; rasters of older generations are stale. */
+  private pageGeneration(pageIndex: number): number {
+    return this.pageGenerations.get(pageIndex) ?? 0;
+  }
+
+  /** Record an edit to the document for getDirtyState and exportIncrementalPdf. */
+  private markDirty(pageIndex: number, kind: DirtyKind): void {
+    this.dirtyPages.add(pageIndex);
+    this.dirtyKinds.add(kind);
+  }
+
+  public getDirtyState(): IDirtyState {
+    return {
+      pages: [...this.dirtyPages].sort((a, b) => a - b),
+      annotations: this.dirtyKinds.has('annotations'),
+      forms: this.dirtyKinds.has('forms'),
+      content: this.dirtyKinds.has('content'),
+    };
+  }
+
+  public getSourceBlob(): Blob | null {
+    return this.sourceBlob;
+  }
+
+  /**
+   * Record that a page renders differently now and drop its cached rasters and its
+   * spatial index, whose annotation rects would otherwise answer hit tests.
+   */
+  private markPageChanged(pageIndex: number): void {
+    this.pageGenerations.set(pageIndex, this.pageGeneration(pageIndex) + 1);
+    this.rasterCache.invalidatePage(pageIndex);
+    if (this.pageCachePtr) {
+      this.pdfiumModule?._PDFium_PageCacheDropSpatial?.(this.pageCachePtr, pageIndex);
+    }
+  }
+
+  /**
+   * Snapshot a finished render into the raster cache. createImageBitmap copies the
+   * canvas when called; the snapshot is dropped if the page changed or the document
+   * was closed before it resolved. Until then the write is listed in pendingRasters, so
+   * a render of the same raster waits for it instead of drawing the page again.
+   */
+  private cacheRaster(
+    canvas: HTMLCanvasElement,
+    key: string,
+    pageIndex: number,
+    generation: number,
+  ): void {
+    if (typeof createImageBitmap !== 'function') return;
+    const { width, height } = canvas;
+    const loadSeq = this.loadSeq;
+    const write: Promise<void> = createImageBitmap(canvas)
+      .then(
+        (bitmap) => {
+          if (loadSeq !== this.loadSeq || generation !== this.pageGeneration(pageIndex)) {
+            bitmap.close();
+            return;
+          }
+          this.rasterCache.set(key, { pageIndex, rotation: 0, generation, bitmap, width, height });
+        },
+        (error: unknown) => {
+          console.warn('[PdfController] Failed to cache rendered page', error);
+        },
+      )
+      .finally(() => {
+        if (this.pendingRasters.get(key) === write) this.pendingRasters.delete(key);
+      });
+    this.pendingRasters.set(key, write);
+  }
+
+  /** Limit the RGBA bytes of rendered pages kept for redraws (0 disables the cache). */
+  public setRasterCacheBudget(maxBytes: number): void {
+    this.rasterCache.setMaxBytes(Math.max(0, Math.floor(maxBytes)));
+  }
+
+  /** _PDFium_RenderThumbnailAtlas copied out of the heap: the atlas and its cell table */
+  private static renderThumbnailAtlas(
+    pdfium: IThumbnailModule,
+    docPtr: number,
+    firstPage: number,
+    count: number,
+    deviceScale: number,
+    options: THUMBNAIL_OPTION,
+  ): { atlas: ImageData; cells: Int32Array } | null {
+    const cellsPtr = pdfium._malloc((2 + 4 * count) * 4);
+    try {
+      const atlasPtr = pdfium._PDFium_RenderThumbnailAtlas(
+        docPtr,
+        firstPage,
+        count,
+        deviceScale,
+        options,
+        cellsPtr,
+      );
+      if (!atlasPtr) return null;
+      try {
+        const cells = pdfium.HEAP32.slice(cellsPtr >> 2, (cellsPtr >> 2) + 2 + 4 * count);
+        const [atlasWidth, atlasHeight] = cells;
+        const atlas = new ImageData(atlasWidth, atlasHeight);
+        atlas.data.set(pdfium.HEAPU8.subarray(atlasPtr, atlasPtr + atlasWidth * atlasHeight * 4));
+        return { atlas, cells };
+      } finally {
+        pdfium._PDFium_FreeBuffer(atlasPtr);
+      }
+    } finally {
+      pdfium._free(cellsPtr);
+    }
+  }
+
+  private static hasThumbnails(pdfium: IPDFiumModule): pdfium is IThumbnailModule {
+    return (
+      typeof pdfium._PDFium_RenderThumbnailRGBA === 'function' &&
+      typeof pdfium._PDFium_RenderThumbnailAtlas === 'function'
+    );
+  }
+
+  private static hasAsyncRender(pdfium: IPDFiumModule): pdfium is IAsyncRenderModule {
+    return (
+      typeof pdfium._PDFium_RenderLoadedPageAsync === 'function' &&
+      typeof pdfium._PDFium_RenderAsyncPump === 'function'
+    );
+  }
+
+  /**
+   * Render through the native async queue. The job has its own cancel flag,
+   * so aborting one page never cancels or restarts another.
+   */
+  private async renderPageAsync(
+    pdfium: IAsyncRenderModule,
+    ctx: CanvasRenderingContext2D,
+    pagePtr: number,
+    width: number,
+    height: number,
+    signal: AbortSignal,
+  ): Promise<void> {
+    const jobId = pdfium._PDFium_RenderLoadedPageAsync(
+      pagePtr,
+      width,
+      height,
+      0,
+      FPDF_RENDER_FLAGS.DEFAULT | FPDF_RENDER_FLAGS.REVERSE_BYTE_ORDER,
+      0xffffffff,
+    );
+    if (!jobId) {
+      throw new Error('Failed to start render');
+    }
+
+    const onAbort = () => {
+      pdfium._PDFium_RenderAsyncCancel(jobId);
+    };
+    signal.addEventListener('abort', onAbort);
+
+    try {
+      const status = await new Promise<number>((resolve) => {
+        this.asyncRenderWaiters.set(jobId, resolve);
+        this.scheduleAsyncRenderPump();
+      });
 
-      // Create bitmap
-      const bitmapPtr = pdfium._PDFium_BitmapCreate(width, height, 1);
-      if (!bitmapPtr) {
-        throw new Error('Failed to create bitmap');
+      if (status === ASYNC_RENDER_STATUS.CANCELLED || signal.aborted) {
+        throw new DOMException('Render aborted', 'AbortError');
+      }
+      if (status !== ASYNC_RENDER_STATUS.DONE) {
+        throw new Error('Progressive rendering failed');
       }
 
-      try {
-        // Fill with white background (BGRA format: 0xffffffff)
-        pdfium._PDFium_BitmapFillRect(bitmapPtr, 0, 0, width, height, 0xffffffff);
-
-        // Use progressive rendering if AbortSignal is provided
-        if (signal) {
-          await this.renderPageProgressive(pdfium, bitmapPtr, pagePtr, width, height, signal);
-        } else {
-          // Synchronous render (original behavior for backwards compatibility)
-          pdfium._PDFium_RenderPageBitmap(
-            bitmapPtr,
-            pagePtr,
-            0,
-            0,
-            width,
-            height,
-            0,
-            FPDF_RENDER_FLAGS.DEFAULT,
-          );
-        }
+      const bufferPtr = pdfium._PDFium_RenderAsyncGetBuffer(jobId);
+      this.putRgbaImage(ctx, pdfium, bufferPtr, width * 4, width, height);
+    } finally {
+      signal.removeEventListener('abort', onAbort);
+      pdfium._PDFium_RenderAsyncRelease(jobId);
+    }
+  }
 
-        // Check if aborted before copying to canvas
-        if (signal?.aborted) {
-          throw new DOMException('Render aborted', 'AbortError');
-        }
+  /** Advance all pending async renders by one slice per event-loop turn. */
+  private scheduleAsyncRenderPump(): void {
+    if (this.asyncRenderPumpScheduled) return;
+    this.asyncRenderPumpScheduled = true;
 
-        // Get bitmap buffer
-        const bufferPtr = pdfium._PDFium_BitmapGetBuffer(bitmapPtr);
-        const stride = pdfium._PDFium_BitmapGetStride(bitmapPtr);
+    setTimeout(() => {
+      this.asyncRenderPumpScheduled = false;
+      const pdfium = this.pdfiumModule;
+      if (!pdfium || !PdfController.hasAsyncRender(pdfium)) return;
 
-        // Copy bitmap data to canvas
-        const ctx = canvas.getContext('2d');
-        if (!ctx) {
-          throw new Error('Failed to get canvas 2D context');
-        }
-        // Disable image smoothing for crisp pixel-perfect rendering
-        ctx.imageSmoothingEnabled = false;
+      pdfium._PDFium_RenderAsyncPump(RENDER_SLICE_MS);
 
-        const imageData = ctx.createImageData(width, height);
-        const dst32 = new Uint32Array(imageData.data.buffer);
-
-        // Convert BGRA to RGBA using Uint32Array for ~10-50x faster performance
-        // Fast path: no stride padding and 4-byte aligned memory (common case)
-        if (stride === width * 4 && bufferPtr % 4 === 0) {
-          const src32 = new Uint32Array(pdfium.HEAPU8.buffer, bufferPtr, width * height);
-          for (let i = 0, len = src32.length; i < len; i++) {
-            const pixel = src32[i];
-            // BGRA -> RGBA: swap R and B, keep G and A in place
-            dst32[i] = (pixel & 0xff00ff00) | ((pixel >> 16) & 0xff) | ((pixel & 0xff) << 16);
-          }
-        } else {
-          // Fallback: handle stride padding or unaligned memory
-          const src = pdfium.HEAPU8.subarray(bufferPtr, bufferPtr + stride * height);
-          for (let y = 0; y < height; y++) {
-            for (let x = 0; x < width; x++) {
-              const srcIdx = y * stride + x * 4;
-              const dstIdx = y * width + x;
-              dst32[dstIdx] =
-                src[srcIdx + 2] | // R
-                (src[srcIdx + 1] << 8) | // G
-                (src[srcIdx + 0] << 16) | // B
-                (src[srcIdx + 3] << 24); // A
-            }
-          }
+      for (const [jobId, resolve] of this.asyncRenderWaiters) {
+        const status = pdfium._PDFium_RenderAsyncPoll(jobId);
+        if (status !== ASYNC_RENDER_STATUS.QUEUED && status !== ASYNC_RENDER_STATUS.RUNNING) {
+          this.asyncRenderWaiters.delete(jobId);
+          resolve(status);
         }
-
-        ctx.putImageData(imageData, 0, 0);
-      } finally {
-        pdfium._PDFium_BitmapDestroy(bitmapPtr);
       }
-    } finally {
-      // Only close the page if it's not a cached edit-mode pointer.
-      // Cached pages are released explicitly via releaseEditPages().
-      if (!cachedEditPage) {
-        pdfium._PDFium_ClosePage(pagePtr);
+
+      if (this.asyncRenderWaiters.size > 0) {
+        this.scheduleAsyncRenderPump();
       }
-    }
+    }, 0);
+  }
+
+  private static hasRenderJobs(pdfium: IPDFiumModule): pdfium is IRenderJobModule {
+    return (
+      typeof pdfium._PDFium_RenderJobCreate === 'function' &&
+      typeof pdfium._PDFium_RenderJobStart === 'function'
+    );
   }
 
   /**
    * Progressive rendering with cancellation support.
    * Renders the page in chunks, yielding to the event loop periodically to check for cancellation.
+   * Uses a native render job (own cancel flag, RENDER_SLICE_MS budget per slice) when the WASM
+   * build provides one, so overlapping renders cannot cancel each other through the global flag.
    */
   private async renderPageProgressive(
     pdfium: IPDFiumModule,
@@ -990,36 +3361,34 @@ export class PdfController implements IPdfController {
     pagePtr: number,
     width: number,
     height: number,
+    flags: number,
     signal: AbortSignal,
   ): Promise<void> {
-    // FPDF_RENDER_STATUS values (CYCLIC=1, DONE=2, TOBECONTINUED=3, FAILED=4)
+    // PDFium progressive status: TOBECONTINUED=1, DONE=2, anything else is a failure
+    const RENDER_TOBECONTINUED = 1;
     const RENDER_DONE = 2;
-    const RENDER_FAILED = 4;
 
-    // Set up abort handler to set the cancel flag
+    const jobs = PdfController.hasRenderJobs(pdfium) ? pdfium : null;
+    const jobPtr = jobs ? jobs._PDFium_RenderJobCreate(RENDER_SLICE_MS) : 0;
+
+    // Set up abort handler to cancel this render
     const onAbort = () => {
-      pdfium._PDFium_SetRenderCancelFlag(1);
+      if (jobs) {
+        jobs._PDFium_RenderJobCancel(jobPtr);
+      } else {
+        pdfium._PDFium_SetRenderCancelFlag(1);
+      }
     };
     signal.addEventListener('abort', onAbort);
 
     try {
-      // Reset cancel flag before starting
-      pdfium._PDFium_SetRenderCancelFlag(0);
-
       // Start progressive rendering
-      let status = pdfium._PDFium_RenderPageBitmap_Start(
-        bitmapPtr,
-        pagePtr,
-        0,
-        0,
-        width,
-        height,
-        0,
-        FPDF_RENDER_FLAGS.DEFAULT,
-      );
+      let status = jobs
+        ? jobs._PDFium_RenderJobStart(jobPtr, bitmapPtr, pagePtr, 0, 0, width, height, 0, flags)
+        : pdfium._PDFium_RenderPageBitmap_Start(bitmapPtr, pagePtr, 0, 0, width, height, 0, flags);
 
       // Continue rendering until done, failed, or cancelled
-      while (status !== RENDER_DONE && status !== RENDER_FAILED) {
+      while (status === RENDER_TOBECONTINUED) {
         // Check if aborted
         if (signal.aborted) {
           // Close progressive rendering to release resources
@@ -1031,13 +3400,15 @@ export class PdfController implements IPdfController {
         await new Promise((resolve) => setTimeout(resolve, 0));
 
         // Continue rendering
-        status = pdfium._PDFium_RenderPage_Continue(pagePtr);
+        status = jobs
+          ? jobs._PDFium_RenderJobContinue(jobPtr, pagePtr)
+          : pdfium._PDFium_RenderPage_Continue(pagePtr);
       }
 
       // Close progressive rendering
       pdfium._PDFium_RenderPage_Close(pagePtr);
 
-      if (status === RENDER_FAILED) {
+      if (status !== RENDER_DONE) {
         throw new Error('Progressive rendering failed');
       }
 
@@ -1047,11 +3418,102 @@ export class PdfController implements IPdfController {
       }
     } finally {
       signal.removeEventListener('abort', onAbort);
-      // Reset cancel flag
-      pdfium._PDFium_SetRenderCancelFlag(0);
+      if (jobs) {
+        jobs._PDFium_RenderJobDestroy(jobPtr);
+      } else {
+        // Reset cancel flag
+        pdfium._PDFium_SetRenderCancelFlag(0);
+      }
+    }
+  }
+
+  /**
+   * Char, link and annotation under a canvas point, from the page's spatial index in the
+   * native page cache (built on first use, dropped when the page changes).
+   */
+  public hitTest(
+    pageIndex: number,
+    opts: { scale: number; canvasPoint: IPoint; kinds?: HIT_TEST_KIND; tolerance?: number },
+  ): IHitTestResult | null {
+    const cache = this.spatialIndexCache(pageIndex);
+    if (!cache) return null;
+    const { pdfium, cachePtr } = cache;
+    this.hitTestOutPtr ||= pdfium._malloc(3 * 4);
+    const { scale, canvasPoint } = opts;
+    pdfium._PDFium_HitTest(
+      cachePtr,
+      pageIndex,
+      scale,
+      0,
+      canvasPoint.x,
+      canvasPoint.y,
+      opts.tolerance ?? HIT_TEST_TOLERANCE_PX,
+      opts.kinds ?? HIT_TEST_KIND.ALL,
+      this.hitTestOutPtr,
+    );
+    const out = this.hitTestOutPtr >> 2;
+    return {
+      charIndex: pdfium.HEAP32[out],
+      linkAnnotIndex: pdfium.HEAP32[out + 1],
+      annotIndex: pdfium.HEAP32[out + 2],
+    };
+  }
+
+  /** Chars whose boxes intersect a canvas rect, as ascending, merged index ranges. */
+  public getCharRangesInRect(
+    pageIndex: number,
+    opts: {
+      scale: number;
+      canvasRect: { left: number; top: number; width: number; height: number };
+    },
+  ): ICharRange[] | null {
+    const cache = this.spatialIndexCache(pageIndex);
+    if (!cache) return null;
+    const { pdfium, cachePtr } = cache;
+    const { scale, canvasRect } = opts;
+    const ptr = pdfium._PDFium_QueryRange(
+      cachePtr,
+      pageIndex,
+      scale,
+      0,
+      canvasRect.left,
+      canvasRect.top,
+      canvasRect.left + canvasRect.width,
+      canvasRect.top + canvasRect.height,
+    );
+    if (!ptr) return null;
+    try {
+      const base = ptr >> 2;
+      const count = pdfium.HEAP32[base];
+      const ranges: ICharRange[] = [];
+      for (let i = 0; i < count; i++) {
+        ranges.push({
+          start: pdfium.HEAP32[base + 1 + i * 2],
+          count: pdfium.HEAP32[base + 2 + i * 2],
+        });
+      }
+      return ranges;
+    } finally {
+      pdfium._PDFium_FreeBuffer(ptr);
     }
   }
 
+  /**
+   * The page cache to hit-test a page through, or null when the binary has no spatial
+   * index, the page's text parse is stale (edit mode or after GenerateContent; see
+   * getPageTextContent) or a progressive load has not delivered the page yet.
+   */
+  private spatialIndexCache(
+    pageIndex: number,
+  ): { pdfium: ISpatialIndexModule; cachePtr: number } | null {
+    const pdfium = this.pdfiumModule;
+    if (!pdfium || !this.docPtr || !PdfController.hasSpatialIndex(pdfium)) return null;
+    if (this.editPageCache.has(pageIndex) || this.generatedPages.has(pageIndex)) return null;
+    if (!this.isPageDataAvailable(pageIndex)) return null;
+    const cachePtr = this.ensurePageCache(pdfium, this.docPtr);
+    return cachePtr ? { pdfium, cachePtr } : null;
+  }
+
   /**
    * Get text content as layout-aware rectangles for a page.
    * Uses FPDFText_CountRects / FPDFText_GetRect / FPDFText_GetBoundedText.
@@ -1061,6 +3523,10 @@ export class PdfController implements IPdfController {
     if (!this.pdfiumModule || !this.docPtr) {
       return null;
     }
+    // Loading a page before its data arrives would cache it without its content
+    if (!this.isPageDataAvailable(pageIndex)) {
+      return null;
+    }
 
     // After FPDFPage_GenerateContent, the text-page parser (FPDFText_GetRect etc.)
     // returns corrupted rects. Use page-object APIs for any page that has been
@@ -1072,10 +3538,9 @@ export class PdfController implements IPdfController {
 
     const pdfium = this.pdfiumModule;
 
-    // Use cached edit-mode page pointer if available so text content
+    // acquirePage prefers the edit-mode page pointer so text content
     // reflects in-memory edits (FPDFText_SetText changes).
-    const cachedEditPage = this.editPageCache.get(pageIndex);
-    const pagePtr = cachedEditPage ?? pdfium._PDFium_LoadPage(this.docPtr, pageIndex);
+    const pagePtr = this.acquirePage(pdfium, this.docPtr, pageIndex);
     if (!pagePtr) {
       return null;
     }
@@ -1084,12 +3549,19 @@ export class PdfController implements IPdfController {
       const pageWidth = pdfium._PDFium_GetPageWidth(pagePtr);
       const pageHeight = pdfium._PDFium_GetPageHeight(pagePtr);
 
-      const textPagePtr = pdfium._PDFium_LoadPageText(pagePtr);
+      const textPagePtr = this.acquireTextPage(pdfium, pageIndex, pagePtr);
       if (!textPagePtr) {
         return { pageIndex, pageWidth, pageHeight, textRects: [] };
       }
 
       try {
+        // Fast path: the whole layout in one native call
+        const layoutRects = this.getTextRectsFromLayout(pdfium, pagePtr, textPagePtr);
+        if (layoutRects) {
+          const mergedRects = this.mergeAdjacentTextRects(layoutRects);
+          return { pageIndex, pageWidth, pageHeight, textRects: mergedRects };
+        }
+
         // Build rect list for entire page
         const rectsCount = pdfium._PDFium_CountRects(textPagePtr, 0, -1);
 
@@ -1252,15 +3724,132 @@ export class PdfController implements IPdfController {
 
         return { pageIndex, pageWidth, pageHeight, textRects: mergedRects };
       } finally {
-        pdfium._PDFium_ClosePageText(textPagePtr);
+        this.releaseTextPage(pdfium, pageIndex, pagePtr, textPagePtr);
       }
     } finally {
-      if (!cachedEditPage) {
-        pdfium._PDFium_ClosePage(pagePtr);
-      }
+      this.releasePage(pdfium, pageIndex, pagePtr);
+    }
+  }
+
+  /**
+   * Read a char range's text layout with a single _PDFium_ExtractTextLayout
+   * call. Columns are copied out of WASM memory before the buffer is freed.
+   * Returns null when the WASM build lacks the export.
+   */
+  private extractTextLayout(
+    pdfium: IPDFiumModule,
+    pagePtr: number,
+    textPagePtr: number,
+    startIndex: number,
+    count: number,
+    scale: number,
+    options: TEXT_LAYOUT_OPTION,
+  ): ITextLayout | null {
+    if (!pdfium._PDFium_ExtractTextLayout) return null;
+    const ptr = pdfium._PDFium_ExtractTextLayout(
+      pagePtr,
+      textPagePtr,
+      startIndex,
+      count,
+      scale,
+      0,
+      options,
+    );
+    if (!ptr) return null;
+
+    try {
+      const buffer = pdfium.HEAPU8.buffer;
+      const [n, textUnits, , fontBytes, fieldCount] = new Int32Array(
+        buffer,
+        ptr,
+        TEXT_LAYOUT_HEADER_WORDS,
+      );
+      const columnsPtr = ptr + TEXT_LAYOUT_HEADER_WORDS * 4;
+      const f32 = (column: number) =>
+        new Float32Array(buffer, columnsPtr + column * n * 4, n).slice();
+      const i32 = (column: number) =>
+        new Int32Array(buffer, columnsPtr + column * n * 4, n).slice();
+
+      // Columns 4-7 hold the page-space rects, which the controller does not need
+      const textPtr = columnsPtr + fieldCount * n * 4;
+      const fontsPtr = textPtr + ((textUnits * 2 + 3) & ~3);
+      const fonts = PdfController.utf8Decoder
+        .decode(pdfium.HEAPU8.subarray(fontsPtr, fontsPtr + fontBytes))
+        .split('\0');
+      fonts.pop();
+
+      return {
+        count: n,
+        deviceLeft: f32(0),
+        deviceTop: f32(1),
+        deviceWidth: f32(2),
+        deviceHeight: f32(3),
+        charIndex: i32(8),
+        textStart: i32(9),
+        textLength: i32(10),
+        fontSize: f32(11),
+        fillColor: new Uint32Array(buffer, columnsPtr + 12 * n * 4, n).slice(),
+        fontIndex: i32(13),
+        text: new Uint16Array(buffer, textPtr, textUnits).slice(),
+        fonts,
+      };
+    } finally {
+      pdfium._PDFium_FreeBuffer(ptr);
     }
   }
 
+  /** Build the page's text rects from one bulk layout call (null if unsupported). */
+  private getTextRectsFromLayout(
+    pdfium: IPDFiumModule,
+    pagePtr: number,
+    textPagePtr: number,
+  ): ITextRect[] | null {
+    const layout = this.extractTextLayout(
+      pdfium,
+      pagePtr,
+      textPagePtr,
+      0,
+      -1,
+      1,
+      TEXT_LAYOUT_OPTION.NONE,
+    );
+    if (!layout) return null;
+
+    // Remove PDF font subset prefix (e.g., "ABCDEF+")
+    const families = layout.fonts.map((name) => name.replace(/^[A-Z]{6}\+/, ''));
+    const textRects: ITextRect[] = [];
+    for (let i = 0; i < layout.count; i++) {
+      const length = layout.textLength[i];
+      if (length <= 0) continue;
+      const start = layout.textStart[i];
+      const content = String.fromCharCode(...layout.text.subarray(start, start + length));
+      if (!content.trim()) continue;
+
+      const color = layout.fillColor[i];
+      const fontIndex = layout.fontIndex[i];
+      textRects.push({
+        content,
+        rect: {
+          left: layout.deviceLeft[i],
+          top: layout.deviceTop[i],
+          width: layout.deviceWidth[i],
+          height: layout.deviceHeight[i],
+        },
+        font: {
+          family: fontIndex >= 0 ? families[fontIndex] : '',
+          size: layout.fontSize[i],
+          color: {
+            r: color & 0xff,
+            g: (color >>> 8) & 0xff,
+            b: (color >>> 16) & 0xff,
+            a: color >>> 24,
+          },
+        },
+      });
+    }
+    return textRects;
+  }
+
   /**
    * Enumerate flattened text objects directly stored in page content.
    * This only returns true page text objects (FPDF_PAGEOBJ_TEXT), not OCR overlays or raster text.
@@ -1274,10 +3863,9 @@ export class PdfController implements IPdfController {
 
     const { pdfium, docPtr } = this.requireDoc();
 
-    // Use the cached edit-mode page pointer when available so that the object
+    // acquirePage prefers the edit-mode page pointer so that the object
     // indices match those on the page where FPDFText_SetText was applied.
-    const cachedEditPage = this.editPageCache.get(pageIndex);
-    const pagePtr = cachedEditPage ?? pdfium._PDFium_LoadPage(docPtr, pageIndex);
+    const pagePtr = this.acquirePage(pdfium, docPtr, pageIndex);
     if (!pagePtr) throw new Error(`Failed to load page ${pageIndex}`);
 
     try {
@@ -1303,6 +3891,15 @@ export class PdfController implements IPdfController {
         );
       }
 
+      const enumerated = this.enumerateTextObjects(pdfium, pageIndex, pagePtr, scale);
+      if (enumerated) {
+        return enumerated.map(({ objectIndex, content, deviceRect }) => ({
+          objectIndex,
+          content,
+          rect: deviceRect,
+        }));
+      }
+
       const pageWidth = pdfium._PDFium_GetPageWidth(pagePtr);
       const pageHeight = pdfium._PDFium_GetPageHeight(pagePtr);
       const deviceWidth = Math.round(pageWidth * scale);
@@ -1316,7 +3913,7 @@ export class PdfController implements IPdfController {
       const bottomPtr = pdfium._malloc(4);
       const rightPtr = pdfium._malloc(4);
       const topPtr = pdfium._malloc(4);
-      const textPagePtr = pdfium._PDFium_LoadPageText(pagePtr);
+      const textPagePtr = this.acquireTextPage(pdfium, pageIndex, pagePtr);
 
       try {
         for (let i = 0; i < objectCount; i++) {
@@ -1372,9 +3969,7 @@ export class PdfController implements IPdfController {
           });
         }
       } finally {
-        if (textPagePtr) {
-          pdfium._PDFium_ClosePageText(textPagePtr);
-        }
+        this.releaseTextPage(pdfium, pageIndex, pagePtr, textPagePtr);
         pdfium._free(leftPtr);
         pdfium._free(bottomPtr);
         pdfium._free(rightPtr);
@@ -1383,9 +3978,7 @@ export class PdfController implements IPdfController {
 
       return out;
     } finally {
-      if (!cachedEditPage) {
-        pdfium._PDFium_ClosePage(pagePtr);
-      }
+      this.releasePage(pdfium, pageIndex, pagePtr);
     }
   }
 
@@ -1412,6 +4005,8 @@ export class PdfController implements IPdfController {
       pagePtr = pdfium._PDFium_LoadPage(docPtr, pageIndex);
       if (!pagePtr) throw new Error(`Failed to load page ${pageIndex}`);
       this.editPageCache.set(pageIndex, pagePtr);
+      // Edits go to this handle; drop the cached parse of the same page
+      this.invalidatePageCache(pageIndex);
     }
 
     const pageObjectApi = pdfium as IPDFiumModule & {
@@ -1492,6 +4087,16 @@ export class PdfController implements IPdfController {
       targets.push({ objectIndex, pageObject, text });
     }
 
+    if (PdfController.hasEditTransactions(pdfium)) {
+      return this.updateTextObjectsInTransaction(
+        pdfium,
+        pagePtr,
+        pageIndex,
+        targets,
+        readObjectBounds,
+      );
+    }
+
     const fallbackTargets: {
       objectIndex: number;
       pageObject: number;
@@ -1632,11 +4237,224 @@ export class PdfController implements IPdfController {
     if (!okGenerate) {
       throw new Error('Failed to generate page content after text update');
     }
-    this.generatedPages.add(pageIndex);
+    this.markPageGenerated(pageIndex);
+
+    return { usedFallbackFont: fallbackTargets.length > 0 };
+  }
+
+  /**
+   * updateEditableTextObjects through a native edit transaction: set all texts in
+   * one batch, then remove emptied objects and replace the ones PDFium refused
+   * with Helvetica text in a second batch, and regenerate the content once.
+   */
+  private updateTextObjectsInTransaction(
+    pdfium: IEditTransactionModule,
+    pagePtr: number,
+    pageIndex: number,
+    targets: { objectIndex: number; pageObject: number; text: string }[],
+    readObjectBounds: (pageObject: number) => {
+      left: number;
+      bottom: number;
+      right: number;
+      top: number;
+    },
+  ): ITextEditResult {
+    const { docPtr } = this.requireDoc();
+    const tx = pdfium._PDFium_EditBegin(docPtr, pagePtr);
+    if (!tx) throw new Error('Failed to start edit transaction');
+
+    const edits = targets.filter((target) => target.text);
+    let fallbackTargets = edits;
+    let committed = false;
+    try {
+      if (!this.editPageReplaceOnly.has(pageIndex)) {
+        const commands = edits.map(({ objectIndex, text }): IEditCommand => {
+          return { op: EDIT_OP.SET_TEXT, objectIndex, text };
+        });
+        const status = new Int32Array(commands.length).fill(EDIT_NOT_RUN);
+        try {
+          status.set(this.applyEditCommands(pdfium, tx, commands, status));
+        } catch (error) {
+          void error;
+          console.info(
+            `[PdfController] FPDFText_SetText trapped on page ${pageIndex}; switching this page to replacement mode.`,
+          );
+          // Texts set before the trap keep their font; the one that trapped is replaced,
+          // and the ones after it are tried on their own
+          for (let i = status.indexOf(EDIT_NOT_RUN) + 1; i < commands.length; i++) {
+            try {
+              status[i] = this.applyEditCommands(pdfium, tx, [commands[i]])[0];
+            } catch {
+              status[i] = EDIT_NOT_RUN;
+            }
+          }
+        }
+        fallbackTargets = edits.filter((_, i) => status[i] !== EDIT_STATUS.APPLIED);
+        if (fallbackTargets.length > 0) {
+          this.editPageReplaceOnly.add(pageIndex);
+        }
+      }
+
+      // Objects cleared to empty text are removed; FPDFText_SetText traps on empty strings
+      const commands: IEditCommand[] = [];
+      const failures: (string | null)[] = [];
+      for (const { objectIndex, text } of targets) {
+        if (text) continue;
+        commands.push({ op: EDIT_OP.REMOVE, objectIndex });
+        failures.push(null);
+      }
+
+      if (fallbackTargets.length > 0) {
+        console.warn(
+          `[PdfController] FALLBACK: ${fallbackTargets.length} objects using Helvetica replacement (original font LOST)`,
+        );
+      }
+      for (const { objectIndex, pageObject, text } of fallbackTargets) {
+        const bounds = readObjectBounds(pageObject);
+        commands.push(
+          { op: EDIT_OP.REMOVE, objectIndex },
+          {
+            op: EDIT_OP.INSERT_TEXT,
+            fontObjectIndex: -1,
+            fontSize: Math.max(4, bounds.top - bounds.bottom),
+            color: { r: 0, g: 0, b: 0, a: 255 },
+            x: bounds.left,
+            y: bounds.bottom,
+            text,
+          },
+        );
+        failures.push(
+          `Failed to remove text object ${objectIndex} for fallback replacement`,
+          `Failed to create replacement text object for ${objectIndex}`,
+        );
+      }
+
+      const status = this.applyEditCommands(pdfium, tx, commands);
+      failures.forEach((message, i) => {
+        if (message && status[i] === EDIT_STATUS.FAILED) throw new Error(message);
+      });
+
+      committed = true;
+      if (!pdfium._PDFium_EditCommit(tx, 1)) {
+        throw new Error('Failed to generate page content after text update');
+      }
+    } finally {
+      if (!committed) pdfium._PDFium_EditCommit(tx, 0);
+    }
+    this.markPageGenerated(pageIndex);
 
     return { usedFallbackFont: fallbackTargets.length > 0 };
   }
 
+  /**
+   * Pack edit commands into the _PDFium_EditApply layout, apply them and
+   * return one EDIT_STATUS per command. If the engine throws, progress (when
+   * given) receives the statuses written so far, EDIT_NOT_RUN for the rest.
+   */
+  private applyEditCommands(
+    pdfium: IEditTransactionModule,
+    tx: number,
+    commands: IEditCommand[],
+    progress?: Int32Array,
+  ): Int32Array {
+    if (commands.length === 0) return new Int32Array(0);
+
+    const textWords = (text: string) => (text.length + 1) >> 1;
+    let wordCount = 0;
+    for (const command of commands) {
+      switch (command.op) {
+        case EDIT_OP.SET_TEXT:
+          wordCount += 3 + textWords(command.text);
+          break;
+        case EDIT_OP.MOVE_TO:
+          wordCount += 4;
+          break;
+        case EDIT_OP.SET_FILL_COLOR:
+          wordCount += 3;
+          break;
+        case EDIT_OP.REMOVE:
+          wordCount += 2;
+          break;
+        case EDIT_OP.INSERT_TEXT:
+          wordCount += 11 + textWords(command.text);
+          break;
+      }
+    }
+
+    const buffer = new ArrayBuffer(wordCount * 4);
+    const ints = new Int32Array(buffer);
+    const floats = new Float32Array(buffer);
+    const units = new Uint16Array(buffer);
+    const packColor = ({ r, g, b, a }: IRgbaColor) =>
+      (r & 0xff) | ((g & 0xff) << 8) | ((b & 0xff) << 16) | ((a & 0xff) << 24);
+    const writeText = (at: number, text: string) => {
+      ints[at] = text.length;
+      for (let i = 0; i < text.length; i++) units[(at + 1) * 2 + i] = text.charCodeAt(i);
+      return at + 1 + textWords(text);
+    };
+
+    let at = 0;
+    for (const command of commands) {
+      ints[at] = command.op;
+      switch (command.op) {
+        case EDIT_OP.SET_TEXT:
+          ints[at + 1] = command.objectIndex;
+          at = writeText(at + 2, command.text);
+          break;
+        case EDIT_OP.MOVE_TO:
+          ints[at + 1] = command.objectIndex;
+          floats[at + 2] = command.x;
+          floats[at + 3] = command.y;
+          at += 4;
+          break;
+        case EDIT_OP.SET_FILL_COLOR:
+          ints[at + 1] = command.objectIndex;
+          ints[at + 2] = packColor(command.color);
+          at += 3;
+          break;
+        case EDIT_OP.REMOVE:
+          ints[at + 1] = command.objectIndex;
+          at += 2;
+          break;
+        case EDIT_OP.INSERT_TEXT:
+          ints[at + 1] = command.fontObjectIndex;
+          floats[at + 2] = command.fontSize;
+          ints[at + 3] = packColor(command.color);
+          floats.set([1, 0, 0, 1, command.x, command.y], at + 4);
+          at = writeText(at + 10, command.text);
+          break;
+      }
+    }
+
+    const commandsPtr = pdfium._malloc(buffer.byteLength);
+    const statusPtr = pdfium._malloc(commands.length * 4);
+    const readStatus = () =>
+      pdfium.HEAP32.slice(statusPtr >> 2, (statusPtr >> 2) + commands.length);
+    try {
+      pdfium.HEAPU8.set(new Uint8Array(buffer), commandsPtr);
+      pdfium.HEAP32.fill(EDIT_NOT_RUN, statusPtr >> 2, (statusPtr >> 2) + commands.length);
+      const applied = pdfium._PDFium_EditApply(tx, commandsPtr, wordCount, statusPtr);
+      if (applied !== commands.length) {
+        throw new Error('Malformed edit command buffer');
+      }
+      return readStatus();
+    } catch (error) {
+      progress?.set(readStatus());
+      throw error;
+    } finally {
+      pdfium._free(commandsPtr);
+      pdfium._free(statusPtr);
+    }
+  }
+
+  private static hasEditTransactions(pdfium: IPDFiumModule): pdfium is IEditTransactionModule {
+    return (
+      typeof pdfium._PDFium_EditBegin === 'function' &&
+      typeof pdfium._PDFium_EditApply === 'function' &&
+      typeof pdfium._PDFium_EditCommit === 'function'
+    );
+  }
+
   /**
    * Update text content of an existing flattened text object on a page.
    * The object index comes from listEditableTextObjects().
@@ -1690,7 +4508,12 @@ export class PdfController implements IPdfController {
       pagePtr = pdfium._PDFium_LoadPage(docPtr, pageIndex);
       if (!pagePtr) throw new Error(`Failed to load page ${pageIndex}`);
       this.editPageCache.set(pageIndex, pagePtr);
+      // Edits go to this handle; drop the cached parse of the same page
+      this.invalidatePageCache(pageIndex);
     }
+    // In-memory edits show in renders even when content generation is deferred
+    this.markDirty(pageIndex, 'content');
+    this.markPageChanged(pageIndex);
 
     const pageObjectApi = pdfium as IPDFiumModule & {
       _FPDFPage_CountObjects_W?: (page: number) => number;
@@ -1734,6 +4557,7 @@ export class PdfController implements IPdfController {
     // For overflow lines, prefer the LAST existing object's font — overflow typically
     // continues body text, not the header that may appear at the start of the paragraph.
     let overflowFontHandle = fontHandle;
+    let overflowFontObjectIndex = fontHandle ? referenceObjectIndex : -1;
     let overflowFontSize = pageFontSize;
     if (existingPointers.length > 1) {
       const lastPtr = existingPointers[existingPointers.length - 1].ptr;
@@ -1744,7 +4568,10 @@ export class PdfController implements IPdfController {
       const p = pdfium as unknown as Record<string, unknown>;
       if (typeof p._FPDFTextObj_GetFont_W === 'function') {
         const lastFont = (p._FPDFTextObj_GetFont_W as (obj: number) => number)(lastPtr);
-        if (lastFont) overflowFontHandle = lastFont;
+        if (lastFont) {
+          overflowFontHandle = lastFont;
+          overflowFontObjectIndex = existingPointers[existingPointers.length - 1].objectIndex;
+        }
       }
     }
 
@@ -1775,6 +4602,90 @@ export class PdfController implements IPdfController {
       throw new Error('Failed to load any font for text object creation');
     };
 
+    if (PdfController.hasEditTransactions(pdfium)) {
+      // Same phases as below, applied natively in two batches. SetText can trap on some
+      // fonts, so the text goes first on its own: it only changes objects in place and
+      // setting it again is harmless, so after a trap the per-line path below starts over
+      // on an otherwise untouched page and guards each line.
+      const textCommands: IEditCommand[] = [];
+      const commands: IEditCommand[] = [];
+      const overflowLines: number[] = [];
+      for (let i = existingPointers.length; i < lines.length; i++) {
+        if (!lines[i].text) continue;
+        const pos = linePagePosition(i);
+        overflowLines.push(i);
+        commands.push({
+          op: EDIT_OP.INSERT_TEXT,
+          fontObjectIndex: overflowFontObjectIndex,
+          fontSize: overflowFontSize,
+          color: lines[i].color,
+          x: pos.x,
+          y: pos.y,
+          text: lines[i].text,
+        });
+      }
+      const reuseCount = Math.min(existingPointers.length, lines.length);
+      for (let i = 0; i < existingPointers.length; i++) {
+        const { objectIndex } = existingPointers[i];
+        const text = i < reuseCount ? lines[i].text : '';
+        if (!text) {
+          commands.push({ op: EDIT_OP.REMOVE, objectIndex });
+          continue;
+        }
+        const pos = linePagePosition(i);
+        textCommands.push({ op: EDIT_OP.SET_TEXT, objectIndex, text });
+        commands.push(
+          { op: EDIT_OP.SET_FILL_COLOR, objectIndex, color: lines[i].color },
+          { op: EDIT_OP.MOVE_TO, objectIndex, x: pos.x, y: pos.y },
+        );
+      }
+
+      const tx = pdfium._PDFium_EditBegin(docPtr, pagePtr);
+      if (!tx) throw new Error('Failed to start edit transaction');
+      let textStatus: Int32Array | null = null;
+      try {
+        textStatus = this.applyEditCommands(pdfium, tx, textCommands);
+      } catch {
+        console.info(
+          `[PdfController] FPDFText_SetText trapped on page ${pageIndex}; reflowing line by line.`,
+        );
+        pdfium._PDFium_EditCommit(tx, 0);
+      }
+
+      if (textStatus) {
+        textCommands.forEach((command, i) => {
+          if (command.op === EDIT_OP.SET_TEXT && textStatus[i] === EDIT_STATUS.FAILED) {
+            console.warn(
+              `[PdfController] FPDFText_SetText failed on reflow object ${command.objectIndex}`,
+            );
+          }
+        });
+        try {
+          const status = this.applyEditCommands(pdfium, tx, commands);
+          overflowLines.forEach((line, i) => {
+            if (status[i] === EDIT_STATUS.APPLIED_FALLBACK_FONT) usedFallbackFont = true;
+            if (status[i] === EDIT_STATUS.FAILED) {
+              console.warn(
+                `[PdfController] Failed to create text object for overflow line ${line}`,
+              );
+            }
+          });
+        } catch (error) {
+          // Part of the layout may be applied already, so it cannot be redone line by line
+          console.warn(`[PdfController] Reflow trapped on page ${pageIndex}`, error);
+        }
+
+        const okGenerate = pdfium._PDFium_EditCommit(tx, skipGenerateContent ? 0 : 1);
+        if (!skipGenerateContent) {
+          if (!okGenerate) {
+            console.warn('[PdfController] Failed to generate page content after reflow');
+          }
+          this.markPageGenerated(pageIndex);
+        }
+        return { usedFallbackFont };
+      }
+    }
+
     // ─── Phase 1: Create overflow objects (BEFORE removals, so font handle stays valid) ───
     const newObjects: number[] = [];
     if (lines.length > existingPointers.length) {
@@ -1888,7 +4799,7 @@ export class PdfController implements IPdfController {
       if (!okGenerate) {
         console.warn('[PdfController] Failed to generate page content after reflow');
       }
-      this.generatedPages.add(pageIndex);
+      this.markPageGenerated(pageIndex);
     }
 
     return { usedFallbackFont };
@@ -1904,10 +4815,19 @@ export class PdfController implements IPdfController {
     const pagePtr = this.editPageCache.get(pageIndex);
     if (!pagePtr) return false;
     const ok = !!pdfium._FPDFPage_GenerateContent_W(pagePtr);
-    if (ok) this.generatedPages.add(pageIndex);
+    if (ok) this.markPageGenerated(pageIndex);
     return ok;
   }
 
+  /** Record that a page's content stream was regenerated and its text may have changed. */
+  private markPageGenerated(pageIndex: number): void {
+    this.generatedPages.add(pageIndex);
+    this.markDirty(pageIndex, 'content');
+    this.markPageChanged(pageIndex);
+    this.invalidateSearchIndex(pageIndex);
+    this.invalidatePageCache(pageIndex);
+  }
+
   /**
    * Extract text content using page-object APIs (FPDFPageObj_GetBounds, FPDFTextObj_GetFont,
    * FPDFTextObj_GetFontSize) instead of text-page APIs (FPDFText_GetRect, FPDFText_GetFillColor).
@@ -1920,8 +4840,7 @@ export class PdfController implements IPdfController {
     if (!this.pdfiumModule || !this.docPtr) return null;
     const pdfium = this.pdfiumModule;
 
-    const cachedEditPage = this.editPageCache.get(pageIndex);
-    const pagePtr = cachedEditPage ?? pdfium._PDFium_LoadPage(this.docPtr, pageIndex);
+    const pagePtr = this.acquirePage(pdfium, this.docPtr, pageIndex);
     if (!pagePtr) return null;
 
     try {
@@ -1951,12 +4870,34 @@ export class PdfController implements IPdfController {
         return null;
       }
 
+      const enumerated = this.enumerateTextObjects(pdfium, pageIndex, pagePtr, 1);
+      if (enumerated) {
+        const textRects: ITextRect[] = [];
+        for (const object of enumerated) {
+          if (!object.content.trim()) continue;
+          // Strip PDF font subset prefix (e.g. "ABCDEF+")
+          const family = (object.fontName ?? '').replace(/^[A-Z]{6}\+/, '');
+          const size = Math.round(object.fontSize * 100) / 100;
+          textRects.push({
+            content: object.content,
+            rect: object.deviceRect,
+            font: {
+              family,
+              size: size > 0 ? size : Math.abs(object.bounds.top - object.bounds.bottom),
+              color: { r: 0, g: 0, b: 0, a: 255 },
+            },
+          });
+        }
+        const mergedRects = this.mergeAdjacentTextRects(textRects);
+        return { pageIndex, pageWidth, pageHeight, textRects: mergedRects };
+      }
+
       const objectCount = pageObjectApi._FPDFPage_CountObjects_W(pagePtr);
       if (objectCount <= 0) {
         return { pageIndex, pageWidth, pageHeight, textRects: [] };
       }
 
-      const textPagePtr = pdfium._PDFium_LoadPageText(pagePtr);
+      const textPagePtr = this.acquireTextPage(pdfium, pageIndex, pagePtr);
       const leftPtr = pdfium._malloc(4);
       const bottomPtr = pdfium._malloc(4);
       const rightPtr = pdfium._malloc(4);
@@ -2039,9 +4980,7 @@ export class PdfController implements IPdfController {
           });
         }
       } finally {
-        if (textPagePtr) {
-          pdfium._PDFium_ClosePageText(textPagePtr);
-        }
+        this.releaseTextPage(pdfium, pageIndex, pagePtr, textPagePtr);
         pdfium._free(leftPtr);
         pdfium._free(bottomPtr);
         pdfium._free(rightPtr);
@@ -2052,9 +4991,7 @@ export class PdfController implements IPdfController {
 
       return { pageIndex, pageWidth, pageHeight, textRects: mergedRects };
     } finally {
-      if (!cachedEditPage) {
-        pdfium._PDFium_ClosePage(pagePtr);
-      }
+      this.releasePage(pdfium, pageIndex, pagePtr);
     }
   }
 
@@ -2108,7 +5045,21 @@ export class PdfController implements IPdfController {
   public listNativeAnnotations(pageIndex: number, opts: { scale: number }): INativeAnnotation[] {
     const { scale } = opts;
     const { docPtr } = this.requireDoc();
+    if (!this.isPageDataAvailable(pageIndex)) return [];
     return this.withPage(pageIndex, (pdfium, pagePtr) => {
+      // One native pass instead of several calls per annotation, quad and ink path
+      const serialized = pdfium._PDFium_SerializePageAnnotations?.(
+        docPtr,
+        pagePtr,
+        scale,
+        0,
+        ANNOT_SERIALIZE_OPTION.SKIP_WIDGETS,
+      );
+      if (serialized) {
+        const records = PdfController.decodePageAnnotations(pdfium, serialized);
+        return PdfController.toNativeAnnotations(records, pageIndex, scale);
+      }
+
       const pageW = pdfium._PDFium_GetPageWidth(pagePtr);
       const pageH = pdfium._PDFium_GetPageHeight(pagePtr);
 
@@ -2320,15 +5271,165 @@ export class PdfController implements IPdfController {
         pdfium._free(quadPtr);
       }
 
-      return out;
-    });
+      return out;
+    });
+  }
+
+  /**
+   * Decode a _PDFium_SerializePageAnnotations buffer and free it.
+   */
+  private static decodePageAnnotations(
+    pdfium: IPDFiumModule,
+    ptr: number,
+  ): ISerializedAnnotation[] {
+    try {
+      const heap32 = pdfium.HEAP32;
+      const heapF32 = pdfium.HEAPF32;
+      const base = ptr >> 2;
+      const count = heap32[base];
+      const fixedWords = heap32[base + 2];
+      const readColor = (word: number) => ({
+        r: word & 0xff,
+        g: (word >>> 8) & 0xff,
+        b: (word >>> 16) & 0xff,
+        a: (word >>> 24) & 0xff,
+      });
+
+      const records: ISerializedAnnotation[] = [];
+      let at = base + ANNOT_HEADER_WORDS;
+      for (let i = 0; i < count; i++) {
+        const quadCount = heap32[at + 11];
+        const inkPathCount = heap32[at + 12];
+        const inkPointCount = heap32[at + 13];
+        const destPageIndex = heap32[at + 14];
+        const uriBytes = heap32[at + 15];
+
+        let cursor = at + fixedWords;
+        const quads: Float32Array[] = [];
+        for (let q = 0; q < quadCount; q++, cursor += 8) {
+          quads.push(heapF32.slice(cursor, cursor + 8));
+        }
+        const pathPoints = heap32.subarray(cursor, cursor + inkPathCount);
+        let pointAt = cursor + inkPathCount;
+        const inkPaths: Float32Array[] = [];
+        for (const points of pathPoints) {
+          inkPaths.push(heapF32.slice(pointAt, pointAt + points * 2));
+          pointAt += points * 2;
+        }
+        cursor += inkPathCount + inkPointCount * 2;
+        const uriBytesView = pdfium.HEAPU8.subarray(cursor * 4, cursor * 4 + uriBytes);
+
+        records.push({
+          annotIndex: heap32[at + 1],
+          subtype: heap32[at + 2] as FPDF_ANNOTATION_SUBTYPE,
+          fields: heap32[at + 3],
+          color: readColor(heap32[at + 4]),
+          interiorColor: readColor(heap32[at + 5]),
+          rect: [heapF32[at + 6], heapF32[at + 7], heapF32[at + 8], heapF32[at + 9]],
+          borderWidth: heapF32[at + 10],
+          quads,
+          inkPaths,
+          uri: uriBytes > 0 ? PdfController.utf8Decoder.decode(uriBytesView) : undefined,
+          destPageIndex: destPageIndex >= 0 ? destPageIndex : undefined,
+        });
+        at += heap32[at];
+      }
+      return records;
+    } finally {
+      pdfium._PDFium_FreeBuffer(ptr);
+    }
+  }
+
+  /** Map decoded annotation records to the shapes listNativeAnnotations returns. */
+  private static toNativeAnnotations(
+    records: ISerializedAnnotation[],
+    pageIndex: number,
+    scale: number,
+  ): INativeAnnotation[] {
+    const out: INativeAnnotation[] = [];
+    for (const record of records) {
+      const { annotIndex: i, subtype, color } = record;
+      const [left, top, right, bottom] = record.rect;
+      const rectPolygon: IPoint[] = [
+        { x: left, y: top },
+        { x: right, y: top },
+        { x: right, y: bottom },
+        { x: left, y: bottom },
+      ];
+      const hasRect = (record.fields & ANNOT_RECORD_FIELD.RECT) !== 0;
+
+      if (subtype === FPDF_ANNOTATION_SUBTYPE.INK) {
+        const borderWidth =
+          (record.fields & ANNOT_RECORD_FIELD.BORDER) !== 0 ? record.borderWidth : 2;
+        record.inkPaths.forEach((path, p) => {
+          if (!path.length) return;
+          const points: IPoint[] = [];
+          for (let k = 0; k < path.length; k += 2) {
+            points.push({ x: path[k], y: path[k + 1] });
+          }
+          out.push({
+            id: `native-${pageIndex}-ink-${i}-${p}`,
+            subtype,
+            shape: 'stroke',
+            points,
+            color,
+            strokeWidth: borderWidth * scale,
+          });
+        });
+      } else if (subtype === FPDF_ANNOTATION_SUBTYPE.HIGHLIGHT) {
+        record.quads.forEach((f, q) => {
+          out.push({
+            id: `native-${pageIndex}-hl-${i}-${q}`,
+            subtype,
+            shape: 'polygon',
+            // FS_QUADPOINTSF order is TL, TR, BL, BR; the polygon goes around
+            points: [
+              { x: f[0], y: f[1] },
+              { x: f[2], y: f[3] },
+              { x: f[6], y: f[7] },
+              { x: f[4], y: f[5] },
+            ],
+            color,
+            strokeWidth: 0,
+          });
+        });
+      } else if (subtype === FPDF_ANNOTATION_SUBTYPE.LINK) {
+        if (!hasRect) continue;
+        out.push({
+          id: `native-${pageIndex}-link-${i}`,
+          subtype,
+          shape: 'polygon',
+          points: rectPolygon,
+          color,
+          strokeWidth: 0,
+          uri: record.uri,
+          destPageIndex: record.destPageIndex,
+        });
+      } else if (hasRect) {
+        out.push({
+          id: `native-${pageIndex}-rect-${i}`,
+          subtype,
+          shape: 'polygon',
+          points: rectPolygon,
+          color,
+          strokeWidth: 0,
+        });
+      }
+    }
+    return out;
   }
 
   public listFormFields(pageIndex: number, opts: { scale: number }): IFormField[] {
     const { scale } = opts;
+    if (!this.isPageDataAvailable(pageIndex)) return [];
     const formHandle = this.ensureFormFillHandle();
 
     return this.withPage(pageIndex, (pdfium, pagePtr) => {
+      const snapshot = formHandle
+        ? pdfium._PDFium_SnapshotFormFields?.(formHandle, pagePtr, pageIndex, scale)
+        : 0;
+      if (snapshot) return PdfController.decodeFormFields(pdfium, snapshot);
+
       const pageW = pdfium._PDFium_GetPageWidth(pagePtr);
       const pageH = pdfium._PDFium_GetPageHeight(pagePtr);
       const deviceWidth = Math.round(pageW * scale);
@@ -2455,13 +5556,7 @@ export class PdfController implements IPdfController {
               exportValue,
               flags,
               fontSize,
-              isReadOnly: flags != null ? (flags & FORM_FIELD_FLAG_READONLY) !== 0 : undefined,
-              isMultiline: flags != null ? (flags & FORM_FIELD_FLAG_MULTILINE) !== 0 : undefined,
-              isPassword: flags != null ? (flags & FORM_FIELD_FLAG_PASSWORD) !== 0 : undefined,
-              isCombo: flags != null ? (flags & FORM_FIELD_FLAG_COMBO) !== 0 : undefined,
-              isEditable: flags != null ? (flags & FORM_FIELD_FLAG_EDIT) !== 0 : undefined,
-              isMultiSelect:
-                flags != null ? (flags & FORM_FIELD_FLAG_MULTISELECT) !== 0 : undefined,
+              ...PdfController.formFieldFlagState(flags),
               controlCount: controlCount ?? undefined,
               controlIndex: controlIndex ?? undefined,
             });
@@ -2478,7 +5573,117 @@ export class PdfController implements IPdfController {
     });
   }
 
+  public listAllFormFields(opts: { scale: number }): IFormField[] {
+    const { scale } = opts;
+    const { pdfium, docPtr } = this.requireDoc();
+    const formHandle = this.ensureFormFillHandle();
+    // The document pass would load pages still missing data; those are skipped page by page
+    const snapshot =
+      formHandle && this.isFullyLoaded()
+        ? pdfium._PDFium_SnapshotDocumentFormFields?.(formHandle, docPtr, scale)
+        : 0;
+    if (snapshot) return PdfController.decodeFormFields(pdfium, snapshot);
+
+    const out: IFormField[] = [];
+    const pageCount = this.getPageCount();
+    for (let pageIndex = 0; pageIndex < pageCount; pageIndex++) {
+      out.push(...this.listFormFields(pageIndex, opts));
+    }
+    return out;
+  }
+
+  /** Boolean views of a field's /Ff flags (all undefined when the flags are unknown). */
+  private static formFieldFlagState(flags: number | undefined) {
+    return {
+      isReadOnly: flags != null ? (flags & FORM_FIELD_FLAG_READONLY) !== 0 : undefined,
+      isMultiline: flags != null ? (flags & FORM_FIELD_FLAG_MULTILINE) !== 0 : undefined,
+      isPassword: flags != null ? (flags & FORM_FIELD_FLAG_PASSWORD) !== 0 : undefined,
+      isCombo: flags != null ? (flags & FORM_FIELD_FLAG_COMBO) !== 0 : undefined,
+      isEditable: flags != null ? (flags & FORM_FIELD_FLAG_EDIT) !== 0 : undefined,
+      isMultiSelect: flags != null ? (flags & FORM_FIELD_FLAG_MULTISELECT) !== 0 : undefined,
+    };
+  }
+
+  /**
+   * Decode a _PDFium_SnapshotFormFields buffer into the fields listFormFields
+   * returns, and free it.
+   */
+  private static decodeFormFields(pdfium: IPDFiumModule, ptr: number): IFormField[] {
+    try {
+      const heap32 = pdfium.HEAP32;
+      const heapF32 = pdfium.HEAPF32;
+      const base = ptr >> 2;
+      const fieldCount = heap32[base];
+      const optionCount = heap32[base + 1];
+      const fieldWords = heap32[base + 3];
+
+      const fieldsAt = base + FORM_HEADER_WORDS;
+      const optionsAt = fieldsAt + fieldCount * fieldWords;
+      const textPtr = (optionsAt + optionCount * FORM_OPTION_WORDS) * 4;
+      const readText = (start: number, length: number) => {
+        if (length <= 0) return '';
+        const from = textPtr + start * 2;
+        return PdfController.utf16Decoder.decode(pdfium.HEAPU8.subarray(from, from + length * 2));
+      };
+
+      const out: IFormField[] = [];
+      for (let i = 0; i < fieldCount; i++) {
+        const at = fieldsAt + i * fieldWords;
+        const pageIndex = heap32[at];
+        const annotIndex = heap32[at + 1];
+        const type = FORM_FIELD_TYPE_MAP[heap32[at + 2]] ?? 'unknown';
+        const flags = heap32[at + 3];
+        const fontSize = heapF32[at + 8];
+        const checkable = type === 'checkbox' || type === 'radio';
+        const exportStart = heap32[at + 16];
+        const optionStart = heap32[at + 18];
+        const fieldOptions = heap32[at + 19];
+
+        let options: IFormFieldOption[] | undefined;
+        if ((type === 'combo' || type === 'list') && fieldOptions > 0) {
+          options = [];
+          for (let o = 0; o < fieldOptions; o++) {
+            const optionAt = optionsAt + (optionStart + o) * FORM_OPTION_WORDS;
+            options.push({
+              label: readText(heap32[optionAt], heap32[optionAt + 1]),
+              selected: heap32[optionAt + 2] !== 0,
+            });
+          }
+        }
+
+        out.push({
+          id: `form-${pageIndex}-${annotIndex}`,
+          annotIndex,
+          pageIndex,
+          type,
+          name: readText(heap32[at + 12], heap32[at + 13]),
+          rect: {
+            left: heapF32[at + 4],
+            top: heapF32[at + 5],
+            width: heapF32[at + 6],
+            height: heapF32[at + 7],
+          },
+          value: readText(heap32[at + 14], heap32[at + 15]),
+          options,
+          isChecked: checkable ? heap32[at + 9] !== 0 : undefined,
+          exportValue:
+            checkable && exportStart >= 0 ? readText(exportStart, heap32[at + 17]) : undefined,
+          flags,
+          fontSize: fontSize > 0 ? fontSize : undefined,
+          ...PdfController.formFieldFlagState(flags),
+          controlCount: heap32[at + 10],
+          controlIndex: heap32[at + 11],
+        });
+      }
+      return out;
+    } finally {
+      pdfium._PDFium_FreeBuffer(ptr);
+    }
+  }
+
   public hideAnnotation(pageIndex: number, annotIndex: number): void {
+    this.markDirty(pageIndex, 'annotations');
+    this.markPageChanged(pageIndex);
     this.withPage(pageIndex, (pdfium, pagePtr) => {
       const annot = pdfium._FPDFPage_GetAnnot_W(pagePtr, annotIndex);
       if (!annot) return;
@@ -2492,6 +5697,8 @@ export class PdfController implements IPdfController {
   }
 
   public setFormFieldValue(field: IFormField, value: string | boolean): void {
+    this.markDirty(field.pageIndex, 'forms');
+    this.markPageChanged(field.pageIndex);
     if (field.type === 'radio') {
       this.updateRadioGroupValue(field, value);
       return;
@@ -2568,17 +5775,12 @@ export class PdfController implements IPdfController {
     const groupKey = field.name || field.id;
     const selectedOnState = this.resolveRadioOnState(field);
 
-    const pageCount = this.getPageCount();
     const groupFields: IFormField[] = [];
-
-    for (let pageIndex = 0; pageIndex < pageCount; pageIndex++) {
-      const fields = this.listFormFields(pageIndex, { scale: 1 });
-      for (const candidate of fields) {
-        if (candidate.type !== 'radio') continue;
-        const candidateKey = candidate.name || candidate.id;
-        if (candidateKey === groupKey) {
-          groupFields.push(candidate);
-        }
+    for (const candidate of this.listAllFormFields({ scale: 1 })) {
+      if (candidate.type !== 'radio') continue;
+      const candidateKey = candidate.name || candidate.id;
+      if (candidateKey === groupKey) {
+        groupFields.push(candidate);
       }
     }
 
@@ -2592,6 +5794,8 @@ export class PdfController implements IPdfController {
 
     try {
       for (const candidate of groupFields) {
+        this.markDirty(candidate.pageIndex, 'forms');
+        this.markPageChanged(candidate.pageIndex);
         this.withPage(candidate.pageIndex, (pagePdfium, pagePtr) => {
           const annot = pagePdfium._FPDFPage_GetAnnot_W(pagePtr, candidate.annotIndex);
           if (!annot) return;
@@ -2678,55 +5882,301 @@ export class PdfController implements IPdfController {
     const textPtr = this.allocUtf16(text);
 
     try {
+      if (this.isFullyLoaded()) {
+        const indexed = this.querySearchIndex(pdfium, textPtr, text, 0, -1, 0, scale);
+        if (indexed) return indexed.results;
+      }
+
+      // While the file loads progressively, only pages whose data has arrived are searched
       const results: ISearchResult[] = [];
       const pageCount = this.getPageCount();
 
       for (let pageIndex = 0; pageIndex < pageCount; pageIndex++) {
-        this.withPage(pageIndex, (pdfium, pagePtr) => {
-          const textPagePtr = pdfium._PDFium_LoadPageText(pagePtr);
-          if (!textPagePtr) return;
+        if (!this.isPageDataAvailable(pageIndex)) continue;
+        results.push(...this.searchPage(pdfium, pageIndex, textPtr, text, scale, results.length));
+      }
+      return results;
+    } finally {
+      pdfium._free(textPtr);
+    }
+  }
+
+  /**
+   * Search incrementally, yielding results in chunks as they are found. Pages are
+   * visited nearest-first around `startPage` (startPage, +1, -1, +2, ...), so matches
+   * near the viewport arrive within the first time slice and the rest of the document
+   * follows in SEARCH_SLICE_MS slices. Chunks are in visiting order, not document order;
+   * matchIndex numbers results in the order they were yielded. The stream ends early
+   * when `signal` aborts or another document is loaded.
+   */
+  public async *searchTextStream(
+    text: string,
+    opts?: { scale?: number; startPage?: number; signal?: AbortSignal },
+  ): AsyncGenerator<ISearchResult[], void, undefined> {
+    if (!text) return;
+    const { pdfium, docPtr } = this.requireDoc();
+    const scale = opts?.scale ?? 1;
+    const signal = opts?.signal;
+    const loadSeq = this.loadSeq;
+    const pageCount = this.getPageCount();
+    const startPage = Math.min(Math.max(opts?.startPage ?? 0, 0), Math.max(pageCount - 1, 0));
+    const isStale = () => signal?.aborted === true || loadSeq !== this.loadSeq;
+    const nextSlice = () => new Promise((resolve) => setTimeout(resolve, 0));
+
+    const textPtr = this.allocUtf16(text);
+    const index = this.ensureSearchIndex(pdfium, docPtr);
+    // The native cursor cannot wait for pages that are still missing data
+    const cursor =
+      index && PdfController.hasSearchCursor(pdfium) && this.isFullyLoaded()
+        ? pdfium._PDFium_SearchCursorStart(index, textPtr, startPage, scale)
+        : 0;
+    if (cursor) this.searchCursors.add(cursor);
+
+    try {
+      let matchIndex = 0;
+
+      if (cursor && PdfController.hasSearchCursor(pdfium)) {
+        while (!isStale()) {
+          const ptr = pdfium._PDFium_SearchCursorContinue(cursor, SEARCH_SLICE_MS, 0);
+          if (!ptr) return;
+          const { results, state: remainingPages } = this.readSearchResults(
+            pdfium,
+            ptr,
+            text,
+            matchIndex,
+          );
+          matchIndex += results.length;
+          if (results.length > 0) yield results;
+          if (remainingPages <= 0) return;
+          await nextSlice();
+        }
+        return;
+      }
 
+      // No native cursor, or the file is still loading: same visiting order, one page at a
+      // time, fetching pages that are still missing data before searching them
+      let chunk: ISearchResult[] = [];
+      let deadline = performance.now() + SEARCH_SLICE_MS;
+      for (let step = 0, visited = 0; visited < pageCount; step++) {
+        const pageIndex = PdfController.nearbyPageAt(startPage, step);
+        if (pageIndex < 0 || pageIndex >= pageCount) continue;
+        visited++;
+
+        if (!this.isPageDataAvailable(pageIndex)) {
+          if (chunk.length > 0) yield chunk;
+          chunk = [];
           try {
-            // 0 = Case Insensitive
-            const searchHandle = pdfium._PDFium_FindStart(textPagePtr, textPtr, 0, 0);
-            if (!searchHandle) return;
+            await this.ensurePageAvailable(pageIndex, signal);
+          } catch (error) {
+            if (isStale()) return;
+            throw error;
+          }
+          if (isStale()) return;
+          deadline = performance.now() + SEARCH_SLICE_MS;
+        }
 
-            try {
-              while (pdfium._PDFium_FindNext(searchHandle)) {
-                const charIndex = pdfium._PDFium_GetSchResultIndex(searchHandle);
-                const charCount = pdfium._PDFium_GetSchCount(searchHandle);
+        const found = this.searchPage(pdfium, pageIndex, textPtr, text, scale, matchIndex);
+        matchIndex += found.length;
+        chunk.push(...found);
+        if (visited < pageCount && performance.now() < deadline) continue;
+
+        if (chunk.length > 0) yield chunk;
+        chunk = [];
+        if (visited === pageCount) return;
+        await nextSlice();
+        if (isStale()) return;
+        deadline = performance.now() + SEARCH_SLICE_MS;
+      }
+    } finally {
+      if (cursor && this.searchCursors.delete(cursor)) {
+        pdfium._PDFium_SearchCursorClose?.(cursor);
+      }
+      pdfium._free(textPtr);
+    }
+  }
 
-                const pageWidth = pdfium._PDFium_GetPageWidth(pagePtr);
-                const pageHeight = pdfium._PDFium_GetPageHeight(pagePtr);
+  private static hasSearchCursor(pdfium: IPDFiumModule): pdfium is ISearchCursorModule {
+    return (
+      typeof pdfium._PDFium_SearchCursorStart === 'function' &&
+      typeof pdfium._PDFium_SearchCursorContinue === 'function'
+    );
+  }
 
-                const rects = this.getTextRects(
-                  pagePtr,
-                  textPagePtr,
-                  charIndex,
-                  charCount,
-                  pageWidth,
-                  pageHeight,
-                  scale,
-                );
+  /** Page at position `step` of the nearest-first order around `origin` (may be out of range). */
+  private static nearbyPageAt(origin: number, step: number): number {
+    const offset = (step + 1) >> 1;
+    return step % 2 === 1 ? origin + offset : origin - offset;
+  }
 
-                results.push({
-                  pageIndex,
-                  matchIndex: results.length,
-                  rects,
-                  text,
-                });
-              }
-            } finally {
-              pdfium._PDFium_FindClose(searchHandle);
-            }
-          } finally {
-            pdfium._PDFium_ClosePageText(textPagePtr);
+  /** Search one page through the native index, or FPDFText_FindStart without one. */
+  private searchPage(
+    pdfium: IPDFiumModule,
+    pageIndex: number,
+    textPtr: number,
+    text: string,
+    scale: number,
+    firstMatchIndex: number,
+  ): ISearchResult[] {
+    const indexed = this.querySearchIndex(
+      pdfium,
+      textPtr,
+      text,
+      pageIndex,
+      pageIndex,
+      0,
+      scale,
+      firstMatchIndex,
+    );
+    return indexed
+      ? indexed.results
+      : this.searchPageWithFind(pageIndex, textPtr, text, scale, firstMatchIndex);
+  }
+
+  /** Search one page with FPDFText_FindStart (case-insensitive). */
+  private searchPageWithFind(
+    pageIndex: number,
+    textPtr: number,
+    text: string,
+    scale: number,
+    firstMatchIndex: number,
+  ): ISearchResult[] {
+    const results: ISearchResult[] = [];
+    this.withPage(pageIndex, (pdfium, pagePtr) => {
+      const textPagePtr = this.acquireTextPage(pdfium, pageIndex, pagePtr);
+      if (!textPagePtr) return;
+
+      try {
+        // 0 = Case Insensitive
+        const searchHandle = pdfium._PDFium_FindStart(textPagePtr, textPtr, 0, 0);
+        if (!searchHandle) return;
+
+        try {
+          while (pdfium._PDFium_FindNext(searchHandle)) {
+            const charIndex = pdfium._PDFium_GetSchResultIndex(searchHandle);
+            const charCount = pdfium._PDFium_GetSchCount(searchHandle);
+
+            const pageWidth = pdfium._PDFium_GetPageWidth(pagePtr);
+            const pageHeight = pdfium._PDFium_GetPageHeight(pagePtr);
+
+            const rects = this.getTextRects(
+              pagePtr,
+              textPagePtr,
+              charIndex,
+              charCount,
+              pageWidth,
+              pageHeight,
+              scale,
+            );
+
+            results.push({
+              pageIndex,
+              matchIndex: firstMatchIndex + results.length,
+              charIndex,
+              rects,
+              text,
+            });
           }
+        } finally {
+          pdfium._PDFium_FindClose(searchHandle);
+        }
+      } finally {
+        this.releaseTextPage(pdfium, pageIndex, pagePtr, textPagePtr);
+      }
+    });
+    return results;
+  }
+
+  /** Get the document's native search index, creating it on first use (0 if unsupported). */
+  private ensureSearchIndex(pdfium: IPDFiumModule, docPtr: number): number {
+    if (!this.searchIndexPtr && pdfium._PDFium_SearchIndexCreate) {
+      this.searchIndexPtr = pdfium._PDFium_SearchIndexCreate(docPtr);
+    }
+    return this.searchIndexPtr;
+  }
+
+  private invalidateSearchIndex(pageIndex: number): void {
+    if (!this.searchIndexPtr) return;
+    this.pdfiumModule?._PDFium_SearchIndexInvalidate?.(this.searchIndexPtr, pageIndex);
+  }
+
+  /**
+   * Search pages [startPage, endPage] through the native index and decode the packed
+   * results. Returns null when the index is unavailable so callers can fall back to
+   * per-page FPDFText_FindStart.
+   */
+  private querySearchIndex(
+    pdfium: IPDFiumModule,
+    queryPtr: number,
+    text: string,
+    startPage: number,
+    endPage: number,
+    maxResults: number,
+    scale: number,
+    firstMatchIndex = 0,
+  ): { results: ISearchResult[]; nextPage: number } | null {
+    const { docPtr } = this.requireDoc();
+    const index = this.ensureSearchIndex(pdfium, docPtr);
+    if (!index || !pdfium._PDFium_SearchIndexQuery) return null;
+
+    const ptr = pdfium._PDFium_SearchIndexQuery(
+      index,
+      queryPtr,
+      startPage,
+      endPage,
+      maxResults,
+      scale,
+    );
+    if (!ptr) return null;
+    const { results, state: nextPage } = this.readSearchResults(pdfium, ptr, text, firstMatchIndex);
+    return { results, nextPage };
+  }
+
+  /**
+   * Decode (and free) a packed _PDFium_SearchIndexQuery / _PDFium_SearchCursorContinue
+   * buffer. `state` is header[2]: the resume page of a query, or the pages a cursor has
+   * left to visit.
+   */
+  private readSearchResults(
+    pdfium: IPDFiumModule,
+    ptr: number,
+    text: string,
+    firstMatchIndex: number,
+  ): { results: ISearchResult[]; state: number } {
+    try {
+      const buffer = pdfium.HEAPU8.buffer;
+      const [resultCount, rectCount, state] = new Int32Array(buffer, ptr, SEARCH_HEADER_WORDS);
+      const resultsPtr = ptr + SEARCH_HEADER_WORDS * 4;
+      const records = new Int32Array(buffer, resultsPtr, resultCount * SEARCH_RESULT_WORDS);
+      const rects = new Float32Array(
+        buffer,
+        resultsPtr + resultCount * SEARCH_RESULT_WORDS * 4,
+        rectCount * 4,
+      );
+
+      const results: ISearchResult[] = [];
+      for (let i = 0; i < resultCount; i++) {
+        const record = i * SEARCH_RESULT_WORDS;
+        const firstRect = records[record + 3];
+        const matchRects: ISearchResult['rects'] = [];
+        for (let r = firstRect; r < firstRect + records[record + 4]; r++) {
+          matchRects.push({
+            left: rects[r * 4],
+            top: rects[r * 4 + 1],
+            width: rects[r * 4 + 2],
+            height: rects[r * 4 + 3],
+          });
+        }
+        results.push({
+          pageIndex: records[record],
+          matchIndex: firstMatchIndex + i,
+          charIndex: records[record + 1],
+          rects: matchRects,
+          text,
         });
       }
-      return results;
+      return { results, state };
     } finally {
-      pdfium._free(textPtr);
+      pdfium._PDFium_FreeBuffer(ptr);
     }
   }
 
@@ -2740,6 +6190,25 @@ export class PdfController implements IPdfController {
     scale = 1,
   ): { left: number; top: number; width: number; height: number }[] {
     const { pdfium } = this.requireDoc();
+
+    const layout = this.extractTextLayout(
+      pdfium,
+      pagePtr,
+      textPagePtr,
+      startIndex,
+      count,
+      scale,
+      TEXT_LAYOUT_OPTION.GEOMETRY_ONLY,
+    );
+    if (layout) {
+      return Array.from({ length: layout.count }, (_, i) => ({
+        left: layout.deviceLeft[i],
+        top: layout.deviceTop[i],
+        width: layout.deviceWidth[i],
+        height: layout.deviceHeight[i],
+      }));
+    }
+
     const rectsCount = pdfium._PDFium_CountRects(textPagePtr, startIndex, count);
     const rects: { left: number; top: number; width: number; height: number }[] = [];
 
@@ -2779,6 +6248,8 @@ export class PdfController implements IPdfController {
     const { scale, canvasPoints } = opts;
     if (canvasPoints.length < 2) return;
 
+    this.markDirty(pageIndex, 'annotations');
+    this.markPageChanged(pageIndex);
     this.withPage(pageIndex, (pdfium, pagePtr) => {
       if (
         typeof (pdfium as IPDFiumModule & { _FPDFPageObj_NewImageObj_W?: unknown })
@@ -2838,6 +6309,8 @@ export class PdfController implements IPdfController {
     const { scale, canvasRect } = opts;
     if (canvasRect.width <= 0 || canvasRect.height <= 0) return;
 
+    this.markDirty(pageIndex, 'annotations');
+    this.markPageChanged(pageIndex);
     this.withPage(pageIndex, (pdfium, pagePtr) => {
       const pageW = pdfium._PDFium_GetPageWidth(pagePtr);
       const pageH = pdfium._PDFium_GetPageHeight(pagePtr);
@@ -2918,6 +6391,8 @@ export class PdfController implements IPdfController {
     if (!uri) return;
     if (canvasRect.width <= 0 || canvasRect.height <= 0) return;
 
+    this.markDirty(pageIndex, 'annotations');
+    this.markPageChanged(pageIndex);
     this.withPage(pageIndex, (pdfium, pagePtr) => {
       const pageW = pdfium._PDFium_GetPageWidth(pagePtr);
       const pageH = pdfium._PDFium_GetPageHeight(pagePtr);
@@ -3006,6 +6481,8 @@ export class PdfController implements IPdfController {
     const g255 = fontColor.g > 1 ? Math.round(fontColor.g) : Math.round(fontColor.g * 255);
     const b255 = fontColor.b > 1 ? Math.round(fontColor.b) : Math.round(fontColor.b * 255);
 
+    this.markDirty(pageIndex, 'content');
+    this.markPageChanged(pageIndex);
     this.withPage(pageIndex, (pdfium, pagePtr) => {
       const pageW = pdfium._PDFium_GetPageWidth(pagePtr);
       const pageH = pdfium._PDFium_GetPageHeight(pagePtr);
@@ -3089,6 +6566,8 @@ export class PdfController implements IPdfController {
         if (!pdfium._FPDFPage_GenerateContent_W(pagePtr)) {
           throw new Error('Failed to generate page content');
         }
+        this.invalidateSearchIndex(pageIndex);
+        this.invalidatePageCache(pageIndex);
       } finally {
         // Cleanup (only if not transferred)
         for (const obj of textObjs) {
@@ -3116,9 +6595,11 @@ export class PdfController implements IPdfController {
       imageRgbaBytes: Uint8Array;
       imageWidthPx: number;
       imageHeightPx: number;
+      imageJpegBytes?: Uint8Array;
     },
   ): void {
-    const { scale, canvasRect, imageRgbaBytes, imageWidthPx, imageHeightPx } = opts;
+    const { scale, canvasRect, imageRgbaBytes, imageWidthPx, imageHeightPx, imageJpegBytes } =
+      opts;
     if (
       canvasRect.width <= 0 ||
       canvasRect.height <= 0 ||
@@ -3132,6 +6613,8 @@ export class PdfController implements IPdfController {
 
     const { docPtr } = this.requireDoc();
 
+    this.markDirty(pageIndex, 'content');
+    this.markPageChanged(pageIndex);
     this.withPage(pageIndex, (pdfium, pagePtr) => {
       const pageW = pdfium._PDFium_GetPageWidth(pagePtr);
       const pageH = pdfium._PDFium_GetPageHeight(pagePtr);
@@ -3159,6 +6642,18 @@ export class PdfController implements IPdfController {
       const pdfTop = Math.max(topLeftPage.y, bottomRightPage.y);
       const pdfWidth = pdfRight - pdfLeft;
       const pdfHeight = pdfTop - pdfBottom;
+      const matrix = [pdfWidth, 0, 0, pdfHeight, pdfLeft, pdfBottom] as const;
+
+      const inserted = this.insertImageNatively(pdfium, docPtr, pagePtr, matrix, {
+        rgba: imageRgbaBytes,
+        width: imageWidthPx,
+        height: imageHeightPx,
+        jpeg: imageJpegBytes,
+      });
+      if (inserted) {
+        this.invalidatePageCache(pageIndex);
+        return;
+      }
 
       let bitmap = 0;
       let imageObj = 0;
@@ -3210,6 +6705,7 @@ export class PdfController implements IPdfController {
         if (!pdfium._FPDFPage_GenerateContent_W(pagePtr)) {
           throw new Error('Failed to generate page content for image object');
         }
+        this.invalidatePageCache(pageIndex);
       } finally {
         if (imageObj) pdfium._FPDFPageObj_Destroy_W(imageObj);
         if (bitmap) pdfium._PDFium_BitmapDestroy(bitmap);
@@ -3218,6 +6714,51 @@ export class PdfController implements IPdfController {
     });
   }
 
+  /**
+   * Insert an image with _PDFium_InsertJpegImage (JPEG passthrough) or _PDFium_InsertImage
+   * (in-WASM swizzle), whichever the binary has and accepts the data. Returns false when
+   * neither applies, leaving the page untouched for the JS bitmap path; throws when the
+   * image was inserted but the content could not be committed.
+   */
+  private insertImageNatively(
+    pdfium: IPDFiumModule,
+    docPtr: number,
+    pagePtr: number,
+    matrix: readonly [number, number, number, number, number, number],
+    image: { rgba: Uint8Array; width: number; height: number; jpeg?: Uint8Array },
+  ): boolean {
+    const insert = (
+      fn: (dataPtr: number, byteLength: number) => number,
+      bytes: Uint8Array,
+    ): boolean => {
+      const ptr = pdfium._malloc(bytes.length);
+      if (!ptr) return false;
+      try {
+        pdfium.HEAPU8.set(bytes, ptr);
+        const result = fn(ptr, bytes.length);
+        if (result < 0) throw new Error('Failed to generate page content for image object');
+        return result === 1;
+      } finally {
+        pdfium._free(ptr);
+      }
+    };
+
+    const { _PDFium_InsertJpegImage: insertJpeg, _PDFium_InsertImage: insertRgba } = pdfium;
+    if (image.jpeg && image.jpeg.length > 0 && insertJpeg) {
+      const ok = insert(
+        (ptr, size) => insertJpeg(docPtr, pagePtr, ptr, size, ...matrix),
+        image.jpeg,
+      );
+      if (ok) return true;
+    }
+    if (!insertRgba) return false;
+    const pixels = image.rgba.subarray(0, image.width * image.height * 4);
+    return insert(
+      (ptr) => insertRgba(docPtr, pagePtr, ptr, image.width, image.height, ...matrix),
+      pixels,
+    );
+  }
+
   /**
    * Export the current PDF document as a byte array.
    * This includes any modifications made (annotations, etc.).
@@ -3230,10 +6771,29 @@ export class PdfController implements IPdfController {
     /** PDF version: 14=1.4, 15=1.5, 16=1.6, 17=1.7, 20=2.0 (optional) */
     version?: number;
   }): Uint8Array {
-    const { pdfium, docPtr } = this.requireDoc();
+    const { pdfium, docPtr } = this.requireSavableDoc();
     const flags = options?.flags ?? 0;
     const version = options?.version;
 
+    if (pdfium._PDFium_SaveToBuffer) {
+      // One buffer sized from the source: no regrowth and no global copy
+      const sizePtr = pdfium._malloc(4);
+      try {
+        const reserve = this.sourceSize + SAVE_RESERVE_SLACK_BYTES;
+        const ptr = pdfium._PDFium_SaveToBuffer(docPtr, flags, version ?? 0, reserve, sizePtr);
+        if (!ptr) {
+          const errorCode = pdfium._PDFium_GetLastError();
+          throw new Error(`Failed to save PDF (error code: ${errorCode})`);
+        }
+        const size = pdfium.HEAP32[sizePtr >> 2];
+        const result = pdfium.HEAPU8.slice(ptr, ptr + size);
+        pdfium._PDFium_FreeBuffer(ptr);
+        return result;
+      } finally {
+        pdfium._free(sizePtr);
+      }
+    }
+
     // Save the document to memory
     let size: number;
     if (version !== undefined) {
@@ -3265,21 +6825,89 @@ export class PdfController implements IPdfController {
     }
   }
 
+  public supportsNativeEncryption(): boolean {
+    return !!this.pdfiumModule && PdfController.hasEncryptedSave(this.pdfiumModule);
+  }
+
+  /**
+   * Export the current PDF document encrypted with the standard security handler.
+   * PDFium writes the document once and the wrapper encrypts it on the way out, so this
+   * costs about as much as exportPdfBytes. Any encryption the document was opened with
+   * is replaced.
+   * @param options Passwords, permissions and algorithm
+   * @returns The encrypted PDF, or null when native encryption is unavailable or PDFium's
+   *   output could not be rewritten
+   */
+  public exportEncryptedPdfBytes(options: IPdfEncryptionOptions): Uint8Array | null {
+    const { pdfium, docPtr } = this.requireSavableDoc();
+    if (!PdfController.hasEncryptedSave(pdfium)) return null;
+
+    const userPtr = this.allocUtf8(options.userPassword);
+    const ownerPtr = this.allocUtf8(options.ownerPassword ?? '');
+    const sizePtr = pdfium._malloc(4);
+    try {
+      const reserve = this.sourceSize + SAVE_RESERVE_SLACK_BYTES;
+      const ptr = pdfium._PDFium_SaveEncryptedToBuffer(
+        docPtr,
+        options.version ?? 0,
+        reserve,
+        userPtr,
+        ownerPtr,
+        options.permissions ?? PDF_PERMISSION.ALL,
+        options.algorithm ?? ENCRYPT_ALGORITHM.AES_128,
+        sizePtr,
+      );
+      if (!ptr) return null;
+      const size = pdfium.HEAP32[sizePtr >> 2];
+      const result = pdfium.HEAPU8.slice(ptr, ptr + size);
+      pdfium._PDFium_FreeBuffer(ptr);
+      return result;
+    } finally {
+      pdfium._free(sizePtr);
+      pdfium._free(ownerPtr);
+      pdfium._free(userPtr);
+    }
+  }
+
   /**
    * Download the current PDF document as a file.
-   * This is a convenience method that exports the PDF and triggers a browser download.
+   * Where the browser has a save dialog (showSaveFilePicker), the file is streamed to the
+   * chosen location with savePdfToStream and never held whole; resolves without saving
+   * when the dialog is dismissed. Elsewhere the PDF is exported to a Blob and a browser
+   * download is triggered. Call from a user gesture, which the save dialog requires.
    * @param filename The filename for the downloaded file (default: 'document.pdf')
    * @param options Optional save options
    */
-  public downloadPdf(
+  public async downloadPdf(
     filename = 'document.pdf',
     options?: {
       flags?: number;
       version?: number;
     },
-  ): void {
-    const pdfBytes = this.exportPdfBytes(options);
-    const blob = new Blob([pdfBytes as BlobPart], { type: 'application/pdf' });
+  ): Promise<void> {
+    const picker = (globalThis as { showSaveFilePicker?: ISaveFilePicker }).showSaveFilePicker;
+    if (typeof picker === 'function') {
+      let handle: Awaited<ReturnType<ISaveFilePicker>> | null = null;
+      try {
+        handle = await picker({
+          suggestedName: filename,
+          types: [{ description: 'PDF document', accept: { 'application/pdf': ['.pdf'] } }],
+        });
+      } catch (error) {
+        if (error instanceof DOMException && error.name === 'AbortError') return;
+        // No user gesture or not allowed here: fall back to a Blob download
+      }
+      if (handle) {
+        await this.savePdfToStream(await handle.createWritable(), options);
+        return;
+      }
+    }
+
+    // Streamed chunks become Blob parts directly, so no contiguous copy is made
+    const parts: BlobPart[] = [];
+    const streamed = this.saveToChunks(options, (chunk) => parts.push(chunk as BlobPart));
+    if (!streamed) parts.push(this.exportPdfBytes(options) as BlobPart);
+    const blob = new Blob(parts, { type: 'application/pdf' });
     const url = URL.createObjectURL(blob);
 
     const link = document.createElement('a');
@@ -3293,4 +6921,163 @@ export class PdfController implements IPdfController {
     // Revoke the object URL after a short delay to allow the download to start
     setTimeout(() => URL.revokeObjectURL(url), 100);
   }
+
+  /**
+   * Save the current PDF document into a WritableStream, such as one from
+   * FileSystemFileHandle.createWritable(). Output reaches the stream in fixed-size
+   * chunks, so the WASM heap never holds the whole file. PDFium saves synchronously and
+   * cannot wait for the stream, so the chunks are copied out as it writes and then fed
+   * to the stream one at a time, each written before the next and released once
+   * written. The stream is closed on success; a failed write aborts it and rejects.
+   * @param stream Destination stream
+   * @param options Optional save options
+   */
+  public async savePdfToStream(
+    stream: WritableStream<Uint8Array>,
+    options?: {
+      flags?: number;
+      version?: number;
+    },
+  ): Promise<void> {
+    const writer = stream.getWriter();
+    try {
+      // Fail before saving when the stream is already errored
+      await writer.ready;
+      const chunks: Uint8Array[] = [];
+      if (!this.saveToChunks(options, (chunk) => chunks.push(chunk))) {
+        chunks.push(this.exportPdfBytes(options));
+      }
+      for (let chunk = chunks.shift(); chunk; chunk = chunks.shift()) {
+        await writer.write(chunk);
+      }
+      await writer.close();
+    } catch (error) {
+      await writer.abort(error).catch(() => undefined);
+      throw error;
+    } finally {
+      writer.releaseLock();
+    }
+  }
+
+  /**
+   * Save the document through _PDFium_SaveToSink, passing each chunk (a copy out
+   * of the heap) to onChunk. Returns false when the WASM binary lacks streaming
+   * save; throws when the save itself fails.
+   */
+  private saveToChunks(
+    options: { flags?: number; version?: number } | undefined,
+    onChunk: (chunk: Uint8Array) => void,
+  ): boolean {
+    const { pdfium, docPtr } = this.requireSavableDoc();
+    if (!PdfController.hasStreamingSave(pdfium)) return false;
+
+    const flags = options?.flags ?? 0;
+    const version = options?.version ?? 0;
+    this.saveThroughSink(
+      pdfium,
+      (sinkId) => pdfium._PDFium_SaveToSink(docPtr, flags, version, sinkId, SAVE_CHUNK_BYTES),
+      onChunk,
+    );
+    return true;
+  }
+
+  /**
+   * Run a native save that writes through a pdfiumSaveSinks entry, passing each chunk
+   * (a copy out of the heap) to onChunk; throws when the save fails.
+   */
+  private saveThroughSink(
+    pdfium: IPDFiumModule,
+    save: (sinkId: number) => number,
+    onChunk: (chunk: Uint8Array) => void,
+  ): void {
+    const sinks = (pdfium.pdfiumSaveSinks ??= {});
+    const sinkId = nextSaveSinkId++;
+    let sinkError: unknown = null;
+    sinks[sinkId] = (ptr, size) => {
+      try {
+        onChunk(pdfium.HEAPU8.slice(ptr, ptr + size));
+        return 1;
+      } catch (error) {
+        sinkError = error;
+        return 0;
+      }
+    };
+    try {
+      if (!save(sinkId)) {
+        if (sinkError) throw sinkError;
+        const errorCode = pdfium._PDFium_GetLastError();
+        throw new Error(`Failed to save PDF (error code: ${errorCode})`);
+      }
+    } finally {
+      delete sinks[sinkId];
+    }
+  }
+
+  /**
+   * Save the document as an incremental update (FPDF_INCREMENTAL): the original file
+   * followed by only the objects that changed, a new xref section and trailer. When the
+   * document was opened from a File or Blob, the result references that Blob and only
+   * the update (a few KB for an annotation or form edit) is written by PDFium into JS,
+   * so the cost scales with the edit rather than the document. Other sources stream
+   * PDFium's whole incremental output instead.
+   *
+   * Removed or replaced content stays in the file's earlier revision, so prefer a full
+   * save (exportPdfBytes) after content edits that must not be recoverable.
+   */
+  public async exportIncrementalPdf(): Promise<Blob> {
+    const loadSeq = this.loadSeq;
+    const prefix = await this.incrementalSavePrefix();
+    if (loadSeq !== this.loadSeq) {
+      throw new Error('The document was closed while saving');
+    }
+
+    const { pdfium, docPtr } = this.requireSavableDoc();
+    const parts: BlobPart[] = [];
+    const onChunk = (chunk: Uint8Array) => parts.push(chunk as BlobPart);
+    if (prefix && PdfController.hasIncrementalSave(pdfium)) {
+      parts.push(prefix);
+      this.saveThroughSink(
+        pdfium,
+        (sinkId) =>
+          pdfium._PDFium_SaveIncrementalToSink(docPtr, sinkId, SAVE_CHUNK_BYTES, prefix.size),
+        onChunk,
+      );
+    } else if (!this.saveToChunks({ flags: FPDF_SAVE_INCREMENTAL }, onChunk)) {
+      parts.push(this.exportPdfBytes({ flags: FPDF_SAVE_INCREMENTAL }) as BlobPart);
+    }
+    return new Blob(parts, { type: 'application/pdf' });
+  }
+
+  /**
+   * The source file, when an incremental save's output is known to start with it byte
+   * for byte. PDFium copies the source from its %PDF- header on, so that holds when the
+   * header sits at offset 0 (no leading junk).
+   */
+  private async incrementalSavePrefix(): Promise<Blob | null> {
+    const blob = this.sourceBlob;
+    if (!blob || blob.size !== this.sourceSize) return null;
+    const head = new Uint8Array(await blob.slice(0, 5).arrayBuffer());
+    return String.fromCharCode(...head) === '%PDF-' ? blob : null;
+  }
+
+  /** The open document, once every byte of it is available to save. */
+  private requireSavableDoc(): { pdfium: IPDFiumModule; docPtr: number } {
+    const { pdfium, docPtr } = this.requireDoc();
+    if (this.fileLoader && !pdfium._PDFium_LoaderIsComplete?.(this.fileLoader.ptr)) {
+      throw new Error('Document is still loading. Await whenFullyLoaded() before saving.');
+    }
+    return { pdfium, docPtr };
+  }
+
+  private static hasStreamingSave(pdfium: IPDFiumModule): pdfium is IStreamingSaveModule {
+    return typeof pdfium._PDFium_SaveToSink === 'function';
+  }
+
+  private static hasIncrementalSave(pdfium: IPDFiumModule): pdfium is IIncrementalSaveModule {
+    return typeof pdfium._PDFium_SaveIncrementalToSink === 'function';
+  }
+
+  private static hasEncryptedSave(pdfium: IPDFiumModule): pdfium is IEncryptedSaveModule {
+    return typeof pdfium._PDFium_SaveEncryptedToBuffer === 'function';
+  }
 }
@@ -0,0 +1,63 @@
+/**
+ * Shared shapes of the batch jobs (print, export pages as images, text dump) run by
+ * PdfController on one engine and by PdfBatchPool across engine workers.
+ */
+
+/** Pages of a batch job, 0-based and inclusive; defaults to the whole document */
+export interface IPageRange {
+  from?: number;
+  to?: number;
+}
+
+/** Encoded image formats, or 'rgba' for the raw pixels as ImageData */
+export type PageImageFormat = 'png' | 'jpeg' | 'webp' | 'rgba';
+
+export interface IPageImageOptions {
+  /** Render resolution (72 = one pixel per point); 150 by default */
+  dpi?: number;
+  format?: PageImageFormat;
+  /** Encoder quality of 'jpeg' and 'webp', 0 to 1 */
+  quality?: number;
+  /** Render as for printing: annotations follow their print flag, no LCD text */
+  print?: boolean;
+}
+
+export interface IPageImage {
+  pageIndex: number;
+  /** Pixel size of the image */
+  width: number;
+  height: number;
+  dpi: number;
+  /** The encoded image; null for 'rgba' */
+  blob: Blob | null;
+  /** The pixels for 'rgba'; null otherwise */
+  pixels: ImageData | null;
+}
+
+export interface IPageText {
+  pageIndex: number;
+  text: string;
+  /** false when the page or its text failed to load */
+  ok: boolean;
+}
+
+export interface IBatchProgress {
+  /** Pages finished so far, out of total */
+  done: number;
+  total: number;
+  /** Last page finished */
+  pageIndex: number;
+}
+
+export interface IBatchOptions {
+  /** Ends the job early; results already yielded stay valid */
+  signal?: AbortSignal;
+  onProgress?: (progress: IBatchProgress) => void;
+}
+
+/** Page indices of a range, clamped to the document */
+export function batchPageIndices(range: IPageRange | undefined, pageCount: number): number[] {
+  const from = Math.max(0, Math.floor(range?.from ?? 0));
+  const to = Math.min(pageCount - 1, Math.floor(range?.to ?? pageCount - 1));
+  return Array.from({ length: Math.max(0, to - from + 1) }, (_, offset) => from + offset);
+}
@@ -0,0 +1,134 @@
+/**
+ * Batch jobs spread over several engine workers. The WASM build is single-threaded,
+ * so parallelism comes from one PDFium instance per worker, each with the document
+ * open; the main thread only dispatches pages and puts results back in page order.
+ * Large files open progressively in each worker, so the pool does not hold one full
+ * copy of the file per engine. The workers open the file as given: edits made in a
+ * PdfController and not yet saved are not in it, so render those through the
+ * controller's own renderPages.
+ */
+import {
+  batchPageIndices,
+  type IBatchOptions,
+  type IPageImage,
+  type IPageImageOptions,
+  type IPageRange,
+  type IPageText,
+} from './batchJob';
+import { PdfWorkerController } from './workerController';
+
+export interface IBatchPoolOptions {
+  /** Engine workers to start; by default one per spare core, at most MAX_POOL_WORKERS */
+  workers?: number;
+  password?: string;
+}
+
+const MAX_POOL_WORKERS = 4;
+/** Tasks queued per worker, so none idles while its next page is dispatched */
+const TASKS_PER_WORKER = 2;
+/** Pages per text extraction task */
+const TEXT_PAGES_PER_TASK = 16;
+
+export class PdfBatchPool {
+  private constructor(
+    private readonly workers: PdfWorkerController[],
+    public readonly pageCount: number,
+  ) {}
+
+  /** Start the workers and open file in each of them. */
+  public static async open(file: File, opts: IBatchPoolOptions = {}): Promise<PdfBatchPool> {
+    const cores = typeof navigator !== 'undefined' ? navigator.hardwareConcurrency : 0;
+    const size = Math.max(1, opts.workers ?? Math.min(MAX_POOL_WORKERS, (cores || 2) - 1));
+    const workers = Array.from({ length: size }, () => PdfWorkerController.create());
+    try {
+      await Promise.all(
+        workers.map((worker) => worker.call('loadFile', file, { password: opts.password })),
+      );
+      const pageCount = await workers[0].call('getPageCount');
+      return new PdfBatchPool(workers, pageCount);
+    } catch (error) {
+      for (const worker of workers) worker.terminate();
+      throw error;
+    }
+  }
+
+  /** Stop the workers; jobs still running end with an error. */
+  public close(): void {
+    for (const worker of this.workers) worker.terminate();
+  }
+
+  /** Render a range of pages to images across the workers, yielded in page order. */
+  public async *renderPages(
+    range?: IPageRange,
+    opts: IPageImageOptions & IBatchOptions = {},
+  ): AsyncGenerator<IPageImage, void, undefined> {
+    const { signal, onProgress, ...imageOptions } = opts;
+    const tasks = batchPageIndices(range, this.pageCount).map((pageIndex) => [pageIndex]);
+    const images = this.run(
+      tasks,
+      async (worker, [pageIndex]) => [
+        await worker.call('exportPageImage', pageIndex, imageOptions),
+      ],
+      { signal, onProgress },
+    );
+    for await (const chunk of images) yield* chunk;
+  }
+
+  /** Plain text of a range of pages across the workers, yielded in page order. */
+  public extractText(
+    range?: IPageRange,
+    opts: IBatchOptions = {},
+  ): AsyncGenerator<IPageText[], void, undefined> {
+    const pages = batchPageIndices(range, this.pageCount);
+    const tasks: number[][] = [];
+    for (let at = 0; at < pages.length; at += TEXT_PAGES_PER_TASK) {
+      tasks.push(pages.slice(at, at + TEXT_PAGES_PER_TASK));
+    }
+    return this.run(
+      tasks,
+      (worker, taskPages) => worker.call('getPagesText', taskPages[0], taskPages.length),
+      opts,
+    );
+  }
+
+  /**
+   * Run tasks (runs of pages) on the least busy workers and yield their results in task
+   * order. At most TASKS_PER_WORKER tasks per worker are in flight, which bounds the
+   * results held while an earlier, slower page is awaited. Ends early when `signal`
+   * aborts; tasks still in flight finish in their workers and are dropped.
+   */
+  private async *run<T>(
+    tasks: number[][],
+    exec: (worker: PdfWorkerController, pages: number[]) => Promise<T[]>,
+    { signal, onProgress }: IBatchOptions,
+  ): AsyncGenerator<T[], void, undefined> {
+    const total = tasks.reduce((count, pages) => count + pages.length, 0);
+    const busy = this.workers.map(() => 0);
+    const start = (pages: number[]): Promise<T[]> => {
+      const index = busy.indexOf(Math.min(...busy));
+      busy[index]++;
+      const result = exec(this.workers[index], pages).finally(() => {
+        busy[index]--;
+      });
+      result.catch(() => undefined);
+      return result;
+    };
+
+    const inFlight: Promise<T[]>[] = [];
+    let next = 0;
+    let done = 0;
+    for (const pages of tasks) {
+      if (signal?.aborted) return;
+      while (next < tasks.length && inFlight.length < this.workers.length * TASKS_PER_WORKER) {
+        inFlight.push(start(tasks[next++]));
+      }
+      const head = inFlight.shift();
+      if (!head) return;
+      const results = await head;
+      if (signal?.aborted) return;
+      done += pages.length;
+      onProgress?.({ done, total, pageIndex: pages[pages.length - 1] });
+      yield results;
+    }
+  }
+}
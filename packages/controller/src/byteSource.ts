@@ -0,0 +1,54 @@
+/**
+ * Random-access byte source for progressive document loading. PdfController
+ * reads only the blocks PDFium asks for, so a large file is never held in
+ * memory or in the WASM heap as one extra copy.
+ */
+export interface IPdfByteSource {
+  /** Total size in bytes */
+  readonly size: number;
+  /**
+   * The whole source when it is a Blob; lets incremental saves reference the original
+   * bytes instead of reading them.
+   */
+  readonly blob?: Blob;
+  /** Read bytes [offset, offset + length) */
+  read(offset: number, length: number, signal?: AbortSignal): Promise<Uint8Array>;
+}
+
+/** Byte source over a File or Blob, read with Blob.slice. */
+export function createBlobByteSource(blob: Blob): IPdfByteSource {
+  return {
+    size: blob.size,
+    blob,
+    read: async (offset, length) =>
+      new Uint8Array(await blob.slice(offset, offset + length).arrayBuffer()),
+  };
+}
+
+/**
+ * Byte source over HTTP Range requests (e.g. object storage). The size comes from a HEAD
+ * request, so the server must report Content-Length and answer Range requests with 206.
+ */
+export async function createHttpRangeByteSource(
+  url: string,
+  init?: RequestInit,
+): Promise<IPdfByteSource> {
+  const head = await fetch(url, { ...init, method: 'HEAD' });
+  const size = Number(head.headers.get('Content-Length'));
+  if (!head.ok || !Number.isFinite(size) || size <= 0) {
+    throw new Error(`Cannot determine the size of ${url} (HTTP ${head.status})`);
+  }
+
+  return {
+    size,
+    read: async (offset, length, signal) => {
+      const headers = new Headers(init?.headers);
+      headers.set('Range', `bytes=${offset}-${offset + length - 1}`);
+      const response = await fetch(url, { ...init, headers, signal });
+      if (response.status !== 206) {
+        throw new Error(`Range request for ${url} failed (HTTP ${response.status})`);
+      }
+      return new Uint8Array(await response.arrayBuffer());
+    },
+  };
+}
@@ -0,0 +1,87 @@
+/**
+ * Messages between PdfWorkerController and the engine worker (engineWorker.ts).
+ * Requests carry an id that the worker answers exactly once; render output is
+ * transferred, never copied.
+ */
+import type { IPdfController } from './PdfController';
+import type { RENDER_PRIORITY } from './renderScheduler';
+
+/** PdfController methods the worker serves; arguments and results are structured-cloneable. */
+export type EngineMethod = keyof Pick<
+  IPdfController,
+  | 'ensureInitialized'
+  | 'preload'
+  | 'getStartupTimings'
+  | 'loadFile'
+  | 'getPageCount'
+  | 'getPageDimension'
+  | 'getOutline'
+  | 'getOutlineChildren'
+  | 'getPageTextContent'
+  | 'hitTest'
+  | 'getCharRangesInRect'
+  | 'listNativeAnnotations'
+  | 'listFormFields'
+  | 'listAllFormFields'
+  | 'hideAnnotation'
+  | 'setFormFieldValue'
+  | 'addInkHighlight'
+  | 'addHighlightAnnotation'
+  | 'addLinkAnnotation'
+  | 'addTextAnnotation'
+  | 'addImageObject'
+  | 'exportPdfBytes'
+  | 'exportIncrementalPdf'
+  | 'getDirtyState'
+  | 'getSourceBlob'
+  | 'supportsNativeEncryption'
+  | 'exportEncryptedPdfBytes'
+  | 'listEditableTextObjects'
+  | 'updateEditableTextObjects'
+  | 'updateEditableTextObject'
+  | 'reflowEditableTextObjects'
+  | 'releaseEditPages'
+  | 'setFontMap'
+  | 'searchText'
+  | 'renderTile'
+  | 'prefetchThumbnails'
+  | 'setPageCacheBudget'
+  | 'getPageCacheStats'
+  | 'setRasterCacheBudget'
+  | 'setPerfCountersEnabled'
+  | 'resetPerfCounters'
+  | 'getPerfCounters'
+  | 'setMemoryBudget'
+  | 'trimMemory'
+  | 'exportPageImage'
+  | 'getPagesText'
+>;
+
+export interface IEngineRenderOptions {
+  pageIndex: number;
+  scale: number;
+  pixelRatio?: number;
+  priority?: RENDER_PRIORITY;
+  /** See IRenderOptions.draft */
+  draft?: boolean;
+}
+
+export type IEngineRequest =
+  | { id: number; type: 'call'; method: EngineMethod; args: unknown[] }
+  /** Render into an attached canvas (canvasId) or, without one, into a transferred ImageBitmap */
+  | { id: number; type: 'render'; options: IEngineRenderOptions; canvasId?: number }
+  | { id: number; type: 'attachCanvas'; canvasId: number; canvas: OffscreenCanvas }
+  | { id: number; type: 'detachCanvas'; canvasId: number }
+  /** Abort the request targetId; it is answered with an AbortError */
+  | { id: number; type: 'cancel'; targetId: number };
+
+export interface IEngineError {
+  name: string;
+  message: string;
+  /** FPDF_ERR code of a PdfPasswordError */
+  code?: number;
+}
+
+export type IEngineResponse =
+  | { id: number; ok: true; result?: unknown; bitmap?: ImageBitmap }
+  | { id: number; ok: false; error: IEngineError };
@@ -0,0 +1,133 @@
+/**
+ * Web Worker entry that hosts the PDFium engine off the main thread. A
+ * PdfController lives here and answers IEngineRequest messages, so rendering
+ * and parsing never block scrolling or ink input. Renders are queued by
+ * priority with a small concurrency limit and delivered either straight into
+ * an OffscreenCanvas transferred from the page, or as a transferred
+ * ImageBitmap.
+ */
+import { PdfController, PdfPasswordError } from './PdfController';
+import type { EngineMethod, IEngineRequest, IEngineResponse } from './engineProtocol';
+import { RENDER_PRIORITY } from './renderScheduler';
+
+/** Renders in flight at once; they share the engine's async render pump */
+const RENDER_CONCURRENCY = 2;
+
+interface IQueuedRender {
+  request: Extract<IEngineRequest, { type: 'render' }>;
+  priority: number;
+  abort: AbortController;
+}
+
+const controller = new PdfController();
+const canvases = new Map<number, OffscreenCanvas>();
+/** Queued renders, highest priority (lowest value) first, FIFO within a priority */
+const pending: IQueuedRender[] = [];
+const running = new Map<number, IQueuedRender>();
+
+function reply(response: IEngineResponse, transfer: Transferable[] = []): void {
+  self.postMessage(response, { transfer });
+}
+
+function replyError(id: number, error: unknown): void {
+  const err = error instanceof Error ? error : new Error(String(error));
+  const code = err instanceof PdfPasswordError ? err.code : undefined;
+  reply({ id, ok: false, error: { name: err.name, message: err.message, code } });
+}
+
+function abortError(): DOMException {
+  return new DOMException('Render aborted', 'AbortError');
+}
+
+function enqueueRender(request: IQueuedRender['request']): void {
+  const queued: IQueuedRender = {
+    request,
+    priority: request.options.priority ?? RENDER_PRIORITY.VISIBLE,
+    abort: new AbortController(),
+  };
+  let at = pending.length;
+  while (at > 0 && pending[at - 1].priority > queued.priority) at--;
+  pending.splice(at, 0, queued);
+  pumpRenders();
+}
+
+function pumpRenders(): void {
+  while (running.size < RENDER_CONCURRENCY) {
+    const queued = pending.shift();
+    if (!queued) return;
+    running.set(queued.request.id, queued);
+    void runRender(queued).finally(() => {
+      running.delete(queued.request.id);
+      pumpRenders();
+    });
+  }
+}
+
+async function runRender({ request, abort }: IQueuedRender): Promise<void> {
+  const { id, options, canvasId } = request;
+  try {
+    const target = canvasId !== undefined ? canvases.get(canvasId) : new OffscreenCanvas(1, 1);
+    if (!target) throw new Error(`Canvas ${canvasId} is not attached`);
+
+    // OffscreenCanvas has the 2D context API renderPdf draws with
+    await controller.renderPdf(target as unknown as HTMLCanvasElement, {
+      pageIndex: options.pageIndex,
+      scale: options.scale,
+      pixelRatio: options.pixelRatio,
+      signal: abort.signal,
+      draft: options.draft,
+    });
+    if (abort.signal.aborted) throw abortError();
+
+    if (canvasId !== undefined) {
+      reply({ id, ok: true, result: { width: target.width, height: target.height } });
+    } else {
+      const bitmap = target.transferToImageBitmap();
+      reply({ id, ok: true, bitmap }, [bitmap]);
+    }
+  } catch (error) {
+    replyError(id, error);
+  }
+}
+
+function cancel(targetId: number): void {
+  const at = pending.findIndex((queued) => queued.request.id === targetId);
+  if (at >= 0) {
+    pending.splice(at, 1);
+    replyError(targetId, abortError());
+    return;
+  }
+  running.get(targetId)?.abort.abort();
+}
+
+async function call(method: EngineMethod, args: unknown[]): Promise<unknown> {
+  const fn = controller[method] as unknown as (...callArgs: unknown[]) => unknown;
+  return await fn.apply(controller, args);
+}
+
+self.onmessage = (event: MessageEvent<IEngineRequest>) => {
+  const request = event.data;
+  switch (request.type) {
+    case 'call':
+      call(request.method, request.args).then(
+        (result) => reply({ id: request.id, ok: true, result }),
+        (error: unknown) => replyError(request.id, error),
+      );
+      break;
+    case 'render':
+      enqueueRender(request);
+      break;
+    case 'attachCanvas':
+      canvases.set(request.canvasId, request.canvas);
+      reply({ id: request.id, ok: true });
+      break;
+    case 'detachCanvas':
+      canvases.delete(request.canvasId);
+      reply({ id: request.id, ok: true });
+      break;
+    case 'cancel':
+      cancel(request.targetId);
+      reply({ id: request.id, ok: true });
+      break;
+  }
+};
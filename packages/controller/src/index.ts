@@ -8,17 +8,63 @@ export {
   type IPdfController,
   type IPageDimension,
   type IRenderOptions,
+  type ITileRect,
   type ITextRect,
   type IPageTextContent,
+  type IHitTestResult,
+  type ICharRange,
   type IEditableTextObject,
   type IReflowLineUpdate,
   type ITextEditResult,
+  type IPageCacheStats,
+  type IDirtyState,
+  type IStartupTimings,
+  type IPerfCounters,
+  type INativePerfCounter,
+  type NativePerfCounterName,
+  type IHeapStats,
+  type IMemoryTrimReport,
+  type INativeMemoryTrim,
+  type MemoryTrimLevel,
+  type IPdfEncryptionOptions,
   type ISearchResult,
   type IFormField,
   type IFormFieldOption,
   type FormFieldType,
 } from './PdfController';
 
+export { PdfWorkerController } from './workerController';
+
+export { PdfBatchPool, type IBatchPoolOptions } from './batchPool';
+
+export type {
+  IPageRange,
+  PageImageFormat,
+  IPageImageOptions,
+  IPageImage,
+  IPageText,
+  IBatchProgress,
+  IBatchOptions,
+} from './batchJob';
+
+export type { IPerfTiming } from './perfCounters';
+
+export { watchMemoryPressure, type IMemoryPressureOptions } from './memoryPressure';
+
+export type { EngineMethod, IEngineRenderOptions } from './engineProtocol';
+
+export {
+  RENDER_PRIORITY,
+  type IRenderViewport,
+  type IScheduledRenderOptions,
+} from './renderScheduler';
+
+export {
+  createBlobByteSource,
+  createHttpRangeByteSource,
+  type IPdfByteSource,
+} from './byteSource';
+
 export type {
   IPdfDest,
   IPdfOutlineNode,
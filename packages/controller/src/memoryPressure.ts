@@ -0,0 +1,57 @@
+/**
+ * Pages get no memory-pressure event, so the engine's caches are trimmed on the signals
+ * that come before a tab is discarded: going hidden trims what is cheap to rebuild, and
+ * a freeze or a pagehide (the page entering the back/forward cache) releases everything
+ * that is rebuilt on demand. Devices that report little memory also get a lower budget.
+ */
+import type { IPdfController } from './PdfController';
+
+export interface IMemoryPressureOptions {
+  /** Memory budget on devices reporting lowMemoryDeviceGb or less (navigator.deviceMemory) */
+  lowMemoryBudgetBytes?: number;
+  lowMemoryDeviceGb?: number;
+}
+
+const LOW_MEMORY_BUDGET_BYTES = 192 * 1024 * 1024;
+const LOW_MEMORY_DEVICE_GB = 2;
+
+/**
+ * Trim the controller's memory when the page is hidden, frozen or hidden into the
+ * back/forward cache.
+ * @returns Stops watching
+ */
+export function watchMemoryPressure(
+  controller: Pick<IPdfController, 'trimMemory' | 'setMemoryBudget'>,
+  options: IMemoryPressureOptions = {},
+): () => void {
+  if (typeof document === 'undefined') return () => undefined;
+  const {
+    lowMemoryBudgetBytes = LOW_MEMORY_BUDGET_BYTES,
+    lowMemoryDeviceGb = LOW_MEMORY_DEVICE_GB,
+  } = options;
+
+  // Chromium only; rounded down and capped at 8
+  const deviceMemory = (navigator as Navigator & { deviceMemory?: number }).deviceMemory;
+  if (deviceMemory !== undefined && deviceMemory <= lowMemoryDeviceGb) {
+    controller.setMemoryBudget(lowMemoryBudgetBytes);
+  }
+
+  const onVisibilityChange = () => {
+    if (document.visibilityState === 'hidden') controller.trimMemory('moderate');
+  };
+  const onFreeze = () => {
+    controller.trimMemory('critical');
+  };
+  const onPageHide = (event: PageTransitionEvent) => {
+    // A page that is unloading frees its heap anyway
+    if (event.persisted) controller.trimMemory('critical');
+  };
+  document.addEventListener('visibilitychange', onVisibilityChange);
+  document.addEventListener('freeze', onFreeze);
+  window.addEventListener('pagehide', onPageHide);
+  return () => {
+    document.removeEventListener('visibilitychange', onVisibilityChange);
+    document.removeEventListener('freeze', onFreeze);
+    window.removeEventListener('pagehide', onPageHide);
+  };
+}
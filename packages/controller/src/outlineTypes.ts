@@ -7,9 +7,13 @@ export interface IPdfDest {
 
 export interface IPdfOutlineNode {
   title: string;
+  /** Native bookmark handle for getOutlineChildren(); refused once another document is loaded */
+  id?: number;
   dest?: IPdfDest;
   unsupported?: string;
   children?: IPdfOutlineNode[];
+  /** Children exist but were not loaded; fetch them with getOutlineChildren(id) */
+  hasMoreChildren?: boolean;
 }
 
 export interface IUserBookmark {
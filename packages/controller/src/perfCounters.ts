@@ -0,0 +1,60 @@
+/**
+ * Timing of the JS side of a render (copying pixels out of the WASM heap and
+ * handing them to the canvas), kept next to the engine's native counters so a
+ * slow frame can be attributed to PDFium or to the browser.
+ */
+
+/** Calls and durations of one profiled step, in milliseconds */
+export interface IPerfTiming {
+  calls: number;
+  totalMs: number;
+  p50Ms: number;
+  p99Ms: number;
+  maxMs: number;
+}
+
+/** Most recent samples kept for the percentiles */
+const MAX_SAMPLES = 512;
+
+export class TimingStats {
+  private calls = 0;
+  private totalMs = 0;
+  private maxMs = 0;
+  /** Ring of the last MAX_SAMPLES durations */
+  private samples: number[] = [];
+  private next = 0;
+
+  public record(ms: number): void {
+    this.calls++;
+    this.totalMs += ms;
+    this.maxMs = Math.max(this.maxMs, ms);
+    if (this.samples.length < MAX_SAMPLES) {
+      this.samples.push(ms);
+    } else {
+      this.samples[this.next] = ms;
+      this.next = (this.next + 1) % MAX_SAMPLES;
+    }
+  }
+
+  public reset(): void {
+    this.calls = 0;
+    this.totalMs = 0;
+    this.maxMs = 0;
+    this.samples = [];
+    this.next = 0;
+  }
+
+  /** Totals since the last reset; percentiles cover the most recent samples only. */
+  public snapshot(): IPerfTiming {
+    const sorted = [...this.samples].sort((a, b) => a - b);
+    const quantile = (q: number) =>
+      sorted.length ? sorted[Math.min(sorted.length - 1, Math.ceil(q * sorted.length) - 1)] : 0;
+    return {
+      calls: this.calls,
+      totalMs: this.totalMs,
+      p50Ms: quantile(0.5),
+      p99Ms: quantile(0.99),
+      maxMs: this.maxMs,
+    };
+  }
+}
@@ -0,0 +1,151 @@
+/**
+ * Cache of rendered page rasters, so a page canvas that remounts or a zoom that
+ * returns to a level shown before is drawn from an ImageBitmap instead of being
+ * rendered again. Entries are keyed by page, rotation, scale bucket and the
+ * page's content generation, and evicted least recently used first once their
+ * pixels exceed the byte budget.
+ */
+export interface IRasterCacheEntry {
+  pageIndex: number;
+  rotation: number;
+  generation: number;
+  bitmap: ImageBitmap;
+  /** Device pixel size of the bitmap */
+  width: number;
+  height: number;
+}
+
+/** Scale buckets per doubling of the device scale (~4.4% apart) */
+const BUCKETS_PER_OCTAVE = 16;
+
+export class RasterCache {
+  /** Entries in least recently used first order */
+  private entries = new Map<string, IRasterCacheEntry>();
+  private bytes = 0;
+
+  constructor(private maxBytes: number) {}
+
+  /** RGBA bytes of the cached rasters */
+  public get byteSize(): number {
+    return this.bytes;
+  }
+
+  /** Quantize a device scale (scale * pixelRatio) so nearby zoom levels share a slot. */
+  public static scaleBucket(deviceScale: number): number {
+    return Math.round(Math.log2(deviceScale) * BUCKETS_PER_OCTAVE);
+  }
+
+  /** Cache key of a raster; draft (thumbnail quality) rasters get their own slot. */
+  public static key(
+    pageIndex: number,
+    rotation: number,
+    deviceScale: number,
+    generation: number,
+    draft = false,
+  ): string {
+    const key = `${pageIndex}:${rotation}:${RasterCache.scaleBucket(deviceScale)}:${generation}`;
+    return draft ? `${key}:draft` : key;
+  }
+
+  public has(key: string): boolean {
+    return this.entries.has(key);
+  }
+
+  /** Entry for key, when it was rendered at exactly width x height device pixels. */
+  public get(key: string, width: number, height: number): IRasterCacheEntry | null {
+    const entry = this.entries.get(key);
+    if (!entry || entry.width !== width || entry.height !== height) return null;
+    this.entries.delete(key);
+    this.entries.set(key, entry);
+    return entry;
+  }
+
+  /**
+   * Closest-sized raster of the same page content at any scale, e.g. a sidebar
+   * thumbnail, to show stretched while the full-resolution render runs.
+   */
+  public findPlaceholder(
+    pageIndex: number,
+    rotation: number,
+    generation: number,
+    width: number,
+  ): IRasterCacheEntry | null {
+    let best: IRasterCacheEntry | null = null;
+    for (const entry of this.entries.values()) {
+      if (
+        entry.pageIndex !== pageIndex ||
+        entry.rotation !== rotation ||
+        entry.generation !== generation
+      ) {
+        continue;
+      }
+      if (!best || Math.abs(entry.width - width) < Math.abs(best.width - width)) {
+        best = entry;
+      }
+    }
+    return best;
+  }
+
+  /** Store a raster, replacing the entry of the same key; the cache owns the bitmap. */
+  public set(key: string, entry: IRasterCacheEntry): void {
+    const size = RasterCache.entryBytes(entry);
+    if (size > this.maxBytes) {
+      entry.bitmap.close();
+      return;
+    }
+    this.remove(key);
+    this.entries.set(key, entry);
+    this.bytes += size;
+    this.trim();
+  }
+
+  /** Drop every raster of a page (content generations before the current one). */
+  public invalidatePage(pageIndex: number): void {
+    for (const [key, entry] of this.entries) {
+      if (entry.pageIndex === pageIndex) this.remove(key);
+    }
+  }
+
+  public setMaxBytes(maxBytes: number): void {
+    this.maxBytes = maxBytes;
+    this.trim();
+  }
+
+  public clear(): void {
+    for (const entry of this.entries.values()) {
+      entry.bitmap.close();
+    }
+    this.entries.clear();
+    this.bytes = 0;
+  }
+
+  private remove(key: string): void {
+    const entry = this.entries.get(key);
+    if (!entry) return;
+    this.entries.delete(key);
+    this.bytes -= RasterCache.entryBytes(entry);
+    entry.bitmap.close();
+  }
+
+  /**
+   * Drop least recently used rasters until at most targetBytes remain, e.g. under
+   * memory pressure; the budget itself is unchanged.
+   * @returns Bytes released
+   */
+  public evict(targetBytes: number): number {
+    const before = this.bytes;
+    for (const key of this.entries.keys()) {
+      if (this.bytes <= targetBytes) break;
+      this.remove(key);
+    }
+    return before - this.bytes;
+  }
+
+  private trim(): void {
+    this.evict(this.maxBytes);
+  }
+
+  private static entryBytes(entry: IRasterCacheEntry): number {
+    return entry.width * entry.height * 4;
+  }
+}
@@ -0,0 +1,260 @@
+/**
+ * Global render queue for page canvases. Requests are ordered by where their
+ * page sits relative to the viewport: the focused page, then visible pages,
+ * then a prefetch band around them, then thumbnails, then everything else.
+ * A concurrency limit keeps PDFium from interleaving too many progressive
+ * renders, and low-priority renders are aborted at their next progressive
+ * yield and requeued when more urgent work is waiting.
+ */
+import type { IRenderOptions } from './PdfController';
+
+/** Render priority; lower runs first. */
+export enum RENDER_PRIORITY {
+  FOCUSED = 0,
+  VISIBLE = 1,
+  PREFETCH = 2,
+  THUMBNAIL = 3,
+  OFFSCREEN = 4,
+}
+
+export interface IRenderViewport {
+  /** Page the user is looking at (current page) */
+  focusedPage: number;
+  /** First and last page intersecting the viewport */
+  firstVisiblePage: number;
+  lastVisiblePage: number;
+  /** Pages on each side of the visible range rendered ahead (default 2) */
+  prefetchPages?: number;
+}
+
+export interface IScheduledRenderOptions extends IRenderOptions {
+  /** Sidebar thumbnail: ranked after all viewer pages near the viewport */
+  thumbnail?: boolean;
+}
+
+/** Renders the scheduler runs at once */
+const RENDER_CONCURRENCY = 2;
+const DEFAULT_PREFETCH_PAGES = 2;
+
+type RenderFn = (
+  canvas: HTMLCanvasElement,
+  options: IRenderOptions,
+  signal: AbortSignal,
+) => Promise<void>;
+
+interface IRenderWaiter {
+  resolve: () => void;
+  reject: (error: unknown) => void;
+}
+
+interface IRenderJob {
+  canvas: HTMLCanvasElement;
+  options: IScheduledRenderOptions;
+  /** Page, scale, pixel ratio and quality; jobs with equal keys produce the same raster */
+  key: string;
+  priority: RENDER_PRIORITY;
+  /** Arrival order, FIFO within a priority */
+  seq: number;
+  waiters: Set<IRenderWaiter>;
+  /** Set while running */
+  abort: AbortController | null;
+  /** Aborted to make room for more urgent work; goes back into the queue */
+  preempted: boolean;
+  /** Withdrawn or replaced; never joined or run again */
+  cancelled: boolean;
+}
+
+function abortError(): DOMException {
+  return new DOMException('Render aborted', 'AbortError');
+}
+
+export class RenderScheduler {
+  private queued: IRenderJob[] = [];
+  private running = new Set<IRenderJob>();
+  private viewport: IRenderViewport | null = null;
+  private nextSeq = 0;
+
+  constructor(private readonly render: RenderFn) {}
+
+  /**
+   * Queue a render into canvas. A request identical to one already queued or
+   * running for the same canvas joins it; a different one for the same canvas
+   * replaces it. Aborting options.signal withdraws this caller; the render is
+   * cancelled once no caller is waiting for it.
+   */
+  public schedule(canvas: HTMLCanvasElement, options: IScheduledRenderOptions = {}): Promise<void> {
+    const { signal } = options;
+    if (signal?.aborted) return Promise.reject(abortError());
+
+    const key = RenderScheduler.jobKey(options);
+    let job = this.findJob(canvas);
+    if (job && job.key !== key) {
+      this.cancelJob(job);
+      job = undefined;
+    }
+    if (!job) {
+      job = {
+        canvas,
+        options,
+        key,
+        priority: this.priorityOf(options),
+        seq: this.nextSeq++,
+        waiters: new Set(),
+        abort: null,
+        preempted: false,
+        cancelled: false,
+      };
+      this.queued.push(job);
+    }
+
+    const scheduled = job;
+    const promise = new Promise<void>((resolve, reject) => {
+      const waiter: IRenderWaiter = {
+        resolve: () => {
+          signal?.removeEventListener('abort', onAbort);
+          resolve();
+        },
+        reject: (error) => {
+          signal?.removeEventListener('abort', onAbort);
+          reject(error);
+        },
+      };
+      const onAbort = () => {
+        scheduled.waiters.delete(waiter);
+        waiter.reject(abortError());
+        if (scheduled.waiters.size === 0) this.cancelJob(scheduled);
+      };
+      signal?.addEventListener('abort', onAbort, { once: true });
+      scheduled.waiters.add(waiter);
+    });
+    this.pump();
+    return promise;
+  }
+
+  /** Re-rank queued and running work after the viewport moved. */
+  public setViewport(viewport: IRenderViewport): void {
+    this.viewport = viewport;
+    for (const job of this.queued) job.priority = this.priorityOf(job.options);
+    for (const job of this.running) job.priority = this.priorityOf(job.options);
+    this.pump();
+  }
+
+  /** Reject every queued and running render, e.g. when the document closes. */
+  public cancelAll(): void {
+    for (const job of [...this.queued, ...this.running]) this.cancelJob(job);
+  }
+
+  private pump(): void {
+    this.preemptForUrgentWork();
+    while (this.running.size < RENDER_CONCURRENCY) {
+      const job = this.takeNext();
+      if (!job) return;
+      void this.run(job);
+    }
+  }
+
+  /**
+   * Best queued job. A job whose raster is being produced for another canvas
+   * waits for it, so it then draws from the raster cache instead of PDFium.
+   */
+  private takeNext(): IRenderJob | undefined {
+    let best = -1;
+    for (let i = 0; i < this.queued.length; i++) {
+      const job = this.queued[i];
+      if ([...this.running].some((active) => !active.cancelled && active.key === job.key)) {
+        continue;
+      }
+      const current = best >= 0 ? this.queued[best] : null;
+      if (
+        !current ||
+        job.priority < current.priority ||
+        (job.priority === current.priority && job.seq < current.seq)
+      ) {
+        best = i;
+      }
+    }
+    return best >= 0 ? this.queued.splice(best, 1)[0] : undefined;
+  }
+
+  /** Abort the least urgent running job when visible work waits for a slot. */
+  private preemptForUrgentWork(): void {
+    if (this.running.size < RENDER_CONCURRENCY) return;
+    const urgent = this.queued.some((job) => job.priority <= RENDER_PRIORITY.VISIBLE);
+    if (!urgent) return;
+    let victim: IRenderJob | null = null;
+    for (const job of this.running) {
+      if (job.priority <= RENDER_PRIORITY.VISIBLE || job.preempted || job.cancelled) continue;
+      if (!victim || job.priority > victim.priority) victim = job;
+    }
+    if (!victim) return;
+    victim.preempted = true;
+    victim.abort?.abort();
+  }
+
+  private async run(job: IRenderJob): Promise<void> {
+    const abort = new AbortController();
+    job.abort = abort;
+    job.preempted = false;
+    this.running.add(job);
+    try {
+      // Everything but the callers' signal (the job has its own) and the ranking flag
+      const options: IScheduledRenderOptions = { ...job.options };
+      delete options.signal;
+      delete options.thumbnail;
+      await this.render(job.canvas, options, abort.signal);
+      for (const waiter of job.waiters) waiter.resolve();
+    } catch (error) {
+      if (job.preempted && !job.cancelled) {
+        this.queued.push(job);
+      } else {
+        for (const waiter of job.waiters) waiter.reject(error);
+      }
+    } finally {
+      job.abort = null;
+      this.running.delete(job);
+      this.pump();
+    }
+  }
+
+  private cancelJob(job: IRenderJob): void {
+    const at = this.queued.indexOf(job);
+    if (at >= 0) this.queued.splice(at, 1);
+    job.cancelled = true;
+    for (const waiter of job.waiters) waiter.reject(abortError());
+    job.waiters.clear();
+    job.abort?.abort();
+  }
+
+  private findJob(canvas: HTMLCanvasElement): IRenderJob | undefined {
+    for (const job of this.running) {
+      if (job.canvas === canvas && !job.cancelled) return job;
+    }
+    return this.queued.find((job) => job.canvas === canvas);
+  }
+
+  private priorityOf(options: IScheduledRenderOptions): RENDER_PRIORITY {
+    if (options.thumbnail) return RENDER_PRIORITY.THUMBNAIL;
+    const viewport = this.viewport;
+    if (!viewport) return RENDER_PRIORITY.VISIBLE;
+    const pageIndex = options.pageIndex ?? 0;
+    if (pageIndex === viewport.focusedPage) return RENDER_PRIORITY.FOCUSED;
+    const { firstVisiblePage, lastVisiblePage } = viewport;
+    if (pageIndex >= firstVisiblePage && pageIndex <= lastVisiblePage) {
+      return RENDER_PRIORITY.VISIBLE;
+    }
+    const prefetch = viewport.prefetchPages ?? DEFAULT_PREFETCH_PAGES;
+    if (pageIndex >= firstVisiblePage - prefetch && pageIndex <= lastVisiblePage + prefetch) {
+      return RENDER_PRIORITY.PREFETCH;
+    }
+    return RENDER_PRIORITY.OFFSCREEN;
+  }
+
+  private static jobKey({
+    pageIndex = 0,
+    scale = 1,
+    pixelRatio = 1,
+    draft = false,
+  }: IRenderOptions): string {
+    return `${pageIndex}:${scale}:${pixelRatio}${draft ? ':draft' : ''}`;
+  }
+}
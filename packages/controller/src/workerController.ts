@@ -0,0 +1,157 @@
+/**
+ * Main-thread facade of a PDFium engine hosted in a Web Worker (engineWorker.ts).
+ * Every PdfController method listed in EngineMethod is available through call()
+ * and returns a promise; renders go through a priority queue in the worker and
+ * come back as ImageBitmaps or land directly in a transferred OffscreenCanvas.
+ */
+import { PdfPasswordError, type IPdfController } from './PdfController';
+import type {
+  EngineMethod,
+  IEngineError,
+  IEngineRenderOptions,
+  IEngineRequest,
+  IEngineResponse,
+} from './engineProtocol';
+
+type EngineResult<K extends EngineMethod> = Awaited<ReturnType<IPdfController[K]>>;
+
+/** Omit applied to each member of a union */
+type DistributiveOmit<T, K extends PropertyKey> = T extends unknown ? Omit<T, K> : never;
+
+/** Request fields without the id, which post() assigns */
+type EngineRequestBody = DistributiveOmit<IEngineRequest, 'id'>;
+
+interface IPendingRequest {
+  resolve: (response: Extract<IEngineResponse, { ok: true }>) => void;
+  reject: (error: Error) => void;
+}
+
+export class PdfWorkerController {
+  private nextId = 1;
+  private nextCanvasId = 1;
+  private pending = new Map<number, IPendingRequest>();
+
+  constructor(private readonly worker: Worker) {
+    worker.onmessage = (event: MessageEvent<IEngineResponse>) => {
+      const response = event.data;
+      const request = this.pending.get(response.id);
+      if (!request) return;
+      this.pending.delete(response.id);
+      if (response.ok) {
+        request.resolve(response);
+      } else {
+        request.reject(PdfWorkerController.toError(response.error));
+      }
+    };
+    worker.onerror = (event: ErrorEvent) => {
+      const error = new Error(`PDF engine worker failed: ${event.message}`);
+      for (const request of this.pending.values()) request.reject(error);
+      this.pending.clear();
+    };
+  }
+
+  /** Start the bundled engine worker (the module next to this one in dist/). */
+  public static create(): PdfWorkerController {
+    const worker = new Worker(new URL('./engineWorker.js', import.meta.url), { type: 'module' });
+    return new PdfWorkerController(worker);
+  }
+
+  /**
+   * Call a PdfController method in the worker. Arguments are structured-cloned,
+   * so AbortSignals in options cannot be passed.
+   */
+  public call<K extends EngineMethod>(
+    method: K,
+    ...args: Parameters<IPdfController[K]>
+  ): Promise<EngineResult<K>> {
+    return this.post({ type: 'call', method, args }).then(
+      (response) => response.result as EngineResult<K>,
+    );
+  }
+
+  /**
+   * Render a page in the worker and receive it as an ImageBitmap (device pixels).
+   * Aborting the signal drops the request from the queue or cancels the render.
+   */
+  public async renderBitmap(
+    options: IEngineRenderOptions,
+    signal?: AbortSignal,
+  ): Promise<ImageBitmap> {
+    const response = await this.post({ type: 'render', options }, [], signal);
+    if (!response.bitmap) throw new Error('Engine returned no bitmap');
+    return response.bitmap;
+  }
+
+  /**
+   * Hand a canvas over to the worker, which then draws it directly. The canvas
+   * can no longer be drawn on the main thread; its CSS size stays under page control.
+   * @returns Id for renderToCanvas() and detachCanvas()
+   */
+  public async attachCanvas(canvas: HTMLCanvasElement): Promise<number> {
+    const canvasId = this.nextCanvasId++;
+    const offscreen = canvas.transferControlToOffscreen();
+    await this.post({ type: 'attachCanvas', canvasId, canvas: offscreen }, [offscreen]);
+    return canvasId;
+  }
+
+  public async detachCanvas(canvasId: number): Promise<void> {
+    await this.post({ type: 'detachCanvas', canvasId });
+  }
+
+  /**
+   * Render a page into an attached canvas.
+   * @returns The canvas size in device pixels after the render
+   */
+  public async renderToCanvas(
+    canvasId: number,
+    options: IEngineRenderOptions,
+    signal?: AbortSignal,
+  ): Promise<{ width: number; height: number }> {
+    const response = await this.post({ type: 'render', options, canvasId }, [], signal);
+    return response.result as { width: number; height: number };
+  }
+
+  /** Stop the worker; pending requests reject. */
+  public terminate(): void {
+    this.worker.terminate();
+    const error = new Error('PDF engine worker terminated');
+    for (const request of this.pending.values()) request.reject(error);
+    this.pending.clear();
+  }
+
+  private post(
+    body: EngineRequestBody,
+    transfer: Transferable[] = [],
+    signal?: AbortSignal,
+  ): Promise<Extract<IEngineResponse, { ok: true }>> {
+    if (signal?.aborted) {
+      return Promise.reject(new DOMException('Render aborted', 'AbortError'));
+    }
+    const id = this.nextId++;
+    return new Promise((resolve, reject) => {
+      const onAbort = () => {
+        this.worker.postMessage({ id: this.nextId++, type: 'cancel', targetId: id });
+      };
+      signal?.addEventListener('abort', onAbort, { once: true });
+      this.pending.set(id, {
+        resolve: (response) => {
+          signal?.removeEventListener('abort', onAbort);
+          resolve(response);
+        },
+        reject: (error) => {
+          signal?.removeEventListener('abort', onAbort);
+          reject(error);
+        },
+      });
+      this.worker.postMessage({ ...body, id } as IEngineRequest, transfer);
+    });
+  }
+
+  private static toError({ name, message, code }: IEngineError): Error {
+    if (name === 'PdfPasswordError') return new PdfPasswordError(message, code);
+    if (name === 'AbortError') return new DOMException(message, 'AbortError');
+    const error = new Error(message);
+    error.name = name;
+    return error;
+  }
+}
@@ -309,6 +309,7 @@ function commitSignatureAnnotation(
       height: annotation.height,
     },
     imageRgbaBytes: annotation.imageRgbaBytes,
+    imageJpegBytes: annotation.imageJpegBytes,
     imageWidthPx: annotation.imageWidthPx,
     imageHeightPx: annotation.imageHeightPx,
   });
@@ -68,6 +68,8 @@ export interface ISignatureAnnotation extends IBaseAnnotation {
   position: IPoint;
   imageDataUrl: string;
   imageRgbaBytes: Uint8Array;
+  /** Uploaded JPEG of the image, embedded without decoding when committed */
+  imageJpegBytes?: Uint8Array;
   imageWidthPx: number;
   imageHeightPx: number;
   width: number;
@@ -6,6 +6,8 @@
  * 1. Rendering at the last drawn scale (renderedScale) and scaling visually via CSS transform for smooth zooming.
  * 2. Debouncing a high quality render at the target scale after a short delay.
  * 3. Cancelling in-progress renders when a new render is requested.
+ * 4. Queueing renders through the controller's scheduler, which runs the focused and
+ *    visible pages before prefetched neighbours and sidebar thumbnails.
  *
  * Flicker fixes in this version:
  * - Do NOT show per-page loader during zoom (only on initial render).
@@ -23,6 +25,8 @@ export interface ICanvasLayerProps extends React.ComponentProps<'canvas'> {
   pageIndex?: number;
   scale?: number;
   hidden?: boolean;
+  /** Sidebar thumbnail; rendered after the viewer pages, in draft quality */
+  thumbnail?: boolean;
   onCanvasReady?: (canvas: HTMLCanvasElement) => void;
 }
 
@@ -30,6 +34,7 @@ export const CanvasLayer: React.FC<ICanvasLayerProps> = ({
   pageIndex = 0,
   scale = 1.0,
   hidden = false,
+  thumbnail = false,
   onCanvasReady,
   ...props
 }) => {
@@ -78,11 +83,13 @@ export const CanvasLayer: React.FC<ICanvasLayerProps> = ({
     const pixelRatio = window.devicePixelRatio || 1;
 
     try {
-      await controller.renderPdf(canvas, {
+      await controller.scheduleRender(canvas, {
         pageIndex,
         scale,
         pixelRatio,
         signal: abortController.signal,
+        thumbnail,
+        draft: thumbnail,
       });
 
       if (abortController.signal.aborted) return;
@@ -101,7 +108,7 @@ export const CanvasLayer: React.FC<ICanvasLayerProps> = ({
 
       console.warn('Failed to render PDF on canvas.', error);
     }
-  }, [controller, isInitialized, pageIndex, scale, onCanvasReady, renderVersion]);
+  }, [controller, isInitialized, pageIndex, scale, thumbnail, onCanvasReady, renderVersion]);
 
   // Debounce expensive render; only run when actually needed
   useEffect(() => {
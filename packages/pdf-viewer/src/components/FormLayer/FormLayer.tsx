@@ -45,9 +45,11 @@ export const FormLayer: React.FC<IFormLayerProps> = ({ pdfCanvas, containerEl, p
   const { scale } = usePdfScale();
   const { registerFields, getValue, setValue } = useFormContext();
 
+  // Read once the page has rendered, so a progressively loading page has its data
+  const isRendered = pdfCanvas !== null;
   const fields = useMemo<IFormField[]>(
-    () => controller.listFormFields(pageIndex, { scale: 1 }),
-    [controller, pageIndex],
+    () => (isRendered ? controller.listFormFields(pageIndex, { scale: 1 }) : []),
+    [controller, isRendered, pageIndex],
   );
 
   useEffect(() => {
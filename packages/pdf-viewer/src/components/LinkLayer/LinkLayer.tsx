@@ -60,10 +60,12 @@ export const LinkLayer: React.FC<ILinkLayerProps> = ({
   const { scale } = usePdfState();
   const rootRef = useRef<HTMLDivElement | null>(null);
 
-  // Memoize native annotations fetch
+  // Memoize native annotations fetch; read once the page has rendered, so a progressively
+  // loading page has its data
+  const isRendered = pdfCanvas !== null;
   const native = useMemo(
-    () => controller.listNativeAnnotations(pageIndex, { scale: 1 }),
-    [controller, pageIndex],
+    () => (isRendered ? controller.listNativeAnnotations(pageIndex, { scale: 1 }) : []),
+    [controller, isRendered, pageIndex],
   );
 
   // Memoize links extraction
@@ -9,12 +9,22 @@ import { usePdfState } from '@/providers/PdfStateContextProvider';
 import { useId } from 'react';
 import { SEARCH_CONFIG } from '@/utils/config';
 
+/** Document order: page, then position on the page */
+const compareMatches = (a: ISearchResult, b: ISearchResult) =>
+  a.pageIndex - b.pageIndex || a.charIndex - b.charIndex;
+
 export const SearchBar = () => {
   const scale = usePdfState().scale;
   const [value, setValue] = useState<string>('');
   const [debouncedValue, setDebouncedValue] = useState<string>('');
-  const { controller, goToPage } = usePdfController();
+  const { controller, currentPage, goToPage } = usePdfController();
   const highlightRef = useRef<HTMLDivElement | null>(null);
+  // Read when a search starts, so paging through the document does not restart it
+  const currentPageRef = useRef(currentPage);
+
+  useEffect(() => {
+    currentPageRef.current = currentPage;
+  }, [currentPage]);
 
   // Debounce the search value
   useEffect(() => {
@@ -24,11 +34,43 @@ export const SearchBar = () => {
     return () => clearTimeout(timer);
   }, [value]);
 
-  const matches: ISearchResult[] = useMemo(() => {
-    if (!debouncedValue) return [];
-    return controller.searchText(debouncedValue, { scale });
-  }, [controller, debouncedValue, scale]);
+  const [matches, setMatches] = useState<ISearchResult[]>([]);
   const [currentIndex, setCurrentIndex] = useState(0);
+
+  // Stream matches in: pages around the current one arrive first, the rest of the
+  // document follows. Matches are kept in document order and the selected match
+  // stays selected as earlier ones are inserted before it.
+  useEffect(() => {
+    // eslint-disable-next-line react-hooks/set-state-in-effect -- a new query drops the old matches
+    setMatches([]);
+    setCurrentIndex(0);
+    if (!debouncedValue) return;
+
+    const abort = new AbortController();
+    const startPage = currentPageRef.current;
+    let found: ISearchResult[] = [];
+
+    void (async () => {
+      const stream = controller.searchTextStream(debouncedValue, {
+        scale,
+        startPage,
+        signal: abort.signal,
+      });
+      for await (const chunk of stream) {
+        if (abort.signal.aborted) return;
+        const previous = found;
+        found = [...previous, ...chunk].sort(compareMatches);
+        setMatches(found);
+        setCurrentIndex((prev) => {
+          if (previous.length > 0) return Math.max(found.indexOf(previous[prev]), 0);
+          const first = found.findIndex((match) => match.pageIndex >= startPage);
+          return first >= 0 ? first : 0;
+        });
+      }
+    })();
+
+    return () => abort.abort();
+  }, [controller, debouncedValue, scale]);
   const searchBoxId = useId();
   // CSS-escape the useId() result for use in querySelector
   const escapedSearchBoxId = useMemo(() => CSS.escape(searchBoxId), [searchBoxId]);
@@ -40,16 +82,14 @@ export const SearchBar = () => {
   }, []);
 
   const drawHighlight = useCallback(
-    (index: number) => {
+    (match: ISearchResult | undefined) => {
       // Clean up previous highlight
       if (highlightRef.current) {
         highlightRef.current.remove();
         highlightRef.current = null;
       }
 
-      if (matches.length === 0 || index < 0 || index >= matches.length) return;
-      const match: ISearchResult = matches[index];
-      if (!match.rects || match.rects.length === 0) return;
+      if (!match || !match.rects || match.rects.length === 0) return;
 
       // Scroll to page first - this triggers viewport observer and rendering
       goToPage(match.pageIndex, {
@@ -117,7 +157,7 @@ export const SearchBar = () => {
       // Wait for page to scroll and render, then highlight
       setTimeout(() => performHighlight(), 100);
     },
-    [matches, goToPage],
+    [goToPage],
   );
 
   // Cleanup highlight on unmount or when value is cleared
@@ -146,10 +186,12 @@ export const SearchBar = () => {
     };
   }, [escapedSearchBoxId]);
 
-  // Draw highlight when index changes or when matches change
+  // Draw highlight when the selected match changes; streamed-in matches keep the
+  // selected object, so later chunks do not scroll back to it again
+  const currentMatch: ISearchResult | undefined = matches[currentIndex];
   useEffect(() => {
-    drawHighlight(currentIndex);
-  }, [currentIndex, drawHighlight, scale]);
+    drawHighlight(currentMatch);
+  }, [currentMatch, drawHighlight, scale]);
 
   return (
     <div className="w-full max-w-xs space-y-2">
@@ -2,6 +2,7 @@ import { usePdfController } from '@/providers/PdfControllerContextProvider';
 import { CanvasLayer } from '../CanvasLayer/CanvasLayer';
 import React, { useCallback, useRef, useState, useEffect } from 'react';
 import { RENDER_CONFIG } from '@/utils/config';
+import { usePageSizesVersion } from '@/hooks/usePageSizesVersion';
 
 interface IPagePreviewProps {
   page: number;
@@ -16,7 +17,8 @@ export const PagePreview = React.memo(({ page }: IPagePreviewProps) => {
     goToPage(page);
   }, [goToPage, page]);
 
-  // Get page dimensions to calculate proper scaling
+  // Get page dimensions to calculate proper scaling (again once a loading page arrives)
+  usePageSizesVersion(page);
   const { width: pageWidth, height: pageHeight } = controller.getPageDimension(page);
   const previewScale = RENDER_CONFIG.PREVIEW_SCALE;
   const canvasWidth = pageWidth * previewScale;
@@ -84,6 +86,7 @@ export const PagePreview = React.memo(({ page }: IPagePreviewProps) => {
             data-preview-index={String(page)}
             pageIndex={page}
             scale={previewScale}
+            thumbnail
           />
         </div>
       </div>
@@ -1,7 +1,7 @@
 'use client';
 
 import { useCallback, useEffect, useMemo, useRef, useState } from 'react';
-import { Virtuoso, type VirtuosoHandle } from 'react-virtuoso';
+import { Virtuoso, type ListRange, type VirtuosoHandle } from 'react-virtuoso';
 import { Sidebar, SidebarContent, useSidebar } from '@pdfviewer/ui/components/sidebar';
 import { Button } from '@pdfviewer/ui/components/button';
 import { usePdfController } from '@/providers/PdfControllerContextProvider';
@@ -10,6 +10,7 @@ import { OutlinePanel } from './OutlinePanel';
 import { BookmarksPanel } from './BookmarksPanel';
 import type { IPdfOutlineNode } from '@pdfviewer/controller';
 import { BookOpen, Bookmark, ListTree } from 'lucide-react';
+import { RENDER_CONFIG } from '@/utils/config';
 
 type SidebarTab = 'pages' | 'outline' | 'bookmarks' | undefined;
 
@@ -43,14 +44,30 @@ export function AppSidebar({ file, isFileLoaded }: IAppSidebarProps) {
     });
   }, [currentPage, pageCount]);
 
+  const isOutlineOpen = activeTab === 'outline';
   useEffect(() => {
     if (!isFileLoaded) {
       // eslint-disable-next-line react-hooks/set-state-in-effect
       setOutline([]);
       return;
     }
-    setOutline(controller.getOutline());
-  }, [controller, isFileLoaded, file]);
+    if (!isOutlineOpen) return;
+
+    // The outline can sit anywhere in the file, so a progressively loaded one is read
+    // in full first
+    let cancelled = false;
+    controller
+      .whenFullyLoaded()
+      .then(() => {
+        if (!cancelled) setOutline(controller.getOutline());
+      })
+      .catch((error: unknown) => {
+        console.warn('Failed to load the outline.', error);
+      });
+    return () => {
+      cancelled = true;
+    };
+  }, [controller, isFileLoaded, isOutlineOpen, file]);
 
   const itemContent = useCallback(
     (index: number) => (
@@ -61,6 +78,22 @@ export function AppSidebar({ file, isFileLoaded }: IAppSidebarProps) {
     [],
   );
 
+  // Draw the thumbnails coming into view in one engine call; their canvases then
+  // render from the controller's raster cache
+  const handleRangeChanged = useCallback(
+    (range: ListRange) => {
+      controller
+        .prefetchThumbnails(range.startIndex, range.endIndex - range.startIndex + 1, {
+          scale: RENDER_CONFIG.PREVIEW_SCALE,
+          pixelRatio: window.devicePixelRatio || 1,
+        })
+        .catch((error: unknown) => {
+          console.warn('Failed to prefetch thumbnails.', error);
+        });
+    },
+    [controller],
+  );
+
   const isCollapsed = state === 'collapsed';
 
   const openSidebar = useCallback(() => {
@@ -142,6 +175,7 @@ export function AppSidebar({ file, isFileLoaded }: IAppSidebarProps) {
                   ref={virtuosoRef}
                   totalCount={pageCount}
                   itemContent={itemContent}
+                  rangeChanged={handleRangeChanged}
                   overscan={500}
                   className="h-full custom-scrollbar"
                 />
@@ -1,11 +1,13 @@
 import React, { useState, useCallback } from 'react';
-import { safeBase64Decode } from '@/utils/shared';
+import { isUprightJpeg, safeBase64Decode } from '@/utils/shared';
 
 export interface IImageUploadProps {
   onSignatureReady: (args: {
     pngDataUrl: string;
     pngBytes: Uint8Array;
     rgbaBytes: Uint8Array;
+    /** The uploaded file when it is a JPEG PDFium can embed without re-encoding */
+    jpegBytes?: Uint8Array;
     widthPx: number;
     heightPx: number;
   }) => void;
@@ -17,6 +19,7 @@ export const ImageUpload: React.FC<IImageUploadProps> = ({ onSignatureReady }) =
     dataUrl: string;
     bytes: Uint8Array;
     rgbaBytes: Uint8Array;
+    jpegBytes?: Uint8Array;
     width: number;
     height: number;
   } | null>(null);
@@ -74,10 +77,17 @@ export const ImageUpload: React.FC<IImageUploadProps> = ({ onSignatureReady }) =
           return;
         }
 
+        // JPEGs are embedded as uploaded instead of as decoded pixels, unless EXIF
+        // rotates them (the browser drew them rotated; the PDF would not)
+        const fileBytes =
+          file.type === 'image/jpeg' ? safeBase64Decode(dataUrl.split(',')[1]) : null;
+        const jpegBytes = fileBytes && isUprightJpeg(fileBytes) ? fileBytes : undefined;
+
         setImageData({
           dataUrl: pngDataUrl,
           bytes: pngBytes,
           rgbaBytes,
+          jpegBytes,
           width: img.naturalWidth,
           height: img.naturalHeight,
         });
@@ -94,6 +104,7 @@ export const ImageUpload: React.FC<IImageUploadProps> = ({ onSignatureReady }) =
         pngDataUrl: imageData.dataUrl,
         pngBytes: imageData.bytes,
         rgbaBytes: imageData.rgbaBytes,
+        jpegBytes: imageData.jpegBytes,
         widthPx: imageData.width,
         heightPx: imageData.height,
       });
@@ -18,6 +18,7 @@ export interface ISignatureDialogProps {
     pngDataUrl: string;
     pngBytes: Uint8Array;
     rgbaBytes: Uint8Array;
+    jpegBytes?: Uint8Array;
     widthPx: number;
     heightPx: number;
   }) => void;
@@ -35,6 +36,7 @@ export const SignatureDialog: React.FC<ISignatureDialogProps> = ({
     pngDataUrl: string;
     pngBytes: Uint8Array;
     rgbaBytes: Uint8Array;
+    jpegBytes?: Uint8Array;
     widthPx: number;
     heightPx: number;
   } | null>(null);
@@ -43,6 +45,7 @@ export const SignatureDialog: React.FC<ISignatureDialogProps> = ({
     pngDataUrl: string;
     pngBytes: Uint8Array;
     rgbaBytes: Uint8Array;
+    jpegBytes?: Uint8Array;
     widthPx: number;
     heightPx: number;
   }) => {
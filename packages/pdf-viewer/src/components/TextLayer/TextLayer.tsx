@@ -17,6 +17,8 @@ import {
 export interface ITextLayerProps {
   pageIndex: number;
   scale?: number;
+  /** False until the page has rendered; a progressively loading page has no text before */
+  isPageReady?: boolean;
 }
 
 /**
@@ -24,7 +26,11 @@ export interface ITextLayerProps {
  * This enables text selection, copy/paste, and search functionality.
  * In edit mode, all paragraphs are rendered as contentEditable editors.
  */
-export const TextLayer: React.FC<ITextLayerProps> = ({ pageIndex, scale = 1.5 }) => {
+export const TextLayer: React.FC<ITextLayerProps> = ({
+  pageIndex,
+  scale = 1.5,
+  isPageReady = true,
+}) => {
   const { controller, isInitialized } = usePdfController();
   const { isEditMode, renderVersion, bumpRenderVersion, editSessionData } = useAnnotation();
   const { savedEditorHtml, savedLineColors } = editSessionData;
@@ -41,7 +47,7 @@ export const TextLayer: React.FC<ITextLayerProps> = ({ pageIndex, scale = 1.5 })
   const textContent = useMemo(() => {
     // renderVersion is a manual invalidation key for flattened-content edits.
     void renderVersion;
-    if (!isInitialized) return null;
+    if (!isInitialized || !isPageReady) return null;
 
     try {
       return controller.getPageTextContent(pageIndex);
@@ -49,7 +55,7 @@ export const TextLayer: React.FC<ITextLayerProps> = ({ pageIndex, scale = 1.5 })
       console.warn('Failed to load text content for page', pageIndex, error);
       return null;
     }
-  }, [controller, isInitialized, pageIndex, renderVersion]);
+  }, [controller, isInitialized, isPageReady, pageIndex, renderVersion]);
 
   const baseSpans = useMemo(() => {
     if (!textContent) return [];
@@ -35,7 +35,9 @@ export const DownloadButton: () => IToolButton = () => {
     groupIndex: 0,
     onClick: (pdfController, commitAnnotations) => {
       commitAnnotations();
-      pdfController.downloadPdf();
+      pdfController.downloadPdf().catch((error: unknown) => {
+        console.error('Failed to download PDF:', error);
+      });
     },
   };
 };
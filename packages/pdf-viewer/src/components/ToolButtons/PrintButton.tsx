@@ -1,13 +1,46 @@
+import { useEffect, useRef, useState } from 'react';
 import { Printer } from 'lucide-react';
+import type { IBatchProgress } from '@pdfviewer/controller';
 import type { IToolButton } from './ToolButton.type';
+import { printPdf } from '@/utils/printPdf';
+
+/**
+ * Hook that returns the Print button configuration.
+ * While a print job renders its pages the button shows the progress, and clicking it
+ * again cancels the job instead of starting a second one.
+ */
+// eslint-disable-next-line react-refresh/only-export-components
+export const usePrintButton = (): IToolButton => {
+  const [progress, setProgress] = useState<IBatchProgress | null>(null);
+  const jobRef = useRef<AbortController | null>(null);
+
+  // Stop rendering pages when the toolbar goes away
+  useEffect(() => () => jobRef.current?.abort(), []);
 
-export const PrintButton: () => IToolButton = () => {
   return {
     id: 'print',
-    name: 'Print',
+    name: progress ? `Cancel Printing (${progress.done}/${progress.total || '…'})` : 'Print',
     icon: Printer,
     type: 'button',
     groupIndex: 0,
+    onClick: (pdfController, commitAnnotations) => {
+      if (jobRef.current) {
+        jobRef.current.abort();
+        return;
+      }
+      const job = new AbortController();
+      jobRef.current = job;
+      setProgress({ done: 0, total: 0, pageIndex: -1 });
+      commitAnnotations();
+      printPdf(pdfController, { signal: job.signal, onProgress: setProgress })
+        .catch((error: unknown) => {
+          console.error('Failed to print PDF:', error);
+        })
+        .finally(() => {
+          if (jobRef.current === job) jobRef.current = null;
+          setProgress(null);
+        });
+    },
   };
 };
 
@@ -7,6 +7,7 @@ import { PageControlBar } from '../PageControlBar/PageControlBar';
 import { usePdfState } from '@/providers/PdfStateContextProvider';
 import { useUndo } from '../../hooks/useUndo';
 import { useCurrentPageTracker } from '../../hooks/useCurrentPageTracker';
+import { usePageSizesVersion } from '../../hooks/usePageSizesVersion';
 import { OBSERVER_CONFIG, VIEWER_CONFIG } from '@/utils/config';
 
 const clamp = (value: number, min: number, max: number) => Math.min(max, Math.max(min, value));
@@ -42,6 +43,7 @@ export const Viewer: React.FC<IViewerProps> = ({ pageCount }) => {
   const [scrollContainer, setScrollContainer] = useState<HTMLDivElement | null>(null);
 
   useUndo();
+  const pageSizesVersion = usePageSizesVersion();
 
   const pageHeights = useMemo(() => {
     if (pageCount <= 0) return [];
@@ -51,7 +53,9 @@ export const Viewer: React.FC<IViewerProps> = ({ pageCount }) => {
       heights[i] = dim.height;
     }
     return heights;
-  }, [controller, pageCount]);
+    // pageSizesVersion: pages that were sized as the first page have their own size now
+    // eslint-disable-next-line react-hooks/exhaustive-deps
+  }, [controller, pageCount, pageSizesVersion]);
 
   const baseCumHeights = useMemo(() => {
     const cumulative = new Array<number>(pageCount + 1);
@@ -75,6 +79,11 @@ export const Viewer: React.FC<IViewerProps> = ({ pageCount }) => {
     overscan: 3,
   });
 
+  // Drop the sizes the virtualizer cached for pages whose real size just arrived
+  useLayoutEffect(() => {
+    if (pageSizesVersion > 0) virtualizer.measure();
+  }, [pageSizesVersion, virtualizer]);
+
   const totalSizeForScale = useCallback(
     (zoom: number) => baseCumHeights[pageCount] * zoom + pageCount * PAGE_GAP_PX,
     [baseCumHeights, pageCount],
@@ -143,17 +152,35 @@ export const Viewer: React.FC<IViewerProps> = ({ pageCount }) => {
     });
   }, [registerScrollToIndex, virtualizer]);
 
+  // Rank page renders by what is on screen: focused page, visible pages, then neighbours
+  const renderViewportRef = useRef({ focusedPage: 0, firstVisiblePage: 0, lastVisiblePage: 0 });
+
   // Track current page using Intersection Observer for accurate scroll sync
   const handlePageChange = useCallback(
     (page: number) => {
       goToPage(page, { scrollIntoView: false, scrollIntoPreview: true });
+      renderViewportRef.current = { ...renderViewportRef.current, focusedPage: page };
+      controller.setRenderViewport(renderViewportRef.current);
+    },
+    [goToPage, controller],
+  );
+
+  const handleVisibleRangeChange = useCallback(
+    (firstVisiblePage: number, lastVisiblePage: number) => {
+      renderViewportRef.current = {
+        ...renderViewportRef.current,
+        firstVisiblePage,
+        lastVisiblePage,
+      };
+      controller.setRenderViewport(renderViewportRef.current);
     },
-    [goToPage],
+    [controller],
   );
 
   const { registerPageElement } = useCurrentPageTracker({
     pageCount,
     onPageChange: handlePageChange,
+    onVisibleRangeChange: handleVisibleRangeChange,
     root: scrollContainer,
     rootMargin: OBSERVER_CONFIG.ROOT_MARGIN,
     threshold: OBSERVER_CONFIG.VISIBILITY_THRESHOLD,
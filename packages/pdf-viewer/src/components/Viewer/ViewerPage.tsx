@@ -143,7 +143,7 @@ export const ViewerPage: React.FC<IViewerPageProps> = ({ pageIndex, registerPage
         containerEl={containerEl}
         onCommitHighlight={onCommitHighlight}
       />
-      <TextLayer pageIndex={pageIndex} scale={scale} />
+      <TextLayer pageIndex={pageIndex} scale={scale} isPageReady={pdfCanvas !== null} />
       <SignatureDialog
         open={isDialogOpen}
         onOpenChange={setIsDialogOpen}
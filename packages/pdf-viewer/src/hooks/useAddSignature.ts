@@ -6,6 +6,7 @@ export interface ISignatureData {
   pngDataUrl: string;
   pngBytes: Uint8Array;
   rgbaBytes: Uint8Array;
+  jpegBytes?: Uint8Array;
   widthPx: number;
   heightPx: number;
 }
@@ -67,6 +68,7 @@ export const useAddSignature = (pageElement: HTMLDivElement | null, pageIndex: n
       position: clickPosition,
       imageDataUrl: pendingSignature.pngDataUrl,
       imageRgbaBytes: pendingSignature.rgbaBytes,
+      imageJpegBytes: pendingSignature.jpegBytes,
       imageWidthPx: pendingSignature.widthPx,
       imageHeightPx: pendingSignature.heightPx,
       width: defaultWidth,
@@ -5,6 +5,8 @@ export interface IUseCurrentPageTrackerOptions {
   pageCount: number;
   /** Callback when current page changes */
   onPageChange: (page: number) => void;
+  /** Callback when the range of pages intersecting the viewport at all changes */
+  onVisibleRangeChange?: (firstPage: number, lastPage: number) => void;
   /** Root element for intersection observer (default: viewport) */
   root?: Element | null;
   /** Root margin for intersection observer */
@@ -17,10 +19,12 @@ export interface IUseCurrentPageTrackerOptions {
  * Hook that tracks which PDF page is currently visible in the viewport
  * using Intersection Observer. Updates currentPage as user scrolls.
  * Only pages with visibility >= 50% are considered as current page.
+ * Optionally also reports the range of pages that are visible at all.
  */
 export const useCurrentPageTracker = ({
   pageCount,
   onPageChange,
+  onVisibleRangeChange,
   root = null,
   rootMargin = '0px',
   threshold = 0.7,
@@ -28,11 +32,57 @@ export const useCurrentPageTracker = ({
   const observerRef = useRef<IntersectionObserver | null>(null);
   const pageElementsRef = useRef<Map<number, Element>>(new Map());
   const lastDetectedPageRef = useRef<number | null>(null);
+  const rangeObserverRef = useRef<IntersectionObserver | null>(null);
+  const visiblePagesRef = useRef<Set<number>>(new Set());
+  const lastRangeRef = useRef<string | null>(null);
   // Use ref for callback to avoid recreating observer when callback changes
   const onPageChangeRef = useRef(onPageChange);
+  const onVisibleRangeChangeRef = useRef(onVisibleRangeChange);
   useEffect(() => {
     onPageChangeRef.current = onPageChange;
   }, [onPageChange]);
+  useEffect(() => {
+    onVisibleRangeChangeRef.current = onVisibleRangeChange;
+  }, [onVisibleRangeChange]);
+
+  // Second observer at threshold 0: every page with any visible pixel
+  useEffect(() => {
+    rangeObserverRef.current?.disconnect();
+    visiblePagesRef.current.clear();
+    lastRangeRef.current = null;
+
+    rangeObserverRef.current = new IntersectionObserver(
+      (entries) => {
+        const visible = visiblePagesRef.current;
+        for (const entry of entries) {
+          const pageIndex = parseInt(entry.target.getAttribute('data-page-index') ?? '0', 10);
+          if (entry.isIntersecting) {
+            visible.add(pageIndex);
+          } else {
+            visible.delete(pageIndex);
+          }
+        }
+        if (visible.size === 0) return;
+
+        const first = Math.min(...visible);
+        const last = Math.max(...visible);
+        const range = `${first}:${last}`;
+        if (lastRangeRef.current !== range) {
+          lastRangeRef.current = range;
+          onVisibleRangeChangeRef.current?.(first, last);
+        }
+      },
+      { root, rootMargin, threshold: 0 },
+    );
+
+    pageElementsRef.current.forEach((element) => {
+      rangeObserverRef.current?.observe(element);
+    });
+
+    return () => {
+      rangeObserverRef.current?.disconnect();
+    };
+  }, [pageCount, root, rootMargin]);
 
   useEffect(() => {
     // Cleanup previous observer
@@ -83,10 +133,13 @@ export const useCurrentPageTracker = ({
       element.setAttribute('data-page-index', pageIndex.toString());
       pageElementsRef.current.set(pageIndex, element);
       observerRef.current?.observe(element);
+      rangeObserverRef.current?.observe(element);
     } else {
       const existing = pageElementsRef.current.get(pageIndex);
       if (existing) {
         observerRef.current?.unobserve(existing);
+        rangeObserverRef.current?.unobserve(existing);
+        visiblePagesRef.current.delete(pageIndex);
         pageElementsRef.current.delete(pageIndex);
       }
     }
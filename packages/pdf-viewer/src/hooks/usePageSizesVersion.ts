@@ -0,0 +1,31 @@
+import { useEffect, useState } from 'react';
+import { usePdfController } from '@/providers/PdfControllerContextProvider';
+
+/**
+ * Counter that goes up when pages laid out before their data arrived get their own
+ * size (a progressively loading document gives them the first page's size). Use it as
+ * a dependency of anything measuring pages; pass pageIndex to follow a single page.
+ * Announcements within one frame are coalesced into one update.
+ */
+export const usePageSizesVersion = (pageIndex?: number): number => {
+  const { controller } = usePdfController();
+  const [version, setVersion] = useState(0);
+
+  useEffect(() => {
+    let frame = 0;
+    const stop = controller.onPageSizesChanged((pageIndices) => {
+      if (pageIndex !== undefined && !pageIndices.includes(pageIndex)) return;
+      if (frame) return;
+      frame = requestAnimationFrame(() => {
+        frame = 0;
+        setVersion((v) => v + 1);
+      });
+    });
+    return () => {
+      stop();
+      if (frame) cancelAnimationFrame(frame);
+    };
+  }, [controller, pageIndex]);
+
+  return version;
+};
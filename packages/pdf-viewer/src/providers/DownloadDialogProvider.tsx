@@ -4,7 +4,7 @@ import { PasswordProtectionDialog } from '@/components/DownloadDialog/PasswordPr
 import { usePdfController } from '@/providers/PdfControllerContextProvider';
 import { useAnnotation } from '@/providers/AnnotationContextProvider';
 import { useFormContext } from '@/providers/FormContextProvider';
-import { encryptPdf } from '@/utils/pdfEncrypt';
+import { encryptPdf, toPdfPermissionBits } from '@/utils/pdfEncrypt';
 import { applyFormValues } from '@/utils/applyFormValues';
 
 interface IDownloadDialogContextValue {
@@ -57,32 +57,59 @@ export function DownloadDialogProvider({
         commitFormValues();
         commitAnnotations();
 
-        // Export the PDF bytes
-        let pdfBytes = controller.exportPdfBytes();
-
-        // Ensure form values (especially radio groups) are persisted for external viewers.
+        // Export the PDF bytes (a progressively opened file must finish arriving first)
+        await controller.whenFullyLoaded();
         const formValues = getFormValuesSnapshot();
-        if (formValues.length > 0) {
-          pdfBytes = await applyFormValues(pdfBytes, formValues);
-        }
+        const password = options.enablePassword ? options.password : undefined;
+        const permissions = options.permissions
+          ? {
+              printing: options.permissions.printing,
+              copying: options.permissions.copying,
+              modifying: options.permissions.modifying,
+              annotating: options.permissions.modifying,
+            }
+          : undefined;
+
+        // Annotation-only edits append an incremental update to the original file.
+        // Content edits get a full rewrite so removed text does not survive in an
+        // earlier revision of the file.
+        const dirty = controller.getDirtyState();
+        const incremental =
+          !password && formValues.length === 0 && dirty.pages.length > 0 && !dirty.content;
+
+        let blob: Blob;
+        if (incremental) {
+          blob = await controller.exportIncrementalPdf();
+        } else {
+          // Encrypt while PDFium saves. Form values are applied with pdf-lib, which
+          // parses the file anyway, so those documents keep the JS encryptor.
+          let pdfBytes =
+            password && formValues.length === 0
+              ? controller.exportEncryptedPdfBytes({
+                  userPassword: password,
+                  permissions: toPdfPermissionBits(permissions),
+                })
+              : null;
+
+          if (!pdfBytes) {
+            pdfBytes = controller.exportPdfBytes();
+
+            // Ensure form values (especially radio groups) are persisted for external viewers.
+            if (formValues.length > 0) {
+              pdfBytes = await applyFormValues(pdfBytes, formValues);
+            }
+
+            // If password protection is enabled, encrypt the PDF
+            if (password) {
+              pdfBytes = await encryptPdf(pdfBytes, { userPassword: password, permissions });
+            }
+          }
 
-        // If password protection is enabled, encrypt the PDF
-        if (options.enablePassword && options.password) {
-          pdfBytes = await encryptPdf(pdfBytes, {
-            userPassword: options.password,
-            permissions: options.permissions
-              ? {
-                  printing: options.permissions.printing,
-                  copying: options.permissions.copying,
-                  modifying: options.permissions.modifying,
-                  annotating: options.permissions.modifying,
-                }
-              : undefined,
-          });
+          // Create a copy with standard ArrayBuffer for Blob compatibility
+          blob = new Blob([new Uint8Array(pdfBytes)], { type: 'application/pdf' });
         }
 
-        // Trigger download - create a copy with standard ArrayBuffer for Blob compatibility
-        const blob = new Blob([new Uint8Array(pdfBytes)], { type: 'application/pdf' });
+        // Trigger download
         const url = URL.createObjectURL(blob);
         const link = document.createElement('a');
         link.href = url;
@@ -12,7 +12,7 @@ import {
 import type { ReactNode } from 'react';
 
 import type { PdfController } from '@pdfviewer/controller';
-import { PdfController as PdfControllerClass } from '@pdfviewer/controller';
+import { PdfController as PdfControllerClass, watchMemoryPressure } from '@pdfviewer/controller';
 
 /** Handler type for scrolling to a specific page index */
 export type ScrollToIndexHandler = (index: number) => void;
@@ -125,10 +125,26 @@ export function PdfControllerContextProvider({
   }, [controller, isInitialized]);
 
   useEffect(() => {
-    if (!autoInitialize) return;
-    // eslint-disable-next-line react-hooks/set-state-in-effect -- auto-initialize intentionally updates state after async init
-    void initialize();
-  }, [autoInitialize, initialize]);
+    // Start the engine once the landing page has painted; opening a file before then
+    // initializes it on demand (loadFile awaits ensureInitialized). Without
+    // autoInitialize, only fetch and compile the binary so the first open is warm.
+    const start = () => {
+      if (autoInitialize) {
+        void initialize();
+      } else {
+        void controller.preload().catch(() => undefined);
+      }
+    };
+    if (typeof requestIdleCallback === 'function') {
+      const handle = requestIdleCallback(start, { timeout: 1000 });
+      return () => cancelIdleCallback(handle);
+    }
+    const timer = setTimeout(start, 0);
+    return () => clearTimeout(timer);
+  }, [autoInitialize, controller, initialize]);
+
+  // Give cached engine memory back when the tab is hidden or frozen
+  useEffect(() => watchMemoryPressure(controller), [controller]);
 
   const value = useMemo<IPdfControllerContextValue>(
     () => ({
@@ -6,7 +6,7 @@ import { DrawButton } from '../components/ToolButtons/DrawButton';
 import { AddTextButton } from '../components/ToolButtons/AddTextButton';
 import { SignatureButton } from '../components/ToolButtons/SignatureButton';
 import { EditTextButton } from '../components/ToolButtons/EditTextButton';
-import { PrintButton } from '@/components/ToolButtons/PrintButton';
+import { usePrintButton } from '@/components/ToolButtons/PrintButton';
 import { useDownloadButton } from '@/components/ToolButtons/DownloadButton';
 import { useThemeToggleButton } from '@/components/ToolButtons/ThemeToggleButton';
 
@@ -29,5 +29,6 @@ export const useButtons = (): IToolButton[] => {
 export const useRightButtons = (): IToolButton[] => {
   const themeToggleButton = useThemeToggleButton();
   const downloadButton = useDownloadButton();
-  return [downloadButton, PrintButton(), themeToggleButton];
+  const printButton = usePrintButton();
+  return [downloadButton, printButton, themeToggleButton];
 };
@@ -1,4 +1,5 @@
 import { PDFDocument } from 'pdf-lib-with-encrypt';
+import { PDF_PERMISSION } from '@pdfviewer/pdfium-wasm';
 
 export interface IEncryptPdfOptions {
   userPassword: string;
@@ -11,9 +12,27 @@ export interface IEncryptPdfOptions {
   };
 }
 
+/**
+ * P-entry bits for the controller's native encrypted save, with the same
+ * defaults as encryptPdf (everything but modifying).
+ */
+export function toPdfPermissionBits(permissions?: IEncryptPdfOptions['permissions']): number {
+  let bits: number = PDF_PERMISSION.EXTRACT_FOR_ACCESSIBILITY;
+  if (permissions?.printing ?? true) {
+    bits |= PDF_PERMISSION.PRINT | PDF_PERMISSION.PRINT_HIGH_QUALITY;
+  }
+  if (permissions?.modifying ?? false) bits |= PDF_PERMISSION.MODIFY | PDF_PERMISSION.ASSEMBLE;
+  if (permissions?.copying ?? true) bits |= PDF_PERMISSION.COPY;
+  if (permissions?.annotating ?? true) {
+    bits |= PDF_PERMISSION.ANNOTATE | PDF_PERMISSION.FILL_FORMS;
+  }
+  return bits;
+}
+
 /**
  * Encrypts a PDF with password protection.
- * Uses RC4 128-bit encryption (widely compatible).
+ * Uses RC4 128-bit encryption (widely compatible). This reparses the whole file,
+ * so it is the fallback for when controller.exportEncryptedPdfBytes cannot be used.
  *
  * @param pdfBytes - The original PDF as a Uint8Array
  * @param options - Encryption options including passwords and permissions
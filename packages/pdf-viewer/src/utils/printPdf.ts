@@ -0,0 +1,116 @@
+import { PdfBatchPool, type IBatchOptions, type PdfController } from '@pdfviewer/controller';
+
+/**
+ * Print resolution. Every page stays in the print frame as an encoded image until the
+ * dialog closes, so this is kept low enough for long documents.
+ */
+const PRINT_DPI = 110;
+
+/** Shorter documents render on the controller faster than a pool's workers start */
+const PRINT_POOL_MIN_PAGES = 8;
+
+/**
+ * A PdfBatchPool over the source file when printing can use one: the document has no
+ * unsaved edits (the workers open the file as it was loaded) and is long enough to be
+ * worth the workers. Null otherwise, or when the pool fails to open, e.g. because the
+ * file needs a password; the controller prints then.
+ */
+async function openPrintPool(
+  controller: PdfController,
+  signal?: AbortSignal,
+): Promise<PdfBatchPool | null> {
+  const source = controller.getSourceBlob();
+  if (
+    !source ||
+    controller.getDirtyState().pages.length > 0 ||
+    controller.getPageCount() < PRINT_POOL_MIN_PAGES
+  ) {
+    return null;
+  }
+  const file =
+    source instanceof File ? source : new File([source], 'document.pdf', { type: source.type });
+  try {
+    const pool = await PdfBatchPool.open(file);
+    if (signal?.aborted || pool.pageCount !== controller.getPageCount()) {
+      pool.close();
+      return null;
+    }
+    return pool;
+  } catch (error) {
+    console.warn('Printing without worker pool:', error);
+    return null;
+  }
+}
+
+/**
+ * Print the document: every page is rendered for printing into a hidden iframe, one
+ * image per sheet at the page's physical size, and the browser's print dialog opens once
+ * all of them have loaded. A document without unsaved edits renders across a
+ * PdfBatchPool; one with edits renders on the controller, since the pool's workers open
+ * the original file. The images are left for the browser to decode as it lays out the
+ * sheets, instead of holding every page's pixels at once.
+ */
+export async function printPdf(
+  controller: PdfController,
+  opts: { dpi?: number } & IBatchOptions = {},
+): Promise<void> {
+  const { dpi = PRINT_DPI, signal, onProgress } = opts;
+  const pool = await openPrintPool(controller, signal);
+  if (signal?.aborted) return;
+  const urls: string[] = [];
+  const frame = document.createElement('iframe');
+  frame.setAttribute('aria-hidden', 'true');
+  frame.style.cssText = 'position:fixed;right:0;bottom:0;width:0;height:0;border:0';
+  document.body.appendChild(frame);
+  const cleanup = () => {
+    frame.remove();
+    for (const url of urls) URL.revokeObjectURL(url);
+  };
+
+  try {
+    const printDoc = frame.contentDocument;
+    const printWindow = frame.contentWindow;
+    if (!printDoc || !printWindow) throw new Error('Failed to create the print frame');
+    const style = printDoc.createElement('style');
+    style.textContent =
+      '@page { margin: 0 } body { margin: 0 } img { display: block; break-after: page }';
+    printDoc.head.appendChild(style);
+
+    const loaded: Promise<void>[] = [];
+    const renderOptions = { dpi, format: 'png', print: true, signal, onProgress } as const;
+    const pages = pool
+      ? pool.renderPages(undefined, renderOptions)
+      : controller.renderPages(undefined, renderOptions);
+    for await (const page of pages) {
+      if (!page.blob) continue;
+      const url = URL.createObjectURL(page.blob);
+      urls.push(url);
+      const img = printDoc.createElement('img');
+      img.decoding = 'async';
+      loaded.push(
+        new Promise<void>((resolve, reject) => {
+          img.onload = () => resolve();
+          img.onerror = () => reject(new Error('Failed to load a printed page'));
+        }),
+      );
+      img.src = url;
+      img.style.width = `${page.width / dpi}in`;
+      img.style.height = `${page.height / dpi}in`;
+      printDoc.body.appendChild(img);
+    }
+    if (signal?.aborted) {
+      cleanup();
+      return;
+    }
+    await Promise.all(loaded);
+
+    printWindow.addEventListener('afterprint', cleanup, { once: true });
+    printWindow.focus();
+    printWindow.print();
+  } catch (error) {
+    cleanup();
+    throw error;
+  } finally {
+    pool?.close();
+  }
+}
@@ -68,3 +68,45 @@ export function safeBase64Decode(base64String: string): Uint8Array | null {
     return null;
   }
 }
+
+/**
+ * Whether bytes are a JPEG that displays as stored: no EXIF orientation, or
+ * orientation 1. Browsers apply the orientation when drawing; embedding a rotated
+ * JPEG as is would show it unrotated.
+ * @param bytes - The file contents
+ */
+export function isUprightJpeg(bytes: Uint8Array): boolean {
+  if (bytes.length < 4 || bytes[0] !== 0xff || bytes[1] !== 0xd8) return false;
+  const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+  let offset = 2;
+  while (offset + 4 <= bytes.length && bytes[offset] === 0xff) {
+    const marker = bytes[offset + 1];
+    // Start of scan or end of image: no APP1 segment came first
+    if (marker === 0xda || marker === 0xd9) return true;
+    const length = view.getUint16(offset + 2);
+    const isExif =
+      marker === 0xe1 &&
+      offset + 10 <= bytes.length &&
+      view.getUint32(offset + 4) === 0x45786966 && // "Exif"
+      view.getUint16(offset + 8) === 0;
+    if (isExif) {
+      try {
+        const tiff = offset + 10;
+        const little = view.getUint16(tiff) === 0x4949; // "II"
+        const ifd = tiff + view.getUint32(tiff + 4, little);
+        const entries = view.getUint16(ifd, little);
+        for (let i = 0; i < entries; i++) {
+          const entry = ifd + 2 + i * 12;
+          if (view.getUint16(entry, little) === 0x0112) {
+            return view.getUint16(entry + 8, little) === 1;
+          }
+        }
+      } catch {
+        // Truncated EXIF: the browser ignores it too
+      }
+      return true;
+    }
+    offset += 2 + length;
+  }
+  return true;
+}
@@ -37,5 +37,7 @@ Write-Host "`nBuild complete!" -ForegroundColor Green
 Write-Host "Output files are in: $WasmDir" -ForegroundColor Cyan
 Write-Host "  - pdfium.js    (JavaScript loader)"
 Write-Host "  - pdfium.wasm  (WebAssembly binary)"
+Write-Host "  - pdfium-simd.{js,wasm}, pdfium-lite.{js,wasm} (SIMD and -Oz variants)"
+Write-Host "  - pdfium-builds.js (manifest of the variants built)"
 Write-Host ""
 Write-Host "Note: TypeScript types are defined in src/index.ts (IPDFiumModule interface)"
@@ -75,10 +75,38 @@ echo "Creating symlink for Emscripten SDK..."
 mkdir -p /build/pdfium_src/pdfium/third_party/emsdk
 ln -sf /build/emsdk/upstream /build/pdfium_src/pdfium/third_party/emsdk/upstream
 
+# Build variants. Each gets its own GN out dir, so switching flags never
+# mixes object files, and its own loader + binary in /build/output:
+#   default  -O3, scalar           pdfium.js      / pdfium.wasm
+#   simd     -O3, -msimd128        pdfium-simd.js / pdfium-simd.wasm
+#   lite     -Oz, scalar           pdfium-lite.js / pdfium-lite.wasm
+# The TS loader picks SIMD when the browser validates a v128 module, lite on
+# constrained connections, and falls back to default otherwise.
+# Override with e.g. PDFIUM_VARIANTS="default" for a quick single build.
+PDFIUM_VARIANTS="${PDFIUM_VARIANTS:-default simd lite}"
+
+# GN out dir and extra compiler flags of a variant. The flags reach every em++
+# invocation ninja makes through EMCC_CFLAGS, which Emscripten appends last,
+# so -Oz overrides the optimization level GN passes.
+variant_out_dir() {
+    case "$1" in
+        default) echo "out/Release" ;;
+        *)       echo "out/Release-$1" ;;
+    esac
+}
+variant_cflags() {
+    case "$1" in
+        simd) echo "-msimd128" ;;
+        lite) echo "-Oz" ;;
+        *)    echo "" ;;
+    esac
+}
+
 # Configure PDFium to build with Emscripten toolchain targeting WebAssembly
-mkdir -p out/Release
+write_args_gn() {
+mkdir -p "$1"
 
-cat > out/Release/args.gn << 'EOF'
+cat > "$1/args.gn" << 'EOF'
 # PDFium WebAssembly Build Configuration using Emscripten
 pdf_enable_v8 = false
 pdf_enable_xfa = false
@@ -110,14 +138,23 @@ use_allocator_shim = false
 use_allocator = "none"
 is_official_build = true
 EOF
+}
 
-echo "Generating build files with GN for WebAssembly target..."
-gn gen out/Release
+for VARIANT in $PDFIUM_VARIANTS; do
+    OUT_DIR="$(variant_out_dir "$VARIANT")"
+    write_args_gn "$OUT_DIR"
+    echo "Generating build files with GN for WebAssembly target ($VARIANT)..."
+    gn gen "$OUT_DIR"
+done
 
 echo ""
 echo "Step 2: Building PDFium static library with Emscripten..."
 echo "=========================================="
-ninja -C out/Release pdfium
+for VARIANT in $PDFIUM_VARIANTS; do
+    OUT_DIR="$(variant_out_dir "$VARIANT")"
+    echo "Building $VARIANT ($OUT_DIR, extra flags: '$(variant_cflags "$VARIANT")')..."
+    EMCC_CFLAGS="$(variant_cflags "$VARIANT")" ninja -C "$OUT_DIR" pdfium
+done
 
 echo ""
 echo "Step 3: Preparing WASM wrapper for Emscripten compilation..."
@@ -135,23 +172,37 @@ echo "=========================================="
 # Find all static libraries from the PDFium build
 cd /build/pdfium_src/pdfium
 
+link_variant() {
+local VARIANT="$1"
+local OUT_DIR
+OUT_DIR="$(variant_out_dir "$VARIANT")"
+
 # The main pdfium library (already a complete static lib)
-PDFIUM_LIB="out/Release/obj/libpdfium.a"
+local PDFIUM_LIB="$OUT_DIR/obj/libpdfium.a"
 
 # Check if the library exists
 if [ ! -f "$PDFIUM_LIB" ]; then
     echo "Error: $PDFIUM_LIB not found!"
     echo "Looking for available libraries..."
-    find out/Release -name "*.a" -type f 2>/dev/null | head -20
+    find "$OUT_DIR" -name "*.a" -type f 2>/dev/null | head -20
     exit 1
 fi
 
+# Optimization level and ISA of the wrapper and the LTO link
+local OPT_FLAGS OUTPUT_NAME
+case "$VARIANT" in
+    simd) OPT_FLAGS="-O3 -msimd128"; OUTPUT_NAME="pdfium-simd" ;;
+    lite) OPT_FLAGS="-Oz"; OUTPUT_NAME="pdfium-lite" ;;
+    *)    OPT_FLAGS="-O3"; OUTPUT_NAME="pdfium" ;;
+esac
+
 echo "Using PDFium library: $PDFIUM_LIB"
 
-echo "Running em++..."
+echo "Running em++ ($VARIANT: $OPT_FLAGS)..."
+# shellcheck disable=SC2086
 em++ \
     -std=c++17 \
-    -O3 \
+    $OPT_FLAGS \
     -flto \
     -s WASM=1 \
     -s MODULARIZE=1 \
@@ -174,7 +225,27 @@ em++ \
     -I/build/pdfium_src/pdfium/third_party/abseil-cpp \
     /build/wasm_build/pdfium_wasm.cpp \
     "$PDFIUM_LIB" \
-    -o /build/output/pdfium.js
+    -o "/build/output/$OUTPUT_NAME.js"
+}
+
+for VARIANT in $PDFIUM_VARIANTS; do
+    link_variant "$VARIANT"
+done
+
+# Manifest of the variants built, so the TS loader's 'auto' only picks binaries
+# that exist instead of fetching a missing one and falling back
+SHIPPED_BUILDS=""
+for VARIANT in $PDFIUM_VARIANTS; do
+    case "$VARIANT" in
+        default) BUILD_NAME="scalar" ;;
+        *)       BUILD_NAME="$VARIANT" ;;
+    esac
+    SHIPPED_BUILDS="${SHIPPED_BUILDS:+$SHIPPED_BUILDS, }'$BUILD_NAME'"
+done
+cat > /build/output/pdfium-builds.js << EOF
+// Generated by build/compile.sh: the PDFIUM_BUILD variants present in this directory
+export default [$SHIPPED_BUILDS];
+EOF
 
 
 # Copy output files
@@ -188,6 +259,8 @@ echo "Build completed successfully!"
 echo "Output files are in /build/output/"
 echo "  - pdfium.js    (JavaScript loader)"
 echo "  - pdfium.wasm  (WebAssembly binary)"
+echo "  - pdfium-simd.{js,wasm}, pdfium-lite.{js,wasm} (variants, see PDFIUM_VARIANTS)"
+echo "  - pdfium-builds.js (manifest of the variants built)"
 echo ""
 echo "Note: TypeScript types are defined in src/index.ts (IPDFiumModule interface)"
 echo ""
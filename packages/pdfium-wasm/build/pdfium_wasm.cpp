@@ -4,9 +4,25 @@
  */
 
 #include <emscripten.h>
+#include <emscripten/heap.h>
+#include <malloc.h>
+#include <unistd.h>
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+#include <algorithm>
+#include <cctype>
+#include <cmath>
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 // PDFium headers
@@ -18,6 +34,8 @@
 #include "public/fpdf_annot.h"
 #include "public/fpdf_formfill.h"
 #include "public/fpdf_progressive.h"
+#include "public/fpdf_dataavail.h"
+#include "public/fpdf_thumbnail.h"
 
 // Platform interface stub for WASM - CFX_GEModule requires a platform implementation
 #include "core/fxge/cfx_gemodule.h"
@@ -70,6 +88,168 @@ static WasmPauseHandler g_pauseHandler;
 
 extern "C" {
 
+// ============================================================================
+// Performance Counters - Opt-in timing and heap use of the heavy entry points
+// ============================================================================
+// Off until PDFium_SetPerfEnabled(1). Each counted call records its duration
+// (emscripten_get_now) in a log-scale histogram of kPerfBuckets buckets, so
+// p50/p99 need no per-sample storage, and how far it moved the allocator's
+// heap break (sbrk(0)), i.e. linear memory newly claimed during the call.
+// Counted calls nest: pages loaded by a render count for both. Progressive
+// render slices (start, continue, async pump) are kPerfRenderSlice calls and
+// one-shot renders kPerfRender calls.
+// Counter layout (all fields float64):
+//   header[8]         counterCount, enabled, heapUsed, heapBreakPeak,
+//                     heapSize, heapMax, 0, 0
+//   counter[8] each   calls, totalMs, p50Ms, p99Ms, maxMs, heapGrowthBytes, 0, 0
+// heapUsed is the allocator's in-use bytes (mallinfo), heapSize the current
+// linear memory size and heapMax its MAXIMUM_MEMORY limit.
+
+enum PerfCounter {
+    kPerfLoadDocument,
+    kPerfLoadPage,
+    kPerfLoadTextPage,
+    kPerfRender,
+    kPerfRenderSlice,
+    kPerfSearch,
+    kPerfSave,
+    kPerfCounterCount
+};
+
+static const int kPerfHeaderFields = 8;
+static const int kPerfCounterFields = 8;
+
+// Bucket b holds durations up to kPerfBucketBaseMs * 2^(b / 4); the last one
+// also holds everything longer (~9 s and up)
+static const int kPerfBuckets = 80;
+static const int kPerfBucketsPerOctave = 4;
+static const double kPerfBucketBaseMs = 0.01;
+
+struct PerfStats {
+    uint32_t calls = 0;
+    double totalMs = 0;
+    double maxMs = 0;
+    double heapGrowth = 0;
+    uint32_t buckets[kPerfBuckets] = {};
+};
+
+static bool g_perfEnabled = false;
+static PerfStats g_perfStats[kPerfCounterCount];
+static uintptr_t g_perfBreakPeak = 0;
+
+static uintptr_t HeapBreak() {
+    return reinterpret_cast<uintptr_t>(sbrk(0));
+}
+
+static void PerfRecord(int counter, double ms, uintptr_t startBreak) {
+    PerfStats& stats = g_perfStats[counter];
+    ++stats.calls;
+    stats.totalMs += ms;
+    stats.maxMs = std::max(stats.maxMs, ms);
+    uintptr_t end = HeapBreak();
+    if (end > startBreak) {
+        stats.heapGrowth += static_cast<double>(end - startBreak);
+    }
+    g_perfBreakPeak = std::max(g_perfBreakPeak, end);
+    int bucket = 0;
+    if (ms > kPerfBucketBaseMs) {
+        bucket = static_cast<int>(
+            std::ceil(std::log2(ms / kPerfBucketBaseMs) * kPerfBucketsPerOctave));
+    }
+    ++stats.buckets[std::min(kPerfBuckets - 1, std::max(0, bucket))];
+}
+
+// Upper bound of the bucket holding quantile q, capped at the longest call
+static double PerfQuantile(const PerfStats& stats, double q) {
+    if (stats.calls == 0) {
+        return 0;
+    }
+    uint32_t rank = std::max<uint32_t>(1, static_cast<uint32_t>(std::ceil(q * stats.calls)));
+    uint32_t seen = 0;
+    for (int b = 0; b < kPerfBuckets; ++b) {
+        seen += stats.buckets[b];
+        if (seen >= rank) {
+            double upper = kPerfBucketBaseMs *
+                           std::exp2(static_cast<double>(b) / kPerfBucketsPerOctave);
+            return std::min(upper, stats.maxMs);
+        }
+    }
+    return stats.maxMs;
+}
+
+// Counts the enclosing block as one call of a counter while enabled
+struct PerfScope {
+    int counter;
+    double start = 0;
+    uintptr_t startBreak = 0;
+
+    explicit PerfScope(int c) : counter(g_perfEnabled ? c : -1) {
+        if (counter >= 0) {
+            start = emscripten_get_now();
+            startBreak = HeapBreak();
+        }
+    }
+    ~PerfScope() {
+        if (counter >= 0) {
+            PerfRecord(counter, emscripten_get_now() - start, startBreak);
+        }
+    }
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+};
+
+static FPDF_PAGE LoadPageCounted(FPDF_DOCUMENT doc, int pageIndex) {
+    PerfScope perf(kPerfLoadPage);
+    return FPDF_LoadPage(doc, pageIndex);
+}
+
+static FPDF_TEXTPAGE LoadTextPageCounted(FPDF_PAGE page) {
+    PerfScope perf(kPerfLoadTextPage);
+    return FPDFText_LoadPage(page);
+}
+
+EMSCRIPTEN_KEEPALIVE
+void PDFium_SetPerfEnabled(int enabled) {
+    g_perfEnabled = enabled != 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void PDFium_ResetPerfCounters() {
+    for (PerfStats& stats : g_perfStats) {
+        stats = PerfStats();
+    }
+    g_perfBreakPeak = HeapBreak();
+}
+
+// Write the counters to out (see the layout above). Returns the number of
+// float64 values written, or needed when out is null.
+EMSCRIPTEN_KEEPALIVE
+int PDFium_GetPerfCounters(double* out) {
+    const int total = kPerfHeaderFields + kPerfCounterCount * kPerfCounterFields;
+    if (!out) {
+        return total;
+    }
+    std::fill(out, out + total, 0.0);
+    g_perfBreakPeak = std::max(g_perfBreakPeak, HeapBreak());
+    out[0] = kPerfCounterCount;
+    out[1] = g_perfEnabled ? 1 : 0;
+    out[2] = static_cast<double>(mallinfo().uordblks);
+    out[3] = static_cast<double>(g_perfBreakPeak);
+    out[4] = static_cast<double>(emscripten_get_heap_size());
+    out[5] = static_cast<double>(emscripten_get_heap_max());
+    for (int c = 0; c < kPerfCounterCount; ++c) {
+        const PerfStats& stats = g_perfStats[c];
+        double* row = out + kPerfHeaderFields + c * kPerfCounterFields;
+        row[0] = stats.calls;
+        row[1] = stats.totalMs;
+        row[2] = PerfQuantile(stats, 0.5);
+        row[3] = PerfQuantile(stats, 0.99);
+        row[4] = stats.maxMs;
+        row[5] = stats.heapGrowth;
+    }
+    return total;
+}
+
 EMSCRIPTEN_KEEPALIVE
 int PDFium_Init() {
     if (g_libraryInitialized) {
@@ -98,6 +278,7 @@ void PDFium_Destroy() {
 
 EMSCRIPTEN_KEEPALIVE
 FPDF_DOCUMENT PDFium_LoadMemDocument(const uint8_t* data, int size, const char* password) {
+    PerfScope perf(kPerfLoadDocument);
     return FPDF_LoadMemDocument(data, size, password);
 }
 
@@ -115,7 +296,7 @@ int PDFium_GetPageCount(FPDF_DOCUMENT doc) {
 
 EMSCRIPTEN_KEEPALIVE
 FPDF_PAGE PDFium_LoadPage(FPDF_DOCUMENT doc, int pageIndex) {
-    return FPDF_LoadPage(doc, pageIndex);
+    return LoadPageCounted(doc, pageIndex);
 }
 
 EMSCRIPTEN_KEEPALIVE
@@ -160,9 +341,287 @@ void PDFium_DeviceToPage(FPDF_PAGE page,
 EMSCRIPTEN_KEEPALIVE
 void PDFium_RenderPageBitmap(FPDF_BITMAP bitmap, FPDF_PAGE page, int start_x, int start_y,
                               int size_x, int size_y, int rotate, int flags) {
+    PerfScope perf(kPerfRender);
     FPDF_RenderPageBitmap(bitmap, page, start_x, start_y, size_x, size_y, rotate, flags);
 }
 
+// ============================================================================
+// Progressive Loading - FPDF_FILEACCESS backed by on-demand blocks
+// ============================================================================
+// Instead of copying the whole file into the heap before FPDF_LoadMemDocument,
+// a FileLoader keeps a sparse table of fixed-size chunks that JavaScript
+// supplies as they arrive (Blob.slice or HTTP Range). PDFium reads through
+// FPDF_FILEACCESS, and FPDFAvail reports through FX_DOWNLOADHINTS which
+// ranges it needs next, so a linearized file can open and render its first
+// page before the rest is downloaded. Each byte lives in the heap once.
+//
+// JS loop: check PDFium_LoaderIsDocAvail / IsPageAvail; while NOTAVAIL, fetch
+// the ranges from PDFium_LoaderTakeRequests, PDFium_LoaderSupply them, retry.
+
+struct FileLoader;
+
+struct LoaderFileAvail : FX_FILEAVAIL {
+    FileLoader* loader;
+};
+
+struct LoaderDownloadHints : FX_DOWNLOADHINTS {
+    FileLoader* loader;
+};
+
+struct FileLoader {
+    FPDF_FILEACCESS access;
+    LoaderFileAvail fileAvail;
+    LoaderDownloadHints hints;
+    FPDF_AVAIL avail = nullptr;
+    size_t fileLength = 0;
+    size_t chunkSize = 0;
+    std::vector<uint8_t*> chunks;   // nullptr until supplied
+    size_t chunksLoaded = 0;
+    std::vector<size_t> requested;  // chunk indices PDFium asked for, not yet taken
+
+    size_t ChunkBytes(size_t chunk) const {
+        size_t start = chunk * chunkSize;
+        return (start + chunkSize <= fileLength) ? chunkSize : fileLength - start;
+    }
+
+    bool HasRange(size_t offset, size_t size) const {
+        if (size == 0) {
+            return offset <= fileLength;
+        }
+        if (offset >= fileLength || size > fileLength - offset) {
+            return false;
+        }
+        for (size_t c = offset / chunkSize; c <= (offset + size - 1) / chunkSize; ++c) {
+            if (!chunks[c]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void RequestRange(size_t offset, size_t size) {
+        if (offset >= fileLength) {
+            return;
+        }
+        if (size == 0 || size > fileLength - offset) {
+            size = fileLength - offset;
+        }
+        for (size_t c = offset / chunkSize; c <= (offset + size - 1) / chunkSize; ++c) {
+            if (!chunks[c]) {
+                requested.push_back(c);
+            }
+        }
+    }
+
+    static FPDF_BOOL IsDataAvail(FX_FILEAVAIL* pThis, size_t offset, size_t size) {
+        return static_cast<LoaderFileAvail*>(pThis)->loader->HasRange(offset, size) ? 1 : 0;
+    }
+
+    static void AddSegment(FX_DOWNLOADHINTS* pThis, size_t offset, size_t size) {
+        static_cast<LoaderDownloadHints*>(pThis)->loader->RequestRange(offset, size);
+    }
+
+    static int GetBlock(void* param, unsigned long position, unsigned char* pBuf,
+                        unsigned long size) {
+        FileLoader* self = static_cast<FileLoader*>(param);
+        if (!self->HasRange(position, size)) {
+            // Record the miss so the next TakeRequests fetches it
+            self->RequestRange(position, size);
+            return 0;
+        }
+        size_t offset = position;
+        size_t end = offset + size;
+        while (offset < end) {
+            size_t chunk = offset / self->chunkSize;
+            size_t within = offset - chunk * self->chunkSize;
+            size_t n = self->ChunkBytes(chunk) - within;
+            if (n > end - offset) {
+                n = end - offset;
+            }
+            memcpy(pBuf, self->chunks[chunk] + within, n);
+            pBuf += n;
+            offset += n;
+        }
+        return 1;
+    }
+};
+
+// Create a loader for a file of fileLength bytes, stored in chunkSize blocks
+// (<= 0 = 64 KiB). Destroy it only after closing the document it loaded.
+EMSCRIPTEN_KEEPALIVE
+FileLoader* PDFium_LoaderCreate(unsigned long fileLength, int chunkSize) {
+    if (fileLength == 0) {
+        return nullptr;
+    }
+    FileLoader* loader = new FileLoader();
+    loader->fileLength = fileLength;
+    loader->chunkSize = chunkSize > 0 ? static_cast<size_t>(chunkSize) : 64 * 1024;
+    loader->chunks.assign((loader->fileLength + loader->chunkSize - 1) / loader->chunkSize,
+                          nullptr);
+
+    loader->access.m_FileLen = fileLength;
+    loader->access.m_GetBlock = &FileLoader::GetBlock;
+    loader->access.m_Param = loader;
+    loader->fileAvail.version = 1;
+    loader->fileAvail.IsDataAvail = &FileLoader::IsDataAvail;
+    loader->fileAvail.loader = loader;
+    loader->hints.version = 1;
+    loader->hints.AddSegment = &FileLoader::AddSegment;
+    loader->hints.loader = loader;
+
+    loader->avail = FPDFAvail_Create(&loader->fileAvail, &loader->access);
+    if (!loader->avail) {
+        delete loader;
+        return nullptr;
+    }
+    return loader;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void PDFium_LoaderDestroy(FileLoader* loader) {
+    if (!loader) {
+        return;
+    }
+    FPDFAvail_Destroy(loader->avail);
+    for (uint8_t* chunk : loader->chunks) {
+        free(chunk);
+    }
+    delete loader;
+}
+
+// Supply file bytes [offset, offset + size). offset must be chunk-aligned;
+// only whole chunks (or the final partial one) are kept, already-present
+// chunks are skipped. Returns the number of bytes stored, or -1 on error.
+EMSCRIPTEN_KEEPALIVE
+int PDFium_LoaderSupply(FileLoader* loader, unsigned long offset, const uint8_t* data,
+                        unsigned long size) {
+    if (!loader || !data || offset % loader->chunkSize != 0 || offset >= loader->fileLength) {
+        return -1;
+    }
+    int stored = 0;
+    for (size_t c = offset / loader->chunkSize; c < loader->chunks.size(); ++c) {
+        size_t start = c * loader->chunkSize - offset;
+        size_t bytes = loader->ChunkBytes(c);
+        if (start + bytes > size) {
+            break;
+        }
+        if (!loader->chunks[c]) {
+            uint8_t* chunk = static_cast<uint8_t*>(malloc(bytes));
+            if (!chunk) {
+                return -1;
+            }
+            memcpy(chunk, data + start, bytes);
+            loader->chunks[c] = chunk;
+            loader->chunksLoaded++;
+            stored += static_cast<int>(bytes);
+        }
+    }
+    return stored;
+}
+
+// Hand out the ranges PDFium asked for since the last call, merged into
+// chunk-aligned (offset, size) pairs written to out[2 * maxRanges]. Returns
+// the number of ranges; requests that did not fit stay queued.
+EMSCRIPTEN_KEEPALIVE
+int PDFium_LoaderTakeRequests(FileLoader* loader, uint32_t* out, int maxRanges) {
+    if (!loader || !out || maxRanges <= 0) {
+        return 0;
+    }
+    std::vector<size_t>& requested = loader->requested;
+    std::sort(requested.begin(), requested.end());
+    requested.erase(std::unique(requested.begin(), requested.end()), requested.end());
+
+    int ranges = 0;
+    size_t i = 0;
+    while (i < requested.size() && ranges < maxRanges) {
+        size_t first = requested[i];
+        size_t last = first;
+        while (++i < requested.size() && requested[i] == last + 1) {
+            last = requested[i];
+        }
+        if (loader->chunks[first] && first == last) {
+            continue;  // supplied since it was requested
+        }
+        out[ranges * 2] = static_cast<uint32_t>(first * loader->chunkSize);
+        out[ranges * 2 + 1] = static_cast<uint32_t>(last * loader->chunkSize +
+                                                     loader->ChunkBytes(last) -
+                                                     first * loader->chunkSize);
+        ranges++;
+    }
+    requested.erase(requested.begin(), requested.begin() + i);
+    return ranges;
+}
+
+// Find the first missing range at or after `from`, up to maxBytes long, for
+// background prefetching. Writes (offset, size) to out[2]; returns 0 when
+// every byte from `from` on is present.
+EMSCRIPTEN_KEEPALIVE
+int PDFium_LoaderNextMissing(FileLoader* loader, unsigned long from, unsigned long maxBytes,
+                             uint32_t* out) {
+    if (!loader || !out) {
+        return 0;
+    }
+    size_t maxChunks = maxBytes / loader->chunkSize;
+    if (maxChunks == 0) {
+        maxChunks = 1;
+    }
+    for (size_t c = from / loader->chunkSize; c < loader->chunks.size(); ++c) {
+        if (loader->chunks[c]) {
+            continue;
+        }
+        size_t last = c;
+        while (last + 1 < loader->chunks.size() && !loader->chunks[last + 1] &&
+               last + 1 - c < maxChunks) {
+            last++;
+        }
+        out[0] = static_cast<uint32_t>(c * loader->chunkSize);
+        out[1] = static_cast<uint32_t>(last * loader->chunkSize + loader->ChunkBytes(last) -
+                                       c * loader->chunkSize);
+        return 1;
+    }
+    return 0;
+}
+
+// 1 once every byte of the file has been supplied
+EMSCRIPTEN_KEEPALIVE
+int PDFium_LoaderIsComplete(FileLoader* loader) {
+    return (loader && loader->chunksLoaded == loader->chunks.size()) ? 1 : 0;
+}
+
+// PDF_LINEARIZED (1), PDF_NOT_LINEARIZED (0) or PDF_LINEARIZATION_UNKNOWN (-1,
+// until the first 1 KiB has arrived)
+EMSCRIPTEN_KEEPALIVE
+int PDFium_LoaderIsLinearized(FileLoader* loader) {
+    return loader ? FPDFAvail_IsLinearized(loader->avail) : PDF_LINEARIZATION_UNKNOWN;
+}
+
+// PDF_DATA_AVAIL (1) once the document can be opened, PDF_DATA_NOTAVAIL (0)
+// while more data is needed (see PDFium_LoaderTakeRequests), PDF_DATA_ERROR (-1)
+EMSCRIPTEN_KEEPALIVE
+int PDFium_LoaderIsDocAvail(FileLoader* loader) {
+    return loader ? FPDFAvail_IsDocAvail(loader->avail, &loader->hints) : PDF_DATA_ERROR;
+}
+
+// Open the document once PDFium_LoaderIsDocAvail returned PDF_DATA_AVAIL
+EMSCRIPTEN_KEEPALIVE
+FPDF_DOCUMENT PDFium_LoaderGetDocument(FileLoader* loader, const char* password) {
+    PerfScope perf(kPerfLoadDocument);
+    return loader ? FPDFAvail_GetDocument(loader->avail, password) : nullptr;
+}
+
+// First page available in a linearized file (0 otherwise)
+EMSCRIPTEN_KEEPALIVE
+int PDFium_LoaderGetFirstPageNum(FPDF_DOCUMENT doc) {
+    return doc ? FPDFAvail_GetFirstPageNum(doc) : 0;
+}
+
+// Same status values as PDFium_LoaderIsDocAvail, for one page
+EMSCRIPTEN_KEEPALIVE
+int PDFium_LoaderIsPageAvail(FileLoader* loader, int pageIndex) {
+    return loader ? FPDFAvail_IsPageAvail(loader->avail, pageIndex, &loader->hints)
+                  : PDF_DATA_ERROR;
+}
+
 // ============================================================================
 // Progressive Rendering API - Interruptible page rendering
 // ============================================================================
@@ -192,6 +651,7 @@ int PDFium_RenderPageBitmap_Start(FPDF_BITMAP bitmap, FPDF_PAGE page,
                                    int start_x, int start_y,
                                    int size_x, int size_y,
                                    int rotate, int flags) {
+    PerfScope perf(kPerfRenderSlice);
     // Reset cancel flag at start of render
     g_renderCancelFlag = false;
 
@@ -206,6 +666,7 @@ int PDFium_RenderPageBitmap_Start(FPDF_BITMAP bitmap, FPDF_PAGE page,
 // Returns: CYCLIC (1) = needs continue, DONE (2) = finished, TOBECONTINUED (3) = paused, FAILED (4) = error
 EMSCRIPTEN_KEEPALIVE
 int PDFium_RenderPage_Continue(FPDF_PAGE page) {
+    PerfScope perf(kPerfRenderSlice);
     return FPDF_RenderPage_Continue(page, &g_pauseHandler);
 }
 
@@ -216,161 +677,2008 @@ void PDFium_RenderPage_Close(FPDF_PAGE page) {
     FPDF_RenderPage_Close(page);
 }
 
+// ============================================================================
+// Render Jobs - Per-render cancel flag and time budget
+// ============================================================================
+// A render job is a pause handler owned by one render, so overlapping
+// progressive renders no longer cancel or un-cancel each other through
+// g_renderCancelFlag. With a non-zero budget, PDFium is asked to pause once
+// the slice has run for budgetMs (measured with emscripten_get_now), so each
+// Start/Continue call fits inside a frame.
+struct RenderJob : IFSDK_PAUSE {
+    volatile bool cancelled = false;
+    double budgetMs = 0;
+    double deadline = 0;
+
+    RenderJob() {
+        version = 1;
+        NeedToPauseNow = &RenderJob::CheckPause;
+        user = nullptr;
+    }
+
+    // Start a new slice; a zero budget means "only pause when cancelled"
+    void BeginSlice() {
+        deadline = budgetMs > 0 ? emscripten_get_now() + budgetMs : 0;
+    }
+
+    static FPDF_BOOL CheckPause(IFSDK_PAUSE* pThis) {
+        RenderJob* self = static_cast<RenderJob*>(pThis);
+        if (self->cancelled) {
+            return 1;
+        }
+        return (self->deadline > 0 && emscripten_get_now() >= self->deadline) ? 1 : 0;
+    }
+};
+
+// Create a render job. budgetMs <= 0 disables the time budget.
 EMSCRIPTEN_KEEPALIVE
-FPDF_BITMAP PDFium_BitmapCreate(int width, int height, int alpha) {
-    return FPDFBitmap_Create(width, height, alpha);
+RenderJob* PDFium_RenderJobCreate(double budgetMs) {
+    RenderJob* job = new RenderJob();
+    job->budgetMs = budgetMs > 0 ? budgetMs : 0;
+    return job;
 }
 
+// Change the per-slice time budget of a job
 EMSCRIPTEN_KEEPALIVE
-void PDFium_BitmapDestroy(FPDF_BITMAP bitmap) {
-    if (bitmap) {
-        FPDFBitmap_Destroy(bitmap);
+void PDFium_RenderJobSetBudget(RenderJob* job, double budgetMs) {
+    if (job) {
+        job->budgetMs = budgetMs > 0 ? budgetMs : 0;
     }
 }
 
+// Request cancellation; the render stops at its next pause point
 EMSCRIPTEN_KEEPALIVE
-void PDFium_BitmapFillRect(FPDF_BITMAP bitmap, int left, int top, int width, int height, unsigned long color) {
-    FPDFBitmap_FillRect(bitmap, left, top, width, height, color);
+void PDFium_RenderJobCancel(RenderJob* job) {
+    if (job) {
+        job->cancelled = true;
+    }
 }
 
 EMSCRIPTEN_KEEPALIVE
-void* PDFium_BitmapGetBuffer(FPDF_BITMAP bitmap) {
-    return FPDFBitmap_GetBuffer(bitmap);
+int PDFium_RenderJobIsCancelled(RenderJob* job) {
+    return (job && job->cancelled) ? 1 : 0;
 }
 
+// Start a progressive render controlled by `job`
+// Returns FPDF_RENDER_TOBECONTINUED (1), FPDF_RENDER_DONE (2) or FPDF_RENDER_FAILED (3)
 EMSCRIPTEN_KEEPALIVE
-int PDFium_BitmapGetStride(FPDF_BITMAP bitmap) {
-    return FPDFBitmap_GetStride(bitmap);
+int PDFium_RenderJobStart(RenderJob* job, FPDF_BITMAP bitmap, FPDF_PAGE page,
+                          int start_x, int start_y,
+                          int size_x, int size_y,
+                          int rotate, int flags) {
+    PerfScope perf(kPerfRenderSlice);
+    if (!job) {
+        return FPDF_RENDER_FAILED;
+    }
+    job->BeginSlice();
+    return FPDF_RenderPageBitmap_Start(
+        bitmap, page, start_x, start_y, size_x, size_y, rotate, flags, job);
 }
 
+// Continue a render started with PDFium_RenderJobStart for one more slice
 EMSCRIPTEN_KEEPALIVE
-void PDFium_FreeBuffer(void* buffer) {
-    if (buffer) {
-        free(buffer);
+int PDFium_RenderJobContinue(RenderJob* job, FPDF_PAGE page) {
+    PerfScope perf(kPerfRenderSlice);
+    if (!job) {
+        return FPDF_RENDER_FAILED;
     }
+    job->BeginSlice();
+    return FPDF_RenderPage_Continue(page, job);
 }
 
+// Destroy a job. Close the page's render with PDFium_RenderPage_Close first.
 EMSCRIPTEN_KEEPALIVE
-FPDF_TEXTPAGE PDFium_LoadPageText(FPDF_PAGE page) {
-    return FPDFText_LoadPage(page);
+void PDFium_RenderJobDestroy(RenderJob* job) {
+    delete job;
 }
 
 EMSCRIPTEN_KEEPALIVE
-void PDFium_ClosePageText(FPDF_TEXTPAGE textPage) {
-    if (textPage) {
-        FPDFText_ClosePage(textPage);
-    }
+FPDF_BITMAP PDFium_BitmapCreate(int width, int height, int alpha) {
+    return FPDFBitmap_Create(width, height, alpha);
 }
 
 EMSCRIPTEN_KEEPALIVE
-int PDFium_GetPageCharCount(FPDF_TEXTPAGE textPage) {
-    return FPDFText_CountChars(textPage);
+void PDFium_BitmapDestroy(FPDF_BITMAP bitmap) {
+    if (bitmap) {
+        FPDFBitmap_Destroy(bitmap);
+    }
 }
 
 EMSCRIPTEN_KEEPALIVE
-int PDFium_GetPageText(FPDF_TEXTPAGE textPage, unsigned short* buffer, int bufferLen) {
-    int charCount = FPDFText_CountChars(textPage);
-    return FPDFText_GetText(textPage, 0, charCount, buffer);
+void PDFium_BitmapFillRect(FPDF_BITMAP bitmap, int left, int top, int width, int height, unsigned long color) {
+    FPDFBitmap_FillRect(bitmap, left, top, width, height, color);
 }
 
-// ============================================================================
-// Text Layer API - Character positioning, selection, and search
-// ============================================================================
-
-// Get the bounding box of a character
 EMSCRIPTEN_KEEPALIVE
-FPDF_BOOL PDFium_GetCharBox(FPDF_TEXTPAGE textPage, int charIndex,
-                             double* left, double* right,
-                             double* bottom, double* top) {
-    return FPDFText_GetCharBox(textPage, charIndex, left, right, bottom, top);
+void* PDFium_BitmapGetBuffer(FPDF_BITMAP bitmap) {
+    return FPDFBitmap_GetBuffer(bitmap);
 }
 
-// Get the origin point of a character
 EMSCRIPTEN_KEEPALIVE
-FPDF_BOOL PDFium_GetCharOrigin(FPDF_TEXTPAGE textPage, int charIndex,
-                                double* x, double* y) {
-    return FPDFText_GetCharOrigin(textPage, charIndex, x, y);
+int PDFium_BitmapGetStride(FPDF_BITMAP bitmap) {
+    return FPDFBitmap_GetStride(bitmap);
 }
 
-// Get the Unicode value of a character
-EMSCRIPTEN_KEEPALIVE
-unsigned int PDFium_GetUnicode(FPDF_TEXTPAGE textPage, int charIndex) {
-    return FPDFText_GetUnicode(textPage, charIndex);
+// ============================================================================
+// Bitmap Buffer Pool
+// ============================================================================
+// Render buffers are recycled instead of being malloc'd and freed on every
+// frame, which fragments the heap while zooming or scrolling. Requests are
+// rounded up to size buckets (1/8 of the enclosing power of two) so slightly
+// different canvas sizes still share buffers. Idle buffers are kept until
+// their total exceeds the retain limit; any buffer handed back beyond that is
+// freed immediately.
+
+struct PoolBuffer {
+    uint8_t* data;
+    size_t capacity;
+    bool inUse;
+};
+
+static std::vector<PoolBuffer> g_bufferPool;
+static size_t g_poolRetainLimit = 64 * 1024 * 1024;
+static size_t g_poolIdleBytes = 0;
+static size_t g_poolInUseBytes = 0;
+static uint32_t g_poolHits = 0;
+static uint32_t g_poolMisses = 0;
+
+static const size_t kPoolMinBucket = 64 * 1024;
+
+static size_t PoolBucketSize(size_t size) {
+    if (size <= kPoolMinBucket) {
+        return kPoolMinBucket;
+    }
+    size_t pow2 = kPoolMinBucket;
+    while (pow2 * 2 <= size && pow2 * 2 > pow2) {
+        pow2 *= 2;
+    }
+    size_t step = pow2 / 8;
+    size_t buckets = (size + step - 1) / step;
+    return buckets * step;
+}
+
+// Free idle buffers (oldest first) until idle bytes drop to `target`
+static void PoolTrimIdle(size_t target) {
+    for (size_t i = 0; i < g_bufferPool.size() && g_poolIdleBytes > target;) {
+        if (g_bufferPool[i].inUse) {
+            ++i;
+            continue;
+        }
+        g_poolIdleBytes -= g_bufferPool[i].capacity;
+        free(g_bufferPool[i].data);
+        g_bufferPool.erase(g_bufferPool.begin() + i);
+    }
 }
 
-// Get the font size of a character
-EMSCRIPTEN_KEEPALIVE
-double PDFium_GetFontSize(FPDF_TEXTPAGE textPage, int charIndex) {
-    return FPDFText_GetFontSize(textPage, charIndex);
+static uint8_t* PoolAcquireBuffer(size_t size) {
+    size_t capacity = PoolBucketSize(size);
+    for (PoolBuffer& entry : g_bufferPool) {
+        if (!entry.inUse && entry.capacity == capacity) {
+            entry.inUse = true;
+            g_poolIdleBytes -= capacity;
+            g_poolInUseBytes += capacity;
+            ++g_poolHits;
+            return entry.data;
+        }
+    }
+
+    // Miss: drop idle buffers of other sizes first if they would push the
+    // pool past its high-water mark.
+    ++g_poolMisses;
+    if (g_poolIdleBytes + g_poolInUseBytes + capacity > g_poolRetainLimit) {
+        PoolTrimIdle(0);
+    }
+
+    uint8_t* data = static_cast<uint8_t*>(malloc(capacity));
+    if (!data) {
+        return nullptr;
+    }
+    g_bufferPool.push_back({data, capacity, true});
+    g_poolInUseBytes += capacity;
+    return data;
+}
+
+// Returns false if `data` does not belong to the pool
+static bool PoolReleaseBuffer(void* data) {
+    for (size_t i = 0; i < g_bufferPool.size(); ++i) {
+        PoolBuffer& entry = g_bufferPool[i];
+        if (entry.data != data || !entry.inUse) {
+            continue;
+        }
+        entry.inUse = false;
+        g_poolInUseBytes -= entry.capacity;
+        g_poolIdleBytes += entry.capacity;
+        if (g_poolIdleBytes > g_poolRetainLimit) {
+            g_poolIdleBytes -= entry.capacity;
+            free(entry.data);
+            g_bufferPool.erase(g_bufferPool.begin() + i);
+        }
+        return true;
+    }
+    return false;
 }
 
-// Get the rotation angle of a character in degrees
+// Acquire a BGRA bitmap (stride == width * 4) backed by a pooled buffer.
+// Release it with PDFium_BitmapPoolRelease, not PDFium_BitmapDestroy.
 EMSCRIPTEN_KEEPALIVE
-float PDFium_GetCharAngle(FPDF_TEXTPAGE textPage, int charIndex) {
-    return FPDFText_GetCharAngle(textPage, charIndex);
+FPDF_BITMAP PDFium_BitmapPoolAcquire(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return nullptr;
+    }
+    uint64_t size = static_cast<uint64_t>(width) * static_cast<uint64_t>(height) * 4;
+    if (size > SIZE_MAX || static_cast<uint64_t>(width) * 4 > INT32_MAX) {
+        return nullptr;
+    }
+
+    uint8_t* data = PoolAcquireBuffer(static_cast<size_t>(size));
+    if (!data) {
+        return nullptr;
+    }
+    FPDF_BITMAP bitmap = FPDFBitmap_CreateEx(width, height, FPDFBitmap_BGRA, data, width * 4);
+    if (!bitmap) {
+        PoolReleaseBuffer(data);
+    }
+    return bitmap;
 }
 
-// Get character index at a specific position
+// Destroy a pooled bitmap and hand its buffer back to the pool
 EMSCRIPTEN_KEEPALIVE
-int PDFium_GetCharIndexAtPos(FPDF_TEXTPAGE textPage, double x, double y,
-                              double xTolerance, double yTolerance) {
-    return FPDFText_GetCharIndexAtPos(textPage, x, y, xTolerance, yTolerance);
+void PDFium_BitmapPoolRelease(FPDF_BITMAP bitmap) {
+    if (!bitmap) {
+        return;
+    }
+    void* data = FPDFBitmap_GetBuffer(bitmap);
+    FPDFBitmap_Destroy(bitmap);
+    PoolReleaseBuffer(data);
 }
 
-// Get font information for a character
+// Set the high-water mark (bytes) for buffers retained by the pool
 EMSCRIPTEN_KEEPALIVE
-unsigned long PDFium_GetFontInfo(FPDF_TEXTPAGE textPage, int charIndex,
-                                  void* buffer, unsigned long bufferLen, int* flags) {
-    return FPDFText_GetFontInfo(textPage, charIndex, buffer, bufferLen, flags);
+void PDFium_BitmapPoolSetLimit(int maxBytes) {
+    g_poolRetainLimit = maxBytes > 0 ? static_cast<size_t>(maxBytes) : 0;
+    PoolTrimIdle(g_poolRetainLimit);
 }
 
-// Get font weight for a character
+// Free every idle buffer; buffers still in use are untouched
 EMSCRIPTEN_KEEPALIVE
-int PDFium_GetFontWeight(FPDF_TEXTPAGE textPage, int charIndex) {
-    return FPDFText_GetFontWeight(textPage, charIndex);
+void PDFium_BitmapPoolTrim() {
+    PoolTrimIdle(0);
 }
 
-// Get text fill color
+// Write pool statistics into `out` (6 x uint32):
+// [buffersInUse, buffersIdle, bytesInUse, bytesIdle, hits, misses]
 EMSCRIPTEN_KEEPALIVE
-FPDF_BOOL PDFium_GetFillColor(FPDF_TEXTPAGE textPage, int charIndex,
-                               unsigned int* R, unsigned int* G,
-                               unsigned int* B, unsigned int* A) {
-    return FPDFText_GetFillColor(textPage, charIndex, R, G, B, A);
+void PDFium_BitmapPoolGetStats(uint32_t* out) {
+    if (!out) {
+        return;
+    }
+    uint32_t inUse = 0;
+    for (const PoolBuffer& entry : g_bufferPool) {
+        if (entry.inUse) {
+            ++inUse;
+        }
+    }
+    out[0] = inUse;
+    out[1] = static_cast<uint32_t>(g_bufferPool.size()) - inUse;
+    out[2] = static_cast<uint32_t>(g_poolInUseBytes);
+    out[3] = static_cast<uint32_t>(g_poolIdleBytes);
+    out[4] = g_poolHits;
+    out[5] = g_poolMisses;
 }
 
-// Get text stroke color
+// Free a buffer returned by the wrapper. Pooled render buffers go back to
+// the bitmap pool; anything else is released with free().
 EMSCRIPTEN_KEEPALIVE
-FPDF_BOOL PDFium_GetStrokeColor(FPDF_TEXTPAGE textPage, int charIndex,
-                                 unsigned int* R, unsigned int* G,
-                                 unsigned int* B, unsigned int* A) {
-    return FPDFText_GetStrokeColor(textPage, charIndex, R, G, B, A);
+void PDFium_FreeBuffer(void* buffer) {
+    if (buffer && !PoolReleaseBuffer(buffer)) {
+        free(buffer);
+    }
 }
 
 // ============================================================================
-// Text Selection API - Rectangle-based text selection
+// One-shot RGBA Rendering
 // ============================================================================
+// Renders straight into a tightly packed RGBA buffer (stride == width * 4) so
+// JavaScript can copy it into ImageData as-is. FPDF_REVERSE_BYTE_ORDER makes
+// PDFium write R,G,B,A instead of its native B,G,R,A.
 
-// Count selection rectangles for a range of characters
-EMSCRIPTEN_KEEPALIVE
-int PDFium_CountRects(FPDF_TEXTPAGE textPage, int startIndex, int count) {
-    return FPDFText_CountRects(textPage, startIndex, count);
+// FPDFBitmap_FillRect always writes BGRA, so swap R and B of the 0xAARRGGBB
+// background color up front to make it land as RGBA in memory.
+static FPDF_DWORD SwapRedBlue(FPDF_DWORD argb) {
+    return (argb & 0xff00ff00UL) | ((argb >> 16) & 0xffUL) | ((argb & 0xffUL) << 16);
 }
 
-// Get a specific selection rectangle
-EMSCRIPTEN_KEEPALIVE
-FPDF_BOOL PDFium_GetRect(FPDF_TEXTPAGE textPage, int rectIndex,
-                          double* left, double* top,
-                          double* right, double* bottom) {
-    return FPDFText_GetRect(textPage, rectIndex, left, top, right, bottom);
+// Take a packed width * height * 4 byte buffer from the pool, or nullptr if
+// too large. PDFium_FreeBuffer hands it back.
+static uint8_t* AllocPackedBuffer(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return nullptr;
+    }
+    uint64_t size = static_cast<uint64_t>(width) * static_cast<uint64_t>(height) * 4;
+    if (size > SIZE_MAX || static_cast<uint64_t>(width) * 4 > INT32_MAX) {
+        return nullptr;
+    }
+    return PoolAcquireBuffer(static_cast<size_t>(size));
 }
 
-// Get text within a bounding rectangle
+// Render an already loaded page (e.g. one holding in-memory edits).
+// Returns an RGBA buffer of width * height * 4 bytes that must be released
+// with PDFium_FreeBuffer, or nullptr on failure.
 EMSCRIPTEN_KEEPALIVE
-int PDFium_GetBoundedText(FPDF_TEXTPAGE textPage, double left, double top,
-                           double right, double bottom,
-                           unsigned short* buffer, int bufferLen) {
-    return FPDFText_GetBoundedText(textPage, left, top, right, bottom, buffer, bufferLen);
-}
+uint8_t* PDFium_RenderLoadedPageRGBA(FPDF_PAGE page, int width, int height,
+                                     int rotate, int flags, unsigned long bgColor) {
+    PerfScope perf(kPerfRender);
+    if (!page) {
+        return nullptr;
+    }
+
+    uint8_t* buffer = AllocPackedBuffer(width, height);
+    if (!buffer) {
+        return nullptr;
+    }
+
+    FPDF_BITMAP bitmap = FPDFBitmap_CreateEx(width, height, FPDFBitmap_BGRA, buffer, width * 4);
+    if (!bitmap) {
+        PoolReleaseBuffer(buffer);
+        return nullptr;
+    }
+
+    FPDFBitmap_FillRect(bitmap, 0, 0, width, height, SwapRedBlue(bgColor));
+    FPDF_RenderPageBitmap(bitmap, page, 0, 0, width, height, rotate,
+                          flags | FPDF_REVERSE_BYTE_ORDER);
+
+    // The bitmap does not own an external buffer, so this leaves it intact
+    FPDFBitmap_Destroy(bitmap);
+    return buffer;
+}
+
+// Load, render and close a page in one call.
+// Returns an RGBA buffer (free with PDFium_FreeBuffer), or nullptr.
+EMSCRIPTEN_KEEPALIVE
+uint8_t* PDFium_RenderPageRGBA(FPDF_DOCUMENT doc, int pageIndex, int width, int height,
+                               int rotate, int flags, unsigned long bgColor) {
+    FPDF_PAGE page = LoadPageCounted(doc, pageIndex);
+    if (!page) {
+        return nullptr;
+    }
+
+    uint8_t* buffer = PDFium_RenderLoadedPageRGBA(page, width, height, rotate, flags, bgColor);
+    FPDF_ClosePage(page);
+    return buffer;
+}
+
+// ============================================================================
+// Thumbnails - Embedded /Thumb images and draft renders, singly or as an atlas
+// ============================================================================
+// Sidebar previews do not need a full-quality render. A page's embedded
+// /Thumb image is used when it is close enough to the requested size: at
+// least half as wide and within kThumbnailAspectSlack of the page's aspect
+// ratio (a thumbnail drawn before a /Rotate change would not match). It is
+// resampled bilinearly to the requested size. Otherwise the page is drawn
+// with kDraftRenderFlags: no anti-aliasing of text, paths or images and a
+// limited image cache. Output is packed RGBA like PDFium_RenderLoadedPageRGBA.
+// Thumbnail sources (the `source` output):
+//   1 = embedded /Thumb image, 2 = draft render
+// Atlas cell layout (int32, 2 + 4 * count): atlasWidth, atlasHeight, then
+// per page (top, width, height, source). Cells are stacked top to bottom and
+// left aligned; a page that failed to load has source 0 and stays white.
+
+// PDFium_RenderThumbnailRGBA option: ignore the embedded thumbnail (the page
+// changed since it was saved)
+static const int kThumbnailSkipEmbedded = 1;
+
+static const int kThumbnailEmbedded = 1;
+static const int kThumbnailDraft = 2;
+
+static const double kThumbnailAspectSlack = 0.05;
+
+static const int kDraftRenderFlags = FPDF_ANNOT | FPDF_RENDER_NO_SMOOTHTEXT |
+                                     FPDF_RENDER_NO_SMOOTHIMAGE | FPDF_RENDER_NO_SMOOTHPATH |
+                                     FPDF_RENDER_LIMITEDIMAGECACHE;
+
+// Read pixel (x, y) of a Gray, BGR, BGRx or BGRA bitmap as R, G, B, A
+static void ReadBitmapPixel(const uint8_t* buffer, int stride, int format, int x, int y,
+                            uint8_t* rgba) {
+    const uint8_t* row = buffer + static_cast<size_t>(y) * stride;
+    switch (format) {
+        case FPDFBitmap_Gray:
+            rgba[0] = rgba[1] = rgba[2] = row[x];
+            rgba[3] = 255;
+            break;
+        case FPDFBitmap_BGR:
+            rgba[0] = row[x * 3 + 2];
+            rgba[1] = row[x * 3 + 1];
+            rgba[2] = row[x * 3];
+            rgba[3] = 255;
+            break;
+        default:
+            rgba[0] = row[x * 4 + 2];
+            rgba[1] = row[x * 4 + 1];
+            rgba[2] = row[x * 4];
+            rgba[3] = format == FPDFBitmap_BGRA ? row[x * 4 + 3] : 255;
+            break;
+    }
+}
+
+// Draw the page's embedded thumbnail into a width x height RGBA region. Returns
+// false, leaving the region untouched, when there is none or it does not fit.
+static bool DrawEmbeddedThumbnail(FPDF_PAGE page, uint8_t* out, int outStride, int width,
+                                  int height) {
+    FPDF_BITMAP thumb = FPDFPage_GetThumbnailAsBitmap(page);
+    if (!thumb) {
+        return false;
+    }
+    const int tw = FPDFBitmap_GetWidth(thumb);
+    const int th = FPDFBitmap_GetHeight(thumb);
+    const int format = FPDFBitmap_GetFormat(thumb);
+    const uint8_t* src = static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(thumb));
+    const int srcStride = FPDFBitmap_GetStride(thumb);
+    const double pageAspect = static_cast<double>(width) / height;
+    const bool fits = src && tw > 0 && th > 0 && format != FPDFBitmap_Unknown &&
+                      tw * 2 >= width &&
+                      std::fabs(static_cast<double>(tw) / th - pageAspect) <=
+                          kThumbnailAspectSlack * pageAspect;
+    if (!fits) {
+        FPDFBitmap_Destroy(thumb);
+        return false;
+    }
+
+    // Bilinear resample, sampling at pixel centers
+    const double sx = static_cast<double>(tw) / width;
+    const double sy = static_cast<double>(th) / height;
+    for (int y = 0; y < height; ++y) {
+        double fy = std::max(0.0, (y + 0.5) * sy - 0.5);
+        int y0 = std::min(th - 1, static_cast<int>(fy));
+        int y1 = std::min(th - 1, y0 + 1);
+        double wy = fy - y0;
+        uint8_t* dst = out + static_cast<size_t>(y) * outStride;
+        for (int x = 0; x < width; ++x) {
+            double fx = std::max(0.0, (x + 0.5) * sx - 0.5);
+            int x0 = std::min(tw - 1, static_cast<int>(fx));
+            int x1 = std::min(tw - 1, x0 + 1);
+            double wx = fx - x0;
+            uint8_t p00[4], p01[4], p10[4], p11[4];
+            ReadBitmapPixel(src, srcStride, format, x0, y0, p00);
+            ReadBitmapPixel(src, srcStride, format, x1, y0, p01);
+            ReadBitmapPixel(src, srcStride, format, x0, y1, p10);
+            ReadBitmapPixel(src, srcStride, format, x1, y1, p11);
+            for (int c = 0; c < 4; ++c) {
+                double top = p00[c] + (p01[c] - p00[c]) * wx;
+                double bottom = p10[c] + (p11[c] - p10[c]) * wx;
+                dst[x * 4 + c] = static_cast<uint8_t>(std::lround(top + (bottom - top) * wy));
+            }
+        }
+    }
+    FPDFBitmap_Destroy(thumb);
+    return true;
+}
+
+// Draw a thumbnail of the page into a width x height RGBA region of a buffer
+// with the given stride. Returns the source used, or 0 on failure.
+static int DrawThumbnail(FPDF_PAGE page, uint8_t* out, int outStride, int width, int height,
+                         int options) {
+    if ((options & kThumbnailSkipEmbedded) == 0 &&
+        DrawEmbeddedThumbnail(page, out, outStride, width, height)) {
+        return kThumbnailEmbedded;
+    }
+    FPDF_BITMAP bitmap = FPDFBitmap_CreateEx(width, height, FPDFBitmap_BGRA, out, outStride);
+    if (!bitmap) {
+        return 0;
+    }
+    FPDFBitmap_FillRect(bitmap, 0, 0, width, height, 0xffffffffUL);
+    FPDF_RenderPageBitmap(bitmap, page, 0, 0, width, height, 0,
+                          kDraftRenderFlags | FPDF_REVERSE_BYTE_ORDER);
+    FPDFBitmap_Destroy(bitmap);
+    return kThumbnailDraft;
+}
+
+// Thumbnail of an already loaded page as a width * height * 4 RGBA buffer
+// (free with PDFium_FreeBuffer), or nullptr. Writes the source used to
+// *outSource when given.
+EMSCRIPTEN_KEEPALIVE
+uint8_t* PDFium_RenderThumbnailRGBA(FPDF_PAGE page, int width, int height, int options,
+                                    int32_t* outSource) {
+    PerfScope perf(kPerfRender);
+    if (!page) {
+        return nullptr;
+    }
+    uint8_t* buffer = AllocPackedBuffer(width, height);
+    if (!buffer) {
+        return nullptr;
+    }
+    int source = DrawThumbnail(page, buffer, width * 4, width, height, options);
+    if (!source) {
+        PoolReleaseBuffer(buffer);
+        return nullptr;
+    }
+    if (outSource) {
+        *outSource = source;
+    }
+    return buffer;
+}
+
+// Thumbnails of pages [firstPage, firstPage + count) at deviceScale pixels per
+// point, sized round(pageSize * deviceScale) like the viewer's renders, in one
+// RGBA atlas buffer (free with PDFium_FreeBuffer). Fills `cells` (2 + 4 *
+// count int32). Returns nullptr when no page loads or the atlas is too large.
+EMSCRIPTEN_KEEPALIVE
+uint8_t* PDFium_RenderThumbnailAtlas(FPDF_DOCUMENT doc, int firstPage, int count,
+                                     double deviceScale, int options, int32_t* cells) {
+    PerfScope perf(kPerfRender);
+    if (!doc || !cells || count <= 0 || deviceScale <= 0 || firstPage < 0 ||
+        firstPage + count > FPDF_GetPageCount(doc)) {
+        return nullptr;
+    }
+
+    int atlasWidth = 0;
+    int64_t atlasHeight = 0;
+    for (int i = 0; i < count; ++i) {
+        double pageWidth = 0, pageHeight = 0;
+        int32_t* cell = cells + 2 + i * 4;
+        if (FPDF_GetPageSizeByIndex(doc, firstPage + i, &pageWidth, &pageHeight)) {
+            cell[1] = std::max(1, static_cast<int>(std::lround(pageWidth * deviceScale)));
+            cell[2] = std::max(1, static_cast<int>(std::lround(pageHeight * deviceScale)));
+        } else {
+            cell[1] = cell[2] = 0;
+        }
+        cell[0] = static_cast<int32_t>(atlasHeight);
+        cell[3] = 0;
+        atlasWidth = std::max(atlasWidth, static_cast<int>(cell[1]));
+        atlasHeight += cell[2];
+    }
+    if (atlasHeight > INT32_MAX) {
+        return nullptr;
+    }
+    cells[0] = atlasWidth;
+    cells[1] = static_cast<int32_t>(atlasHeight);
+
+    uint8_t* atlas = AllocPackedBuffer(atlasWidth, static_cast<int>(atlasHeight));
+    if (!atlas) {
+        return nullptr;
+    }
+    memset(atlas, 0xff, static_cast<size_t>(atlasWidth) * 4 * atlasHeight);
+
+    bool any = false;
+    for (int i = 0; i < count; ++i) {
+        int32_t* cell = cells + 2 + i * 4;
+        if (cell[1] <= 0 || cell[2] <= 0) {
+            continue;
+        }
+        FPDF_PAGE page = LoadPageCounted(doc, firstPage + i);
+        if (!page) {
+            continue;
+        }
+        uint8_t* origin = atlas + static_cast<size_t>(cell[0]) * atlasWidth * 4;
+        cell[3] = DrawThumbnail(page, origin, atlasWidth * 4, cell[1], cell[2], options);
+        any = any || cell[3] != 0;
+        FPDF_ClosePage(page);
+    }
+    if (!any) {
+        PoolReleaseBuffer(atlas);
+        return nullptr;
+    }
+    return atlas;
+}
+
+// ============================================================================
+// Tile Rendering - Render a device-space region for deep zoom
+// ============================================================================
+// Only the requested tile is rasterized, so memory stays at
+// tileWidth * tileHeight * 4 bytes no matter how far the page is zoomed.
+// Device space is the page at `scale` pixels per point with a top-left origin
+// (the page's /Rotate is already applied), matching FPDF_RenderPageBitmap.
+
+// Render the tile [tileX, tileX + tileWidth) x [tileY, tileY + tileHeight) of
+// a loaded page into packed RGBA. Returns a buffer to release with
+// PDFium_FreeBuffer, or nullptr on failure.
+EMSCRIPTEN_KEEPALIVE
+uint8_t* PDFium_RenderPageTileRGBA(FPDF_PAGE page, float scale,
+                                   int tileX, int tileY, int tileWidth, int tileHeight,
+                                   int flags, unsigned long bgColor) {
+    PerfScope perf(kPerfRender);
+    if (!page || scale <= 0) {
+        return nullptr;
+    }
+
+    uint8_t* buffer = AllocPackedBuffer(tileWidth, tileHeight);
+    if (!buffer) {
+        return nullptr;
+    }
+
+    FPDF_BITMAP bitmap = FPDFBitmap_CreateEx(tileWidth, tileHeight, FPDFBitmap_BGRA, buffer,
+                                             tileWidth * 4);
+    if (!bitmap) {
+        PoolReleaseBuffer(buffer);
+        return nullptr;
+    }
+
+    FPDFBitmap_FillRect(bitmap, 0, 0, tileWidth, tileHeight, SwapRedBlue(bgColor));
+
+    // Scale page space to device space, then shift the tile origin to (0, 0)
+    FS_MATRIX matrix = {scale, 0, 0, scale, -static_cast<float>(tileX),
+                        -static_cast<float>(tileY)};
+    FS_RECTF clip = {0, 0, static_cast<float>(tileWidth), static_cast<float>(tileHeight)};
+    FPDF_RenderPageBitmapWithMatrix(bitmap, page, &matrix, &clip,
+                                    flags | FPDF_REVERSE_BYTE_ORDER);
+
+    FPDFBitmap_Destroy(bitmap);
+    return buffer;
+}
+
+// ============================================================================
+// Async Render Queue - Several renders in flight at once
+// ============================================================================
+// PDFium keeps process-wide state and is not thread-safe, so renders cannot
+// run on parallel threads against one library instance. Instead every async
+// job owns its bitmap, progressive render context and RenderJob pause
+// handler, and PDFium_RenderAsyncPump advances all active jobs in round-robin time slices.
+// Visible pages and thumbnails therefore progress together instead of queuing
+// behind one another, and cancelling one job never affects the others.
+
+enum AsyncRenderStatus {
+    ASYNC_RENDER_QUEUED = 0,
+    ASYNC_RENDER_RUNNING = 1,
+    ASYNC_RENDER_DONE = 2,
+    ASYNC_RENDER_FAILED = 3,
+    ASYNC_RENDER_CANCELLED = 4,
+};
+
+struct AsyncRenderJob {
+    int id;
+    FPDF_PAGE page;
+    bool ownsPage;
+    FPDF_BITMAP bitmap;
+    int width;
+    int height;
+    int rotate;
+    int flags;
+    unsigned long bgColor;
+    bool started;
+    int status;
+    RenderJob pause;
+};
+
+static std::vector<std::unique_ptr<AsyncRenderJob>> g_asyncJobs;
+static int g_nextAsyncJobId = 1;
+static size_t g_asyncPumpCursor = 0;
+
+static AsyncRenderJob* FindAsyncJob(int jobId) {
+    for (auto& job : g_asyncJobs) {
+        if (job->id == jobId) {
+            return job.get();
+        }
+    }
+    return nullptr;
+}
+
+static bool IsAsyncJobActive(const AsyncRenderJob& job) {
+    return job.status == ASYNC_RENDER_QUEUED || job.status == ASYNC_RENDER_RUNNING;
+}
+
+static int SubmitAsyncJob(FPDF_PAGE page, bool ownsPage, int width, int height,
+                          int rotate, int flags, unsigned long bgColor) {
+    FPDF_BITMAP bitmap = PDFium_BitmapPoolAcquire(width, height);
+    if (!bitmap) {
+        if (ownsPage) {
+            FPDF_ClosePage(page);
+        }
+        return 0;
+    }
+
+    std::unique_ptr<AsyncRenderJob> job(new AsyncRenderJob());
+    job->id = g_nextAsyncJobId++;
+    job->page = page;
+    job->ownsPage = ownsPage;
+    job->bitmap = bitmap;
+    job->width = width;
+    job->height = height;
+    job->rotate = rotate;
+    job->flags = flags;
+    job->bgColor = bgColor;
+    job->started = false;
+    job->status = ASYNC_RENDER_QUEUED;
+    int id = job->id;
+    g_asyncJobs.push_back(std::move(job));
+    return id;
+}
+
+// Run one slice of a job until its pause deadline
+static void StepAsyncJob(AsyncRenderJob& job) {
+    PerfScope perf(kPerfRenderSlice);
+    int status;
+    if (!job.started) {
+        job.started = true;
+        job.status = ASYNC_RENDER_RUNNING;
+        unsigned long fill = (job.flags & FPDF_REVERSE_BYTE_ORDER) ? SwapRedBlue(job.bgColor)
+                                                                   : job.bgColor;
+        FPDFBitmap_FillRect(job.bitmap, 0, 0, job.width, job.height, fill);
+        status = FPDF_RenderPageBitmap_Start(job.bitmap, job.page, 0, 0, job.width, job.height,
+                                             job.rotate, job.flags, &job.pause);
+    } else {
+        status = FPDF_RenderPage_Continue(job.page, &job.pause);
+    }
+
+    if (status == FPDF_RENDER_DONE || status == FPDF_RENDER_FAILED) {
+        FPDF_RenderPage_Close(job.page);
+        job.status = status == FPDF_RENDER_DONE ? ASYNC_RENDER_DONE : ASYNC_RENDER_FAILED;
+    }
+}
+
+// Queue a render of a page the job loads (and closes) itself.
+// The bitmap is a pooled BGRA buffer; pass FPDF_REVERSE_BYTE_ORDER in flags
+// to get RGBA. bgColor is 0xAARRGGBB. Returns a job id, or 0 on failure.
+EMSCRIPTEN_KEEPALIVE
+int PDFium_RenderPageAsync(FPDF_DOCUMENT doc, int pageIndex, int width, int height,
+                           int rotate, int flags, unsigned long bgColor) {
+    FPDF_PAGE page = LoadPageCounted(doc, pageIndex);
+    if (!page) {
+        return 0;
+    }
+    return SubmitAsyncJob(page, true, width, height, rotate, flags, bgColor);
+}
+
+// Queue a render of a caller-owned page. The page must stay open, and must
+// not be rendered elsewhere, until the job is released.
+EMSCRIPTEN_KEEPALIVE
+int PDFium_RenderLoadedPageAsync(FPDF_PAGE page, int width, int height,
+                                 int rotate, int flags, unsigned long bgColor) {
+    if (!page) {
+        return 0;
+    }
+    return SubmitAsyncJob(page, false, width, height, rotate, flags, bgColor);
+}
+
+// Advance active jobs for up to budgetMs, giving each one an equal slice and
+// rotating the starting job between calls. Returns the number of jobs that
+// still need pumping.
+EMSCRIPTEN_KEEPALIVE
+int PDFium_RenderAsyncPump(double budgetMs) {
+    size_t active = 0;
+    for (auto& job : g_asyncJobs) {
+        if (IsAsyncJobActive(*job)) {
+            ++active;
+        }
+    }
+    if (active == 0) {
+        return 0;
+    }
+
+    double end = emscripten_get_now() + budgetMs;
+    double slice = budgetMs / static_cast<double>(active);
+    if (slice < 1.0) {
+        slice = 1.0;
+    }
+
+    size_t count = g_asyncJobs.size();
+    size_t start = g_asyncPumpCursor % count;
+    for (size_t n = 0; n < count; ++n) {
+        size_t index = (start + n) % count;
+        AsyncRenderJob& job = *g_asyncJobs[index];
+        if (!IsAsyncJobActive(job)) {
+            continue;
+        }
+        double now = emscripten_get_now();
+        if (now >= end) {
+            break;
+        }
+        job.pause.budgetMs = slice;
+        job.pause.BeginSlice();
+        StepAsyncJob(job);
+        g_asyncPumpCursor = index + 1;
+    }
+
+    active = 0;
+    for (auto& job : g_asyncJobs) {
+        if (IsAsyncJobActive(*job)) {
+            ++active;
+        }
+    }
+    return static_cast<int>(active);
+}
+
+// Get job status: QUEUED (0), RUNNING (1), DONE (2), FAILED (3),
+// CANCELLED (4), or -1 for an unknown job id
+EMSCRIPTEN_KEEPALIVE
+int PDFium_RenderAsyncPoll(int jobId) {
+    AsyncRenderJob* job = FindAsyncJob(jobId);
+    return job ? job->status : -1;
+}
+
+// Get the pixel buffer of a finished job (stride == width * 4)
+EMSCRIPTEN_KEEPALIVE
+void* PDFium_RenderAsyncGetBuffer(int jobId) {
+    AsyncRenderJob* job = FindAsyncJob(jobId);
+    if (!job || job->status != ASYNC_RENDER_DONE) {
+        return nullptr;
+    }
+    return FPDFBitmap_GetBuffer(job->bitmap);
+}
+
+// Cancel a queued or running job; other jobs are unaffected
+EMSCRIPTEN_KEEPALIVE
+void PDFium_RenderAsyncCancel(int jobId) {
+    AsyncRenderJob* job = FindAsyncJob(jobId);
+    if (!job || !IsAsyncJobActive(*job)) {
+        return;
+    }
+    job->pause.cancelled = true;
+    if (job->started) {
+        FPDF_RenderPage_Close(job->page);
+    }
+    job->status = ASYNC_RENDER_CANCELLED;
+}
+
+// Release a job's bitmap (and page, if the job loaded it). Cancels it first
+// if still active.
+EMSCRIPTEN_KEEPALIVE
+void PDFium_RenderAsyncRelease(int jobId) {
+    for (size_t i = 0; i < g_asyncJobs.size(); ++i) {
+        AsyncRenderJob& job = *g_asyncJobs[i];
+        if (job.id != jobId) {
+            continue;
+        }
+        PDFium_RenderAsyncCancel(jobId);
+        PDFium_BitmapPoolRelease(job.bitmap);
+        if (job.ownsPage) {
+            FPDF_ClosePage(job.page);
+        }
+        g_asyncJobs.erase(g_asyncJobs.begin() + i);
+        return;
+    }
+}
+
+EMSCRIPTEN_KEEPALIVE
+FPDF_TEXTPAGE PDFium_LoadPageText(FPDF_PAGE page) {
+    return LoadTextPageCounted(page);
+}
+
+EMSCRIPTEN_KEEPALIVE
+void PDFium_ClosePageText(FPDF_TEXTPAGE textPage) {
+    if (textPage) {
+        FPDFText_ClosePage(textPage);
+    }
+}
+
+EMSCRIPTEN_KEEPALIVE
+int PDFium_GetPageCharCount(FPDF_TEXTPAGE textPage) {
+    return FPDFText_CountChars(textPage);
+}
+
+EMSCRIPTEN_KEEPALIVE
+int PDFium_GetPageText(FPDF_TEXTPAGE textPage, unsigned short* buffer, int bufferLen) {
+    int charCount = FPDFText_CountChars(textPage);
+    return FPDFText_GetText(textPage, 0, charCount, buffer);
+}
+
+// ============================================================================
+// Batch Text Extraction - Plain text of a run of pages in one buffer
+// ============================================================================
+// A text dump through the per-page exports costs a page load, a text page
+// load, a measure, a copy and two closes per page, each a JS<->WASM call. This
+// extracts consecutive pages natively until maxPages are done or the slice has
+// run for budgetMs (0 = no limit; at least one page is always extracted), so a
+// caller can stream a large document in frame-sized steps. Pages are loaded
+// and closed per call rather than taken from a page cache, so a pass over the
+// whole document does not evict the pages on screen.
+// Layout (all fields 4 bytes):
+//   int32   header[4]   pageCount, textUnits, nextPage, kTextBatchPageWords
+//   per page (kTextBatchPageWords words):
+//     int32   pageIndex, status      status 1 = extracted, 0 = failed to load
+//     int32   textStart, textLength  UTF-16 range in the text block
+//   uint16  text[textUnits]          padded to 4 bytes
+// nextPage is the first page not extracted, or the page count when done.
+
+static const int kTextBatchHeaderWords = 4;
+static const int kTextBatchPageWords = 4;
+
+// Returns a buffer to release with PDFium_FreeBuffer, or nullptr when
+// firstPage is out of range.
+EMSCRIPTEN_KEEPALIVE
+void* PDFium_ExtractPagesText(FPDF_DOCUMENT doc, int firstPage, int maxPages, double budgetMs) {
+    const int pageCount = doc ? FPDF_GetPageCount(doc) : 0;
+    if (firstPage < 0 || firstPage >= pageCount || maxPages <= 0) {
+        return nullptr;
+    }
+    const int endPage = std::min(pageCount, firstPage + maxPages);
+    const double deadline = budgetMs > 0 ? emscripten_get_now() + budgetMs : 0;
+
+    std::vector<int32_t> pages;
+    std::vector<unsigned short> text;
+    int pageIndex = firstPage;
+    while (pageIndex < endPage) {
+        int32_t status = 0;
+        int32_t textStart = static_cast<int32_t>(text.size());
+        int32_t textLength = 0;
+        FPDF_PAGE page = LoadPageCounted(doc, pageIndex);
+        if (page) {
+            FPDF_TEXTPAGE textPage = LoadTextPageCounted(page);
+            if (textPage) {
+                int charCount = FPDFText_CountChars(textPage);
+                if (charCount > 0) {
+                    // FPDFText_GetText writes charCount units plus a NUL
+                    text.resize(textStart + charCount + 1);
+                    int written = FPDFText_GetText(textPage, 0, charCount, &text[textStart]);
+                    textLength = std::max(0, std::min(written - 1, charCount));
+                    text.resize(textStart + textLength);
+                }
+                FPDFText_ClosePage(textPage);
+                status = 1;
+            }
+            FPDF_ClosePage(page);
+        }
+        pages.push_back(pageIndex);
+        pages.push_back(status);
+        pages.push_back(textStart);
+        pages.push_back(textLength);
+        ++pageIndex;
+        if (deadline > 0 && emscripten_get_now() >= deadline) {
+            break;
+        }
+    }
+
+    const size_t headerBytes = kTextBatchHeaderWords * 4;
+    const size_t pageBytes = pages.size() * 4;
+    const size_t textBytes = (text.size() * 2 + 3) & ~static_cast<size_t>(3);
+    uint8_t* out = static_cast<uint8_t*>(malloc(headerBytes + pageBytes + textBytes));
+    if (!out) {
+        return nullptr;
+    }
+    int32_t header[kTextBatchHeaderWords] = {
+        static_cast<int32_t>(pages.size() / kTextBatchPageWords),
+        static_cast<int32_t>(text.size()),
+        pageIndex,
+        kTextBatchPageWords,
+    };
+    memcpy(out, header, headerBytes);
+    memcpy(out + headerBytes, pages.data(), pageBytes);
+    memset(out + headerBytes + pageBytes, 0, textBytes);
+    if (!text.empty()) {
+        memcpy(out + headerBytes + pageBytes, text.data(), text.size() * 2);
+    }
+    return out;
+}
+
+// ============================================================================
+// Page Handle Cache - Bounded LRU of parsed pages and text pages
+// ============================================================================
+// Rendering, the text layer and the annotation scan of one page each load and
+// parse it again. The cache keeps FPDF_PAGE and FPDF_TEXTPAGE handles of
+// recently used pages of one document. Acquire pins an entry until the
+// matching Release; pinned entries are never evicted, unpinned ones are evicted
+// least recently used first once the page count or the estimated byte size
+// exceeds the budget. PDFium does not report memory per page, so the size is
+// estimated from the page object and character counts. An entry also keeps
+// the page's spatial index once a hit test has built it (see Spatial Index).
+// Stats layout (all fields 4 bytes):
+//   uint32  hits, misses, evictions, pages, estimatedBytes
+
+// Defined with the Spatial Index section below
+struct SpatialIndex;
+static SpatialIndex* BuildSpatialIndex(FPDF_PAGE page, FPDF_TEXTPAGE textPage);
+static size_t SpatialIndexBytes(const SpatialIndex* index);
+static void DestroySpatialIndex(SpatialIndex* index);
+
+static const size_t kPageCacheBaseBytes = 16 * 1024;
+static const size_t kPageCacheObjectBytes = 512;
+static const size_t kPageCacheCharBytes = 64;
+
+// Estimated size of a parsed page, without its text page
+static size_t EstimatePageBytes(FPDF_PAGE page) {
+    return kPageCacheBaseBytes +
+           static_cast<size_t>(std::max(0, FPDFPage_CountObjects(page))) * kPageCacheObjectBytes;
+}
+
+struct PageCacheEntry {
+    int pageIndex = -1;
+    FPDF_PAGE page = nullptr;
+    FPDF_TEXTPAGE textPage = nullptr;
+    SpatialIndex* spatial = nullptr;
+    int pins = 0;
+    bool stale = false;  // invalidated while pinned; closed on the last Release
+    size_t bytes = 0;
+};
+
+struct PageCache {
+    FPDF_DOCUMENT doc = nullptr;
+    size_t maxPages = 0;
+    size_t maxBytes = 0;
+    size_t bytes = 0;
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    uint32_t evictions = 0;
+    std::list<PageCacheEntry> lru;  // most recently used first
+    std::unordered_map<int, std::list<PageCacheEntry>::iterator> index;
+
+    std::list<PageCacheEntry>::iterator Find(int pageIndex) {
+        auto it = index.find(pageIndex);
+        if (it == index.end()) {
+            return lru.end();
+        }
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second;
+    }
+
+    std::list<PageCacheEntry>::iterator Load(int pageIndex) {
+        auto entry = Find(pageIndex);
+        if (entry != lru.end()) {
+            ++hits;
+            return entry;
+        }
+        ++misses;
+        FPDF_PAGE page = LoadPageCounted(doc, pageIndex);
+        if (!page) {
+            return lru.end();
+        }
+        PageCacheEntry created;
+        created.pageIndex = pageIndex;
+        created.page = page;
+        created.bytes = EstimatePageBytes(page);
+        bytes += created.bytes;
+        lru.push_front(created);
+        index[pageIndex] = lru.begin();
+        return lru.begin();
+    }
+
+    void LoadText(std::list<PageCacheEntry>::iterator entry) {
+        if (entry->textPage) {
+            return;
+        }
+        entry->textPage = LoadTextPageCounted(entry->page);
+        if (entry->textPage) {
+            size_t textBytes =
+                static_cast<size_t>(std::max(0, FPDFText_CountChars(entry->textPage))) *
+                kPageCacheCharBytes;
+            entry->bytes += textBytes;
+            bytes += textBytes;
+        }
+    }
+
+    // Load the page, its text page and its spatial index. Not pinned: use the
+    // entry before the next Trim.
+    std::list<PageCacheEntry>::iterator LoadSpatial(int pageIndex) {
+        auto entry = Load(pageIndex);
+        if (entry == lru.end() || entry->spatial) {
+            return entry;
+        }
+        LoadText(entry);
+        entry->spatial = BuildSpatialIndex(entry->page, entry->textPage);
+        size_t indexBytes = SpatialIndexBytes(entry->spatial);
+        entry->bytes += indexBytes;
+        bytes += indexBytes;
+        return entry;
+    }
+
+    void DropSpatial(std::list<PageCacheEntry>::iterator entry) {
+        size_t indexBytes = SpatialIndexBytes(entry->spatial);
+        DestroySpatialIndex(entry->spatial);
+        entry->spatial = nullptr;
+        entry->bytes -= indexBytes;
+        bytes -= indexBytes;
+    }
+
+    void Close(std::list<PageCacheEntry>::iterator entry) {
+        DestroySpatialIndex(entry->spatial);
+        if (entry->textPage) {
+            FPDFText_ClosePage(entry->textPage);
+        }
+        FPDF_ClosePage(entry->page);
+        bytes -= entry->bytes;
+        if (!entry->stale) {
+            index.erase(entry->pageIndex);
+        }
+        lru.erase(entry);
+    }
+
+    void Trim() {
+        auto it = lru.end();
+        while (it != lru.begin() && (lru.size() > maxPages || bytes > maxBytes)) {
+            --it;
+            if (it->pins > 0) {
+                continue;
+            }
+            auto victim = it++;
+            Close(victim);
+            ++evictions;
+        }
+    }
+
+    void Invalidate(std::list<PageCacheEntry>::iterator entry) {
+        if (entry->pins > 0) {
+            // Still borrowed: unlist it so the next Acquire reloads the page
+            index.erase(entry->pageIndex);
+            entry->stale = true;
+        } else {
+            Close(entry);
+        }
+    }
+};
+
+EMSCRIPTEN_KEEPALIVE
+PageCache* PDFium_PageCacheCreate(FPDF_DOCUMENT doc, int maxPages, int maxBytes) {
+    if (!doc) {
+        return nullptr;
+    }
+    PageCache* cache = new PageCache();
+    cache->doc = doc;
+    cache->maxPages = static_cast<size_t>(std::max(1, maxPages));
+    cache->maxBytes = static_cast<size_t>(std::max(0, maxBytes));
+    return cache;
+}
+
+// Closes every cached handle, pinned or not. Call before closing the document.
+EMSCRIPTEN_KEEPALIVE
+void PDFium_PageCacheDestroy(PageCache* cache) {
+    if (!cache) {
+        return;
+    }
+    for (PageCacheEntry& entry : cache->lru) {
+        DestroySpatialIndex(entry.spatial);
+        if (entry.textPage) {
+            FPDFText_ClosePage(entry.textPage);
+        }
+        FPDF_ClosePage(entry.page);
+    }
+    delete cache;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void PDFium_PageCacheSetBudget(PageCache* cache, int maxPages, int maxBytes) {
+    if (!cache) {
+        return;
+    }
+    cache->maxPages = static_cast<size_t>(std::max(1, maxPages));
+    cache->maxBytes = static_cast<size_t>(std::max(0, maxBytes));
+    cache->Trim();
+}
+
+// Borrow the page; it stays valid until the matching PDFium_PageCacheRelease.
+EMSCRIPTEN_KEEPALIVE
+FPDF_PAGE PDFium_PageCacheAcquire(PageCache* cache, int pageIndex) {
+    if (!cache) {
+        return nullptr;
+    }
+    auto entry = cache->Load(pageIndex);
+    if (entry == cache->lru.end()) {
+        return nullptr;
+    }
+    ++entry->pins;
+    return entry->page;
+}
+
+// Borrow the text page, loading the page too if needed. Pins the entry like
+// PDFium_PageCacheAcquire and needs its own Release. The text page belongs to
+// the page PDFium_PageCacheAcquire returns for the same index.
+EMSCRIPTEN_KEEPALIVE
+FPDF_TEXTPAGE PDFium_PageCacheAcquireText(PageCache* cache, int pageIndex) {
+    if (!cache) {
+        return nullptr;
+    }
+    auto entry = cache->Load(pageIndex);
+    if (entry == cache->lru.end()) {
+        return nullptr;
+    }
+    cache->LoadText(entry);
+    if (!entry->textPage) {
+        return nullptr;
+    }
+    ++entry->pins;
+    return entry->textPage;
+}
+
+// Release one borrow of a page handle. Looked up by handle because an
+// invalidated entry is no longer listed under its page index.
+EMSCRIPTEN_KEEPALIVE
+void PDFium_PageCacheRelease(PageCache* cache, FPDF_PAGE page) {
+    if (!cache || !page) {
+        return;
+    }
+    for (auto it = cache->lru.begin(); it != cache->lru.end(); ++it) {
+        if (it->page != page) {
+            continue;
+        }
+        if (it->pins > 0) {
+            --it->pins;
+        }
+        if (it->stale && it->pins == 0) {
+            cache->Close(it);
+        }
+        cache->Trim();
+        return;
+    }
+}
+
+// Release one borrow of a text page handle.
+EMSCRIPTEN_KEEPALIVE
+void PDFium_PageCacheReleaseText(PageCache* cache, FPDF_TEXTPAGE textPage) {
+    if (!cache || !textPage) {
+        return;
+    }
+    for (const PageCacheEntry& entry : cache->lru) {
+        if (entry.textPage == textPage) {
+            PDFium_PageCacheRelease(cache, entry.page);
+            return;
+        }
+    }
+}
+
+// Drop the cached handles of a page whose content changed (-1 = every page).
+// Borrowed handles stay valid until released but are not handed out again.
+EMSCRIPTEN_KEEPALIVE
+void PDFium_PageCacheInvalidate(PageCache* cache, int pageIndex) {
+    if (!cache) {
+        return;
+    }
+    if (pageIndex >= 0) {
+        auto it = cache->index.find(pageIndex);
+        if (it != cache->index.end()) {
+            cache->Invalidate(it->second);
+        }
+        return;
+    }
+    for (auto it = cache->lru.begin(); it != cache->lru.end();) {
+        auto entry = it++;
+        if (!entry->stale) {
+            cache->Invalidate(entry);
+        }
+    }
+}
+
+EMSCRIPTEN_KEEPALIVE
+void PDFium_PageCacheGetStats(PageCache* cache, uint32_t* out) {
+    if (!cache || !out) {
+        return;
+    }
+    out[0] = cache->hits;
+    out[1] = cache->misses;
+    out[2] = cache->evictions;
+    out[3] = static_cast<uint32_t>(cache->lru.size());
+    out[4] = static_cast<uint32_t>(cache->bytes);
+}
+
+// ============================================================================
+// Memory Governor - Release rebuildable memory when the heap runs full
+// ============================================================================
+// The WASM heap grows but never shrinks, so a session that opened a few large
+// documents ends up at MAXIMUM_MEMORY and allocations start to fail. Trimming
+// releases what the wrapper rebuilds on demand, cheapest to rebuild first:
+// idle pool buffers, spatial indexes, text pages, then parsed pages, each in
+// least recently used order. Pinned cache entries are skipped. It stops once
+// the allocator's bytes in use are estimated to be at or below targetBytes
+// (0 = release everything selected); nothing is released when they already
+// are, which costs one allocator walk. Closing a page also drops what PDFium
+// keeps per page: the parsed content, decoded images and the render cache.
+// Freed memory goes back to the allocator for reuse; linear memory itself
+// cannot shrink, so freeBytes is how much the heap can take without growing.
+// Report layout (all fields float64):
+//   usedBefore, usedAfter, freeBytes, heapSize, heapMax,
+//   poolBytesFreed, spatialIndexesFreed, textPagesClosed, pagesClosed
+
+enum MemoryTrimKind {
+    kMemoryTrimPool = 1,
+    kMemoryTrimSpatial = 2,
+    kMemoryTrimTextPages = 4,
+    kMemoryTrimPages = 8,
+};
+
+static const int kMemoryTrimReportFields = 9;
+
+// Release memory of the selected MemoryTrimKind bits until the heap in use
+// reaches targetBytes. cache may be null (only the pool is trimmed then).
+// Returns the number of bytes freed, as measured by the allocator.
+EMSCRIPTEN_KEEPALIVE
+double PDFium_MemoryTrim(PageCache* cache, double targetBytes, int kinds, double* out) {
+    const struct mallinfo before = mallinfo();
+    const double usedBefore = static_cast<double>(before.uordblks);
+    double estimate = usedBefore;
+    double target = std::max(0.0, targetBytes);
+    double poolFreed = 0;
+    int spatialFreed = 0;
+    int textClosed = 0;
+    int pagesClosed = 0;
+
+    if ((kinds & kMemoryTrimPool) && estimate > target) {
+        size_t idle = g_poolIdleBytes;
+        size_t keep = static_cast<size_t>(std::max(0.0, idle - (estimate - target)));
+        PoolTrimIdle(keep);
+        poolFreed = static_cast<double>(idle - g_poolIdleBytes);
+        estimate -= poolFreed;
+    }
+
+    // lru is most recently used first, so each pass walks it from the back
+    if (cache && (kinds & kMemoryTrimSpatial)) {
+        for (auto it = cache->lru.end(); it != cache->lru.begin() && estimate > target;) {
+            --it;
+            if (it->pins > 0 || !it->spatial) {
+                continue;
+            }
+            estimate -= static_cast<double>(SpatialIndexBytes(it->spatial));
+            cache->DropSpatial(it);
+            ++spatialFreed;
+        }
+    }
+    if (cache && (kinds & kMemoryTrimTextPages)) {
+        for (auto it = cache->lru.end(); it != cache->lru.begin() && estimate > target;) {
+            --it;
+            if (it->pins > 0 || !it->textPage) {
+                continue;
+            }
+            size_t textBytes = static_cast<size_t>(std::max(0, FPDFText_CountChars(it->textPage))) *
+                               kPageCacheCharBytes;
+            FPDFText_ClosePage(it->textPage);
+            it->textPage = nullptr;
+            it->bytes -= textBytes;
+            cache->bytes -= textBytes;
+            estimate -= static_cast<double>(textBytes);
+            ++textClosed;
+        }
+    }
+    if (cache && (kinds & kMemoryTrimPages)) {
+        for (auto it = cache->lru.end(); it != cache->lru.begin() && estimate > target;) {
+            --it;
+            if (it->pins > 0) {
+                continue;
+            }
+            estimate -= static_cast<double>(it->bytes);
+            auto victim = it++;
+            cache->Close(victim);
+            ++cache->evictions;
+            ++pagesClosed;
+        }
+    }
+
+    // Walk the allocator again only when something was released
+    struct mallinfo info = before;
+    if (poolFreed > 0 || spatialFreed > 0 || textClosed > 0 || pagesClosed > 0) {
+        info = mallinfo();
+    }
+    const double usedAfter = static_cast<double>(info.uordblks);
+    if (out) {
+        std::fill(out, out + kMemoryTrimReportFields, 0.0);
+        out[0] = usedBefore;
+        out[1] = usedAfter;
+        out[2] = static_cast<double>(info.fordblks) +
+                 static_cast<double>(emscripten_get_heap_size()) -
+                 static_cast<double>(HeapBreak());
+        out[3] = static_cast<double>(emscripten_get_heap_size());
+        out[4] = static_cast<double>(emscripten_get_heap_max());
+        out[5] = poolFreed;
+        out[6] = spatialFreed;
+        out[7] = textClosed;
+        out[8] = pagesClosed;
+    }
+    return std::max(0.0, usedBefore - usedAfter);
+}
+
+// Estimated bytes a parsed page holds, as the page cache accounts for it.
+// Lets the caller discount pages it keeps open outside the cache, which a
+// trim cannot release.
+EMSCRIPTEN_KEEPALIVE
+double PDFium_EstimatePageBytes(FPDF_PAGE page) {
+    return page ? static_cast<double>(EstimatePageBytes(page)) : 0.0;
+}
+
+// ============================================================================
+// Text Layer API - Character positioning, selection, and search
+// ============================================================================
+
+// Get the bounding box of a character
+EMSCRIPTEN_KEEPALIVE
+FPDF_BOOL PDFium_GetCharBox(FPDF_TEXTPAGE textPage, int charIndex,
+                             double* left, double* right,
+                             double* bottom, double* top) {
+    return FPDFText_GetCharBox(textPage, charIndex, left, right, bottom, top);
+}
+
+// Get the origin point of a character
+EMSCRIPTEN_KEEPALIVE
+FPDF_BOOL PDFium_GetCharOrigin(FPDF_TEXTPAGE textPage, int charIndex,
+                                double* x, double* y) {
+    return FPDFText_GetCharOrigin(textPage, charIndex, x, y);
+}
+
+// Get the Unicode value of a character
+EMSCRIPTEN_KEEPALIVE
+unsigned int PDFium_GetUnicode(FPDF_TEXTPAGE textPage, int charIndex) {
+    return FPDFText_GetUnicode(textPage, charIndex);
+}
+
+// Get the font size of a character
+EMSCRIPTEN_KEEPALIVE
+double PDFium_GetFontSize(FPDF_TEXTPAGE textPage, int charIndex) {
+    return FPDFText_GetFontSize(textPage, charIndex);
+}
+
+// Get the rotation angle of a character in degrees
+EMSCRIPTEN_KEEPALIVE
+float PDFium_GetCharAngle(FPDF_TEXTPAGE textPage, int charIndex) {
+    return FPDFText_GetCharAngle(textPage, charIndex);
+}
+
+// Get character index at a specific position
+EMSCRIPTEN_KEEPALIVE
+int PDFium_GetCharIndexAtPos(FPDF_TEXTPAGE textPage, double x, double y,
+                              double xTolerance, double yTolerance) {
+    return FPDFText_GetCharIndexAtPos(textPage, x, y, xTolerance, yTolerance);
+}
+
+// Get font information for a character
+EMSCRIPTEN_KEEPALIVE
+unsigned long PDFium_GetFontInfo(FPDF_TEXTPAGE textPage, int charIndex,
+                                  void* buffer, unsigned long bufferLen, int* flags) {
+    return FPDFText_GetFontInfo(textPage, charIndex, buffer, bufferLen, flags);
+}
+
+// Get font weight for a character
+EMSCRIPTEN_KEEPALIVE
+int PDFium_GetFontWeight(FPDF_TEXTPAGE textPage, int charIndex) {
+    return FPDFText_GetFontWeight(textPage, charIndex);
+}
+
+// Get text fill color
+EMSCRIPTEN_KEEPALIVE
+FPDF_BOOL PDFium_GetFillColor(FPDF_TEXTPAGE textPage, int charIndex,
+                               unsigned int* R, unsigned int* G,
+                               unsigned int* B, unsigned int* A) {
+    return FPDFText_GetFillColor(textPage, charIndex, R, G, B, A);
+}
+
+// Get text stroke color
+EMSCRIPTEN_KEEPALIVE
+FPDF_BOOL PDFium_GetStrokeColor(FPDF_TEXTPAGE textPage, int charIndex,
+                                 unsigned int* R, unsigned int* G,
+                                 unsigned int* B, unsigned int* A) {
+    return FPDFText_GetStrokeColor(textPage, charIndex, R, G, B, A);
+}
+
+// ============================================================================
+// Text Selection API - Rectangle-based text selection
+// ============================================================================
+
+// Count selection rectangles for a range of characters
+EMSCRIPTEN_KEEPALIVE
+int PDFium_CountRects(FPDF_TEXTPAGE textPage, int startIndex, int count) {
+    return FPDFText_CountRects(textPage, startIndex, count);
+}
+
+// Get a specific selection rectangle
+EMSCRIPTEN_KEEPALIVE
+FPDF_BOOL PDFium_GetRect(FPDF_TEXTPAGE textPage, int rectIndex,
+                          double* left, double* top,
+                          double* right, double* bottom) {
+    return FPDFText_GetRect(textPage, rectIndex, left, top, right, bottom);
+}
+
+// Get text within a bounding rectangle
+EMSCRIPTEN_KEEPALIVE
+int PDFium_GetBoundedText(FPDF_TEXTPAGE textPage, double left, double top,
+                           double right, double bottom,
+                           unsigned short* buffer, int bufferLen) {
+    return FPDFText_GetBoundedText(textPage, left, top, right, bottom, buffer, bufferLen);
+}
+
+// ============================================================================
+// Bulk Text Layout Extraction
+// ============================================================================
+// Returns every text rect of a character range in one packed buffer, instead
+// of one JS<->WASM round trip per rect, coordinate and color channel.
+// Layout (all fields 4 bytes, struct-of-arrays with N = rect count):
+//   int32   header[8]   N, textUnits, fontCount, fontBytes, fieldCount, 0, 0, 0
+//   float32 deviceLeft[N], deviceTop[N], deviceWidth[N], deviceHeight[N]
+//   float32 pageLeft[N], pageTop[N], pageRight[N], pageBottom[N]
+//   int32   charIndex[N]              char at the rect's top-left, or -1
+//   int32   textStart[N], textLength[N]   range in the UTF-16 text block
+//   float32 fontSize[N]
+//   uint32  fillColor[N]              bytes R, G, B, A
+//   int32   fontIndex[N]              index into the font table, or -1
+//   uint16  text[textUnits]           padded to 4 bytes
+//   char    fonts[fontBytes]          NUL-terminated UTF-8 font names
+// Device rects match FPDF_PageToDevice on a page of round(size * scale).
+
+static const int kTextLayoutHeaderWords = 8;
+static const int kTextLayoutFieldCount = 14;
+
+// PDFium_ExtractTextLayout option: only fill rect geometry (skips text,
+// font and color lookups)
+static const int kTextLayoutGeometryOnly = 1;
+
+struct TextLayoutEntry {
+    float deviceLeft, deviceTop, deviceWidth, deviceHeight;
+    float pageLeft, pageTop, pageRight, pageBottom;
+    int32_t charIndex, textStart, textLength;
+    float fontSize;
+    uint32_t fillColor;
+    int32_t fontIndex;
+};
+
+static int32_t InternFontName(std::vector<std::string>& fonts, const std::string& name) {
+    for (size_t i = 0; i < fonts.size(); ++i) {
+        if (fonts[i] == name) {
+            return static_cast<int32_t>(i);
+        }
+    }
+    fonts.push_back(name);
+    return static_cast<int32_t>(fonts.size() - 1);
+}
+
+// Extract the layout of `count` chars from `startIndex` (count -1 = to the
+// end). Returns a buffer to release with PDFium_FreeBuffer, or nullptr.
+EMSCRIPTEN_KEEPALIVE
+void* PDFium_ExtractTextLayout(FPDF_PAGE page, FPDF_TEXTPAGE textPage,
+                               int startIndex, int count,
+                               double scale, int rotate, int options) {
+    if (!page || !textPage || scale <= 0) {
+        return nullptr;
+    }
+
+    int sizeX = static_cast<int>(std::lround(FPDF_GetPageWidth(page) * scale));
+    int sizeY = static_cast<int>(std::lround(FPDF_GetPageHeight(page) * scale));
+    if (rotate % 2 != 0) {
+        int tmp = sizeX;
+        sizeX = sizeY;
+        sizeY = tmp;
+    }
+    const bool geometryOnly = (options & kTextLayoutGeometryOnly) != 0;
+
+    std::vector<TextLayoutEntry> entries;
+    std::vector<unsigned short> text;
+    std::vector<std::string> fonts;
+
+    int rectCount = FPDFText_CountRects(textPage, startIndex, count);
+    entries.reserve(rectCount > 0 ? rectCount : 0);
+
+    for (int i = 0; i < rectCount; ++i) {
+        double left, top, right, bottom;
+        if (!FPDFText_GetRect(textPage, i, &left, &top, &right, &bottom)) {
+            continue;
+        }
+
+        int x1, y1, x2, y2;
+        FPDF_PageToDevice(page, 0, 0, sizeX, sizeY, rotate, left, top, &x1, &y1);
+        FPDF_PageToDevice(page, 0, 0, sizeX, sizeY, rotate, right, bottom, &x2, &y2);
+
+        TextLayoutEntry entry;
+        entry.deviceLeft = static_cast<float>(x1 < x2 ? x1 : x2);
+        entry.deviceTop = static_cast<float>(y1 < y2 ? y1 : y2);
+        entry.deviceWidth = static_cast<float>(std::abs(x2 - x1));
+        entry.deviceHeight = static_cast<float>(std::abs(y2 - y1));
+        entry.pageLeft = static_cast<float>(left);
+        entry.pageTop = static_cast<float>(top);
+        entry.pageRight = static_cast<float>(right);
+        entry.pageBottom = static_cast<float>(bottom);
+        entry.charIndex = -1;
+        entry.textStart = static_cast<int32_t>(text.size());
+        entry.textLength = 0;
+        entry.fontSize = static_cast<float>(std::fabs(top - bottom));
+        entry.fillColor = 0xff000000u;
+        entry.fontIndex = -1;
+
+        if (!geometryOnly) {
+            int units = FPDFText_GetBoundedText(textPage, left, top, right, bottom, nullptr, 0);
+            if (units > 0) {
+                size_t offset = text.size();
+                text.resize(offset + units);
+                int written = FPDFText_GetBoundedText(textPage, left, top, right, bottom,
+                                                      &text[offset], units);
+                text.resize(offset + (written > 0 ? written : 0));
+                entry.textLength = static_cast<int32_t>(text.size() - offset);
+            }
+
+            entry.charIndex = FPDFText_GetCharIndexAtPos(textPage, left, top, 2, 2);
+            if (entry.charIndex >= 0) {
+                entry.fontSize = static_cast<float>(FPDFText_GetFontSize(textPage, entry.charIndex));
+
+                unsigned int r, g, b, a;
+                if (FPDFText_GetFillColor(textPage, entry.charIndex, &r, &g, &b, &a)) {
+                    entry.fillColor = (r & 0xff) | ((g & 0xff) << 8) | ((b & 0xff) << 16) |
+                                      ((a & 0xff) << 24);
+                }
+
+                int fontFlags = 0;
+                unsigned long nameLen =
+                    FPDFText_GetFontInfo(textPage, entry.charIndex, nullptr, 0, &fontFlags);
+                if (nameLen > 0) {
+                    std::string name(nameLen, '\0');
+                    FPDFText_GetFontInfo(textPage, entry.charIndex, &name[0], nameLen, &fontFlags);
+                    name.resize(strlen(name.c_str()));
+                    entry.fontIndex = InternFontName(fonts, name);
+                }
+            }
+        }
+
+        entries.push_back(entry);
+    }
+
+    size_t fontBytes = 0;
+    for (const std::string& name : fonts) {
+        fontBytes += name.size() + 1;
+    }
+
+    const size_t n = entries.size();
+    const size_t textBytes = (text.size() * 2 + 3) & ~static_cast<size_t>(3);
+    const size_t total = kTextLayoutHeaderWords * 4 + n * kTextLayoutFieldCount * 4 +
+                         textBytes + fontBytes;
+    uint8_t* out = static_cast<uint8_t*>(malloc(total));
+    if (!out) {
+        return nullptr;
+    }
+    memset(out, 0, total);
+
+    int32_t* header = reinterpret_cast<int32_t*>(out);
+    header[0] = static_cast<int32_t>(n);
+    header[1] = static_cast<int32_t>(text.size());
+    header[2] = static_cast<int32_t>(fonts.size());
+    header[3] = static_cast<int32_t>(fontBytes);
+    header[4] = kTextLayoutFieldCount;
+
+    // Every field is 4 bytes wide, so columns are written as raw 32-bit words
+    uint32_t* columns = reinterpret_cast<uint32_t*>(out + kTextLayoutHeaderWords * 4);
+    for (size_t i = 0; i < n; ++i) {
+        const TextLayoutEntry& e = entries[i];
+        const void* fields[kTextLayoutFieldCount] = {
+            &e.deviceLeft, &e.deviceTop, &e.deviceWidth, &e.deviceHeight,
+            &e.pageLeft, &e.pageTop, &e.pageRight, &e.pageBottom,
+            &e.charIndex, &e.textStart, &e.textLength,
+            &e.fontSize, &e.fillColor, &e.fontIndex,
+        };
+        for (int f = 0; f < kTextLayoutFieldCount; ++f) {
+            memcpy(&columns[f * n + i], fields[f], 4);
+        }
+    }
+
+    uint8_t* cursor = out + kTextLayoutHeaderWords * 4 + n * kTextLayoutFieldCount * 4;
+    if (!text.empty()) {
+        memcpy(cursor, text.data(), text.size() * 2);
+    }
+    cursor += textBytes;
+    for (const std::string& name : fonts) {
+        memcpy(cursor, name.c_str(), name.size() + 1);
+        cursor += name.size() + 1;
+    }
+
+    return out;
+}
+
+// ============================================================================
+// Spatial Index - Hit-testing chars, links and annotations under the pointer
+// ============================================================================
+// Hover and drag-selection ask what lies under the pointer on every move.
+// FPDFText_GetCharIndexAtPos scans every char of the page, and link and
+// annotation rects otherwise sit in JS arrays that are scanned linearly. The
+// index buckets a page's loose char boxes, link rects and annotation rects
+// into a uniform grid of about kSpatialItemsPerCell items per cell, so a query
+// only visits the cells it overlaps. The page cache builds it on the first
+// query of a page and drops it with the page's entry (eviction or
+// invalidation after an edit), or on its own with PDFium_PageCacheDropSpatial
+// when only the page's annotations changed. Hidden and popup annotations are
+// left out.
+// Queries take device pixels of the page rendered at `scale` and `rotate`,
+// like PDFium_ExtractTextLayout, so each pointer event is one call.
+// Hit test output (int32[3], -1 = nothing within tolerance):
+//   charIndex, linkAnnotIndex, annotIndex
+// Query range layout (all fields 4 bytes):
+//   int32   rangeCount, then rangeCount pairs of (firstChar, charCount)
+
+// Hit test kinds
+static const int kSpatialChars = 1;
+static const int kSpatialLinks = 2;
+static const int kSpatialAnnots = 4;
+
+static const int kSpatialItemsPerCell = 4;
+static const int kSpatialMaxCellsPerSide = 128;
+
+struct SpatialItem {
+    float left, bottom, right, top;  // page space, left <= right, bottom <= top
+    int32_t id;                      // char index or annotation index
+    int32_t kind;
+};
+
+struct SpatialIndex {
+    float left = 0, bottom = 0;
+    float cellWidth = 1, cellHeight = 1;
+    int cols = 1, rows = 1;
+    std::vector<SpatialItem> items;
+    std::vector<uint32_t> cellStart;  // cols * rows + 1 offsets into cellItems
+    std::vector<uint32_t> cellItems;  // item indices, grouped by cell
+    std::vector<uint32_t> seen;       // per item: stamp of the last query that visited it
+    std::vector<uint32_t> found;      // result of the last Collect, reused between queries
+    uint32_t stamp = 0;
+
+    void CellSpan(float l, float b, float r, float t, int* c0, int* r0, int* c1,
+                  int* r1) const {
+        auto clampCell = [](float v, int n) {
+            return std::min(n - 1, std::max(0, static_cast<int>(std::floor(v))));
+        };
+        *c0 = clampCell((l - left) / cellWidth, cols);
+        *c1 = clampCell((r - left) / cellWidth, cols);
+        *r0 = clampCell((b - bottom) / cellHeight, rows);
+        *r1 = clampCell((t - bottom) / cellHeight, rows);
+    }
+
+    // Fill `found` with every item, once, of the cells overlapping the rect
+    void Collect(float l, float b, float r, float t) {
+        found.clear();
+        if (++stamp == 0) {
+            std::fill(seen.begin(), seen.end(), 0);
+            stamp = 1;
+        }
+        int c0, r0, c1, r1;
+        CellSpan(l, b, r, t, &c0, &r0, &c1, &r1);
+        for (int row = r0; row <= r1; ++row) {
+            for (int col = c0; col <= c1; ++col) {
+                size_t cell = static_cast<size_t>(row) * cols + col;
+                for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                    uint32_t item = cellItems[k];
+                    if (seen[item] != stamp) {
+                        seen[item] = stamp;
+                        found.push_back(item);
+                    }
+                }
+            }
+        }
+    }
+};
+
+static void AddSpatialItem(std::vector<SpatialItem>& items, float l, float b, float r, float t,
+                           int32_t id, int32_t kind) {
+    SpatialItem item;
+    item.left = std::min(l, r);
+    item.right = std::max(l, r);
+    item.bottom = std::min(b, t);
+    item.top = std::max(b, t);
+    item.id = id;
+    item.kind = kind;
+    if (item.right > item.left || item.top > item.bottom) {
+        items.push_back(item);
+    }
+}
+
+static SpatialIndex* BuildSpatialIndex(FPDF_PAGE page, FPDF_TEXTPAGE textPage) {
+    SpatialIndex* index = new SpatialIndex();
+    std::vector<SpatialItem>& items = index->items;
+
+    int charCount = textPage ? FPDFText_CountChars(textPage) : 0;
+    items.reserve(charCount > 0 ? charCount : 0);
+    for (int i = 0; i < charCount; ++i) {
+        FS_RECTF box;
+        if (FPDFText_GetLooseCharBox(textPage, i, &box)) {
+            AddSpatialItem(items, box.left, box.bottom, box.right, box.top, i, kSpatialChars);
+        }
+    }
+
+    int annotCount = FPDFPage_GetAnnotCount(page);
+    for (int i = 0; i < annotCount; ++i) {
+        FPDF_ANNOTATION annot = FPDFPage_GetAnnot(page, i);
+        if (!annot) {
+            continue;
+        }
+        FPDF_ANNOTATION_SUBTYPE subtype = FPDFAnnot_GetSubtype(annot);
+        FS_RECTF rect;
+        if (subtype != FPDF_ANNOT_POPUP &&
+            (FPDFAnnot_GetFlags(annot) & FPDF_ANNOT_FLAG_HIDDEN) == 0 &&
+            FPDFAnnot_GetRect(annot, &rect)) {
+            AddSpatialItem(items, rect.left, rect.bottom, rect.right, rect.top, i,
+                           subtype == FPDF_ANNOT_LINK ? kSpatialLinks : kSpatialAnnots);
+        }
+        FPDFPage_CloseAnnot(annot);
+    }
+
+    const size_t n = items.size();
+    if (n > 0) {
+        float l = items[0].left, b = items[0].bottom, r = items[0].right, t = items[0].top;
+        for (const SpatialItem& item : items) {
+            l = std::min(l, item.left);
+            b = std::min(b, item.bottom);
+            r = std::max(r, item.right);
+            t = std::max(t, item.top);
+        }
+        // Aim for square-ish cells holding kSpatialItemsPerCell items on average
+        double width = std::max(1.0f, r - l);
+        double height = std::max(1.0f, t - b);
+        double cells = std::max(1.0, static_cast<double>(n) / kSpatialItemsPerCell);
+        index->cols = std::min(kSpatialMaxCellsPerSide,
+                               std::max(1, static_cast<int>(std::ceil(
+                                               std::sqrt(cells * width / height)))));
+        index->rows = std::min(kSpatialMaxCellsPerSide,
+                               std::max(1, static_cast<int>(std::ceil(cells / index->cols))));
+        index->left = l;
+        index->bottom = b;
+        index->cellWidth = static_cast<float>(width / index->cols);
+        index->cellHeight = static_cast<float>(height / index->rows);
+    }
+
+    // Bucket items into every cell they overlap: count, prefix-sum, fill
+    const size_t cellCount = static_cast<size_t>(index->cols) * index->rows;
+    index->cellStart.assign(cellCount + 1, 0);
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<uint32_t> cursor;
+        if (pass == 1) {
+            for (size_t c = 0; c < cellCount; ++c) {
+                index->cellStart[c + 1] += index->cellStart[c];
+            }
+            index->cellItems.resize(index->cellStart[cellCount]);
+            cursor.assign(index->cellStart.begin(), index->cellStart.end() - 1);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            const SpatialItem& item = items[i];
+            int c0, r0, c1, r1;
+            index->CellSpan(item.left, item.bottom, item.right, item.top, &c0, &r0, &c1, &r1);
+            for (int row = r0; row <= r1; ++row) {
+                for (int col = c0; col <= c1; ++col) {
+                    size_t cell = static_cast<size_t>(row) * index->cols + col;
+                    if (pass == 0) {
+                        ++index->cellStart[cell + 1];
+                    } else {
+                        index->cellItems[cursor[cell]++] = static_cast<uint32_t>(i);
+                    }
+                }
+            }
+        }
+    }
+    index->seen.assign(n, 0);
+    return index;
+}
+
+static size_t SpatialIndexBytes(const SpatialIndex* index) {
+    if (!index) {
+        return 0;
+    }
+    return sizeof(SpatialIndex) + index->items.capacity() * sizeof(SpatialItem) +
+           (index->cellStart.capacity() + index->cellItems.capacity() +
+            index->seen.capacity() * 2) * sizeof(uint32_t);
+}
+
+static void DestroySpatialIndex(SpatialIndex* index) {
+    delete index;
+}
+
+// Device pixels of the page rendered at scale/rotate to page space
+struct SpatialDeviceMapper {
+    FPDF_PAGE page;
+    int sizeX, sizeY, rotate;
+
+    SpatialDeviceMapper(FPDF_PAGE p, double scale, int r) : page(p), rotate(r) {
+        sizeX = static_cast<int>(std::lround(FPDF_GetPageWidth(page) * scale));
+        sizeY = static_cast<int>(std::lround(FPDF_GetPageHeight(page) * scale));
+        if (rotate % 2 != 0) {
+            std::swap(sizeX, sizeY);
+        }
+    }
+
+    void Map(double x, double y, float* pageX, float* pageY) const {
+        double px = 0, py = 0;
+        FPDF_DeviceToPage(page, 0, 0, sizeX, sizeY, rotate, static_cast<int>(std::lround(x)),
+                          static_cast<int>(std::lround(y)), &px, &py);
+        *pageX = static_cast<float>(px);
+        *pageY = static_cast<float>(py);
+    }
+};
+
+// Distance from a point to a rect (0 inside), Chebyshev so the tolerance is a
+// square around the pointer like FPDFText_GetCharIndexAtPos's
+static float SpatialDistance(const SpatialItem& item, float x, float y) {
+    float dx = std::max(0.0f, std::max(item.left - x, x - item.right));
+    float dy = std::max(0.0f, std::max(item.bottom - y, y - item.top));
+    return std::max(dx, dy);
+}
+
+// What lies under device point (x, y) of page `pageIndex`, within `tolerance`
+// device pixels. Fills out[3] and returns the kinds that were hit. The nearest
+// char wins; among links and annotations the nearest and then the topmost
+// (last drawn) one wins.
+EMSCRIPTEN_KEEPALIVE
+int PDFium_HitTest(PageCache* cache, int pageIndex, double scale, int rotate, double x,
+                   double y, double tolerance, int kinds, int32_t* out) {
+    if (!out) {
+        return 0;
+    }
+    out[0] = out[1] = out[2] = -1;
+    if (!cache || scale <= 0) {
+        return 0;
+    }
+    auto entry = cache->LoadSpatial(pageIndex);
+    if (entry == cache->lru.end() || !entry->spatial) {
+        return 0;
+    }
+
+    float px, py;
+    SpatialDeviceMapper(entry->page, scale, rotate).Map(x, y, &px, &py);
+    const float tol = static_cast<float>(std::max(0.0, tolerance) / scale);
+
+    SpatialIndex* index = entry->spatial;
+    float best[3] = {tol, tol, tol};
+    int hits = 0;
+    index->Collect(px - tol, py - tol, px + tol, py + tol);
+    for (uint32_t i : index->found) {
+        const SpatialItem& item = index->items[i];
+        if ((item.kind & kinds) == 0) {
+            continue;
+        }
+        float dist = SpatialDistance(item, px, py);
+        int slot = item.kind == kSpatialChars ? 0 : item.kind == kSpatialLinks ? 1 : 2;
+        if (dist > best[slot]) {
+            continue;
+        }
+        bool better = out[slot] < 0 || dist < best[slot] ||
+                      (slot == 0 ? item.id < out[slot] : item.id > out[slot]);
+        if (better) {
+            best[slot] = dist;
+            out[slot] = item.id;
+            hits |= item.kind;
+        }
+    }
+
+    cache->Trim();
+    return hits;
+}
+
+// Chars of page `pageIndex` whose loose boxes intersect a device rect, as
+// ascending, merged index ranges. Returns a buffer to release with
+// PDFium_FreeBuffer, or nullptr.
+EMSCRIPTEN_KEEPALIVE
+void* PDFium_QueryRange(PageCache* cache, int pageIndex, double scale, int rotate,
+                        double left, double top, double right, double bottom) {
+    if (!cache || scale <= 0) {
+        return nullptr;
+    }
+    auto entry = cache->LoadSpatial(pageIndex);
+    if (entry == cache->lru.end() || !entry->spatial) {
+        return nullptr;
+    }
+
+    SpatialDeviceMapper mapper(entry->page, scale, rotate);
+    float x1, y1, x2, y2;
+    mapper.Map(left, top, &x1, &y1);
+    mapper.Map(right, bottom, &x2, &y2);
+    const float l = std::min(x1, x2), r = std::max(x1, x2);
+    const float b = std::min(y1, y2), t = std::max(y1, y2);
+
+    SpatialIndex* index = entry->spatial;
+    std::vector<int32_t> chars;
+    index->Collect(l, b, r, t);
+    for (uint32_t i : index->found) {
+        const SpatialItem& item = index->items[i];
+        if (item.kind == kSpatialChars && item.left <= r && item.right >= l &&
+            item.bottom <= t && item.top >= b) {
+            chars.push_back(item.id);
+        }
+    }
+    cache->Trim();
+    std::sort(chars.begin(), chars.end());
+
+    std::vector<int32_t> ranges;
+    for (int32_t c : chars) {
+        if (!ranges.empty() && ranges[ranges.size() - 2] + ranges.back() == c) {
+            ++ranges.back();
+        } else {
+            ranges.push_back(c);
+            ranges.push_back(1);
+        }
+    }
+
+    const size_t total = (1 + ranges.size()) * 4;
+    int32_t* out = static_cast<int32_t*>(malloc(total));
+    if (!out) {
+        return nullptr;
+    }
+    out[0] = static_cast<int32_t>(ranges.size() / 2);
+    if (!ranges.empty()) {
+        memcpy(out + 1, ranges.data(), ranges.size() * 4);
+    }
+    return out;
+}
+
+// Drop a page's spatial index after its annotations changed; the page stays
+// cached and the next query rebuilds the index from it.
+EMSCRIPTEN_KEEPALIVE
+void PDFium_PageCacheDropSpatial(PageCache* cache, int pageIndex) {
+    if (!cache) {
+        return;
+    }
+    auto it = cache->index.find(pageIndex);
+    if (it != cache->index.end() && it->second->spatial) {
+        cache->DropSpatial(it->second);
+    }
+}
 
 // ============================================================================
 // Text Search API - Find text within a page
@@ -380,18 +2688,21 @@ int PDFium_GetBoundedText(FPDF_TEXTPAGE textPage, double left, double top,
 EMSCRIPTEN_KEEPALIVE
 FPDF_SCHHANDLE PDFium_FindStart(FPDF_TEXTPAGE textPage, const unsigned short* findWhat,
                                  unsigned long flags, int startIndex) {
+    PerfScope perf(kPerfSearch);
     return FPDFText_FindStart(textPage, findWhat, flags, startIndex);
 }
 
 // Find next occurrence
 EMSCRIPTEN_KEEPALIVE
 FPDF_BOOL PDFium_FindNext(FPDF_SCHHANDLE searchHandle) {
+    PerfScope perf(kPerfSearch);
     return FPDFText_FindNext(searchHandle);
 }
 
 // Find previous occurrence
 EMSCRIPTEN_KEEPALIVE
 FPDF_BOOL PDFium_FindPrev(FPDF_SCHHANDLE searchHandle) {
+    PerfScope perf(kPerfSearch);
     return FPDFText_FindPrev(searchHandle);
 }
 
@@ -455,6 +2766,135 @@ int PDFium_GetDestPageIndex(FPDF_DOCUMENT doc, FPDF_DEST dest) {
     return FPDFDest_GetDestPageIndex(doc, dest);
 }
 
+// ============================================================================
+// Outline Serialization - A bookmark tree or subtree in one buffer
+// ============================================================================
+// Walking the outline through the bookmark exports costs five calls per node
+// plus a two-pass title read, which stalls on manuals with tens of thousands
+// of entries. This walks it natively, in pre-order and without recursion, and
+// skips any bookmark already visited, so a /First or /Next chain that loops
+// back ends instead of spinning. Nodes deeper than maxDepth are left out and
+// their parent is flagged, so large trees can be expanded on demand by
+// serializing the children of that parent's handle.
+// Layout (all fields 4 bytes):
+//   int32   header[4]   nodeCount, textUnits, kOutlineNodeWords, 0
+//   per node (kOutlineNodeWords words):
+//     int32   bookmark          handle, valid while the document is open
+//     int32   depth             0 = child of the serialized parent
+//     int32   pageIndex         kOutlineDestUnresolved / kOutlineDestMissing if none
+//     int32   flags             kOutlineHas* bits
+//     int32   titleStart, titleLength   UTF-16 range in the text block
+//   uint16  text[textUnits]     padded to 4 bytes
+
+static const int kOutlineHeaderWords = 4;
+static const int kOutlineNodeWords = 6;
+
+static const int32_t kOutlineDestUnresolved = -1;
+static const int32_t kOutlineDestMissing = -2;
+
+static const int32_t kOutlineHasChildren = 1;
+// Children exist but are deeper than maxDepth
+static const int32_t kOutlineChildrenOmitted = 2;
+
+// Serialize the bookmarks under `parent` (nullptr = the whole outline), at
+// most maxDepth levels deep (<= 0 = unlimited). Returns a buffer to release
+// with PDFium_FreeBuffer, or nullptr when there are no such bookmarks.
+EMSCRIPTEN_KEEPALIVE
+void* PDFium_SerializeOutline(FPDF_DOCUMENT doc, FPDF_BOOKMARK parent, int maxDepth) {
+    if (!doc) {
+        return nullptr;
+    }
+    std::vector<int32_t> nodes;
+    std::vector<unsigned short> text;
+    std::unordered_set<FPDF_BOOKMARK> visited;
+    std::vector<std::pair<FPDF_BOOKMARK, int32_t>> pending;
+    if (parent) {
+        visited.insert(parent);
+    }
+    FPDF_BOOKMARK first = FPDFBookmark_GetFirstChild(doc, parent);
+    if (first) {
+        pending.emplace_back(first, 0);
+    }
+
+    while (!pending.empty()) {
+        FPDF_BOOKMARK bookmark = pending.back().first;
+        int32_t depth = pending.back().second;
+        pending.pop_back();
+        if (!visited.insert(bookmark).second) {
+            continue;
+        }
+
+        int32_t pageIndex = kOutlineDestMissing;
+        FPDF_DEST dest = FPDFBookmark_GetDest(doc, bookmark);
+        if (dest) {
+            pageIndex = FPDFDest_GetDestPageIndex(doc, dest);
+            if (pageIndex < 0) {
+                pageIndex = kOutlineDestUnresolved;
+            }
+        }
+
+        int32_t titleStart = static_cast<int32_t>(text.size());
+        int32_t titleLength = 0;
+        unsigned long needed = FPDFBookmark_GetTitle(bookmark, nullptr, 0);
+        if (needed > 2) {
+            size_t units = needed / 2;
+            text.resize(titleStart + units);
+            FPDFBookmark_GetTitle(bookmark, &text[titleStart], needed);
+            // Drop the NUL terminator
+            text.resize(titleStart + units - 1);
+            titleLength = static_cast<int32_t>(units - 1);
+        }
+
+        // Push the next sibling first so the subtree is emitted before it
+        FPDF_BOOKMARK next = FPDFBookmark_GetNextSibling(doc, bookmark);
+        if (next) {
+            pending.emplace_back(next, depth);
+        }
+        int32_t flags = 0;
+        FPDF_BOOKMARK child = FPDFBookmark_GetFirstChild(doc, bookmark);
+        if (child && !visited.count(child)) {
+            flags |= kOutlineHasChildren;
+            if (maxDepth <= 0 || depth + 1 < maxDepth) {
+                pending.emplace_back(child, depth + 1);
+            } else {
+                flags |= kOutlineChildrenOmitted;
+            }
+        }
+
+        nodes.push_back(static_cast<int32_t>(reinterpret_cast<uintptr_t>(bookmark)));
+        nodes.push_back(depth);
+        nodes.push_back(pageIndex);
+        nodes.push_back(flags);
+        nodes.push_back(titleStart);
+        nodes.push_back(titleLength);
+    }
+
+    if (nodes.empty()) {
+        return nullptr;
+    }
+    const size_t nodeCount = nodes.size() / kOutlineNodeWords;
+    const size_t headerBytes = kOutlineHeaderWords * 4;
+    const size_t nodeBytes = nodes.size() * 4;
+    const size_t textBytes = (text.size() * 2 + 3) & ~static_cast<size_t>(3);
+    uint8_t* out = static_cast<uint8_t*>(malloc(headerBytes + nodeBytes + textBytes));
+    if (!out) {
+        return nullptr;
+    }
+    int32_t header[kOutlineHeaderWords] = {
+        static_cast<int32_t>(nodeCount),
+        static_cast<int32_t>(text.size()),
+        kOutlineNodeWords,
+        0,
+    };
+    memcpy(out, header, headerBytes);
+    memcpy(out + headerBytes, nodes.data(), nodeBytes);
+    memset(out + headerBytes + nodeBytes, 0, textBytes);
+    if (!text.empty()) {
+        memcpy(out + headerBytes + nodeBytes, text.data(), text.size() * 2);
+    }
+    return out;
+}
+
 EMSCRIPTEN_KEEPALIVE
 void* PDFium_Malloc(int size) {
     return malloc(size);
@@ -467,6 +2907,418 @@ void PDFium_Free(void* ptr) {
     }
 }
 
+// ============================================================================
+// Document Search Index
+// ============================================================================
+// Extracts each page's text once, case-folds it and keeps it per document, so
+// a query is a substring scan over memory instead of reloading every page and
+// rerunning FPDFText_FindStart. Only the folded text is stored (one code point
+// per text-page char index, so chars outside the BMP fold and match like any
+// other); selection rects are resolved on demand for pages that actually
+// match, which keeps the index at four bytes per char.
+//
+// PDFium_SearchIndexQuery result layout:
+//   int32   header[4]    resultCount, rectCount, nextPage, 0
+//   int32   results[5 * resultCount]   pageIndex, charIndex, charCount,
+//                                      firstRect, rectCount
+//   float32 rects[4 * rectCount]       left, top, width, height (device)
+// Device rects match FPDF_PageToDevice on a page of round(size * scale).
+
+static const int kSearchHeaderWords = 4;
+static const int kSearchResultWords = 5;
+
+struct SearchIndexPage {
+    bool indexed = false;
+    std::vector<uint32_t> folded;
+};
+
+struct SearchIndex {
+    FPDF_DOCUMENT doc;
+    std::vector<SearchIndexPage> pages;
+    int cursor = 0;  // next page PDFium_SearchIndexBuild looks at
+};
+
+struct SearchHit {
+    int32_t pageIndex;
+    int32_t charIndex;
+    int32_t charCount;
+    int32_t firstRect;
+    int32_t rectCount;
+};
+
+// Simple case folding for Latin, Greek and Cyrillic; whitespace and the line
+// breaks PDFium generates between lines fold to a space so phrases match
+// across lines.
+static uint32_t FoldSearchChar(unsigned int c) {
+    if (c == '\r' || c == '\n' || c == '\t' || c == 0xA0 || (c >= 0x2000 && c <= 0x200A)) {
+        return ' ';
+    }
+    if (c < 0x80) {
+        return c >= 'A' && c <= 'Z' ? c + 32 : c;
+    }
+    if (c >= 0xC0 && c <= 0xDE && c != 0xD7) {
+        return c + 32;
+    }
+    if (c >= 0x100 && c <= 0x17F) {
+        if (c == 0x130 || c == 0x131 || c == 0x138 || c == 0x149 || c == 0x17F) {
+            return c;
+        }
+        if (c == 0x178) {
+            return 0xFF;
+        }
+        // Upper case sits on the odd code point in these two runs, even elsewhere
+        bool oddUpper = (c >= 0x139 && c <= 0x148) || (c >= 0x179 && c <= 0x17E);
+        bool isUpper = oddUpper ? (c & 1) != 0 : (c & 1) == 0;
+        return isUpper ? c + 1 : c;
+    }
+    if (c >= 0x391 && c <= 0x3AB && c != 0x3A2) {
+        return c + 32;
+    }
+    if (c >= 0x410 && c <= 0x42F) {
+        return c + 32;
+    }
+    if (c >= 0x400 && c <= 0x40F) {
+        return c + 80;
+    }
+    return c;
+}
+
+static void SearchIndexLoadPage(SearchIndex* index, int pageIndex) {
+    SearchIndexPage& entry = index->pages[pageIndex];
+    if (entry.indexed) {
+        return;
+    }
+    // Pages that fail to load are indexed as empty rather than retried per query
+    entry.indexed = true;
+    FPDF_PAGE page = LoadPageCounted(index->doc, pageIndex);
+    if (!page) {
+        return;
+    }
+    FPDF_TEXTPAGE textPage = LoadTextPageCounted(page);
+    if (textPage) {
+        int count = FPDFText_CountChars(textPage);
+        entry.folded.resize(count > 0 ? count : 0);
+        for (int i = 0; i < count; ++i) {
+            entry.folded[i] = FoldSearchChar(FPDFText_GetUnicode(textPage, i));
+        }
+        FPDFText_ClosePage(textPage);
+    }
+    FPDF_ClosePage(page);
+}
+
+// A folded query (code points, like the indexed text) plus its Horspool skip table
+struct SearchNeedle {
+    std::vector<uint32_t> chars;
+    size_t skip[256];
+};
+
+static void PrepareSearchNeedle(const unsigned short* query, SearchNeedle& needle) {
+    needle.chars.clear();
+    for (const unsigned short* p = query; *p; ++p) {
+        unsigned int c = *p;
+        // A surrogate pair is one text-page char; a lone surrogate stays a unit
+        if (c >= 0xD800 && c <= 0xDBFF && p[1] >= 0xDC00 && p[1] <= 0xDFFF) {
+            c = 0x10000 + ((c - 0xD800) << 10) + (p[1] - 0xDC00);
+            ++p;
+        }
+        needle.chars.push_back(FoldSearchChar(c));
+    }
+    const size_t m = needle.chars.size();
+    for (size_t& s : needle.skip) {
+        s = m;
+    }
+    for (size_t i = 0; i + 1 < m; ++i) {
+        needle.skip[needle.chars[i] & 0xFF] = m - 1 - i;
+    }
+}
+
+// Boyer-Moore-Horspool over code points, with the skip table keyed by the low
+// byte (collisions only shorten skips). Matches do not overlap, like
+// FPDFText_FindNext.
+static void SearchIndexScanPage(const std::vector<uint32_t>& text, const SearchNeedle& needle,
+                                int pageIndex, std::vector<SearchHit>& hits) {
+    const size_t m = needle.chars.size();
+    const size_t n = text.size();
+    if (m == 0 || n < m) {
+        return;
+    }
+    const uint32_t last = needle.chars[m - 1];
+    const size_t* skip = needle.skip;
+    size_t pos = 0;
+    while (pos + m <= n) {
+        uint32_t tail = text[pos + m - 1];
+        if (tail == last && memcmp(&text[pos], needle.chars.data(), (m - 1) * 4) == 0) {
+            SearchHit hit = {pageIndex, static_cast<int32_t>(pos), static_cast<int32_t>(m), 0, 0};
+            hits.push_back(hit);
+            pos += m;
+        } else {
+            pos += skip[tail & 0xFF];
+        }
+    }
+}
+
+// Append the device rects of every hit on page `pageIndex` (hits[first, end))
+static void SearchIndexResolveRects(SearchIndex* index, int pageIndex, double scale,
+                                    std::vector<SearchHit>& hits, size_t first, size_t end,
+                                    std::vector<float>& rects) {
+    FPDF_PAGE page = LoadPageCounted(index->doc, pageIndex);
+    if (!page) {
+        return;
+    }
+    FPDF_TEXTPAGE textPage = LoadTextPageCounted(page);
+    if (textPage) {
+        int sizeX = static_cast<int>(std::lround(FPDF_GetPageWidth(page) * scale));
+        int sizeY = static_cast<int>(std::lround(FPDF_GetPageHeight(page) * scale));
+        for (size_t h = first; h < end; ++h) {
+            SearchHit& hit = hits[h];
+            hit.firstRect = static_cast<int32_t>(rects.size() / 4);
+            int rectCount = FPDFText_CountRects(textPage, hit.charIndex, hit.charCount);
+            for (int i = 0; i < rectCount; ++i) {
+                double left, top, right, bottom;
+                if (!FPDFText_GetRect(textPage, i, &left, &top, &right, &bottom)) {
+                    continue;
+                }
+                int x1, y1, x2, y2;
+                FPDF_PageToDevice(page, 0, 0, sizeX, sizeY, 0, left, top, &x1, &y1);
+                FPDF_PageToDevice(page, 0, 0, sizeX, sizeY, 0, right, bottom, &x2, &y2);
+                rects.push_back(static_cast<float>(x1 < x2 ? x1 : x2));
+                rects.push_back(static_cast<float>(y1 < y2 ? y1 : y2));
+                rects.push_back(static_cast<float>(std::abs(x2 - x1)));
+                rects.push_back(static_cast<float>(std::abs(y2 - y1)));
+            }
+            hit.rectCount = static_cast<int32_t>(rects.size() / 4) - hit.firstRect;
+        }
+        FPDFText_ClosePage(textPage);
+    }
+    FPDF_ClosePage(page);
+}
+
+// Index (if needed), scan and resolve rects of one page
+static void SearchIndexSearchPage(SearchIndex* index, int pageIndex, const SearchNeedle& needle,
+                                  double scale, std::vector<SearchHit>& hits,
+                                  std::vector<float>& rects) {
+    if (pageIndex < 0 || pageIndex >= static_cast<int>(index->pages.size())) {
+        return;
+    }
+    SearchIndexLoadPage(index, pageIndex);
+    size_t first = hits.size();
+    SearchIndexScanPage(index->pages[pageIndex].folded, needle, pageIndex, hits);
+    if (hits.size() > first) {
+        SearchIndexResolveRects(index, pageIndex, scale, hits, first, hits.size(), rects);
+    }
+}
+
+// Pack hits and rects into the result layout; `state` fills header[2]
+static void* PackSearchResults(const std::vector<SearchHit>& hits,
+                               const std::vector<float>& rects, int32_t state) {
+    const size_t total = kSearchHeaderWords * 4 + hits.size() * kSearchResultWords * 4 +
+                         rects.size() * 4;
+    uint8_t* out = static_cast<uint8_t*>(malloc(total));
+    if (!out) {
+        return nullptr;
+    }
+    int32_t* header = reinterpret_cast<int32_t*>(out);
+    header[0] = static_cast<int32_t>(hits.size());
+    header[1] = static_cast<int32_t>(rects.size() / 4);
+    header[2] = state;
+    header[3] = 0;
+    uint8_t* cursor = out + kSearchHeaderWords * 4;
+    if (!hits.empty()) {
+        memcpy(cursor, hits.data(), hits.size() * sizeof(SearchHit));
+        cursor += hits.size() * sizeof(SearchHit);
+    }
+    if (!rects.empty()) {
+        memcpy(cursor, rects.data(), rects.size() * 4);
+    }
+    return out;
+}
+
+EMSCRIPTEN_KEEPALIVE
+SearchIndex* PDFium_SearchIndexCreate(FPDF_DOCUMENT doc) {
+    if (!doc) {
+        return nullptr;
+    }
+    SearchIndex* index = new SearchIndex();
+    index->doc = doc;
+    int pageCount = FPDF_GetPageCount(doc);
+    index->pages.resize(pageCount > 0 ? pageCount : 0);
+    return index;
+}
+
+// Index pages ahead of the first query, for at most budgetMs (0 = all pages).
+// Returns the number of pages still to index.
+EMSCRIPTEN_KEEPALIVE
+int PDFium_SearchIndexBuild(SearchIndex* index, double budgetMs) {
+    PerfScope perf(kPerfSearch);
+    if (!index) {
+        return 0;
+    }
+    const int pageCount = static_cast<int>(index->pages.size());
+    double deadline = budgetMs > 0 ? emscripten_get_now() + budgetMs : 0;
+    while (index->cursor < pageCount) {
+        SearchIndexLoadPage(index, index->cursor++);
+        if (deadline > 0 && emscripten_get_now() >= deadline) {
+            break;
+        }
+    }
+    int remaining = 0;
+    for (const SearchIndexPage& entry : index->pages) {
+        if (!entry.indexed) {
+            remaining++;
+        }
+    }
+    return remaining;
+}
+
+// Drop the cached text of one page after its content changed (-1 = all pages,
+// which also picks up pages added or removed since the index was created)
+EMSCRIPTEN_KEEPALIVE
+void PDFium_SearchIndexInvalidate(SearchIndex* index, int pageIndex) {
+    if (!index) {
+        return;
+    }
+    if (pageIndex < 0) {
+        int pageCount = FPDF_GetPageCount(index->doc);
+        index->pages.clear();
+        index->pages.resize(pageCount > 0 ? pageCount : 0);
+        index->cursor = 0;
+        return;
+    }
+    if (pageIndex < static_cast<int>(index->pages.size())) {
+        index->pages[pageIndex] = SearchIndexPage();
+        if (pageIndex < index->cursor) {
+            index->cursor = pageIndex;
+        }
+    }
+}
+
+// Case-insensitive search of pages [startPage, endPage] (endPage -1 = last).
+// Pages not indexed yet are indexed on the way. Scanning stops at the first
+// page boundary after maxResults hits (0 = no limit); header nextPage is the
+// page to resume from, or -1 when the range is exhausted. Returns a buffer to
+// release with PDFium_FreeBuffer, or nullptr.
+EMSCRIPTEN_KEEPALIVE
+void* PDFium_SearchIndexQuery(SearchIndex* index, const unsigned short* query,
+                              int startPage, int endPage, int maxResults, double scale) {
+    PerfScope perf(kPerfSearch);
+    if (!index || !query || scale <= 0) {
+        return nullptr;
+    }
+
+    SearchNeedle needle;
+    PrepareSearchNeedle(query, needle);
+
+    const int pageCount = static_cast<int>(index->pages.size());
+    if (startPage < 0) {
+        startPage = 0;
+    }
+    if (endPage < 0 || endPage >= pageCount) {
+        endPage = pageCount - 1;
+    }
+
+    std::vector<SearchHit> hits;
+    std::vector<float> rects;
+    int nextPage = -1;
+    for (int pageIndex = startPage; !needle.chars.empty() && pageIndex <= endPage; ++pageIndex) {
+        if (maxResults > 0 && hits.size() >= static_cast<size_t>(maxResults)) {
+            nextPage = pageIndex;
+            break;
+        }
+        SearchIndexSearchPage(index, pageIndex, needle, scale, hits, rects);
+    }
+    return PackSearchResults(hits, rects, nextPage);
+}
+
+EMSCRIPTEN_KEEPALIVE
+void PDFium_SearchIndexDestroy(SearchIndex* index) {
+    delete index;
+}
+
+// ============================================================================
+// Search Cursor - Resumable, time-sliced search over a search index
+// ============================================================================
+// Works like the progressive render API. Pages are visited nearest-first
+// around an origin page (origin, origin + 1, origin - 1, origin + 2, ...) so
+// matches near the viewport come back first. Each PDFium_SearchCursorContinue
+// returns the hits of the pages it got through, in the PDFium_SearchIndexQuery
+// layout, with header[2] set to the number of pages still to visit (0 = done).
+
+struct SearchCursor {
+    SearchIndex* index;
+    SearchNeedle needle;
+    double scale;
+    int origin;
+    int pageCount;
+    int step = 0;     // position in the nearest-first visiting order
+    int visited = 0;
+};
+
+// Page at position `step` of the nearest-first order, or -1 when out of range
+static int SearchCursorPageAt(const SearchCursor* cursor, int step) {
+    int offset = (step + 1) / 2;
+    int page = (step % 2 == 1) ? cursor->origin + offset : cursor->origin - offset;
+    return (page >= 0 && page < cursor->pageCount) ? page : -1;
+}
+
+// Start a search around originPage. Close the cursor before destroying the
+// index it reads from.
+EMSCRIPTEN_KEEPALIVE
+SearchCursor* PDFium_SearchCursorStart(SearchIndex* index, const unsigned short* query,
+                                       int originPage, double scale) {
+    if (!index || !query || scale <= 0) {
+        return nullptr;
+    }
+    SearchCursor* cursor = new SearchCursor();
+    cursor->index = index;
+    PrepareSearchNeedle(query, cursor->needle);
+    cursor->scale = scale;
+    cursor->pageCount = cursor->needle.chars.empty() ? 0
+                                                     : static_cast<int>(index->pages.size());
+    if (originPage < 0) {
+        originPage = 0;
+    }
+    if (originPage >= cursor->pageCount) {
+        originPage = cursor->pageCount > 0 ? cursor->pageCount - 1 : 0;
+    }
+    cursor->origin = originPage;
+    return cursor;
+}
+
+// Search more pages for at most budgetMs (0 = to the end), stopping early at
+// the first page boundary after maxResults hits (0 = no limit). At least one
+// page is searched per call. Returns a buffer to release with
+// PDFium_FreeBuffer, or nullptr.
+EMSCRIPTEN_KEEPALIVE
+void* PDFium_SearchCursorContinue(SearchCursor* cursor, double budgetMs, int maxResults) {
+    PerfScope perf(kPerfSearch);
+    if (!cursor) {
+        return nullptr;
+    }
+    double deadline = budgetMs > 0 ? emscripten_get_now() + budgetMs : 0;
+    std::vector<SearchHit> hits;
+    std::vector<float> rects;
+    while (cursor->visited < cursor->pageCount) {
+        int page = SearchCursorPageAt(cursor, cursor->step++);
+        if (page < 0) {
+            continue;
+        }
+        SearchIndexSearchPage(cursor->index, page, cursor->needle, cursor->scale, hits, rects);
+        cursor->visited++;
+        if (maxResults > 0 && hits.size() >= static_cast<size_t>(maxResults)) {
+            break;
+        }
+        if (deadline > 0 && emscripten_get_now() >= deadline) {
+            break;
+        }
+    }
+    return PackSearchResults(hits, rects, cursor->pageCount - cursor->visited);
+}
+
+EMSCRIPTEN_KEEPALIVE
+void PDFium_SearchCursorClose(SearchCursor* cursor) {
+    delete cursor;
+}
+
 // ============================================================================
 // Annotation API - Direct PDFium function wrappers
 // ============================================================================
@@ -868,6 +3720,483 @@ FPDF_BOOL FPDFAnnot_SetURI_W(FPDF_ANNOTATION annot, const char* uri) {
     return FPDFAnnot_SetURI(annot, uri);
 }
 
+// ============================================================================
+// Annotation Serialization - All annotations of a page in one buffer
+// ============================================================================
+// Listing annotations through the _W wrappers costs several JS<->WASM calls
+// and scratch allocations per annotation, quad and ink path. This walks the
+// page once and packs everything into variable-length records.
+// Layout (all fields 4 bytes):
+//   int32   header[4]   recordCount, totalBytes, kAnnotRecordFixedWords, 0
+//   per record:
+//     int32   recordWords              length of this record, fixed part included
+//     int32   annotIndex, subtype, fields (kAnnotHas* bits)
+//     uint32  color, interiorColor     bytes R, G, B, A
+//     float32 rect[4]                  device (left, top) and (right, bottom) corners
+//     float32 borderWidth              in points
+//     int32   quadCount, inkPathCount, inkPointCount
+//     int32   destPageIndex            link destination, or -1
+//     int32   uriBytes                 link URI length (no NUL)
+//     float32 quads[quadCount * 8]     device x1, y1 .. x4, y4 (FS_QUADPOINTSF order)
+//     int32   inkPathPoints[inkPathCount]
+//     float32 inkPoints[inkPointCount * 2]   device x, y
+//     char    uri[uriBytes]            UTF-8, padded to 4 bytes
+// Device coordinates match FPDF_PageToDevice on a page of round(size * scale).
+
+static const int kAnnotHeaderWords = 4;
+static const int kAnnotRecordFixedWords = 16;
+
+static const int32_t kAnnotHasColor = 1;
+static const int32_t kAnnotHasInteriorColor = 2;
+static const int32_t kAnnotHasRect = 4;
+static const int32_t kAnnotHasBorder = 8;
+
+// PDFium_SerializePageAnnotations option: leave out form widgets (the form
+// layer lists those through FPDFAnnot_GetFormField*)
+static const int kAnnotSkipWidgets = 1;
+
+struct AnnotDeviceMapper {
+    FPDF_PAGE page;
+    int sizeX, sizeY, rotate;
+
+    void Map(float x, float y, std::vector<float>& out) const {
+        int dx, dy;
+        FPDF_PageToDevice(page, 0, 0, sizeX, sizeY, rotate, x, y, &dx, &dy);
+        out.push_back(static_cast<float>(dx));
+        out.push_back(static_cast<float>(dy));
+    }
+};
+
+static uint32_t GetAnnotColor(FPDF_ANNOTATION annot, FPDFANNOT_COLORTYPE type, bool* found) {
+    unsigned int r = 0, g = 0, b = 0, a = 255;
+    *found = FPDFAnnot_GetColor(annot, type, &r, &g, &b, &a) != 0;
+    if (!*found) {
+        return 0xff000000u;
+    }
+    return (r & 0xff) | ((g & 0xff) << 8) | ((b & 0xff) << 16) | ((a & 0xff) << 24);
+}
+
+// Resolve a link annotation's URI, or failing that its destination page
+static void ResolveAnnotLink(FPDF_DOCUMENT doc, FPDF_ANNOTATION annot, std::string& uri,
+                             int32_t& destPageIndex) {
+    FPDF_LINK link = FPDFAnnot_GetLink(annot);
+    if (!link) {
+        return;
+    }
+    FPDF_ACTION action = FPDFLink_GetAction(link);
+    if (action) {
+        unsigned long needed = FPDFAction_GetURIPath(doc, action, nullptr, 0);
+        if (needed > 1) {
+            uri.assign(needed, '\0');
+            FPDFAction_GetURIPath(doc, action, &uri[0], needed);
+            uri.resize(strlen(uri.c_str()));
+        }
+        if (uri.empty()) {
+            FPDF_DEST dest = FPDFAction_GetDest(doc, action);
+            if (dest) {
+                destPageIndex = FPDFDest_GetDestPageIndex(doc, dest);
+            }
+        }
+    }
+    if (uri.empty() && destPageIndex < 0) {
+        FPDF_DEST dest = FPDFLink_GetDest(doc, link);
+        if (dest) {
+            destPageIndex = FPDFDest_GetDestPageIndex(doc, dest);
+        }
+    }
+    if (destPageIndex < 0) {
+        destPageIndex = -1;
+    }
+}
+
+static void AppendWord(std::vector<uint32_t>& out, const void* value) {
+    uint32_t word;
+    memcpy(&word, value, 4);
+    out.push_back(word);
+}
+
+// Serialize the annotations of `page`. `doc` resolves link targets and may be
+// null to skip them. Returns a buffer to release with PDFium_FreeBuffer, or
+// nullptr.
+EMSCRIPTEN_KEEPALIVE
+void* PDFium_SerializePageAnnotations(FPDF_DOCUMENT doc, FPDF_PAGE page, double scale,
+                                      int rotate, int options) {
+    if (!page || scale <= 0) {
+        return nullptr;
+    }
+
+    AnnotDeviceMapper mapper;
+    mapper.page = page;
+    mapper.sizeX = static_cast<int>(std::lround(FPDF_GetPageWidth(page) * scale));
+    mapper.sizeY = static_cast<int>(std::lround(FPDF_GetPageHeight(page) * scale));
+    mapper.rotate = rotate;
+    if (rotate % 2 != 0) {
+        std::swap(mapper.sizeX, mapper.sizeY);
+    }
+    const bool skipWidgets = (options & kAnnotSkipWidgets) != 0;
+
+    std::vector<uint32_t> words(kAnnotHeaderWords, 0);
+    std::vector<float> quads;
+    std::vector<int32_t> inkPathPoints;
+    std::vector<float> inkPoints;
+    std::vector<FS_POINTF> pathBuffer;
+    std::string uri;
+    int32_t recordCount = 0;
+
+    int count = FPDFPage_GetAnnotCount(page);
+    for (int i = 0; i < count; ++i) {
+        FPDF_ANNOTATION annot = FPDFPage_GetAnnot(page, i);
+        if (!annot) {
+            continue;
+        }
+        int32_t subtype = FPDFAnnot_GetSubtype(annot);
+        if (skipWidgets && (subtype == FPDF_ANNOT_WIDGET || subtype == FPDF_ANNOT_XFAWIDGET)) {
+            FPDFPage_CloseAnnot(annot);
+            continue;
+        }
+
+        int32_t fields = 0;
+        bool found = false;
+        uint32_t color = GetAnnotColor(annot, FPDFANNOT_COLORTYPE_Color, &found);
+        fields |= found ? kAnnotHasColor : 0;
+        uint32_t interiorColor = GetAnnotColor(annot, FPDFANNOT_COLORTYPE_InteriorColor, &found);
+        fields |= found ? kAnnotHasInteriorColor : 0;
+
+        std::vector<float> rect;
+        FS_RECTF pageRect;
+        if (FPDFAnnot_GetRect(annot, &pageRect)) {
+            fields |= kAnnotHasRect;
+            mapper.Map(pageRect.left, pageRect.top, rect);
+            mapper.Map(pageRect.right, pageRect.bottom, rect);
+        } else {
+            rect.assign(4, 0.0f);
+        }
+
+        float hRadius = 0, vRadius = 0, borderWidth = 0;
+        if (FPDFAnnot_GetBorder(annot, &hRadius, &vRadius, &borderWidth)) {
+            fields |= kAnnotHasBorder;
+        }
+
+        quads.clear();
+        size_t quadCount = 0;
+        if (FPDFAnnot_HasAttachmentPoints(annot)) {
+            size_t available = FPDFAnnot_CountAttachmentPoints(annot);
+            for (size_t q = 0; q < available; ++q) {
+                FS_QUADPOINTSF quad;
+                if (!FPDFAnnot_GetAttachmentPoints(annot, q, &quad)) {
+                    continue;
+                }
+                mapper.Map(quad.x1, quad.y1, quads);
+                mapper.Map(quad.x2, quad.y2, quads);
+                mapper.Map(quad.x3, quad.y3, quads);
+                mapper.Map(quad.x4, quad.y4, quads);
+                ++quadCount;
+            }
+        }
+
+        inkPathPoints.clear();
+        inkPoints.clear();
+        if (subtype == FPDF_ANNOT_INK) {
+            unsigned long pathCount = FPDFAnnot_GetInkListCount(annot);
+            for (unsigned long p = 0; p < pathCount; ++p) {
+                unsigned long points = FPDFAnnot_GetInkListPath(annot, p, nullptr, 0);
+                pathBuffer.resize(points);
+                if (points > 0) {
+                    points = FPDFAnnot_GetInkListPath(annot, p, pathBuffer.data(), points);
+                }
+                for (unsigned long k = 0; k < points; ++k) {
+                    mapper.Map(pathBuffer[k].x, pathBuffer[k].y, inkPoints);
+                }
+                inkPathPoints.push_back(static_cast<int32_t>(points));
+            }
+        }
+
+        uri.clear();
+        int32_t destPageIndex = -1;
+        if (doc && subtype == FPDF_ANNOT_LINK) {
+            ResolveAnnotLink(doc, annot, uri, destPageIndex);
+        }
+        FPDFPage_CloseAnnot(annot);
+
+        const size_t uriWords = (uri.size() + 3) / 4;
+        const size_t recordWords = kAnnotRecordFixedWords + quads.size() + inkPathPoints.size() +
+                                   inkPoints.size() + uriWords;
+        const int32_t header[] = {
+            static_cast<int32_t>(recordWords), i, subtype, fields,
+        };
+        const int32_t counts[] = {
+            static_cast<int32_t>(quadCount),
+            static_cast<int32_t>(inkPathPoints.size()),
+            static_cast<int32_t>(inkPoints.size() / 2),
+            destPageIndex,
+            static_cast<int32_t>(uri.size()),
+        };
+        for (int32_t value : header) {
+            AppendWord(words, &value);
+        }
+        words.push_back(color);
+        words.push_back(interiorColor);
+        for (float value : rect) {
+            AppendWord(words, &value);
+        }
+        AppendWord(words, &borderWidth);
+        for (int32_t value : counts) {
+            AppendWord(words, &value);
+        }
+        for (float value : quads) {
+            AppendWord(words, &value);
+        }
+        for (int32_t value : inkPathPoints) {
+            AppendWord(words, &value);
+        }
+        for (float value : inkPoints) {
+            AppendWord(words, &value);
+        }
+        size_t uriOffset = words.size();
+        words.resize(uriOffset + uriWords, 0);
+        if (!uri.empty()) {
+            memcpy(&words[uriOffset], uri.data(), uri.size());
+        }
+        ++recordCount;
+    }
+
+    const size_t total = words.size() * 4;
+    words[0] = static_cast<uint32_t>(recordCount);
+    words[1] = static_cast<uint32_t>(total);
+    words[2] = kAnnotRecordFixedWords;
+    void* out = malloc(total);
+    if (!out) {
+        return nullptr;
+    }
+    memcpy(out, words.data(), total);
+    return out;
+}
+
+// ============================================================================
+// Form Field Snapshot - All form fields of a page or document in one buffer
+// ============================================================================
+// Hydrating a form layer through the FPDFAnnot_GetFormField*_W wrappers costs
+// a dozen calls per widget, and two per string (measure, then copy). These
+// exports read every widget natively into fixed records plus one UTF-16 block.
+// Layout (all fields 4 bytes):
+//   int32   header[4]   fieldCount, optionCount, textUnits, kFormFieldRecordWords
+//   per field (kFormFieldRecordWords words):
+//     int32   pageIndex, annotIndex, fieldType, flags
+//     float32 rect[4]                  device left, top, width, height
+//     float32 fontSize                 0 = unknown
+//     int32   checked                  1 = checked (checkbox / radio)
+//     int32   controlCount, controlIndex
+//     int32   nameStart, nameLength    UTF-16 range in the text block
+//     int32   valueStart, valueLength
+//     int32   exportStart, exportLength   exportStart -1 = not a checkbox / radio
+//     int32   optionStart, optionCount    range in the option records
+//   per option (kFormOptionRecordWords words):
+//     int32   labelStart, labelLength, selected
+//   uint16  text[textUnits]
+// Device rects match FPDF_PageToDevice on a page of round(size * scale).
+
+static const int kFormHeaderWords = 4;
+static const int kFormFieldRecordWords = 20;
+static const int kFormOptionRecordWords = 3;
+
+struct FormSnapshot {
+    std::vector<uint32_t> fields;
+    std::vector<int32_t> options;
+    std::vector<unsigned short> text;
+
+    // Append a string read by a FPDF_WCHAR getter (lengths in bytes, NUL
+    // included) and return its start; `length` receives its UTF-16 length.
+    int32_t AppendString(const std::function<unsigned long(FPDF_WCHAR*, unsigned long)>& getter,
+                         int32_t* length) {
+        int32_t start = static_cast<int32_t>(text.size());
+        *length = 0;
+        unsigned long needed = getter(nullptr, 0);
+        if (needed <= 2) {
+            return start;
+        }
+        size_t units = needed / 2;
+        text.resize(start + units);
+        getter(reinterpret_cast<FPDF_WCHAR*>(&text[start]), needed);
+        // Drop the NUL terminator
+        text.resize(start + units - 1);
+        *length = static_cast<int32_t>(units - 1);
+        return start;
+    }
+
+    void AddPage(FPDF_FORMHANDLE form, FPDF_PAGE page, int pageIndex, double scale);
+    void* Pack() const;
+};
+
+void FormSnapshot::AddPage(FPDF_FORMHANDLE form, FPDF_PAGE page, int pageIndex, double scale) {
+    int sizeX = static_cast<int>(std::lround(FPDF_GetPageWidth(page) * scale));
+    int sizeY = static_cast<int>(std::lround(FPDF_GetPageHeight(page) * scale));
+
+    int count = FPDFPage_GetAnnotCount(page);
+    for (int i = 0; i < count; ++i) {
+        FPDF_ANNOTATION annot = FPDFPage_GetAnnot(page, i);
+        if (!annot) {
+            continue;
+        }
+        FPDF_ANNOTATION_SUBTYPE subtype = FPDFAnnot_GetSubtype(annot);
+        FS_RECTF rect;
+        if ((subtype != FPDF_ANNOT_WIDGET && subtype != FPDF_ANNOT_XFAWIDGET) ||
+            !FPDFAnnot_GetRect(annot, &rect)) {
+            FPDFPage_CloseAnnot(annot);
+            continue;
+        }
+
+        int x1, y1, x2, y2;
+        FPDF_PageToDevice(page, 0, 0, sizeX, sizeY, 0, rect.left, rect.top, &x1, &y1);
+        FPDF_PageToDevice(page, 0, 0, sizeX, sizeY, 0, rect.right, rect.bottom, &x2, &y2);
+        float device[4] = {
+            static_cast<float>(x1 < x2 ? x1 : x2),
+            static_cast<float>(y1 < y2 ? y1 : y2),
+            static_cast<float>(std::abs(x2 - x1)),
+            static_cast<float>(std::abs(y2 - y1)),
+        };
+
+        int32_t type = FPDFAnnot_GetFormFieldType(form, annot);
+        float fontSize = 0;
+        if (!FPDFAnnot_GetFontSize(form, annot, &fontSize) || !(fontSize > 0)) {
+            fontSize = 0;
+        }
+        const bool checkable =
+            type == FPDF_FORMFIELD_CHECKBOX || type == FPDF_FORMFIELD_RADIOBUTTON;
+        const bool choice = type == FPDF_FORMFIELD_COMBOBOX || type == FPDF_FORMFIELD_LISTBOX;
+
+        int32_t nameLength, valueLength, exportLength = 0;
+        int32_t nameStart = AppendString(
+            [&](FPDF_WCHAR* buffer, unsigned long length) {
+                return FPDFAnnot_GetFormFieldName(form, annot, buffer, length);
+            },
+            &nameLength);
+        int32_t valueStart = AppendString(
+            [&](FPDF_WCHAR* buffer, unsigned long length) {
+                return FPDFAnnot_GetFormFieldValue(form, annot, buffer, length);
+            },
+            &valueLength);
+        int32_t exportStart = -1;
+        if (checkable) {
+            exportStart = AppendString(
+                [&](FPDF_WCHAR* buffer, unsigned long length) {
+                    return FPDFAnnot_GetFormFieldExportValue(form, annot, buffer, length);
+                },
+                &exportLength);
+        }
+
+        int32_t optionStart = static_cast<int32_t>(options.size() / kFormOptionRecordWords);
+        int32_t optionCount = 0;
+        if (choice) {
+            int available = FPDFAnnot_GetOptionCount(form, annot);
+            for (int o = 0; o < available; ++o) {
+                int32_t labelLength;
+                int32_t labelStart = AppendString(
+                    [&](FPDF_WCHAR* buffer, unsigned long length) {
+                        return FPDFAnnot_GetOptionLabel(form, annot, o, buffer, length);
+                    },
+                    &labelLength);
+                options.push_back(labelStart);
+                options.push_back(labelLength);
+                options.push_back(FPDFAnnot_IsOptionSelected(form, annot, o) ? 1 : 0);
+                ++optionCount;
+            }
+        }
+
+        const int32_t ints[] = {
+            pageIndex,
+            i,
+            type,
+            FPDFAnnot_GetFormFieldFlags(form, annot),
+        };
+        const int32_t tail[] = {
+            checkable && FPDFAnnot_IsChecked(form, annot) ? 1 : 0,
+            FPDFAnnot_GetFormControlCount(form, annot),
+            FPDFAnnot_GetFormControlIndex(form, annot),
+            nameStart, nameLength,
+            valueStart, valueLength,
+            exportStart, exportLength,
+            optionStart, optionCount,
+        };
+        FPDFPage_CloseAnnot(annot);
+
+        for (int32_t value : ints) {
+            AppendWord(fields, &value);
+        }
+        for (float value : device) {
+            AppendWord(fields, &value);
+        }
+        AppendWord(fields, &fontSize);
+        for (int32_t value : tail) {
+            AppendWord(fields, &value);
+        }
+    }
+}
+
+void* FormSnapshot::Pack() const {
+    const size_t textBytes = (text.size() * 2 + 3) & ~static_cast<size_t>(3);
+    const size_t total = kFormHeaderWords * 4 + fields.size() * 4 + options.size() * 4 +
+                         textBytes;
+    uint8_t* out = static_cast<uint8_t*>(malloc(total));
+    if (!out) {
+        return nullptr;
+    }
+    memset(out, 0, total);
+
+    int32_t* header = reinterpret_cast<int32_t*>(out);
+    header[0] = static_cast<int32_t>(fields.size() / kFormFieldRecordWords);
+    header[1] = static_cast<int32_t>(options.size() / kFormOptionRecordWords);
+    header[2] = static_cast<int32_t>(text.size());
+    header[3] = kFormFieldRecordWords;
+
+    uint8_t* cursor = out + kFormHeaderWords * 4;
+    if (!fields.empty()) {
+        memcpy(cursor, fields.data(), fields.size() * 4);
+        cursor += fields.size() * 4;
+    }
+    if (!options.empty()) {
+        memcpy(cursor, options.data(), options.size() * 4);
+        cursor += options.size() * 4;
+    }
+    if (!text.empty()) {
+        memcpy(cursor, text.data(), text.size() * 2);
+    }
+    return out;
+}
+
+// Snapshot the form fields of one page; pageIndex is copied into the records.
+// Returns a buffer to release with PDFium_FreeBuffer, or nullptr.
+EMSCRIPTEN_KEEPALIVE
+void* PDFium_SnapshotFormFields(FPDF_FORMHANDLE form, FPDF_PAGE page, int pageIndex,
+                                double scale) {
+    if (!form || !page || scale <= 0) {
+        return nullptr;
+    }
+    FormSnapshot snapshot;
+    snapshot.AddPage(form, page, pageIndex, scale);
+    return snapshot.Pack();
+}
+
+// Snapshot the form fields of every page in the document, so a viewer can
+// index all fields once at load. Same layout as PDFium_SnapshotFormFields.
+EMSCRIPTEN_KEEPALIVE
+void* PDFium_SnapshotDocumentFormFields(FPDF_FORMHANDLE form, FPDF_DOCUMENT doc,
+                                        double scale) {
+    if (!form || !doc || scale <= 0) {
+        return nullptr;
+    }
+    FormSnapshot snapshot;
+    int pageCount = FPDF_GetPageCount(doc);
+    for (int pageIndex = 0; pageIndex < pageCount; ++pageIndex) {
+        FPDF_PAGE page = LoadPageCounted(doc, pageIndex);
+        if (!page) {
+            continue;
+        }
+        snapshot.AddPage(form, page, pageIndex, scale);
+        FPDF_ClosePage(page);
+    }
+    return snapshot.Pack();
+}
+
 // ============================================================================
 // Page Object API - Create and manipulate page objects (text, path, image)
 // ============================================================================
@@ -991,24 +4320,146 @@ void FPDFPageObj_Destroy_W(FPDF_PAGEOBJECT page_object) {
     FPDFPageObj_Destroy(page_object);
 }
 
-// Close/release a font object
+// Close/release a font object
+EMSCRIPTEN_KEEPALIVE
+void FPDFFont_Close_W(FPDF_FONT font) {
+    FPDFFont_Close(font);
+}
+
+// Set text rendering mode
+// 0 = Fill, 1 = Stroke, 2 = Fill+Stroke, 3 = Invisible,
+// 4 = Fill+Clip, 5 = Stroke+Clip, 6 = Fill+Stroke+Clip, 7 = Clip
+EMSCRIPTEN_KEEPALIVE
+FPDF_BOOL FPDFTextObj_SetTextRenderMode_W(FPDF_PAGEOBJECT text_object, int render_mode) {
+    return FPDFTextObj_SetTextRenderMode(text_object, static_cast<FPDF_TEXT_RENDERMODE>(render_mode));
+}
+
+// Get text rendering mode
+EMSCRIPTEN_KEEPALIVE
+int FPDFTextObj_GetTextRenderMode_W(FPDF_PAGEOBJECT text_object) {
+    return static_cast<int>(FPDFTextObj_GetTextRenderMode(text_object));
+}
+
+// ============================================================================
+// Image Insertion - RGBA pixels or JPEG bytes to a placed image in one call
+// ============================================================================
+// addImageObject used to swizzle RGBA to BGRA in a JS loop over HEAPU8 and
+// always embedded raw pixels. PDFium_InsertImage converts in place (16 bytes
+// per step in the SIMD build) and wraps the converted buffer as the bitmap, so
+// no second copy is made; fully opaque images are set as BGRx, which embeds no
+// soft mask. PDFium_InsertJpegImage embeds JPEG bytes as a DCTDecode stream
+// without decoding them. Both place the image with the matrix (a b c d e f),
+// insert it into the page and regenerate the page content.
+
+// RGBA to BGRA, in place; returns whether every alpha byte is 255
+static bool SwizzleRgbaToBgra(uint8_t* pixels, size_t byteCount) {
+    size_t i = 0;
+    uint8_t alphaAnd = 0xff;
+#ifdef __wasm_simd128__
+    const v128_t order =
+        wasm_i8x16_const(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    v128_t alpha = wasm_i8x16_splat(-1);
+    for (; i + 16 <= byteCount; i += 16) {
+        v128_t v = wasm_v128_load(pixels + i);
+        alpha = wasm_v128_and(alpha, v);
+        wasm_v128_store(pixels + i, wasm_i8x16_swizzle(v, order));
+    }
+    alphaAnd = wasm_u8x16_extract_lane(alpha, 3) & wasm_u8x16_extract_lane(alpha, 7) &
+               wasm_u8x16_extract_lane(alpha, 11) & wasm_u8x16_extract_lane(alpha, 15);
+#endif
+    for (; i + 4 <= byteCount; i += 4) {
+        std::swap(pixels[i], pixels[i + 2]);
+        alphaAnd &= pixels[i + 3];
+    }
+    return alphaAnd == 0xff;
+}
+
+// Set the matrix, insert into the page and regenerate its content. Takes
+// ownership of image: it is destroyed if it could not be inserted. Returns 1,
+// 0 when nothing was inserted, or -1 when the image is on the page but the
+// content stream could not be regenerated.
+static int PlaceImageObject(FPDF_PAGE page, FPDF_PAGEOBJECT image, double a, double b,
+                            double c, double d, double e, double f) {
+    if (!FPDFImageObj_SetMatrix(image, a, b, c, d, e, f)) {
+        FPDFPageObj_Destroy(image);
+        return 0;
+    }
+    FPDFPage_InsertObject(page, image);
+    return FPDFPage_GenerateContent(page) ? 1 : -1;
+}
+
+// Insert width x height RGBA pixels (stride = width * 4) as an image object.
+// The pixels are converted to BGRA in place, so rgba must be a scratch copy
+// the caller frees afterwards. Returns as PlaceImageObject.
 EMSCRIPTEN_KEEPALIVE
-void FPDFFont_Close_W(FPDF_FONT font) {
-    FPDFFont_Close(font);
+int PDFium_InsertImage(FPDF_DOCUMENT doc, FPDF_PAGE page, uint8_t* rgba, int width, int height,
+                       double a, double b, double c, double d, double e, double f) {
+    if (!doc || !page || !rgba || width <= 0 || height <= 0) {
+        return 0;
+    }
+    bool opaque = SwizzleRgbaToBgra(rgba, static_cast<size_t>(width) * height * 4);
+    FPDF_BITMAP bitmap = FPDFBitmap_CreateEx(width, height,
+                                             opaque ? FPDFBitmap_BGRx : FPDFBitmap_BGRA, rgba,
+                                             width * 4);
+    if (!bitmap) {
+        return 0;
+    }
+    FPDF_PAGEOBJECT image = FPDFPageObj_NewImageObj(doc);
+    FPDF_PAGE pages[1] = {page};
+    bool ok = image && FPDFImageObj_SetBitmap(pages, 1, image, bitmap);
+    // SetBitmap encodes the pixels into the image stream, so the buffer is free again
+    FPDFBitmap_Destroy(bitmap);
+    if (!ok) {
+        if (image) {
+            FPDFPageObj_Destroy(image);
+        }
+        return 0;
+    }
+    return PlaceImageObject(page, image, a, b, c, d, e, f);
 }
 
-// Set text rendering mode
-// 0 = Fill, 1 = Stroke, 2 = Fill+Stroke, 3 = Invisible,
-// 4 = Fill+Clip, 5 = Stroke+Clip, 6 = Fill+Stroke+Clip, 7 = Clip
-EMSCRIPTEN_KEEPALIVE
-FPDF_BOOL FPDFTextObj_SetTextRenderMode_W(FPDF_PAGEOBJECT text_object, int render_mode) {
-    return FPDFTextObj_SetTextRenderMode(text_object, static_cast<FPDF_TEXT_RENDERMODE>(render_mode));
-}
+struct MemoryFileAccess {
+    FPDF_FILEACCESS access;
+    const uint8_t* data;
 
-// Get text rendering mode
+    static int GetBlock(void* param, unsigned long position, unsigned char* pBuf,
+                        unsigned long size) {
+        MemoryFileAccess* self = static_cast<MemoryFileAccess*>(param);
+        if (position > self->access.m_FileLen || size > self->access.m_FileLen - position) {
+            return 0;
+        }
+        memcpy(pBuf, self->data + position, size);
+        return 1;
+    }
+};
+
+// Insert a JPEG file as an image object without decoding it. PDFium reads the
+// header for size and color space and copies the bytes, so jpeg can be freed
+// on return. Returns as PlaceImageObject; 0 includes data that is not a JPEG
+// PDFium understands, in which case callers can fall back to PDFium_InsertImage.
 EMSCRIPTEN_KEEPALIVE
-int FPDFTextObj_GetTextRenderMode_W(FPDF_PAGEOBJECT text_object) {
-    return static_cast<int>(FPDFTextObj_GetTextRenderMode(text_object));
+int PDFium_InsertJpegImage(FPDF_DOCUMENT doc, FPDF_PAGE page, const uint8_t* jpeg,
+                           unsigned long size, double a, double b, double c, double d, double e,
+                           double f) {
+    if (!doc || !page || !jpeg || size == 0) {
+        return 0;
+    }
+    MemoryFileAccess file;
+    file.access.m_FileLen = size;
+    file.access.m_GetBlock = &MemoryFileAccess::GetBlock;
+    file.access.m_Param = &file;
+    file.data = jpeg;
+
+    FPDF_PAGEOBJECT image = FPDFPageObj_NewImageObj(doc);
+    if (!image) {
+        return 0;
+    }
+    FPDF_PAGE pages[1] = {page};
+    if (!FPDFImageObj_LoadJpegFileInline(pages, 1, image, &file.access)) {
+        FPDFPageObj_Destroy(image);
+        return 0;
+    }
+    return PlaceImageObject(page, image, a, b, c, d, e, f);
 }
 
 // ============================================================================
@@ -1035,6 +4486,201 @@ unsigned long FPDFFont_GetFontName_W(FPDF_FONT font, char* buffer, unsigned long
     return FPDFFont_GetBaseFontName(font, buffer, length);
 }
 
+// ============================================================================
+// Text Object Enumeration - Every text object of a page in one buffer
+// ============================================================================
+// Edit mode walks page objects through the wrappers above: type, bounds, text
+// (measured, then copied), font, size and color, each a separate call. This
+// walks the page once. Font names go into a FontNameTable that lives as long
+// as the document, so each name crosses into JS only the first time it is
+// seen; later buffers refer to it by id.
+// Layout (all fields 4 bytes):
+//   int32   header[8]   objectCount, textUnits, firstNewFont, newFontCount,
+//                       newFontBytes, kTextObjectRecordWords, 0, 0
+//   per object (kTextObjectRecordWords words):
+//     int32   objectIndex, fontId (-1 = none), renderMode
+//     uint32  fillColor                bytes R, G, B, A
+//     float32 fontSize
+//     float32 bounds[4]                page left, bottom, right, top
+//     float32 device[4]                device left, top, width, height
+//     float32 matrix[6]                a, b, c, d, e, f
+//     int32   textStart, textLength    UTF-16 range in the text block
+//   uint16  text[textUnits]           padded to 4 bytes
+//   char    fonts[newFontBytes]       NUL-terminated UTF-8 names of font ids
+//                                     firstNewFont .. firstNewFont + newFontCount - 1
+// Device rects match FPDF_PageToDevice on a page of round(size * scale).
+
+static const int kTextObjectHeaderWords = 8;
+static const int kTextObjectRecordWords = 21;
+
+struct FontNameTable {
+    std::vector<std::string> names;
+    std::unordered_map<std::string, int32_t> ids;
+
+    int32_t Intern(const std::string& name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) {
+            return it->second;
+        }
+        int32_t id = static_cast<int32_t>(names.size());
+        names.push_back(name);
+        ids.emplace(name, id);
+        return id;
+    }
+};
+
+EMSCRIPTEN_KEEPALIVE
+FontNameTable* PDFium_FontTableCreate() {
+    return new FontNameTable();
+}
+
+EMSCRIPTEN_KEEPALIVE
+void PDFium_FontTableDestroy(FontNameTable* fonts) {
+    delete fonts;
+}
+
+// Enumerate the text objects of `page`. textPage may be null to skip text.
+// Names of fonts with id >= knownFonts (the number of names the caller has
+// already read from this table) are included in the buffer. Returns a buffer
+// to release with PDFium_FreeBuffer, or nullptr.
+EMSCRIPTEN_KEEPALIVE
+void* PDFium_EnumerateTextObjects(FPDF_PAGE page, FPDF_TEXTPAGE textPage, FontNameTable* fonts,
+                                  int knownFonts, double scale) {
+    if (!page || !fonts || scale <= 0) {
+        return nullptr;
+    }
+
+    const int sizeX = static_cast<int>(std::lround(FPDF_GetPageWidth(page) * scale));
+    const int sizeY = static_cast<int>(std::lround(FPDF_GetPageHeight(page) * scale));
+
+    std::vector<uint32_t> records;
+    std::vector<unsigned short> text;
+    std::string name;
+    int32_t objectCount = 0;
+
+    int count = FPDFPage_CountObjects(page);
+    for (int i = 0; i < count; ++i) {
+        FPDF_PAGEOBJECT object = FPDFPage_GetObject(page, i);
+        if (!object || FPDFPageObj_GetType(object) != FPDF_PAGEOBJ_TEXT) {
+            continue;
+        }
+        float bounds[4];
+        if (!FPDFPageObj_GetBounds(object, &bounds[0], &bounds[1], &bounds[2], &bounds[3])) {
+            continue;
+        }
+
+        int x1, y1, x2, y2;
+        FPDF_PageToDevice(page, 0, 0, sizeX, sizeY, 0, bounds[0], bounds[3], &x1, &y1);
+        FPDF_PageToDevice(page, 0, 0, sizeX, sizeY, 0, bounds[2], bounds[1], &x2, &y2);
+        const float device[4] = {
+            static_cast<float>(x1 < x2 ? x1 : x2),
+            static_cast<float>(y1 < y2 ? y1 : y2),
+            static_cast<float>(std::abs(x2 - x1)),
+            static_cast<float>(std::abs(y2 - y1)),
+        };
+
+        FS_MATRIX matrix = {1, 0, 0, 1, 0, 0};
+        FPDFPageObj_GetMatrix(object, &matrix);
+        const float transform[6] = {matrix.a, matrix.b, matrix.c, matrix.d, matrix.e, matrix.f};
+
+        float fontSize = 0;
+        if (!FPDFTextObj_GetFontSize(object, &fontSize)) {
+            fontSize = 0;
+        }
+
+        int32_t fontId = -1;
+        FPDF_FONT font = FPDFTextObj_GetFont(object);
+        if (font) {
+            size_t needed = FPDFFont_GetBaseFontName(font, nullptr, 0);
+            if (needed > 0) {
+                name.assign(needed, '\0');
+                FPDFFont_GetBaseFontName(font, &name[0], needed);
+                name.resize(strlen(name.c_str()));
+                fontId = fonts->Intern(name);
+            }
+        }
+
+        uint32_t fillColor = 0xff000000u;
+        unsigned int r, g, b, a;
+        if (FPDFPageObj_GetFillColor(object, &r, &g, &b, &a)) {
+            fillColor = (r & 0xff) | ((g & 0xff) << 8) | ((b & 0xff) << 16) | ((a & 0xff) << 24);
+        }
+
+        int32_t textStart = static_cast<int32_t>(text.size());
+        int32_t textLength = 0;
+        if (textPage) {
+            // Lengths are in bytes, trailing NUL included
+            unsigned long needed = FPDFTextObj_GetText(object, textPage, nullptr, 0);
+            if (needed > 2) {
+                size_t units = needed / 2;
+                text.resize(textStart + units);
+                FPDFTextObj_GetText(object, textPage,
+                                    reinterpret_cast<FPDF_WCHAR*>(&text[textStart]), needed);
+                text.resize(textStart + units - 1);
+                textLength = static_cast<int32_t>(units - 1);
+            }
+        }
+
+        const int32_t head[] = {i, fontId, FPDFTextObj_GetTextRenderMode(object)};
+        for (int32_t value : head) {
+            AppendWord(records, &value);
+        }
+        records.push_back(fillColor);
+        AppendWord(records, &fontSize);
+        for (float value : bounds) {
+            AppendWord(records, &value);
+        }
+        for (float value : device) {
+            AppendWord(records, &value);
+        }
+        for (float value : transform) {
+            AppendWord(records, &value);
+        }
+        AppendWord(records, &textStart);
+        AppendWord(records, &textLength);
+        ++objectCount;
+    }
+
+    const int32_t firstNewFont =
+        knownFonts < 0 ? 0 : std::min(knownFonts, static_cast<int>(fonts->names.size()));
+    size_t fontBytes = 0;
+    for (size_t f = firstNewFont; f < fonts->names.size(); ++f) {
+        fontBytes += fonts->names[f].size() + 1;
+    }
+
+    const size_t textBytes = (text.size() * 2 + 3) & ~static_cast<size_t>(3);
+    const size_t total = kTextObjectHeaderWords * 4 + records.size() * 4 + textBytes + fontBytes;
+    uint8_t* out = static_cast<uint8_t*>(malloc(total));
+    if (!out) {
+        return nullptr;
+    }
+    memset(out, 0, total);
+
+    int32_t* header = reinterpret_cast<int32_t*>(out);
+    header[0] = objectCount;
+    header[1] = static_cast<int32_t>(text.size());
+    header[2] = firstNewFont;
+    header[3] = static_cast<int32_t>(fonts->names.size()) - firstNewFont;
+    header[4] = static_cast<int32_t>(fontBytes);
+    header[5] = kTextObjectRecordWords;
+
+    uint8_t* cursor = out + kTextObjectHeaderWords * 4;
+    if (!records.empty()) {
+        memcpy(cursor, records.data(), records.size() * 4);
+        cursor += records.size() * 4;
+    }
+    if (!text.empty()) {
+        memcpy(cursor, text.data(), text.size() * 2);
+    }
+    cursor += textBytes;
+    for (size_t f = firstNewFont; f < fonts->names.size(); ++f) {
+        const std::string& fontName = fonts->names[f];
+        memcpy(cursor, fontName.c_str(), fontName.size() + 1);
+        cursor += fontName.size() + 1;
+    }
+    return out;
+}
+
 // ============================================================================
 // Page Object Manipulation API - Insert objects directly into page content
 // ============================================================================
@@ -1053,6 +4699,251 @@ FPDF_BOOL FPDFPage_GenerateContent_W(FPDF_PAGE page) {
     return FPDFPage_GenerateContent(page);
 }
 
+// ============================================================================
+// Edit Transactions - Batched page object mutations, one GenerateContent
+// ============================================================================
+// PDFium_EditBegin captures the page's objects, PDFium_EditApply runs a packed
+// command buffer against them, and PDFium_EditCommit regenerates the content
+// stream once for the whole batch. Commands name objects by their index at
+// PDFium_EditBegin, so removals inside a batch do not shift later indices.
+// Command layout (int32 words; matrices, sizes and positions are float32):
+//   kEditSetText       op, object, units, UTF-16 text padded to 4 bytes
+//                      (empty text removes the object)
+//   kEditTransform     op, object, a, b, c, d, e, f
+//   kEditMoveTo        op, object, x, y   translate so the bounds' left/bottom
+//                                         land on (x, y)
+//   kEditSetFillColor  op, object, color (bytes R, G, B, A)
+//   kEditRemove        op, object
+//   kEditInsertText    op, fontObject (-1 = Helvetica), fontSize, color,
+//                      a, b, c, d, e, f, units, UTF-16 text padded to 4 bytes
+// Per-command status: kEditFailed, kEditApplied, or kEditAppliedFallbackFont
+// when an insert had to use Helvetica because fontObject has no font.
+
+static const int32_t kEditSetText = 1;
+static const int32_t kEditTransform = 2;
+static const int32_t kEditMoveTo = 3;
+static const int32_t kEditSetFillColor = 4;
+static const int32_t kEditRemove = 5;
+static const int32_t kEditInsertText = 6;
+
+static const int32_t kEditFailed = 0;
+static const int32_t kEditApplied = 1;
+static const int32_t kEditAppliedFallbackFont = 2;
+
+struct EditTransaction {
+    FPDF_DOCUMENT doc = nullptr;
+    FPDF_PAGE page = nullptr;
+    // Objects at PDFium_EditBegin; null once removed
+    std::vector<FPDF_PAGEOBJECT> objects;
+    FPDF_FONT fallbackFont = nullptr;
+
+    FPDF_PAGEOBJECT Object(int32_t index) const {
+        return index >= 0 && static_cast<size_t>(index) < objects.size() ? objects[index]
+                                                                         : nullptr;
+    }
+
+    FPDF_FONT FallbackFont() {
+        if (!fallbackFont) {
+            fallbackFont = FPDFText_LoadStandardFont(doc, "Helvetica");
+        }
+        return fallbackFont;
+    }
+
+    int32_t Remove(int32_t index) {
+        FPDF_PAGEOBJECT object = Object(index);
+        if (!object || !FPDFPage_RemoveObject(page, object)) {
+            return kEditFailed;
+        }
+        FPDFPageObj_Destroy(object);
+        objects[index] = nullptr;
+        return kEditApplied;
+    }
+};
+
+static float ReadEditFloat(const int32_t* word) {
+    float value;
+    memcpy(&value, word, 4);
+    return value;
+}
+
+// Copy `units` UTF-16 units starting at `words` into a NUL-terminated string
+static std::vector<unsigned short> ReadEditText(const int32_t* words, int32_t units) {
+    std::vector<unsigned short> text(units + 1, 0);
+    if (units > 0) {
+        memcpy(text.data(), words, units * 2);
+    }
+    return text;
+}
+
+static void SetFillColorWord(FPDF_PAGEOBJECT object, uint32_t color) {
+    FPDFPageObj_SetFillColor(object, color & 0xff, (color >> 8) & 0xff, (color >> 16) & 0xff,
+                             (color >> 24) & 0xff);
+}
+
+EMSCRIPTEN_KEEPALIVE
+EditTransaction* PDFium_EditBegin(FPDF_DOCUMENT doc, FPDF_PAGE page) {
+    if (!doc || !page) {
+        return nullptr;
+    }
+    EditTransaction* tx = new EditTransaction();
+    tx->doc = doc;
+    tx->page = page;
+    int count = FPDFPage_CountObjects(page);
+    tx->objects.reserve(count > 0 ? count : 0);
+    for (int i = 0; i < count; ++i) {
+        tx->objects.push_back(FPDFPage_GetObject(page, i));
+    }
+    return tx;
+}
+
+// Apply `wordCount` words of commands, writing one status per command. Returns
+// the number of commands applied, or -1 if the buffer is malformed (commands
+// before the malformed one have been applied).
+EMSCRIPTEN_KEEPALIVE
+int PDFium_EditApply(EditTransaction* tx, const int32_t* commands, int wordCount,
+                     int32_t* status) {
+    if (!tx || (!commands && wordCount > 0) || !status) {
+        return -1;
+    }
+
+    int applied = 0;
+    int at = 0;
+    while (at < wordCount) {
+        const int32_t* cmd = commands + at;
+        const int remaining = wordCount - at;
+        int32_t result = kEditFailed;
+        int size = 0;
+
+        switch (cmd[0]) {
+            case kEditSetText: {
+                if (remaining < 3 || cmd[2] < 0) {
+                    return -1;
+                }
+                size = 3 + (cmd[2] + 1) / 2;
+                if (size > remaining) {
+                    return -1;
+                }
+                FPDF_PAGEOBJECT object = tx->Object(cmd[1]);
+                if (cmd[2] == 0) {
+                    result = tx->Remove(cmd[1]);
+                } else if (object && FPDFPageObj_GetType(object) == FPDF_PAGEOBJ_TEXT) {
+                    std::vector<unsigned short> text = ReadEditText(cmd + 3, cmd[2]);
+                    result = FPDFText_SetText(object, text.data()) ? kEditApplied : kEditFailed;
+                }
+                break;
+            }
+            case kEditTransform: {
+                size = 8;
+                if (size > remaining) {
+                    return -1;
+                }
+                FPDF_PAGEOBJECT object = tx->Object(cmd[1]);
+                if (object) {
+                    FPDFPageObj_Transform(object, ReadEditFloat(cmd + 2), ReadEditFloat(cmd + 3),
+                                          ReadEditFloat(cmd + 4), ReadEditFloat(cmd + 5),
+                                          ReadEditFloat(cmd + 6), ReadEditFloat(cmd + 7));
+                    result = kEditApplied;
+                }
+                break;
+            }
+            case kEditMoveTo: {
+                size = 4;
+                if (size > remaining) {
+                    return -1;
+                }
+                FPDF_PAGEOBJECT object = tx->Object(cmd[1]);
+                float left, bottom, right, top;
+                if (object && FPDFPageObj_GetBounds(object, &left, &bottom, &right, &top)) {
+                    const float dx = ReadEditFloat(cmd + 2) - left;
+                    const float dy = ReadEditFloat(cmd + 3) - bottom;
+                    if (std::fabs(dx) > 0.1f || std::fabs(dy) > 0.1f) {
+                        FPDFPageObj_Transform(object, 1, 0, 0, 1, dx, dy);
+                    }
+                    result = kEditApplied;
+                }
+                break;
+            }
+            case kEditSetFillColor: {
+                size = 3;
+                if (size > remaining) {
+                    return -1;
+                }
+                FPDF_PAGEOBJECT object = tx->Object(cmd[1]);
+                if (object) {
+                    SetFillColorWord(object, static_cast<uint32_t>(cmd[2]));
+                    result = kEditApplied;
+                }
+                break;
+            }
+            case kEditRemove: {
+                size = 2;
+                if (size > remaining) {
+                    return -1;
+                }
+                result = tx->Remove(cmd[1]);
+                break;
+            }
+            case kEditInsertText: {
+                if (remaining < 11 || cmd[10] < 0) {
+                    return -1;
+                }
+                size = 11 + (cmd[10] + 1) / 2;
+                if (size > remaining) {
+                    return -1;
+                }
+                FPDF_PAGEOBJECT source = tx->Object(cmd[1]);
+                FPDF_FONT font = source ? FPDFTextObj_GetFont(source) : nullptr;
+                int32_t success = kEditApplied;
+                if (!font) {
+                    font = tx->FallbackFont();
+                    success = kEditAppliedFallbackFont;
+                }
+                FPDF_PAGEOBJECT object =
+                    font && cmd[10] > 0
+                        ? FPDFPageObj_CreateTextObj(tx->doc, font, ReadEditFloat(cmd + 2))
+                        : nullptr;
+                if (object) {
+                    std::vector<unsigned short> text = ReadEditText(cmd + 11, cmd[10]);
+                    if (FPDFText_SetText(object, text.data())) {
+                        SetFillColorWord(object, static_cast<uint32_t>(cmd[3]));
+                        FPDFPageObj_Transform(object, ReadEditFloat(cmd + 4),
+                                              ReadEditFloat(cmd + 5), ReadEditFloat(cmd + 6),
+                                              ReadEditFloat(cmd + 7), ReadEditFloat(cmd + 8),
+                                              ReadEditFloat(cmd + 9));
+                        FPDFPage_InsertObject(tx->page, object);
+                        result = success;
+                    } else {
+                        FPDFPageObj_Destroy(object);
+                    }
+                }
+                break;
+            }
+            default:
+                return -1;
+        }
+
+        status[applied] = result;
+        ++applied;
+        at += size;
+    }
+    return applied;
+}
+
+// Finish a transaction: regenerate the page content once when `generate` is
+// non-zero, then free the transaction. Returns 0 if GenerateContent failed.
+EMSCRIPTEN_KEEPALIVE
+int PDFium_EditCommit(EditTransaction* tx, int generate) {
+    if (!tx) {
+        return 0;
+    }
+    int ok = generate ? (FPDFPage_GenerateContent(tx->page) ? 1 : 0) : 1;
+    if (tx->fallbackFont) {
+        FPDFFont_Close(tx->fallbackFont);
+    }
+    delete tx;
+    return ok;
+}
+
 // ============================================================================
 // PDF Save/Download API - Save document to memory buffer
 // ============================================================================
@@ -1078,6 +4969,7 @@ static std::vector<uint8_t> g_savedPdfBuffer;
 // The buffer can be accessed via PDFium_GetSaveBuffer()
 EMSCRIPTEN_KEEPALIVE
 int PDFium_SaveToMemory(FPDF_DOCUMENT doc, int flags) {
+    PerfScope perf(kPerfSave);
     if (!doc) {
         return 0;
     }
@@ -1137,6 +5029,7 @@ void PDFium_FreeSaveBuffer() {
 // version: 14 = PDF 1.4, 15 = PDF 1.5, 16 = PDF 1.6, 17 = PDF 1.7, 20 = PDF 2.0
 EMSCRIPTEN_KEEPALIVE
 int PDFium_SaveToMemoryWithVersion(FPDF_DOCUMENT doc, int flags, int version) {
+    PerfScope perf(kPerfSave);
     if (!doc) {
         return 0;
     }
@@ -1169,4 +5062,1497 @@ int PDFium_SaveToMemoryWithVersion(FPDF_DOCUMENT doc, int flags, int version) {
     return 0;
 }
 
+// ============================================================================
+// Streaming Save - FPDF_FILEWRITE without a global buffer
+// ============================================================================
+// PDFium_SaveToMemory grows a vector, moves it into g_savedPdfBuffer and JS
+// then copies it out, so a save briefly needs about 3x the document size and
+// cannot run twice at once. The variants below keep no global state:
+// PDFium_SaveToSink forwards fixed-size chunks to a JS callback while PDFium
+// writes, so the heap only ever holds one chunk, and PDFium_SaveToBuffer
+// writes into one buffer reserved up front from the expected output size.
+
+// Deliver a chunk to the JS sink registered as Module.pdfiumSaveSinks[sinkId].
+// The sink must copy the bytes before returning; non-zero means success.
+EM_JS(int, PDFium_JsWriteSaveChunk, (int sinkId, const uint8_t* data, int size), {
+    var sinks = Module["pdfiumSaveSinks"];
+    var sink = sinks && sinks[sinkId];
+    return sink && sink(data, size) ? 1 : 0;
+});
+
+static FPDF_BOOL SaveDocument(FPDF_DOCUMENT doc, FPDF_FILEWRITE* writer, int flags,
+                              int version) {
+    PerfScope perf(kPerfSave);
+    return version > 0 ? FPDF_SaveWithVersion(doc, writer, flags, version)
+                       : FPDF_SaveAsCopy(doc, writer, flags);
+}
+
+struct ChunkSinkWriter : FPDF_FILEWRITE {
+    int sinkId = 0;
+    std::vector<uint8_t> chunk;
+    size_t used = 0;
+    bool failed = false;
+    // Leading output bytes dropped before anything reaches the sink
+    uint64_t skip = 0;
+
+    bool Flush() {
+        if (used > 0 && !failed) {
+            failed = PDFium_JsWriteSaveChunk(sinkId, chunk.data(), static_cast<int>(used)) == 0;
+        }
+        used = 0;
+        return !failed;
+    }
+
+    static int Write(FPDF_FILEWRITE* pThis, const void* data, unsigned long size) {
+        ChunkSinkWriter* self = static_cast<ChunkSinkWriter*>(pThis);
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        if (self->skip > 0) {
+            unsigned long n = self->skip < size ? static_cast<unsigned long>(self->skip) : size;
+            self->skip -= n;
+            bytes += n;
+            size -= n;
+        }
+        while (size > 0) {
+            size_t n = self->chunk.size() - self->used;
+            if (n > size) {
+                n = size;
+            }
+            memcpy(self->chunk.data() + self->used, bytes, n);
+            self->used += n;
+            bytes += n;
+            size -= n;
+            if (self->used == self->chunk.size() && !self->Flush()) {
+                return 0;
+            }
+        }
+        return 1;
+    }
+};
+
+// Save the document through the JS sink `sinkId` in chunks of chunkSize bytes
+// (<= 0 = 1 MiB); the last chunk may be shorter. version <= 0 saves with
+// FPDF_SaveAsCopy, otherwise FPDF_SaveWithVersion. Returns 1 on success.
+EMSCRIPTEN_KEEPALIVE
+int PDFium_SaveToSink(FPDF_DOCUMENT doc, int flags, int version, int sinkId, int chunkSize) {
+    if (!doc) {
+        return 0;
+    }
+
+    ChunkSinkWriter writer;
+    writer.version = 1;
+    writer.WriteBlock = &ChunkSinkWriter::Write;
+    writer.sinkId = sinkId;
+    writer.chunk.resize(chunkSize > 0 ? static_cast<size_t>(chunkSize) : 1024 * 1024);
+
+    FPDF_BOOL success = SaveDocument(doc, &writer, flags, version);
+    return (success && writer.Flush()) ? 1 : 0;
+}
+
+// Incremental update (FPDF_INCREMENTAL) without the original file: PDFium
+// copies the source document first and appends the changed objects, a new
+// xref section and trailer. Dropping the first sourceBytes bytes leaves just
+// the appended update, so for an annotation or form edit the sink sees a few
+// KB no matter how large the file is. The caller concatenates the original
+// file and the update; PDFium copies from the %PDF- header, so that equals
+// the full output when the file starts with its header. Returns 1 on success,
+// 0 on failure or when PDFium wrote fewer than sourceBytes bytes.
+EMSCRIPTEN_KEEPALIVE
+int PDFium_SaveIncrementalToSink(FPDF_DOCUMENT doc, int sinkId, int chunkSize,
+                                 double sourceBytes) {
+    PerfScope perf(kPerfSave);
+    if (!doc || sourceBytes < 0) {
+        return 0;
+    }
+
+    ChunkSinkWriter writer;
+    writer.version = 1;
+    writer.WriteBlock = &ChunkSinkWriter::Write;
+    writer.sinkId = sinkId;
+    writer.chunk.resize(chunkSize > 0 ? static_cast<size_t>(chunkSize) : 1024 * 1024);
+    writer.skip = static_cast<uint64_t>(sourceBytes);
+
+    FPDF_BOOL success = FPDF_SaveAsCopy(doc, &writer, FPDF_INCREMENTAL);
+    return (success && writer.skip == 0 && writer.Flush()) ? 1 : 0;
+}
+
+struct ReservedBufferWriter : FPDF_FILEWRITE {
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+
+    static int Write(FPDF_FILEWRITE* pThis, const void* bytes, unsigned long count) {
+        ReservedBufferWriter* self = static_cast<ReservedBufferWriter*>(pThis);
+        if (count > self->capacity - self->size) {
+            // Grow by 1.5x rather than doubling; the reservation usually suffices
+            size_t needed = self->size + count;
+            size_t grown = self->capacity + self->capacity / 2;
+            size_t capacity = grown > needed ? grown : needed;
+            uint8_t* data = static_cast<uint8_t*>(realloc(self->data, capacity));
+            if (!data) {
+                return 0;
+            }
+            self->data = data;
+            self->capacity = capacity;
+        }
+        memcpy(self->data + self->size, bytes, count);
+        self->size += count;
+        return 1;
+    }
+};
+
+// Save the document into one buffer reserved for reserveBytes up front (for
+// example the source file length), so it is not regrown while PDFium writes.
+// Writes the output size to *outSize and returns a buffer to release with
+// PDFium_FreeBuffer, or nullptr on failure.
+EMSCRIPTEN_KEEPALIVE
+void* PDFium_SaveToBuffer(FPDF_DOCUMENT doc, int flags, int version,
+                          unsigned long reserveBytes, uint32_t* outSize) {
+    if (!doc || !outSize) {
+        return nullptr;
+    }
+    *outSize = 0;
+
+    ReservedBufferWriter writer;
+    writer.version = 1;
+    writer.WriteBlock = &ReservedBufferWriter::Write;
+    writer.capacity = reserveBytes > 0 ? reserveBytes : 64 * 1024;
+    writer.data = static_cast<uint8_t*>(malloc(writer.capacity));
+    if (!writer.data) {
+        return nullptr;
+    }
+
+    if (!SaveDocument(doc, &writer, flags, version) || writer.size == 0) {
+        free(writer.data);
+        return nullptr;
+    }
+    *outSize = static_cast<uint32_t>(writer.size);
+    return writer.data;
+}
+
+// ============================================================================
+// Encrypted Save - standard security handler applied while PDFium writes
+// ============================================================================
+// PDFium can only re-encrypt with the security handler a document was opened
+// with, so password-protected export used to save, reparse and re-serialize
+// the whole file in JS. EncryptingWriter instead sits between
+// FPDF_SaveAsCopy(FPDF_REMOVE_SECURITY) and the real writer and rewrites the
+// plain output one object at a time: strings are encrypted and written as hex
+// strings, stream data is encrypted as it passes (its /Length adjusted in the
+// dictionary first), and the xref table and trailer are regenerated with the
+// new offsets, a fresh /ID and the /Encrypt dictionary. Only the object being
+// rewritten is buffered, so a protected save costs about as much as a plain one.
+//
+// Algorithms (ENCRYPT_ALGORITHM in TS):
+//   0 = RC4 128-bit (V2 R3), 1 = AES-128 (V4 R4 AESV2), 2 = AES-256 (V5 R6 AESV3)
+// Passwords are UTF-8; R3/R4 map them to Latin-1, R6 truncates to 127 bytes.
+// permissions are the P bits the document grants (print 4, modify 8, copy 16,
+// annotate 32, fill forms 256, accessibility 512, assemble 1024, print high
+// 2048); the reserved bits are set here.
+
+static const int ENCRYPT_RC4_128 = 0;
+static const int ENCRYPT_AES_128 = 1;
+static const int ENCRYPT_AES_256 = 2;
+
+static bool FillRandom(uint8_t* data, size_t size) {
+    while (size > 0) {
+        size_t n = size > 256 ? 256 : size;
+        if (getentropy(data, n) != 0) {
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+// ---- MD5 (RFC 1321) ---------------------------------------------------------
+
+static void Md5(const uint8_t* data, size_t size, uint8_t out[16]) {
+    static const uint32_t K[64] = {
+        0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613,
+        0xfd469501, 0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193,
+        0xa679438e, 0x49b40821, 0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d,
+        0x02441453, 0xd8a1e681, 0xe7d3fbc8, 0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed,
+        0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a, 0xfffa3942, 0x8771f681, 0x6d9d6122,
+        0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70, 0x289b7ec6, 0xeaa127fa,
+        0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665, 0xf4292244,
+        0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+        0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb,
+        0xeb86d391};
+    static const uint8_t R[64] = {7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+                                  5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20,
+                                  4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+                                  6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21};
+    uint32_t h[4] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+
+    std::vector<uint8_t> msg(data, data + size);
+    msg.push_back(0x80);
+    while (msg.size() % 64 != 56) {
+        msg.push_back(0);
+    }
+    uint64_t bits = static_cast<uint64_t>(size) * 8;
+    for (int i = 0; i < 8; i++) {
+        msg.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+    }
+
+    for (size_t block = 0; block < msg.size(); block += 64) {
+        uint32_t w[16];
+        for (int i = 0; i < 16; i++) {
+            const uint8_t* p = &msg[block + i * 4];
+            w[i] = p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+        for (int i = 0; i < 64; i++) {
+            uint32_t f;
+            int g;
+            if (i < 16) {
+                f = (b & c) | (~b & d);
+                g = i;
+            } else if (i < 32) {
+                f = (d & b) | (~d & c);
+                g = (5 * i + 1) % 16;
+            } else if (i < 48) {
+                f = b ^ c ^ d;
+                g = (3 * i + 5) % 16;
+            } else {
+                f = c ^ (b | ~d);
+                g = (7 * i) % 16;
+            }
+            uint32_t rotated = a + f + K[i] + w[g];
+            a = d;
+            d = c;
+            c = b;
+            b += (rotated << R[i]) | (rotated >> (32 - R[i]));
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+    }
+    for (int i = 0; i < 16; i++) {
+        out[i] = static_cast<uint8_t>(h[i / 4] >> (8 * (i % 4)));
+    }
+}
+
+// ---- SHA-256 / SHA-384 / SHA-512 (FIPS 180-4), for R6 key derivation ---------
+
+static void Sha256(const uint8_t* data, size_t size, uint8_t out[32]) {
+    static const uint32_t K[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+        0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+        0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+        0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+        0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+        0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+        0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+        0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+        0xc67178f2};
+    uint32_t h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                     0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+    std::vector<uint8_t> msg(data, data + size);
+    msg.push_back(0x80);
+    while (msg.size() % 64 != 56) {
+        msg.push_back(0);
+    }
+    uint64_t bits = static_cast<uint64_t>(size) * 8;
+    for (int i = 7; i >= 0; i--) {
+        msg.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+    }
+
+    auto rotr = [](uint32_t x, int n) { return (x >> n) | (x << (32 - n)); };
+    for (size_t block = 0; block < msg.size(); block += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) {
+            const uint8_t* p = &msg[block + i * 4];
+            w[i] = (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+        }
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t v[8];
+        memcpy(v, h, sizeof(v));
+        for (int i = 0; i < 64; i++) {
+            uint32_t s1 = rotr(v[4], 6) ^ rotr(v[4], 11) ^ rotr(v[4], 25);
+            uint32_t ch = (v[4] & v[5]) ^ (~v[4] & v[6]);
+            uint32_t t1 = v[7] + s1 + ch + K[i] + w[i];
+            uint32_t s0 = rotr(v[0], 2) ^ rotr(v[0], 13) ^ rotr(v[0], 22);
+            uint32_t maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+            memmove(v + 1, v, 7 * sizeof(uint32_t));
+            v[4] += t1;
+            v[0] = t1 + s0 + maj;
+        }
+        for (int i = 0; i < 8; i++) {
+            h[i] += v[i];
+        }
+    }
+    for (int i = 0; i < 32; i++) {
+        out[i] = static_cast<uint8_t>(h[i / 4] >> (24 - 8 * (i % 4)));
+    }
+}
+
+// SHA-512, or SHA-384 (other initial values, output truncated to 48 bytes)
+static void Sha512(const uint8_t* data, size_t size, bool sha384, uint8_t* out) {
+    static const uint64_t K[80] = {
+        0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+        0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+        0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+        0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+        0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+        0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+        0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+        0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+        0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+        0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+        0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+        0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+        0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+        0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+        0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+        0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+        0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+        0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+        0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+        0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL};
+    uint64_t h[8];
+    if (sha384) {
+        const uint64_t init[8] = {0xcbbb9d5dc1059ed8ULL, 0x629a292a367cd507ULL,
+                                  0x9159015a3070dd17ULL, 0x152fecd8f70e5939ULL,
+                                  0x67332667ffc00b31ULL, 0x8eb44a8768581511ULL,
+                                  0xdb0c2e0d64f98fa7ULL, 0x47b5481dbefa4fa4ULL};
+        memcpy(h, init, sizeof(h));
+    } else {
+        const uint64_t init[8] = {0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL,
+                                  0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+                                  0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+                                  0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL};
+        memcpy(h, init, sizeof(h));
+    }
+
+    std::vector<uint8_t> msg(data, data + size);
+    msg.push_back(0x80);
+    while (msg.size() % 128 != 112) {
+        msg.push_back(0);
+    }
+    // 128-bit length; inputs here are far below 2^64 bits
+    for (int i = 0; i < 8; i++) {
+        msg.push_back(0);
+    }
+    uint64_t bits = static_cast<uint64_t>(size) * 8;
+    for (int i = 7; i >= 0; i--) {
+        msg.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+    }
+
+    auto rotr = [](uint64_t x, int n) { return (x >> n) | (x << (64 - n)); };
+    for (size_t block = 0; block < msg.size(); block += 128) {
+        uint64_t w[80];
+        for (int i = 0; i < 16; i++) {
+            uint64_t word = 0;
+            for (int j = 0; j < 8; j++) {
+                word = (word << 8) | msg[block + i * 8 + j];
+            }
+            w[i] = word;
+        }
+        for (int i = 16; i < 80; i++) {
+            uint64_t s0 = rotr(w[i - 15], 1) ^ rotr(w[i - 15], 8) ^ (w[i - 15] >> 7);
+            uint64_t s1 = rotr(w[i - 2], 19) ^ rotr(w[i - 2], 61) ^ (w[i - 2] >> 6);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint64_t v[8];
+        memcpy(v, h, sizeof(v));
+        for (int i = 0; i < 80; i++) {
+            uint64_t s1 = rotr(v[4], 14) ^ rotr(v[4], 18) ^ rotr(v[4], 41);
+            uint64_t ch = (v[4] & v[5]) ^ (~v[4] & v[6]);
+            uint64_t t1 = v[7] + s1 + ch + K[i] + w[i];
+            uint64_t s0 = rotr(v[0], 28) ^ rotr(v[0], 34) ^ rotr(v[0], 39);
+            uint64_t maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+            memmove(v + 1, v, 7 * sizeof(uint64_t));
+            v[4] += t1;
+            v[0] = t1 + s0 + maj;
+        }
+        for (int i = 0; i < 8; i++) {
+            h[i] += v[i];
+        }
+    }
+    int outSize = sha384 ? 48 : 64;
+    for (int i = 0; i < outSize; i++) {
+        out[i] = static_cast<uint8_t>(h[i / 8] >> (56 - 8 * (i % 8)));
+    }
+}
+
+// ---- RC4 --------------------------------------------------------------------
+
+struct Rc4State {
+    uint8_t s[256];
+    uint8_t i = 0;
+    uint8_t j = 0;
+
+    void Init(const uint8_t* key, size_t keySize) {
+        for (int k = 0; k < 256; k++) {
+            s[k] = static_cast<uint8_t>(k);
+        }
+        uint8_t t = 0;
+        for (int k = 0; k < 256; k++) {
+            t = static_cast<uint8_t>(t + s[k] + key[k % keySize]);
+            std::swap(s[k], s[t]);
+        }
+        i = j = 0;
+    }
+
+    void Apply(uint8_t* data, size_t size) {
+        for (size_t k = 0; k < size; k++) {
+            i = static_cast<uint8_t>(i + 1);
+            j = static_cast<uint8_t>(j + s[i]);
+            std::swap(s[i], s[j]);
+            data[k] ^= s[static_cast<uint8_t>(s[i] + s[j])];
+        }
+    }
+};
+
+static void Rc4(const uint8_t* key, size_t keySize, uint8_t* data, size_t size) {
+    Rc4State state;
+    state.Init(key, keySize);
+    state.Apply(data, size);
+}
+
+// ---- AES encryption (FIPS 197), 128- and 256-bit keys ------------------------
+
+static const uint8_t kAesSbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16};
+
+struct AesKey {
+    uint8_t roundKeys[240];
+    int rounds = 0;
+
+    // keySize is 16 or 32
+    void Init(const uint8_t* key, size_t keySize) {
+        int nk = static_cast<int>(keySize / 4);
+        rounds = nk + 6;
+        int words = 4 * (rounds + 1);
+        memcpy(roundKeys, key, keySize);
+        uint8_t rcon = 1;
+        for (int w = nk; w < words; w++) {
+            uint8_t t[4];
+            memcpy(t, roundKeys + 4 * (w - 1), 4);
+            if (w % nk == 0) {
+                uint8_t first = t[0];
+                t[0] = static_cast<uint8_t>(kAesSbox[t[1]] ^ rcon);
+                t[1] = kAesSbox[t[2]];
+                t[2] = kAesSbox[t[3]];
+                t[3] = kAesSbox[first];
+                rcon = static_cast<uint8_t>((rcon << 1) ^ ((rcon & 0x80) ? 0x1b : 0));
+            } else if (nk > 6 && w % nk == 4) {
+                for (int k = 0; k < 4; k++) {
+                    t[k] = kAesSbox[t[k]];
+                }
+            }
+            for (int k = 0; k < 4; k++) {
+                roundKeys[4 * w + k] = roundKeys[4 * (w - nk) + k] ^ t[k];
+            }
+        }
+    }
+
+    void EncryptBlock(uint8_t block[16]) const {
+        auto xtime = [](uint8_t x) {
+            return static_cast<uint8_t>((x << 1) ^ ((x & 0x80) ? 0x1b : 0));
+        };
+        for (int k = 0; k < 16; k++) {
+            block[k] ^= roundKeys[k];
+        }
+        for (int round = 1; round <= rounds; round++) {
+            // SubBytes + ShiftRows (column-major state)
+            uint8_t s[16];
+            for (int c = 0; c < 4; c++) {
+                for (int r = 0; r < 4; r++) {
+                    s[4 * c + r] = kAesSbox[block[4 * ((c + r) % 4) + r]];
+                }
+            }
+            if (round != rounds) {
+                for (int c = 0; c < 4; c++) {
+                    uint8_t* col = s + 4 * c;
+                    uint8_t all = col[0] ^ col[1] ^ col[2] ^ col[3];
+                    uint8_t first = col[0];
+                    col[0] ^= all ^ xtime(col[0] ^ col[1]);
+                    col[1] ^= all ^ xtime(col[1] ^ col[2]);
+                    col[2] ^= all ^ xtime(col[2] ^ col[3]);
+                    col[3] ^= all ^ xtime(col[3] ^ first);
+                }
+            }
+            for (int k = 0; k < 16; k++) {
+                block[k] = s[k] ^ roundKeys[16 * round + k];
+            }
+        }
+    }
+};
+
+// CBC without padding; size is a multiple of 16
+static void AesCbcEncrypt(const uint8_t* key, size_t keySize, const uint8_t iv[16],
+                          uint8_t* data, size_t size) {
+    AesKey aes;
+    aes.Init(key, keySize);
+    uint8_t chain[16];
+    memcpy(chain, iv, 16);
+    for (size_t offset = 0; offset + 16 <= size; offset += 16) {
+        for (int k = 0; k < 16; k++) {
+            data[offset + k] ^= chain[k];
+        }
+        aes.EncryptBlock(data + offset);
+        memcpy(chain, data + offset, 16);
+    }
+}
+
+// ---- Standard security handler key derivation --------------------------------
+
+static const uint8_t kPasswordPadding[32] = {
+    0x28, 0xbf, 0x4e, 0x5e, 0x4e, 0x75, 0x8a, 0x41, 0x64, 0x00, 0x4e, 0x56, 0xff, 0xfa, 0x01, 0x08,
+    0x2e, 0x2e, 0x00, 0xb6, 0xd0, 0x68, 0x3e, 0x80, 0x2f, 0x0c, 0xa9, 0xfe, 0x64, 0x53, 0x69, 0x7a};
+
+// UTF-8 password as Latin-1 (PDFDocEncoding for ASCII and Latin-1), padded to 32 bytes
+static void PadLegacyPassword(const std::string& utf8, uint8_t out[32]) {
+    std::vector<uint8_t> bytes;
+    for (size_t k = 0; k < utf8.size() && bytes.size() < 32;) {
+        uint8_t c = static_cast<uint8_t>(utf8[k]);
+        if (c < 0x80) {
+            bytes.push_back(c);
+            k++;
+        } else if ((c & 0xe0) == 0xc0 && k + 1 < utf8.size()) {
+            unsigned int cp = ((c & 0x1f) << 6) | (static_cast<uint8_t>(utf8[k + 1]) & 0x3f);
+            bytes.push_back(cp < 0x100 ? static_cast<uint8_t>(cp) : '?');
+            k += 2;
+        } else {
+            // Outside Latin-1: skip the whole sequence
+            bytes.push_back('?');
+            k++;
+            while (k < utf8.size() && (static_cast<uint8_t>(utf8[k]) & 0xc0) == 0x80) {
+                k++;
+            }
+        }
+    }
+    std::copy(bytes.begin(), bytes.end(), out);
+    memcpy(out + bytes.size(), kPasswordPadding, 32 - bytes.size());
+}
+
+// Algorithm 2.B (ISO 32000-2): hash of an R6 password with a salt and, for the
+// owner password, the 48-byte U string
+static void HashR6Password(const std::string& password, const uint8_t salt[8],
+                           const uint8_t* userKey, uint8_t out[32]) {
+    std::string pw = password.substr(0, 127);
+    std::vector<uint8_t> input(pw.begin(), pw.end());
+    input.insert(input.end(), salt, salt + 8);
+    if (userKey) {
+        input.insert(input.end(), userKey, userKey + 48);
+    }
+    uint8_t k[64];
+    size_t kSize = 32;
+    Sha256(input.data(), input.size(), k);
+
+    std::vector<uint8_t> k1;
+    std::vector<uint8_t> e;
+    for (int round = 0;; round++) {
+        k1.clear();
+        for (int rep = 0; rep < 64; rep++) {
+            k1.insert(k1.end(), pw.begin(), pw.end());
+            k1.insert(k1.end(), k, k + kSize);
+            if (userKey) {
+                k1.insert(k1.end(), userKey, userKey + 48);
+            }
+        }
+        e = k1;
+        AesCbcEncrypt(k, 16, k + 16, e.data(), e.size());
+        int sum = 0;
+        for (int i = 0; i < 16; i++) {
+            sum += e[i];
+        }
+        switch (sum % 3) {
+            case 0:
+                Sha256(e.data(), e.size(), k);
+                kSize = 32;
+                break;
+            case 1:
+                Sha512(e.data(), e.size(), true, k);
+                kSize = 48;
+                break;
+            default:
+                Sha512(e.data(), e.size(), false, k);
+                kSize = 64;
+                break;
+        }
+        if (round >= 63 && e.back() <= round - 31) {
+            break;
+        }
+    }
+    memcpy(out, k, 32);
+}
+
+// Hex string bytes of the /Encrypt dictionary
+static void AppendHexString(std::string& out, const uint8_t* data, size_t size) {
+    static const char kHex[] = "0123456789ABCDEF";
+    out.push_back('<');
+    for (size_t k = 0; k < size; k++) {
+        out.push_back(kHex[data[k] >> 4]);
+        out.push_back(kHex[data[k] & 15]);
+    }
+    out.push_back('>');
+}
+
+struct StandardSecurity {
+    int algorithm = ENCRYPT_AES_128;
+    uint8_t fileKey[32];
+    size_t keySize = 16;
+    int32_t permissions = 0;
+    uint8_t id[16];
+    // /Encrypt dictionary entries after /Filter /Standard
+    std::string dictEntries;
+
+    bool Setup(int alg, const std::string& userPw, const std::string& ownerPw, uint32_t perms) {
+        algorithm = alg;
+        permissions = static_cast<int32_t>((perms & 0xf3cu) | 0xfffff0c0u);
+        if (!FillRandom(id, sizeof(id))) {
+            return false;
+        }
+        const std::string& owner = ownerPw.empty() ? userPw : ownerPw;
+        return alg == ENCRYPT_AES_256 ? SetupR6(userPw, owner) : SetupLegacy(userPw, owner);
+    }
+
+    // Algorithms 2, 3 and 5 (revisions 3 and 4)
+    bool SetupLegacy(const std::string& userPw, const std::string& ownerPw) {
+        keySize = 16;
+        uint8_t userPad[32];
+        uint8_t ownerPad[32];
+        PadLegacyPassword(userPw, userPad);
+        PadLegacyPassword(ownerPw, ownerPad);
+
+        uint8_t ownerKey[16];
+        Md5(ownerPad, 32, ownerKey);
+        for (int k = 0; k < 50; k++) {
+            Md5(ownerKey, 16, ownerKey);
+        }
+        uint8_t o[32];
+        memcpy(o, userPad, 32);
+        for (int round = 0; round < 20; round++) {
+            uint8_t key[16];
+            for (int k = 0; k < 16; k++) {
+                key[k] = ownerKey[k] ^ static_cast<uint8_t>(round);
+            }
+            Rc4(key, 16, o, 32);
+        }
+
+        std::vector<uint8_t> input(userPad, userPad + 32);
+        input.insert(input.end(), o, o + 32);
+        for (int k = 0; k < 4; k++) {
+            input.push_back(static_cast<uint8_t>(static_cast<uint32_t>(permissions) >> (8 * k)));
+        }
+        input.insert(input.end(), id, id + 16);
+        Md5(input.data(), input.size(), fileKey);
+        for (int k = 0; k < 50; k++) {
+            Md5(fileKey, 16, fileKey);
+        }
+
+        std::vector<uint8_t> userInput(kPasswordPadding, kPasswordPadding + 32);
+        userInput.insert(userInput.end(), id, id + 16);
+        uint8_t u[32] = {0};
+        Md5(userInput.data(), userInput.size(), u);
+        for (int round = 0; round < 20; round++) {
+            uint8_t key[16];
+            for (int k = 0; k < 16; k++) {
+                key[k] = fileKey[k] ^ static_cast<uint8_t>(round);
+            }
+            Rc4(key, 16, u, 16);
+        }
+
+        if (algorithm == ENCRYPT_RC4_128) {
+            dictEntries = "/V 2 /R 3 /Length 128";
+        } else {
+            dictEntries =
+                "/V 4 /R 4 /Length 128 /CF <</StdCF <</CFM /AESV2 /AuthEvent /DocOpen "
+                "/Length 16>>>> /StmF /StdCF /StrF /StdCF";
+        }
+        dictEntries += " /O ";
+        AppendHexString(dictEntries, o, 32);
+        dictEntries += " /U ";
+        AppendHexString(dictEntries, u, 32);
+        dictEntries += " /P " + std::to_string(permissions);
+        return true;
+    }
+
+    // Algorithms 8, 9 and 10 (revision 6)
+    bool SetupR6(const std::string& userPw, const std::string& ownerPw) {
+        keySize = 32;
+        uint8_t salts[32];
+        if (!FillRandom(fileKey, 32) || !FillRandom(salts, sizeof(salts))) {
+            return false;
+        }
+        const uint8_t zeroIv[16] = {0};
+
+        uint8_t u[48];
+        HashR6Password(userPw, salts, nullptr, u);
+        memcpy(u + 32, salts, 16);
+        uint8_t ue[32];
+        uint8_t hash[32];
+        HashR6Password(userPw, salts + 8, nullptr, hash);
+        memcpy(ue, fileKey, 32);
+        AesCbcEncrypt(hash, 32, zeroIv, ue, 32);
+
+        uint8_t o[48];
+        HashR6Password(ownerPw, salts + 16, u, o);
+        memcpy(o + 32, salts + 16, 16);
+        uint8_t oe[32];
+        HashR6Password(ownerPw, salts + 24, u, hash);
+        memcpy(oe, fileKey, 32);
+        AesCbcEncrypt(hash, 32, zeroIv, oe, 32);
+
+        uint8_t perms[16];
+        for (int k = 0; k < 4; k++) {
+            perms[k] = static_cast<uint8_t>(static_cast<uint32_t>(permissions) >> (8 * k));
+        }
+        memset(perms + 4, 0xff, 4);
+        memcpy(perms + 8, "Tadb", 4);
+        if (!FillRandom(perms + 12, 4)) {
+            return false;
+        }
+        AesKey aes;
+        aes.Init(fileKey, 32);
+        aes.EncryptBlock(perms);
+
+        dictEntries =
+            "/V 5 /R 6 /Length 256 /CF <</StdCF <</CFM /AESV3 /AuthEvent /DocOpen "
+            "/Length 32>>>> /StmF /StdCF /StrF /StdCF /O ";
+        AppendHexString(dictEntries, o, 48);
+        dictEntries += " /U ";
+        AppendHexString(dictEntries, u, 48);
+        dictEntries += " /OE ";
+        AppendHexString(dictEntries, oe, 32);
+        dictEntries += " /UE ";
+        AppendHexString(dictEntries, ue, 32);
+        dictEntries += " /Perms ";
+        AppendHexString(dictEntries, perms, 16);
+        dictEntries += " /P " + std::to_string(permissions);
+        return true;
+    }
+
+    bool UsesAes() const { return algorithm != ENCRYPT_RC4_128; }
+
+    // Algorithm 1: key of one object (R6 uses the file key directly)
+    size_t ObjectKey(uint32_t objNum, uint32_t gen, uint8_t out[32]) const {
+        if (algorithm == ENCRYPT_AES_256) {
+            memcpy(out, fileKey, 32);
+            return 32;
+        }
+        uint8_t input[16 + 5 + 4];
+        memcpy(input, fileKey, 16);
+        input[16] = static_cast<uint8_t>(objNum);
+        input[17] = static_cast<uint8_t>(objNum >> 8);
+        input[18] = static_cast<uint8_t>(objNum >> 16);
+        input[19] = static_cast<uint8_t>(gen);
+        input[20] = static_cast<uint8_t>(gen >> 8);
+        size_t size = 21;
+        if (UsesAes()) {
+            memcpy(input + 21, "sAlT", 4);
+            size = 25;
+        }
+        Md5(input, size, out);
+        return 16;
+    }
+
+    // Encrypted size of plain data of the given size
+    uint64_t EncryptedSize(uint64_t size) const {
+        return UsesAes() ? 16 + (size / 16 + 1) * 16 : size;
+    }
+};
+
+// Encrypts one string or stream, in pieces: RC4 as is, AES-CBC with a random
+// IV written first and PKCS#7 padding on Finish
+struct ObjectCipher {
+    bool aes = false;
+    Rc4State rc4;
+    AesKey aesKey;
+    uint8_t chain[16];
+    uint8_t pending[16];
+    size_t pendingSize = 0;
+
+    bool Begin(const StandardSecurity& security, uint32_t objNum, uint32_t gen,
+               std::vector<uint8_t>& out) {
+        uint8_t key[32];
+        size_t keySize = security.ObjectKey(objNum, gen, key);
+        aes = security.UsesAes();
+        pendingSize = 0;
+        if (!aes) {
+            rc4.Init(key, keySize);
+            return true;
+        }
+        aesKey.Init(key, keySize);
+        if (!FillRandom(chain, 16)) {
+            return false;
+        }
+        out.insert(out.end(), chain, chain + 16);
+        return true;
+    }
+
+    void Update(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+        if (!aes) {
+            size_t start = out.size();
+            out.insert(out.end(), data, data + size);
+            rc4.Apply(out.data() + start, size);
+            return;
+        }
+        while (size > 0) {
+            size_t n = std::min(size, 16 - pendingSize);
+            memcpy(pending + pendingSize, data, n);
+            pendingSize += n;
+            data += n;
+            size -= n;
+            if (pendingSize == 16) {
+                EmitBlock(out);
+            }
+        }
+    }
+
+    void Finish(std::vector<uint8_t>& out) {
+        if (!aes) {
+            return;
+        }
+        uint8_t pad = static_cast<uint8_t>(16 - pendingSize);
+        memset(pending + pendingSize, pad, pad);
+        pendingSize = 16;
+        EmitBlock(out);
+    }
+
+    void EmitBlock(std::vector<uint8_t>& out) {
+        for (int k = 0; k < 16; k++) {
+            chain[k] ^= pending[k];
+        }
+        aesKey.EncryptBlock(chain);
+        out.insert(out.end(), chain, chain + 16);
+        pendingSize = 0;
+    }
+};
+
+// ---- Rewriting PDFium's plain output -----------------------------------------
+
+static bool IsPdfWhitespace(uint8_t c) {
+    return c == ' ' || c == '\r' || c == '\n' || c == '\t' || c == '\f' || c == 0;
+}
+
+static bool IsPdfDelimiter(uint8_t c) {
+    return c == '(' || c == ')' || c == '<' || c == '>' || c == '[' || c == ']' || c == '{' ||
+           c == '}' || c == '/' || c == '%';
+}
+
+// End (one past the closing parenthesis) of the literal string at data[start],
+// or std::string::npos when it continues past size
+static size_t LiteralStringEnd(const uint8_t* data, size_t size, size_t start) {
+    int depth = 0;
+    for (size_t k = start; k < size; k++) {
+        uint8_t c = data[k];
+        if (c == '\\') {
+            k++;
+        } else if (c == '(') {
+            depth++;
+        } else if (c == ')' && --depth == 0) {
+            return k + 1;
+        }
+    }
+    return std::string::npos;
+}
+
+static void DecodeLiteralString(const uint8_t* data, size_t start, size_t end,
+                                std::vector<uint8_t>& out) {
+    for (size_t k = start + 1; k + 1 < end; k++) {
+        uint8_t c = data[k];
+        if (c != '\\') {
+            out.push_back(c);
+            continue;
+        }
+        c = data[++k];
+        switch (c) {
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case '\r':
+                // Line continuation
+                if (k + 2 < end && data[k + 1] == '\n') {
+                    k++;
+                }
+                break;
+            case '\n':
+                break;
+            default:
+                if (c >= '0' && c <= '7') {
+                    int value = c - '0';
+                    for (int digits = 1; digits < 3 && k + 2 < end && data[k + 1] >= '0' &&
+                                         data[k + 1] <= '7';
+                         digits++) {
+                        value = value * 8 + (data[++k] - '0');
+                    }
+                    out.push_back(static_cast<uint8_t>(value));
+                } else {
+                    out.push_back(c);
+                }
+                break;
+        }
+    }
+}
+
+static int HexDigitValue(uint8_t c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static void DecodeHexString(const uint8_t* data, size_t start, size_t end,
+                            std::vector<uint8_t>& out) {
+    int high = -1;
+    for (size_t k = start + 1; k + 1 < end; k++) {
+        int value = HexDigitValue(data[k]);
+        if (value < 0) {
+            continue;
+        }
+        if (high < 0) {
+            high = value;
+        } else {
+            out.push_back(static_cast<uint8_t>(high * 16 + value));
+            high = -1;
+        }
+    }
+    if (high >= 0) {
+        out.push_back(static_cast<uint8_t>(high * 16));
+    }
+}
+
+struct EncryptingWriter : FPDF_FILEWRITE {
+    enum class Mode { kTop, kObject, kStreamData, kStreamEnd, kTail };
+
+    FPDF_FILEWRITE* out = nullptr;
+    StandardSecurity security;
+    bool failed = false;
+    uint64_t written = 0;
+    // Header version at least 1.6 for AES-128 and 1.7 for AES-256
+    int minVersion = 14;
+
+    Mode mode = Mode::kTop;
+    std::vector<uint8_t> input;
+    size_t scanPos = 0;
+    uint32_t objNum = 0;
+    uint32_t gen = 0;
+    uint64_t streamRemaining = 0;
+    ObjectCipher cipher;
+    std::vector<uint8_t> scratch;
+    std::vector<std::pair<uint32_t, uint64_t>> offsets;
+    uint32_t maxObjNum = 0;
+    bool trailerFound = false;
+    std::string trailer;
+
+    static int Write(FPDF_FILEWRITE* pThis, const void* data, unsigned long size) {
+        EncryptingWriter* self = static_cast<EncryptingWriter*>(pThis);
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        self->input.insert(self->input.end(), bytes, bytes + size);
+        self->Process();
+        return self->failed ? 0 : 1;
+    }
+
+    void Emit(const void* data, size_t size) {
+        if (failed || size == 0) {
+            return;
+        }
+        if (!out->WriteBlock(out, data, static_cast<unsigned long>(size))) {
+            failed = true;
+        }
+        written += size;
+    }
+
+    void Emit(const std::string& text) { Emit(text.data(), text.size()); }
+
+    void Consume(size_t count) {
+        input.erase(input.begin(), input.begin() + count);
+        scanPos = 0;
+    }
+
+    void Process() {
+        bool progress = true;
+        while (progress && !failed) {
+            switch (mode) {
+                case Mode::kTop: progress = ProcessTop(); break;
+                case Mode::kObject: progress = ProcessObject(); break;
+                case Mode::kStreamData: progress = ProcessStreamData(); break;
+                case Mode::kStreamEnd: progress = ProcessStreamEnd(); break;
+                case Mode::kTail: progress = ProcessTail(); break;
+            }
+        }
+    }
+
+    // Between objects: header comments, "N G obj" or the start of the xref table
+    bool ProcessTop() {
+        size_t k = 0;
+        while (k < input.size() && IsPdfWhitespace(input[k])) {
+            k++;
+        }
+        if (k > 0) {
+            Emit(input.data(), k);
+            Consume(k);
+        }
+        if (input.empty()) {
+            return false;
+        }
+        auto eol = std::find(input.begin(), input.end(), '\n');
+        if (input[0] == '%') {
+            if (eol == input.end()) {
+                return false;
+            }
+            size_t lineSize = static_cast<size_t>(eol - input.begin()) + 1;
+            std::string line(input.begin(), input.begin() + lineSize);
+            if (line.compare(0, 5, "%PDF-") == 0 && line.size() >= 8) {
+                int version = (line[5] - '0') * 10 + (line[7] - '0');
+                if (version < minVersion) {
+                    line[5] = static_cast<char>('0' + minVersion / 10);
+                    line[7] = static_cast<char>('0' + minVersion % 10);
+                }
+            }
+            Emit(line);
+            Consume(lineSize);
+            return true;
+        }
+        if (input.size() >= 4 && memcmp(input.data(), "xref", 4) == 0) {
+            mode = Mode::kTail;
+            return true;
+        }
+        // "N G obj"; wait until the keyword has arrived
+        size_t limit = std::min<size_t>(input.size(), 32);
+        std::string head(input.begin(), input.begin() + limit);
+        size_t objPos = head.find("obj");
+        if (objPos == std::string::npos) {
+            if (input.size() >= 32 || !isdigit(input[0])) {
+                failed = true;
+            }
+            return false;
+        }
+        unsigned int num = 0;
+        unsigned int generation = 0;
+        if (sscanf(head.c_str(), "%u %u obj", &num, &generation) != 2) {
+            failed = true;
+            return false;
+        }
+        objNum = num;
+        gen = generation;
+        offsets.emplace_back(objNum, written);
+        maxObjNum = std::max(maxObjNum, objNum);
+        Emit(input.data(), objPos + 3);
+        Consume(objPos + 3);
+        mode = Mode::kObject;
+        return true;
+    }
+
+    // Object body up to "endobj" or "stream", skipping over strings
+    bool ProcessObject() {
+        const uint8_t* data = input.data();
+        size_t size = input.size();
+        size_t k = scanPos;
+        while (k < size) {
+            uint8_t c = data[k];
+            if (c == '(') {
+                size_t end = LiteralStringEnd(data, size, k);
+                if (end == std::string::npos) {
+                    break;
+                }
+                k = end;
+                continue;
+            }
+            if (c == '<') {
+                if (k + 1 >= size) {
+                    break;
+                }
+                if (data[k + 1] == '<') {
+                    k += 2;
+                    continue;
+                }
+                const void* close = memchr(data + k, '>', size - k);
+                if (!close) {
+                    break;
+                }
+                k = static_cast<size_t>(static_cast<const uint8_t*>(close) - data) + 1;
+                continue;
+            }
+            bool boundary = k == 0 || IsPdfWhitespace(data[k - 1]) || data[k - 1] == '>' ||
+                            data[k - 1] == ']' || data[k - 1] == ')';
+            if (boundary && c == 'e' && k + 6 <= size && memcmp(data + k, "endobj", 6) == 0) {
+                if (!FinishBody(k, false)) {
+                    failed = true;
+                    return false;
+                }
+                Emit("endobj");
+                Consume(k + 6);
+                mode = Mode::kTop;
+                return true;
+            }
+            if (boundary && c == 's' && k + 6 <= size && memcmp(data + k, "stream", 6) == 0) {
+                // Data starts after CRLF or LF
+                size_t dataStart = k + 6;
+                if (dataStart < size && data[dataStart] == '\r') {
+                    dataStart++;
+                }
+                if (dataStart >= size) {
+                    break;
+                }
+                if (data[dataStart] != '\n') {
+                    failed = true;
+                    return false;
+                }
+                dataStart++;
+                if (!FinishBody(k, true)) {
+                    failed = true;
+                    return false;
+                }
+                Emit(data + k, dataStart - k);
+                Consume(dataStart);
+                scratch.clear();
+                if (!cipher.Begin(security, objNum, gen, scratch)) {
+                    failed = true;
+                    return false;
+                }
+                Emit(scratch.data(), scratch.size());
+                mode = Mode::kStreamData;
+                return true;
+            }
+            k++;
+        }
+        // Resume from the last complete token; strings are rescanned whole
+        scanPos = ResumePoint(k);
+        return false;
+    }
+
+    // Start of the token k stopped in, where scanning restarts once more data arrives
+    size_t ResumePoint(size_t k) const {
+        size_t resume = std::min(k, input.size());
+        while (resume > 0 && !IsPdfWhitespace(input[resume - 1])) {
+            resume--;
+        }
+        // Never resume inside a string: rescan from before its opening bracket
+        for (size_t p = 0, size = input.size(); p < resume && p < size;) {
+            if (input[p] == '(') {
+                size_t end = LiteralStringEnd(input.data(), size, p);
+                if (end == std::string::npos || end > resume) {
+                    return p;
+                }
+                p = end;
+            } else if (input[p] == '<' && p + 1 < size && input[p + 1] != '<') {
+                const void* close = memchr(input.data() + p, '>', size - p);
+                if (!close) {
+                    return p;
+                }
+                size_t end = static_cast<size_t>(static_cast<const uint8_t*>(close) -
+                                                 input.data()) + 1;
+                if (end > resume) {
+                    return p;
+                }
+                p = end;
+            } else if (input[p] == '<') {
+                p += 2;
+            } else {
+                p++;
+            }
+        }
+        return resume;
+    }
+
+    // Emit input[0, bodyEnd) with every string encrypted. For a stream, /Length
+    // (direct integer at the top level of the dictionary) is set to the
+    // encrypted size and the plain length kept in streamRemaining.
+    bool FinishBody(size_t bodyEnd, bool isStream) {
+        const uint8_t* data = input.data();
+        std::string body;
+        int depth = 0;
+        bool lengthFound = false;
+        for (size_t k = 0; k < bodyEnd;) {
+            uint8_t c = data[k];
+            if (c == '(' || (c == '<' && k + 1 < bodyEnd && data[k + 1] != '<')) {
+                size_t end;
+                std::vector<uint8_t> plain;
+                if (c == '(') {
+                    end = LiteralStringEnd(data, bodyEnd, k);
+                    if (end == std::string::npos) {
+                        return false;
+                    }
+                    DecodeLiteralString(data, k, end, plain);
+                } else {
+                    const void* close = memchr(data + k, '>', bodyEnd - k);
+                    if (!close) {
+                        return false;
+                    }
+                    end = static_cast<size_t>(static_cast<const uint8_t*>(close) - data) + 1;
+                    DecodeHexString(data, k, end, plain);
+                }
+                std::vector<uint8_t> encrypted;
+                ObjectCipher stringCipher;
+                if (!stringCipher.Begin(security, objNum, gen, encrypted)) {
+                    return false;
+                }
+                stringCipher.Update(plain.data(), plain.size(), encrypted);
+                stringCipher.Finish(encrypted);
+                AppendHexString(body, encrypted.data(), encrypted.size());
+                k = end;
+                continue;
+            }
+            if (c == '<' || c == '>') {
+                depth += c == '<' ? 1 : -1;
+                body.append(reinterpret_cast<const char*>(data + k), 2);
+                k += 2;
+                continue;
+            }
+            if (isStream && depth == 1 && c == '/' && k + 7 <= bodyEnd &&
+                memcmp(data + k, "/Length", 7) == 0 &&
+                (k + 7 == bodyEnd || IsPdfWhitespace(data[k + 7]) ||
+                 IsPdfDelimiter(data[k + 7]))) {
+                size_t v = k + 7;
+                while (v < bodyEnd && IsPdfWhitespace(data[v])) {
+                    v++;
+                }
+                size_t digitsEnd = v;
+                uint64_t length = 0;
+                while (digitsEnd < bodyEnd && isdigit(data[digitsEnd])) {
+                    length = length * 10 + (data[digitsEnd++] - '0');
+                }
+                // An indirect "N G R" length cannot be rewritten here
+                size_t after = digitsEnd;
+                while (after < bodyEnd && IsPdfWhitespace(data[after])) {
+                    after++;
+                }
+                if (digitsEnd == v || (after < bodyEnd && isdigit(data[after]))) {
+                    return false;
+                }
+                streamRemaining = length;
+                lengthFound = true;
+                body += "/Length " + std::to_string(security.EncryptedSize(length));
+                k = digitsEnd;
+                continue;
+            }
+            body.push_back(static_cast<char>(c));
+            k++;
+        }
+        if (isStream && !lengthFound) {
+            return false;
+        }
+        Emit(body);
+        return true;
+    }
+
+    bool ProcessStreamData() {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(streamRemaining, input.size()));
+        if (n > 0) {
+            scratch.clear();
+            cipher.Update(input.data(), n, scratch);
+            Emit(scratch.data(), scratch.size());
+            Consume(n);
+            streamRemaining -= n;
+        }
+        if (streamRemaining > 0) {
+            return false;
+        }
+        scratch.clear();
+        cipher.Finish(scratch);
+        Emit(scratch.data(), scratch.size());
+        mode = Mode::kStreamEnd;
+        return true;
+    }
+
+    // "endstream endobj" after the data
+    bool ProcessStreamEnd() {
+        static const char kEnd[] = "endobj";
+        auto it = std::search(input.begin(), input.end(), kEnd, kEnd + 6);
+        if (it == input.end()) {
+            if (input.size() > 64) {
+                failed = true;
+            }
+            return false;
+        }
+        size_t end = static_cast<size_t>(it - input.begin()) + 6;
+        Emit(input.data(), end);
+        Consume(end);
+        mode = Mode::kTop;
+        return true;
+    }
+
+    // PDFium's xref table is dropped; only the trailer dictionary is kept
+    bool ProcessTail() {
+        std::string text(input.begin(), input.end());
+        if (!trailerFound) {
+            size_t at = text.find("trailer");
+            if (at == std::string::npos) {
+                // Keep a possible split keyword
+                if (input.size() > 8) {
+                    Consume(input.size() - 8);
+                }
+                return false;
+            }
+            trailerFound = true;
+            Consume(at + 7);
+            return true;
+        }
+        size_t end = text.find("startxref");
+        if (end == std::string::npos) {
+            return false;
+        }
+        trailer = text.substr(0, end);
+        input.clear();
+        return false;
+    }
+
+    // Value text of a top-level trailer key, e.g. "1 0 R" for /Root
+    std::string TrailerReference(const char* key) const {
+        size_t at = trailer.find(key);
+        while (at != std::string::npos) {
+            size_t next = at + strlen(key);
+            if (next < trailer.size() &&
+                (IsPdfWhitespace(trailer[next]) || IsPdfDelimiter(trailer[next]))) {
+                unsigned int num = 0;
+                unsigned int generation = 0;
+                if (sscanf(trailer.c_str() + next, " %u %u R", &num, &generation) == 2) {
+                    return std::to_string(num) + " " + std::to_string(generation) + " R";
+                }
+            }
+            at = trailer.find(key, next);
+        }
+        return std::string();
+    }
+
+    // Write /Encrypt, a new xref table and the trailer after PDFium finished
+    bool Finish() {
+        std::string root = TrailerReference("/Root");
+        if (failed || mode != Mode::kTail || root.empty()) {
+            return false;
+        }
+        std::string info = TrailerReference("/Info");
+
+        uint32_t encryptNum = maxObjNum + 1;
+        offsets.emplace_back(encryptNum, written);
+        Emit(std::to_string(encryptNum) + " 0 obj\r\n<</Filter /Standard " +
+             security.dictEntries + ">>\r\nendobj\r\n");
+
+        uint64_t xrefOffset = written;
+        std::sort(offsets.begin(), offsets.end());
+        std::string xref = "xref\r\n0 1\r\n0000000000 65535 f\r\n";
+        char entry[32];
+        for (size_t k = 0; k < offsets.size();) {
+            size_t run = k + 1;
+            while (run < offsets.size() && offsets[run].first == offsets[run - 1].first + 1) {
+                run++;
+            }
+            xref += std::to_string(offsets[k].first) + " " + std::to_string(run - k) + "\r\n";
+            for (; k < run; k++) {
+                snprintf(entry, sizeof(entry), "%010llu 00000 n\r\n",
+                         static_cast<unsigned long long>(offsets[k].second));
+                xref += entry;
+            }
+            Emit(xref);
+            xref.clear();
+        }
+
+        std::string tail = "trailer\r\n<</Size " + std::to_string(encryptNum + 1) +
+                           " /Root " + root;
+        if (!info.empty()) {
+            tail += " /Info " + info;
+        }
+        tail += " /Encrypt " + std::to_string(encryptNum) + " 0 R /ID [";
+        AppendHexString(tail, security.id, 16);
+        AppendHexString(tail, security.id, 16);
+        tail += "]>>\r\nstartxref\r\n" + std::to_string(xrefOffset) + "\r\n%%EOF\r\n";
+        Emit(tail);
+        return !failed;
+    }
+};
+
+// Run a security-removing save of doc through an EncryptingWriter into out
+static bool SaveEncrypted(FPDF_DOCUMENT doc, FPDF_FILEWRITE* out, int version,
+                          const char* userPassword, const char* ownerPassword,
+                          uint32_t permissions, int algorithm) {
+    if (algorithm < ENCRYPT_RC4_128 || algorithm > ENCRYPT_AES_256) {
+        return false;
+    }
+    // Heap-allocated: the parser state holds a few KB of cipher tables
+    std::unique_ptr<EncryptingWriter> writer(new EncryptingWriter());
+    writer->version = 1;
+    writer->WriteBlock = &EncryptingWriter::Write;
+    writer->out = out;
+    writer->minVersion = algorithm == ENCRYPT_AES_256 ? 17 : algorithm == ENCRYPT_AES_128 ? 16 : 14;
+    if (!writer->security.Setup(algorithm, userPassword ? userPassword : "",
+                                ownerPassword ? ownerPassword : "", permissions)) {
+        return false;
+    }
+    int saveVersion = version > 0 ? std::max(version, writer->minVersion) : 0;
+    if (!SaveDocument(doc, writer.get(), FPDF_REMOVE_SECURITY, saveVersion)) {
+        return false;
+    }
+    return writer->Finish();
+}
+
+// Encrypted counterpart of PDFium_SaveToSink. Returns 1 on success; 0 when the
+// save fails or PDFium's output has a form this rewriter does not handle
+// (e.g. an indirect stream /Length), in which case callers can fall back.
+EMSCRIPTEN_KEEPALIVE
+int PDFium_SaveEncryptedToSink(FPDF_DOCUMENT doc, int version, int sinkId, int chunkSize,
+                               const char* userPassword, const char* ownerPassword,
+                               uint32_t permissions, int algorithm) {
+    if (!doc) {
+        return 0;
+    }
+    ChunkSinkWriter sink;
+    sink.version = 1;
+    sink.WriteBlock = &ChunkSinkWriter::Write;
+    sink.sinkId = sinkId;
+    sink.chunk.resize(chunkSize > 0 ? static_cast<size_t>(chunkSize) : 1024 * 1024);
+
+    bool ok = SaveEncrypted(doc, &sink, version, userPassword, ownerPassword, permissions,
+                            algorithm);
+    return (ok && sink.Flush()) ? 1 : 0;
+}
+
+// Encrypted counterpart of PDFium_SaveToBuffer; release the result with
+// PDFium_FreeBuffer.
+EMSCRIPTEN_KEEPALIVE
+void* PDFium_SaveEncryptedToBuffer(FPDF_DOCUMENT doc, int version, unsigned long reserveBytes,
+                                   const char* userPassword, const char* ownerPassword,
+                                   uint32_t permissions, int algorithm, uint32_t* outSize) {
+    if (!doc || !outSize) {
+        return nullptr;
+    }
+    *outSize = 0;
+
+    ReservedBufferWriter buffer;
+    buffer.version = 1;
+    buffer.WriteBlock = &ReservedBufferWriter::Write;
+    buffer.capacity = reserveBytes > 0 ? reserveBytes : 64 * 1024;
+    buffer.data = static_cast<uint8_t*>(malloc(buffer.capacity));
+    if (!buffer.data) {
+        return nullptr;
+    }
+
+    if (!SaveEncrypted(doc, &buffer, version, userPassword, ownerPassword, permissions,
+                       algorithm) ||
+        buffer.size == 0) {
+        free(buffer.data);
+        return nullptr;
+    }
+    *outSize = static_cast<uint32_t>(buffer.size);
+    return buffer.data;
+}
+
 } // extern "C"
@@ -4,6 +4,7 @@
  */
 
 import * as pdfiumModule from '../wasm/pdfium.js';
+import shippedBuilds from '../wasm/pdfium-builds.js';
 
 /**
  * Annotation subtype constants
@@ -124,6 +125,217 @@ export enum FPDF_RENDER_STATUS {
   FAILED = 4,
 }
 
+/**
+ * Async render job status codes returned by _PDFium_RenderAsyncPoll
+ */
+export enum ASYNC_RENDER_STATUS {
+  /** Unknown or already released job id */
+  INVALID = -1,
+  /** Queued, not started yet */
+  QUEUED = 0,
+  /** Started, needs more pump slices */
+  RUNNING = 1,
+  /** Render is complete and the buffer can be read */
+  DONE = 2,
+  /** Render failed */
+  FAILED = 3,
+  /** Cancelled via _PDFium_RenderAsyncCancel */
+  CANCELLED = 4,
+}
+
+/**
+ * Option flags for _PDFium_ExtractTextLayout
+ */
+export enum TEXT_LAYOUT_OPTION {
+  NONE = 0,
+  /** Only fill rect geometry; skip text, font and color lookups */
+  GEOMETRY_ONLY = 1,
+}
+
+/**
+ * Option flags for _PDFium_RenderThumbnailRGBA and _PDFium_RenderThumbnailAtlas
+ */
+export enum THUMBNAIL_OPTION {
+  NONE = 0,
+  /** Ignore the embedded /Thumb image, e.g. because the page changed since it was saved */
+  SKIP_EMBEDDED = 1,
+}
+
+/**
+ * Where a thumbnail's pixels came from
+ */
+export enum THUMBNAIL_SOURCE {
+  /** Not drawn (the page failed to load) */
+  NONE = 0,
+  /** The page's embedded /Thumb image, resampled */
+  EMBEDDED = 1,
+  /** A draft render without anti-aliasing */
+  DRAFT = 2,
+}
+
+/**
+ * Kind bits for _PDFium_HitTest
+ */
+export enum HIT_TEST_KIND {
+  CHARS = 1,
+  LINKS = 2,
+  /** Annotations other than links (hidden and popup annotations are not indexed) */
+  ANNOTS = 4,
+  ALL = 7,
+}
+
+/**
+ * Counter rows of _PDFium_GetPerfCounters, in output order
+ */
+export enum PERF_COUNTER {
+  LOAD_DOCUMENT = 0,
+  /** Page loads, including those made by renders and the page cache */
+  LOAD_PAGE = 1,
+  LOAD_TEXT_PAGE = 2,
+  /** One-shot renders (full page, tile, thumbnail and atlas) */
+  RENDER = 3,
+  /** Progressive render slices (start, continue and async queue pumps) */
+  RENDER_SLICE = 4,
+  SEARCH = 5,
+  SAVE = 6,
+}
+
+/**
+ * Kinds of memory released by _PDFium_MemoryTrim, cheapest to rebuild first
+ */
+export enum MEMORY_TRIM {
+  /** Idle buffers of the bitmap pool */
+  POOL = 1,
+  /** Spatial indexes of cached pages */
+  SPATIAL = 2,
+  /** Text pages of cached pages */
+  TEXT_PAGES = 4,
+  /** Cached pages themselves, with PDFium's per-page caches */
+  PAGES = 8,
+  ALL = 15,
+}
+
+/**
+ * Option flags for _PDFium_SerializePageAnnotations
+ */
+export enum ANNOT_SERIALIZE_OPTION {
+  NONE = 0,
+  /** Leave out WIDGET and XFAWIDGET annotations */
+  SKIP_WIDGETS = 1,
+}
+
+/**
+ * Field-presence bits of a _PDFium_SerializePageAnnotations record
+ */
+export enum ANNOT_RECORD_FIELD {
+  COLOR = 1,
+  INTERIOR_COLOR = 2,
+  RECT = 4,
+  BORDER = 8,
+}
+
+/**
+ * Flag bits of a _PDFium_SerializeOutline node
+ */
+export enum OUTLINE_NODE_FLAG {
+  HAS_CHILDREN = 1,
+  /** Children exist but are below maxDepth; serialize them from this node's handle */
+  CHILDREN_OMITTED = 2,
+}
+
+/**
+ * Page index of a _PDFium_SerializeOutline node without a usable destination
+ */
+export enum OUTLINE_DEST {
+  /** The destination's page is not in the document */
+  UNRESOLVED = -1,
+  /** The bookmark has no /Dest (e.g. it runs an action) */
+  MISSING = -2,
+}
+
+/**
+ * Command opcodes of a _PDFium_EditApply buffer
+ */
+export enum EDIT_OP {
+  /** [op, object, units, UTF-16 text padded to 4 bytes]; empty text removes the object */
+  SET_TEXT = 1,
+  /** [op, object, a, b, c, d, e, f] (f32) */
+  TRANSFORM = 2,
+  /** [op, object, x, y] (f32): translate so the bounds' left/bottom land on (x, y) */
+  MOVE_TO = 3,
+  /** [op, object, color] (u32 bytes R,G,B,A) */
+  SET_FILL_COLOR = 4,
+  /** [op, object] */
+  REMOVE = 5,
+  /**
+   * [op, fontObject (-1 = Helvetica), fontSize (f32), color (u32), a, b, c, d, e, f (f32),
+   * units, UTF-16 text padded to 4 bytes]
+   */
+  INSERT_TEXT = 6,
+}
+
+/**
+ * Per-command status written by _PDFium_EditApply
+ */
+export enum EDIT_STATUS {
+  FAILED = 0,
+  APPLIED = 1,
+  /** INSERT_TEXT applied with Helvetica because the font object has no font */
+  APPLIED_FALLBACK_FONT = 2,
+}
+
+/**
+ * Data availability returned by _PDFium_LoaderIsDocAvail and _PDFium_LoaderIsPageAvail
+ */
+export enum PDF_DATA_STATUS {
+  /** Malformed data or error */
+  ERROR = -1,
+  /** More data is needed; fetch the ranges from _PDFium_LoaderTakeRequests */
+  NOTAVAIL = 0,
+  /** The document or page can be loaded */
+  AVAIL = 1,
+}
+
+/**
+ * Encryption of _PDFium_SaveEncryptedToSink / _PDFium_SaveEncryptedToBuffer output
+ */
+export enum ENCRYPT_ALGORITHM {
+  /** RC4 128-bit (standard security handler V2 R3), readable by PDF 1.4 viewers */
+  RC4_128 = 0,
+  /** AES-128 (V4 R4, AESV2), PDF 1.6 */
+  AES_128 = 1,
+  /** AES-256 (V5 R6, AESV3), PDF 1.7 extension level 8 and PDF 2.0 */
+  AES_256 = 2,
+}
+
+/**
+ * Permission bits (P entry) granted to users who open an encrypted save with the user password
+ */
+export enum PDF_PERMISSION {
+  NONE = 0,
+  PRINT = 1 << 2,
+  MODIFY = 1 << 3,
+  COPY = 1 << 4,
+  ANNOTATE = 1 << 5,
+  FILL_FORMS = 1 << 8,
+  EXTRACT_FOR_ACCESSIBILITY = 1 << 9,
+  ASSEMBLE = 1 << 10,
+  PRINT_HIGH_QUALITY = 1 << 11,
+  ALL = 0xf3c,
+}
+
+/**
+ * Binary variants shipped in wasm/ (see build/compile.sh)
+ */
+export enum PDFIUM_BUILD {
+  /** -O3, no SIMD: pdfium.wasm, loads everywhere */
+  SCALAR = 'scalar',
+  /** -O3 -msimd128: pdfium-simd.wasm, fastest where WASM SIMD is supported */
+  SIMD = 'simd',
+  /** -Oz, no SIMD: pdfium-lite.wasm, smallest download and compile for slow links */
+  LITE = 'lite',
+}
+
 /**
  * PDFium Module interface - the raw WASM module exports
  */
@@ -167,6 +379,56 @@ export interface IPDFiumModule {
     pageYPtr: number,
   ): void;
 
+  // ============================================================================
+  // Progressive Loading - FPDF_FILEACCESS backed by on-demand blocks
+  // Optional: missing from WASM binaries built before progressive loading existed.
+  // ============================================================================
+  /**
+   * Create a loader that stores the file in chunks supplied on demand, instead of one
+   * in-heap copy made before loading. Destroy it after closing its document.
+   * @param fileLength File size in bytes
+   * @param chunkSize Chunk size in bytes (<= 0 = 64 KiB)
+   * @returns Loader handle, or 0 on failure
+   */
+  _PDFium_LoaderCreate?(fileLength: number, chunkSize: number): number;
+  /** Destroy a loader and free its chunks */
+  _PDFium_LoaderDestroy?(loader: number): void;
+  /**
+   * Supply file bytes [offset, offset + size); offset must be chunk-aligned and only whole
+   * chunks (or the final partial one) are stored.
+   * @returns Bytes stored, or -1 on error
+   */
+  _PDFium_LoaderSupply?(loader: number, offset: number, data: number, size: number): number;
+  /**
+   * Take the byte ranges PDFium asked for, as uint32 (offset, size) pairs.
+   * @param outPtr Buffer for 2 * maxRanges uint32 values
+   * @returns Number of ranges written
+   */
+  _PDFium_LoaderTakeRequests?(loader: number, outPtr: number, maxRanges: number): number;
+  /**
+   * Find the first missing range at or after `from`, at most maxBytes long.
+   * @param outPtr Buffer for a uint32 (offset, size) pair
+   * @returns 1 if a range was written, 0 if everything from `from` on is present
+   */
+  _PDFium_LoaderNextMissing?(
+    loader: number,
+    from: number,
+    maxBytes: number,
+    outPtr: number,
+  ): number;
+  /** @returns 1 once every byte of the file has been supplied */
+  _PDFium_LoaderIsComplete?(loader: number): number;
+  /** @returns 1 = linearized, 0 = not linearized, -1 = unknown yet */
+  _PDFium_LoaderIsLinearized?(loader: number): number;
+  /** @returns PDF_DATA_STATUS for opening the document */
+  _PDFium_LoaderIsDocAvail?(loader: number): number;
+  /** Open the document once _PDFium_LoaderIsDocAvail returns AVAIL (0 on failure) */
+  _PDFium_LoaderGetDocument?(loader: number, passwordPtr: number): number;
+  /** First page available in a linearized file (0 otherwise) */
+  _PDFium_LoaderGetFirstPageNum?(doc: number): number;
+  /** @returns PDF_DATA_STATUS for loading one page */
+  _PDFium_LoaderIsPageAvail?(loader: number, pageIndex: number): number;
+
   // ============================================================================
   // Bitmap/Rendering Functions
   // ============================================================================
@@ -192,7 +454,113 @@ export interface IPDFiumModule {
   ): void;
   _PDFium_BitmapGetBuffer(bitmap: number): number;
   _PDFium_BitmapGetStride(bitmap: number): number;
+  /** Free a wrapper-allocated buffer (pooled render buffers are recycled) */
   _PDFium_FreeBuffer(buffer: number): void;
+  /**
+   * Acquire a BGRA bitmap (stride = width * 4) backed by the size-bucketed buffer pool.
+   * Optional: missing from WASM binaries built before the pool existed.
+   * @returns Bitmap handle (release with _PDFium_BitmapPoolRelease), or 0 on failure
+   */
+  _PDFium_BitmapPoolAcquire?(width: number, height: number): number;
+  /** Destroy a pooled bitmap and return its buffer to the pool */
+  _PDFium_BitmapPoolRelease?(bitmap: number): void;
+  /**
+   * Set the high-water mark for buffers retained by the pool (default 64 MiB).
+   * Idle buffers above the limit are freed immediately.
+   */
+  _PDFium_BitmapPoolSetLimit?(maxBytes: number): void;
+  /** Free all idle pooled buffers */
+  _PDFium_BitmapPoolTrim?(): void;
+  /**
+   * Write pool statistics as 6 x uint32:
+   * [buffersInUse, buffersIdle, bytesInUse, bytesIdle, hits, misses]
+   */
+  _PDFium_BitmapPoolGetStats?(outPtr: number): void;
+  /**
+   * Load, render and close a page in one call, producing tightly packed RGBA
+   * (stride = width * 4) that can be copied into ImageData without swizzling.
+   * Optional: missing from WASM binaries built before this export existed.
+   * @param doc Document handle
+   * @param pageIndex Zero-based page index
+   * @param width Output width in pixels
+   * @param height Output height in pixels
+   * @param rotate Rotation (0, 1, 2, 3 for 0, 90, 180, 270 degrees)
+   * @param flags Render flags (FPDF_REVERSE_BYTE_ORDER is always added)
+   * @param bgColor Background color as 0xAARRGGBB
+   * @returns RGBA buffer pointer (free with _PDFium_FreeBuffer), or 0 on failure
+   */
+  _PDFium_RenderPageRGBA?(
+    doc: number,
+    pageIndex: number,
+    width: number,
+    height: number,
+    rotate: number,
+    flags: number,
+    bgColor: number,
+  ): number;
+  /**
+   * Same as _PDFium_RenderPageRGBA but renders an already loaded page handle.
+   * @returns RGBA buffer pointer (free with _PDFium_FreeBuffer), or 0 on failure
+   */
+  _PDFium_RenderLoadedPageRGBA?(
+    page: number,
+    width: number,
+    height: number,
+    rotate: number,
+    flags: number,
+    bgColor: number,
+  ): number;
+  /**
+   * Render one device-space tile of a loaded page into packed RGBA (stride = tileWidth * 4).
+   * Device space is the page at `scale` pixels per point with a top-left origin.
+   * Optional: missing from WASM binaries built before this export existed.
+   * @returns RGBA buffer pointer (free with _PDFium_FreeBuffer), or 0 on failure
+   */
+  _PDFium_RenderPageTileRGBA?(
+    page: number,
+    scale: number,
+    tileX: number,
+    tileY: number,
+    tileWidth: number,
+    tileHeight: number,
+    flags: number,
+    bgColor: number,
+  ): number;
+
+  // ============================================================================
+  // Thumbnails - Embedded /Thumb images and draft renders, singly or as an atlas
+  // Optional: missing from WASM binaries built before thumbnails existed.
+  // ============================================================================
+  /**
+   * Thumbnail of a loaded page as packed RGBA. Uses the embedded /Thumb image when it is at
+   * least half as wide as requested and has the page's aspect ratio, else a draft render
+   * (no anti-aliasing, limited image cache).
+   * @param options THUMBNAIL_OPTION flags
+   * @param outSource Optional int32 that receives the THUMBNAIL_SOURCE used (0 to skip)
+   * @returns RGBA buffer pointer (free with _PDFium_FreeBuffer), or 0 on failure
+   */
+  _PDFium_RenderThumbnailRGBA?(
+    page: number,
+    width: number,
+    height: number,
+    options: number,
+    outSource: number,
+  ): number;
+  /**
+   * Thumbnails of a page range in one packed RGBA atlas, stacked top to bottom and left
+   * aligned, each sized round(pageSize * deviceScale). Fills cells with int32
+   * [atlasWidth, atlasHeight, then per page top, width, height, THUMBNAIL_SOURCE].
+   * @param cells Buffer of 2 + 4 * count int32
+   * @returns RGBA buffer pointer (free with _PDFium_FreeBuffer), or 0 on failure
+   */
+  _PDFium_RenderThumbnailAtlas?(
+    doc: number,
+    firstPage: number,
+    count: number,
+    deviceScale: number,
+    options: number,
+    cells: number,
+  ): number;
 
   // ============================================================================
   // Progressive Rendering Functions - Interruptible page rendering
@@ -246,6 +614,91 @@ export interface IPDFiumModule {
    */
   _PDFium_RenderPage_Close(page: number): void;
 
+  // ============================================================================
+  // Render Jobs - Per-render cancel flag and time budget
+  // Optional: missing from WASM binaries built before render jobs existed.
+  // ============================================================================
+  /**
+   * Create a render job: a pause handler owned by a single progressive render.
+   * @param budgetMs Pause each Start/Continue slice after this many ms (<= 0 = no budget)
+   * @returns Job handle (destroy with _PDFium_RenderJobDestroy)
+   */
+  _PDFium_RenderJobCreate?(budgetMs: number): number;
+  /** Change the per-slice time budget of a job */
+  _PDFium_RenderJobSetBudget?(job: number, budgetMs: number): void;
+  /** Request cancellation of this job only; the render stops at its next pause point */
+  _PDFium_RenderJobCancel?(job: number): void;
+  /** @returns 1 if the job was cancelled */
+  _PDFium_RenderJobIsCancelled?(job: number): number;
+  /**
+   * Start a progressive render controlled by a job.
+   * @returns PDFium render status: 1=TOBECONTINUED, 2=DONE, 3=FAILED
+   */
+  _PDFium_RenderJobStart?(
+    job: number,
+    bitmap: number,
+    page: number,
+    startX: number,
+    startY: number,
+    sizeX: number,
+    sizeY: number,
+    rotate: number,
+    flags: number,
+  ): number;
+  /**
+   * Continue a job's render for one more time slice.
+   * @returns PDFium render status: 1=TOBECONTINUED, 2=DONE, 3=FAILED
+   */
+  _PDFium_RenderJobContinue?(job: number, page: number): number;
+  /** Destroy a job (call _PDFium_RenderPage_Close on the page first) */
+  _PDFium_RenderJobDestroy?(job: number): void;
+
+  // ============================================================================
+  // Async Render Queue - Several renders in flight, advanced by a shared pump
+  // Optional: missing from WASM binaries built before the queue existed.
+  // ============================================================================
+  /**
+   * Queue a render of a page that the job loads and closes itself.
+   * Renders into a pooled BGRA bitmap; add FPDF_REVERSE_BYTE_ORDER (0x10) to flags for RGBA.
+   * @param bgColor Background color as 0xAARRGGBB
+   * @returns Job id, or 0 on failure
+   */
+  _PDFium_RenderPageAsync?(
+    doc: number,
+    pageIndex: number,
+    width: number,
+    height: number,
+    rotate: number,
+    flags: number,
+    bgColor: number,
+  ): number;
+  /**
+   * Queue a render of a caller-owned page. The page must stay open, and must not be
+   * rendered elsewhere, until the job is released.
+   * @returns Job id, or 0 on failure
+   */
+  _PDFium_RenderLoadedPageAsync?(
+    page: number,
+    width: number,
+    height: number,
+    rotate: number,
+    flags: number,
+    bgColor: number,
+  ): number;
+  /**
+   * Advance all active jobs for up to budgetMs, in equal round-robin slices.
+   * @returns Number of jobs that still need pumping
+   */
+  _PDFium_RenderAsyncPump?(budgetMs: number): number;
+  /** @returns ASYNC_RENDER_STATUS of the job */
+  _PDFium_RenderAsyncPoll?(jobId: number): number;
+  /** @returns Pixel buffer of a DONE job (stride = width * 4), or 0 */
+  _PDFium_RenderAsyncGetBuffer?(jobId: number): number;
+  /** Cancel a queued or running job without affecting other jobs */
+  _PDFium_RenderAsyncCancel?(jobId: number): void;
+  /** Release the job's bitmap (and page, if the job loaded it); cancels it if still active */
+  _PDFium_RenderAsyncRelease?(jobId: number): void;
+
   // ============================================================================
   // Text Functions
   // ============================================================================
@@ -254,6 +707,117 @@ export interface IPDFiumModule {
   _PDFium_GetPageCharCount(textPage: number): number;
   _PDFium_GetPageText(textPage: number, buffer: number, bufferLen: number): number;
 
+  // ============================================================================
+  // Batch Text Extraction - Plain text of a run of pages in one buffer
+  // Optional: missing from WASM binaries built before batch text extraction existed.
+  // ============================================================================
+  /**
+   * Extract the text of pages firstPage.. until maxPages are done or budgetMs has passed
+   * (0 = no limit; at least one page is extracted). Pages are loaded and closed per call.
+   * Layout: int32 [pageCount, textUnits, nextPage, pageWords], then per page int32
+   * [pageIndex, status, textStart, textLength] (status 0 = failed), then the UTF-16 text.
+   * @returns Buffer to free with _PDFium_FreeBuffer, or 0 when firstPage is out of range
+   */
+  _PDFium_ExtractPagesText?(
+    doc: number,
+    firstPage: number,
+    maxPages: number,
+    budgetMs: number,
+  ): number;
+
+  // ============================================================================
+  // Page Handle Cache - Bounded LRU of parsed pages and text pages
+  // Optional: missing from WASM binaries built before the page cache existed.
+  // ============================================================================
+  /**
+   * Create a page cache for a document. Unpinned entries are evicted least recently
+   * used first once either budget is exceeded.
+   * @param maxBytes Budget for the estimated size of the cached pages
+   * @returns Cache handle, or 0 on failure. Destroy before closing the document.
+   */
+  _PDFium_PageCacheCreate?(doc: number, maxPages: number, maxBytes: number): number;
+  /** Close every cached page and text page and free the cache */
+  _PDFium_PageCacheDestroy?(cache: number): void;
+  /** Change the budget; evicts unpinned entries that no longer fit */
+  _PDFium_PageCacheSetBudget?(cache: number, maxPages: number, maxBytes: number): void;
+  /** @returns Borrowed page handle (release with _PDFium_PageCacheRelease), or 0 */
+  _PDFium_PageCacheAcquire?(cache: number, pageIndex: number): number;
+  /**
+   * Borrow the text page of the cached page, loading both if needed.
+   * @returns Borrowed text page handle (release with _PDFium_PageCacheReleaseText), or 0
+   */
+  _PDFium_PageCacheAcquireText?(cache: number, pageIndex: number): number;
+  /** Release one borrow of a page handle */
+  _PDFium_PageCacheRelease?(cache: number, page: number): void;
+  /** Release one borrow of a text page handle */
+  _PDFium_PageCacheReleaseText?(cache: number, textPage: number): void;
+  /** Drop the cached handles of a page after its content changed (-1 = all pages) */
+  _PDFium_PageCacheInvalidate?(cache: number, pageIndex: number): void;
+  /** Write uint32 [hits, misses, evictions, pages, estimatedBytes] to out */
+  _PDFium_PageCacheGetStats?(cache: number, out: number): void;
+
+  // ============================================================================
+  // Memory Governor - Release rebuildable memory when the heap runs full
+  // Optional: missing from WASM binaries built before the memory governor existed.
+  // ============================================================================
+  /**
+   * Release the MEMORY_TRIM kinds, least recently used and unpinned first, until the
+   * allocator's bytes in use reach targetBytes. The heap does not shrink; the memory is
+   * reused before the heap grows again.
+   * @param cache Page cache handle, or 0 to trim the bitmap pool only
+   * @param targetBytes Bytes in use to trim down to (0 = release everything selected)
+   * @param out Optional float64[9]: usedBefore, usedAfter, freeBytes, heapSize, heapMax,
+   *   poolBytesFreed, spatialIndexesFreed, textPagesClosed, pagesClosed
+   * @returns Bytes freed, as measured by the allocator
+   */
+  _PDFium_MemoryTrim?(cache: number, targetBytes: number, kinds: number, out: number): number;
+  /** Estimated bytes of a parsed page, as the page cache accounts for it (0 for a null page) */
+  _PDFium_EstimatePageBytes?(page: number): number;
+
+  // ============================================================================
+  // Spatial Index - Hit-testing chars, links and annotations of a cached page
+  // Optional: missing from WASM binaries built before the spatial index existed.
+  // ============================================================================
+  /**
+   * What lies under a device point of the page rendered at scale/rotate. The page's grid
+   * index of char boxes, link and annotation rects is built on first use and kept with the
+   * cached page. Writes int32 [charIndex, linkAnnotIndex, annotIndex] (-1 = none) to out.
+   * @param tolerance Hit slop in device pixels
+   * @param kinds HIT_TEST_KIND bits
+   * @returns HIT_TEST_KIND bits of the kinds that were hit
+   */
+  _PDFium_HitTest?(
+    cache: number,
+    pageIndex: number,
+    scale: number,
+    rotate: number,
+    x: number,
+    y: number,
+    tolerance: number,
+    kinds: number,
+    out: number,
+  ): number;
+  /**
+   * Chars whose boxes intersect a device rect, as int32 [rangeCount, then rangeCount pairs
+   * of (firstChar, charCount)], ascending and merged.
+   * @returns Buffer pointer (free with _PDFium_FreeBuffer), or 0 on failure
+   */
+  _PDFium_QueryRange?(
+    cache: number,
+    pageIndex: number,
+    scale: number,
+    rotate: number,
+    left: number,
+    top: number,
+    right: number,
+    bottom: number,
+  ): number;
+  /**
+   * Drop a cached page's spatial index after its annotations changed; the next query
+   * rebuilds it. The page itself stays cached.
+   */
+  _PDFium_PageCacheDropSpatial?(cache: number, pageIndex: number): void;
+
   // ============================================================================
   // Text Layer APIs - Character positioning
   // ============================================================================
@@ -335,6 +899,29 @@ export interface IPDFiumModule {
     buffer: number,
     bufferLen: number,
   ): number;
+  /**
+   * Extract the text layout of a character range in one call as a packed struct-of-arrays buffer:
+   * int32 header[8] = [rectCount N, textUnits, fontCount, fontBytes, fieldCount, 0, 0, 0], then
+   * 14 columns of N 4-byte values (deviceLeft/Top/Width/Height, pageLeft/Top/Right/Bottom as f32;
+   * charIndex, textStart, textLength as i32; fontSize f32; fillColor u32 with bytes R,G,B,A;
+   * fontIndex i32), the UTF-16 text block padded to 4 bytes, and NUL-terminated UTF-8 font names.
+   * Optional: missing from WASM binaries built before this export existed.
+   * @param startIndex First char index
+   * @param count Number of chars (-1 = to the end of the page)
+   * @param scale Device pixels per point (device size is round(pageSize * scale))
+   * @param rotate Rotation (0, 1, 2, 3 for 0, 90, 180, 270 degrees)
+   * @param options TEXT_LAYOUT_OPTION flags
+   * @returns Buffer pointer (free with _PDFium_FreeBuffer), or 0 on failure
+   */
+  _PDFium_ExtractTextLayout?(
+    page: number,
+    textPage: number,
+    startIndex: number,
+    count: number,
+    scale: number,
+    rotate: number,
+    options: number,
+  ): number;
 
   // ============================================================================
   // Text Search APIs
@@ -352,6 +939,74 @@ export interface IPDFiumModule {
   /** Close the search handle */
   _PDFium_FindClose(searchHandle: number): void;
 
+  // ============================================================================
+  // Document Search Index - Page text extracted once, queried from memory
+  // Optional: missing from WASM binaries built before the search index existed.
+  // ============================================================================
+  /**
+   * Create a search index for a document. Page text is extracted on first use and cached
+   * case-folded, so repeated queries do not reload pages.
+   * @returns Index handle, or 0 on failure. Destroy before closing the document.
+   */
+  _PDFium_SearchIndexCreate?(doc: number): number;
+  /**
+   * Index pages ahead of the first query
+   * @param budgetMs Time budget in milliseconds (0 = index all pages)
+   * @returns Number of pages still to index
+   */
+  _PDFium_SearchIndexBuild?(index: number, budgetMs: number): number;
+  /** Drop the cached text of a page after its content changed (-1 = all pages) */
+  _PDFium_SearchIndexInvalidate?(index: number, pageIndex: number): void;
+  /**
+   * Case-insensitive search of pages [startPage, endPage]. Returns a packed buffer:
+   * int32 header[4] = [resultCount, rectCount, nextPage, 0], then resultCount int32 records
+   * [pageIndex, charIndex, charCount, firstRect, rectCount], then rectCount f32 records
+   * [left, top, width, height] in device space.
+   * @param query Null-terminated UTF-16 query
+   * @param endPage Last page to scan (-1 = last page of the document)
+   * @param maxResults Stop at the first page boundary after this many hits (0 = no limit);
+   * nextPage is where to resume, or -1 when the range is exhausted
+   * @param scale Device pixels per point
+   * @returns Buffer pointer (free with _PDFium_FreeBuffer), or 0 on failure
+   */
+  _PDFium_SearchIndexQuery?(
+    index: number,
+    query: number,
+    startPage: number,
+    endPage: number,
+    maxResults: number,
+    scale: number,
+  ): number;
+  /** Destroy a search index */
+  _PDFium_SearchIndexDestroy?(index: number): void;
+
+  // ============================================================================
+  // Search Cursor - Resumable, time-sliced search over a search index
+  // Optional: missing from WASM binaries built before the search cursor existed.
+  // ============================================================================
+  /**
+   * Start a search that visits pages nearest-first around originPage
+   * (origin, origin + 1, origin - 1, ...). Close the cursor before destroying its index.
+   * @param query Null-terminated UTF-16 query
+   * @param scale Device pixels per point
+   * @returns Cursor handle, or 0 on failure
+   */
+  _PDFium_SearchCursorStart?(
+    index: number,
+    query: number,
+    originPage: number,
+    scale: number,
+  ): number;
+  /**
+   * Search more pages for at most budgetMs (0 = to the end). Returns a buffer in the
+   * _PDFium_SearchIndexQuery layout, with header[2] = pages still to visit (0 = done).
+   * @param maxResults Stop at the first page boundary after this many hits (0 = no limit)
+   * @returns Buffer pointer (free with _PDFium_FreeBuffer), or 0 on failure
+   */
+  _PDFium_SearchCursorContinue?(cursor: number, budgetMs: number, maxResults: number): number;
+  /** Close a search cursor */
+  _PDFium_SearchCursorClose?(cursor: number): void;
+
   // ============================================================================
   // Metadata & Error Functions
   // ============================================================================
@@ -368,6 +1023,21 @@ export interface IPDFiumModule {
   _PDFium_GetBookmarkDest(doc: number, bookmark: number): number;
   _PDFium_GetDestPageIndex(doc: number, dest: number): number;
 
+  // ============================================================================
+  // Outline Serialization - A bookmark tree or subtree in one buffer
+  // Optional: missing from WASM binaries built before outline serialization existed.
+  // ============================================================================
+  /**
+   * Serialize the bookmarks under parent in pre-order, skipping bookmarks already visited.
+   * Layout: int32 [nodeCount, textUnits, nodeWords, 0], then per node int32 [bookmark,
+   * depth, pageIndex, flags, titleStart, titleLength], then the UTF-16 titles.
+   * @param parent Bookmark handle, or 0 for the whole outline
+   * @param maxDepth Levels to include (<= 0 = all); deeper children are flagged
+   *   OUTLINE_NODE_FLAG.CHILDREN_OMITTED
+   * @returns Buffer to free with _PDFium_FreeBuffer, or 0 when there are no bookmarks
+   */
+  _PDFium_SerializeOutline?(doc: number, parent: number, maxDepth: number): number;
+
   // ============================================================================
   // Memory Functions
   // ============================================================================
@@ -376,6 +1046,23 @@ export interface IPDFiumModule {
   _malloc(size: number): number;
   _free(ptr: number): void;
 
+  // ============================================================================
+  // Performance Counters - Opt-in timing and heap use of the heavy entry points
+  // Optional: missing from WASM binaries built before performance counters existed.
+  // ============================================================================
+  /** Start (1) or stop (0) counting calls; counting is off by default */
+  _PDFium_SetPerfEnabled?(enabled: number): void;
+  /** Zero the counters and restart the heap peak from the current heap break */
+  _PDFium_ResetPerfCounters?(): void;
+  /**
+   * Write float64 [counterCount, enabled, heapUsed, heapBreakPeak, heapSize, heapMax, 0, 0]
+   * followed by [calls, totalMs, p50Ms, p99Ms, maxMs, heapGrowthBytes, 0, 0] per
+   * PERF_COUNTER to out. Percentiles are histogram bucket bounds (about 19% apart).
+   * @param out Output buffer, or 0 to only query its size
+   * @returns Number of float64 values written (or needed)
+   */
+  _PDFium_GetPerfCounters?(out: number): number;
+
   // ============================================================================
   // Annotation API - Page-level functions
   // ============================================================================
@@ -656,6 +1343,60 @@ export interface IPDFiumModule {
   /** Set URI for link annotation */
   _FPDFAnnot_SetURI_W(annot: number, uriPtr: number): number;
 
+  // ============================================================================
+  // Annotation Serialization - All annotations of a page in one buffer
+  // Optional: missing from WASM binaries built before annotation serialization existed.
+  // ============================================================================
+  /**
+   * Serialize every annotation of a page. Returns a packed buffer: int32 header[4] =
+   * [recordCount, totalBytes, fixedWords, 0], then variable-length records of 4-byte words:
+   * [recordWords, annotIndex, subtype, fields (ANNOT_RECORD_FIELD), color, interiorColor
+   * (u32 bytes R,G,B,A), rect (f32 device left, top, right, bottom), borderWidth (f32 points),
+   * quadCount, inkPathCount, inkPointCount, destPageIndex (-1 = none), uriBytes], then
+   * quadCount * 8 f32 device quad coordinates, inkPathCount i32 point counts,
+   * inkPointCount * 2 f32 device points and the UTF-8 URI padded to 4 bytes.
+   * @param doc Document pointer, used to resolve link targets (0 = skip)
+   * @param scale Device pixels per point (device size is round(pageSize * scale))
+   * @param rotate Rotation (0, 1, 2, 3 for 0, 90, 180, 270 degrees)
+   * @param options ANNOT_SERIALIZE_OPTION flags
+   * @returns Buffer pointer (free with _PDFium_FreeBuffer), or 0 on failure
+   */
+  _PDFium_SerializePageAnnotations?(
+    doc: number,
+    page: number,
+    scale: number,
+    rotate: number,
+    options: number,
+  ): number;
+
+  // ============================================================================
+  // Form Field Snapshot - All form fields of a page or document in one buffer
+  // Optional: missing from WASM binaries built before form field snapshots existed.
+  // ============================================================================
+  /**
+   * Snapshot the form fields of a page. Returns a packed buffer: int32 header[4] =
+   * [fieldCount, optionCount, textUnits, fieldWords], then fieldCount records of fieldWords
+   * 4-byte values [pageIndex, annotIndex, fieldType, flags, rect (f32 device left, top, width,
+   * height), fontSize (f32, 0 = unknown), checked, controlCount, controlIndex, nameStart,
+   * nameLength, valueStart, valueLength, exportStart (-1 = none), exportLength, optionStart,
+   * optionCount], then optionCount int32 records [labelStart, labelLength, selected], then the
+   * UTF-16 text block that the start/length pairs index into.
+   * @param pageIndex Copied into each record
+   * @param scale Device pixels per point (device size is round(pageSize * scale))
+   * @returns Buffer pointer (free with _PDFium_FreeBuffer), or 0 on failure
+   */
+  _PDFium_SnapshotFormFields?(
+    formHandle: number,
+    page: number,
+    pageIndex: number,
+    scale: number,
+  ): number;
+  /**
+   * Snapshot the form fields of every page, in the _PDFium_SnapshotFormFields layout
+   * @returns Buffer pointer (free with _PDFium_FreeBuffer), or 0 on failure
+   */
+  _PDFium_SnapshotDocumentFormFields?(formHandle: number, doc: number, scale: number): number;
+
   // ============================================================================
   // Page Object API - Create and manipulate page objects (text, path, image)
   // ============================================================================
@@ -797,6 +1538,48 @@ export interface IPDFiumModule {
    * Destroy a page object (only call if not added to page/annotation)
    */
   _FPDFPageObj_Destroy_W(pageObject: number): void;
+
+  // ============================================================================
+  // Image Insertion - RGBA pixels or JPEG bytes to a placed image in one call
+  // Optional: missing from WASM binaries built before image insertion existed.
+  // ============================================================================
+  /**
+   * Insert width x height RGBA pixels as an image placed with the matrix (a b c d e f),
+   * then regenerate the page content. The pixels are converted to BGRA in place, so pass
+   * a scratch copy and free it afterwards.
+   * @returns 1 on success, 0 when nothing was inserted, -1 when the image was inserted but
+   *   the page content could not be regenerated
+   */
+  _PDFium_InsertImage?(
+    doc: number,
+    page: number,
+    rgbaPtr: number,
+    width: number,
+    height: number,
+    a: number,
+    b: number,
+    c: number,
+    d: number,
+    e: number,
+    f: number,
+  ): number;
+  /**
+   * Insert a JPEG file without decoding it (DCTDecode passthrough), placed and committed
+   * like _PDFium_InsertImage. The bytes are copied, so jpegPtr can be freed on return.
+   * @returns As _PDFium_InsertImage; 0 includes data PDFium cannot embed (fall back to RGBA)
+   */
+  _PDFium_InsertJpegImage?(
+    doc: number,
+    page: number,
+    jpegPtr: number,
+    size: number,
+    a: number,
+    b: number,
+    c: number,
+    d: number,
+    e: number,
+    f: number,
+  ): number;
   /**
    * Close/release a font object
    */
@@ -822,6 +1605,36 @@ export interface IPDFiumModule {
   /** Get font name. Pass buffer=0, length=0 to query required size. Returns byte count including NUL. */
   _FPDFFont_GetFontName_W(font: number, buffer: number, length: number): number;
 
+  // ============================================================================
+  // Text Object Enumeration - Every text object of a page in one buffer
+  // Optional: missing from WASM binaries built before text object enumeration existed.
+  // ============================================================================
+  /** Create a font name table; keep one per document and destroy it when the document closes */
+  _PDFium_FontTableCreate?(): number;
+  /** Destroy a font name table */
+  _PDFium_FontTableDestroy?(fonts: number): void;
+  /**
+   * Enumerate the text objects of a page. Returns a packed buffer: int32 header[8] =
+   * [objectCount, textUnits, firstNewFont, newFontCount, newFontBytes, recordWords, 0, 0], then
+   * objectCount records of recordWords 4-byte values [objectIndex, fontId (-1 = none),
+   * renderMode, fillColor (u32 bytes R,G,B,A), fontSize, bounds (f32 page left, bottom, right,
+   * top), device (f32 left, top, width, height), matrix (f32 a..f), textStart, textLength], the
+   * UTF-16 text block padded to 4 bytes, and the NUL-terminated UTF-8 names of font ids
+   * firstNewFont onwards.
+   * @param textPage Text page for object text (0 = skip text)
+   * @param fonts Font name table from _PDFium_FontTableCreate
+   * @param knownFonts Number of font names already read from this table
+   * @param scale Device pixels per point (device size is round(pageSize * scale))
+   * @returns Buffer pointer (free with _PDFium_FreeBuffer), or 0 on failure
+   */
+  _PDFium_EnumerateTextObjects?(
+    page: number,
+    textPage: number,
+    fonts: number,
+    knownFonts: number,
+    scale: number,
+  ): number;
+
   // ============================================================================
   // Page Object Manipulation API - Insert objects directly into page content
   // ============================================================================
@@ -841,6 +1654,31 @@ export interface IPDFiumModule {
    */
   _FPDFPage_GenerateContent_W(page: number): number;
 
+  // ============================================================================
+  // Edit Transactions - Batched page object mutations, one GenerateContent
+  // Optional: missing from WASM binaries built before edit transactions existed.
+  // ============================================================================
+  /**
+   * Start a transaction on a page. Commands refer to objects by their index at this point,
+   * so removals inside the transaction do not shift later indices.
+   * @returns Transaction handle, or 0 on failure
+   */
+  _PDFium_EditBegin?(doc: number, page: number): number;
+  /**
+   * Apply a buffer of EDIT_OP commands (int32 words) and write one EDIT_STATUS per command
+   * @param commands Pointer to the command words
+   * @param wordCount Number of int32 words in the buffer
+   * @param status Pointer to an int32 array with room for one entry per command
+   * @returns Number of commands applied, or -1 if the buffer is malformed
+   */
+  _PDFium_EditApply?(tx: number, commands: number, wordCount: number, status: number): number;
+  /**
+   * Finish a transaction, regenerating the page content once when generate is non-zero.
+   * Frees the transaction.
+   * @returns 0 if content generation failed
+   */
+  _PDFium_EditCommit?(tx: number, generate: number): number;
+
   // ============================================================================
   // PDF Save/Download API
   // ============================================================================
@@ -874,6 +1712,92 @@ export interface IPDFiumModule {
    */
   _PDFium_SaveToMemoryWithVersion(doc: number, flags: number, version: number): number;
 
+  // ============================================================================
+  // Streaming Save - Chunked and reserve-ahead saves without the global buffer
+  // Optional: missing from WASM binaries built before streaming save existed.
+  // ============================================================================
+  /**
+   * Save through the sink registered as pdfiumSaveSinks[sinkId], chunkSize bytes at a time
+   * (<= 0 = 1 MiB). version <= 0 saves without changing the PDF version.
+   * @returns 1 on success, 0 on failure (including a sink returning 0)
+   */
+  _PDFium_SaveToSink?(
+    doc: number,
+    flags: number,
+    version: number,
+    sinkId: number,
+    chunkSize: number,
+  ): number;
+  /**
+   * Save into a single buffer reserved for reserveBytes up front (e.g. the source file length).
+   * version <= 0 saves without changing the PDF version.
+   * @param outSize Pointer to a uint32 that receives the output size
+   * @returns Buffer pointer (free with _PDFium_FreeBuffer), or 0 on failure
+   */
+  _PDFium_SaveToBuffer?(
+    doc: number,
+    flags: number,
+    version: number,
+    reserveBytes: number,
+    outSize: number,
+  ): number;
+  /**
+   * Incremental update (FPDF_INCREMENTAL) through pdfiumSaveSinks[sinkId] with the first
+   * sourceBytes bytes (the copied original file) dropped, so the sink only receives the
+   * appended objects, xref and trailer. Original file + update = the saved document when
+   * the file starts with its %PDF- header.
+   * @returns 1 on success, 0 on failure
+   */
+  _PDFium_SaveIncrementalToSink?(
+    doc: number,
+    sinkId: number,
+    chunkSize: number,
+    sourceBytes: number,
+  ): number;
+  /**
+   * Chunk sinks called by _PDFium_SaveToSink, keyed by sinkId. A sink receives a heap
+   * pointer and byte count, must copy the bytes before returning, and returns 0 to abort.
+   */
+  pdfiumSaveSinks?: Record<number, (ptr: number, size: number) => number>;
+
+  // ============================================================================
+  // Encrypted Save - Password protection applied while PDFium writes
+  // Optional: missing from WASM binaries built before encrypted save existed.
+  // ============================================================================
+  /**
+   * Save with the standard security handler through pdfiumSaveSinks[sinkId]. Any existing
+   * encryption is replaced. Passwords are NUL-terminated UTF-8; an empty owner password
+   * reuses the user password.
+   * @param permissions PDF_PERMISSION bits granted with the user password
+   * @param algorithm ENCRYPT_ALGORITHM
+   * @returns 1 on success, 0 on failure (the caller may fall back to another encryptor)
+   */
+  _PDFium_SaveEncryptedToSink?(
+    doc: number,
+    version: number,
+    sinkId: number,
+    chunkSize: number,
+    userPassword: number,
+    ownerPassword: number,
+    permissions: number,
+    algorithm: number,
+  ): number;
+  /**
+   * Encrypted counterpart of _PDFium_SaveToBuffer; parameters as _PDFium_SaveEncryptedToSink.
+   * @param outSize Pointer to a uint32 that receives the output size
+   * @returns Buffer pointer (free with _PDFium_FreeBuffer), or 0 on failure
+   */
+  _PDFium_SaveEncryptedToBuffer?(
+    doc: number,
+    version: number,
+    reserveBytes: number,
+    userPassword: number,
+    ownerPassword: number,
+    permissions: number,
+    algorithm: number,
+    outSize: number,
+  ): number;
+
   // ============================================================================
   // Emscripten Runtime
   // ============================================================================
@@ -893,18 +1817,335 @@ export interface IPDFiumModule {
   lengthBytesUTF8(str: string): number;
 }
 
+/** Emscripten hook that replaces the loader's own fetch + instantiate */
+type InstantiateWasmHook = (
+  imports: WebAssembly.Imports,
+  receiveInstance: (instance: WebAssembly.Instance, module: WebAssembly.Module) => void,
+) => object;
+
+type PDFiumModuleFactory = (moduleArg?: {
+  instantiateWasm?: InstantiateWasmHook;
+}) => Promise<IPDFiumModule>;
+
 // Get the factory function from the module (handles ESM/CJS interop)
 const createPDFiumModuleFactory =
-  (pdfiumModule as unknown as { default?: () => Promise<IPDFiumModule> }).default ?? pdfiumModule;
+  (pdfiumModule as unknown as { default?: PDFiumModuleFactory }).default ?? pdfiumModule;
+
+export interface ICreatePdfiumModuleOptions {
+  /**
+   * Binary to load. 'auto' (default) picks LITE on save-data or 2G/3G connections,
+   * else SIMD when the browser supports it, else SCALAR.
+   */
+  build?: PDFIUM_BUILD | 'auto';
+  /** Keep the binary in Cache Storage across sessions (default true) */
+  persistentCache?: boolean;
+}
+
+/** Where the compiled WebAssembly.Module of a startup came from */
+export type PdfiumModuleSource = 'memory' | 'cache' | 'network';
 
 /**
- * Create and initialize a PDFium WASM module instance
- * @returns Promise that resolves to an initialized IPDFiumModule
+ * Cold/warm start breakdown of the last createPdfiumModule() call, in milliseconds.
+ * Compilation streams, so compileMs overlaps the body download after fetchMs.
  */
-export async function createPdfiumModule(): Promise<IPDFiumModule> {
-  const module = await (createPDFiumModuleFactory as () => Promise<IPDFiumModule>)();
+export interface IPdfiumStartupTimings {
+  build: PDFIUM_BUILD;
+  source: PdfiumModuleSource;
+  /** Until the response headers arrived (network) or the cache matched; 0 from memory */
+  fetchMs: number;
+  /** Streaming compile of the body; 0 from memory */
+  compileMs: number;
+  /** Instantiation of the compiled module, including memory and data segments */
+  instantiateMs: number;
+  /** End to end, including loading the variant's JS loader */
+  totalMs: number;
+}
+
+/** Cache Storage bucket of wasm binaries; bump when the cached response format changes */
+const BINARY_CACHE_NAME = 'pdfium-wasm-v1';
+
+/**
+ * Loader and binary of a variant, resolved relative to this module so bundlers emit
+ * both as assets.
+ */
+function variantLoaderUrl(build: PDFIUM_BUILD.SIMD | PDFIUM_BUILD.LITE): string {
+  return new URL(`../wasm/pdfium-${build}.js`, import.meta.url).href;
+}
+function binaryUrl(build: PDFIUM_BUILD): string {
+  if (build === PDFIUM_BUILD.SCALAR) {
+    return new URL('../wasm/pdfium.wasm', import.meta.url).href;
+  }
+  return new URL(`../wasm/pdfium-${build}.wasm`, import.meta.url).href;
+}
+
+// Smallest module using v128 ops (i8x16.splat, i8x16.popcnt), as in wasm-feature-detect
+const SIMD_PROBE = new Uint8Array([
+  0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1, 8, 0, 65, 0, 253, 15,
+  253, 98, 11,
+]);
+
+let simdSupported: boolean | undefined;
+
+/** Whether this engine validates WebAssembly SIMD (fixed-width v128) modules. */
+export function supportsWasmSimd(): boolean {
+  if (simdSupported === undefined) {
+    try {
+      simdSupported = typeof WebAssembly === 'object' && WebAssembly.validate(SIMD_PROBE);
+    } catch {
+      simdSupported = false;
+    }
+  }
+  return simdSupported;
+}
+
+/** Whether the package ships a variant's binary (wasm/pdfium-builds.js, from compile.sh). */
+export function isPdfiumBuildShipped(build: PDFIUM_BUILD): boolean {
+  return build === PDFIUM_BUILD.SCALAR || shippedBuilds.includes(build);
+}
+
+/**
+ * Build 'auto' resolves to in this environment, among the shipped ones; the scalar build
+ * when no variant was built.
+ */
+export function selectPdfiumBuild(): PDFIUM_BUILD {
+  const connection = (
+    globalThis.navigator as
+      | (Navigator & { connection?: { saveData?: boolean; effectiveType?: string } })
+      | undefined
+  )?.connection;
+  const constrained =
+    connection?.saveData || /^(slow-2g|2g|3g)$/.test(connection?.effectiveType ?? '');
+  if (constrained && isPdfiumBuildShipped(PDFIUM_BUILD.LITE)) {
+    return PDFIUM_BUILD.LITE;
+  }
+  return supportsWasmSimd() && isPdfiumBuildShipped(PDFIUM_BUILD.SIMD)
+    ? PDFIUM_BUILD.SIMD
+    : PDFIUM_BUILD.SCALAR;
+}
+
+let loadedBuild: PDFIUM_BUILD | null = null;
+let lastStartupTimings: IPdfiumStartupTimings | null = null;
+
+/** Build the last createPdfiumModule() call instantiated, after fallbacks. */
+export function getLoadedPdfiumBuild(): PDFIUM_BUILD | null {
+  return loadedBuild;
+}
+
+/** Timings of the last successful createPdfiumModule() call. */
+export function getPdfiumStartupTimings(): IPdfiumStartupTimings | null {
+  return lastStartupTimings;
+}
+
+interface ICompiledBinary {
+  module: WebAssembly.Module;
+  source: PdfiumModuleSource;
+  fetchMs: number;
+  compileMs: number;
+}
+
+/** Compiled modules by binary URL; a module can be instantiated any number of times */
+const compiledBinaries = new Map<string, Promise<ICompiledBinary>>();
+
+async function openBinaryCache(): Promise<Cache | null> {
+  // Cache Storage only exists in secure contexts
+  if (typeof caches === 'undefined') return null;
+  try {
+    return await caches.open(BINARY_CACHE_NAME);
+  } catch {
+    return null;
+  }
+}
+
+/**
+ * Drop a cached binary the server has since replaced, so the next start fetches it.
+ * Runs after the cached copy was used; a rebuilt binary is picked up one start later.
+ */
+async function revalidateCachedBinary(cache: Cache, url: string, cached: Response): Promise<void> {
+  const etag = cached.headers.get('ETag');
+  const lastModified = cached.headers.get('Last-Modified');
+  if (!etag && !lastModified) {
+    await cache.delete(url);
+    return;
+  }
+  try {
+    const current = await fetch(url, { method: 'HEAD', cache: 'no-cache' });
+    if (
+      current.ok &&
+      (current.headers.get('ETag') !== etag ||
+        current.headers.get('Last-Modified') !== lastModified)
+    ) {
+      await cache.delete(url);
+    }
+  } catch {
+    // Offline: keep serving the cached binary
+  }
+}
+
+/**
+ * Drop the entries of binaries this version of the package no longer loads (an older
+ * release, or asset URLs a bundler has since re-hashed) once a new binary is stored.
+ */
+async function pruneBinaryCache(cache: Cache): Promise<void> {
+  const current = new Set(Object.values(PDFIUM_BUILD).map(binaryUrl));
+  for (const request of await cache.keys()) {
+    if (!current.has(request.url)) await cache.delete(request);
+  }
+}
+
+/** Compile while the body downloads when the server sends application/wasm. */
+async function compileResponse(response: Response): Promise<WebAssembly.Module> {
+  const contentType = response.headers.get('Content-Type') ?? '';
+  const streamable = contentType.startsWith('application/wasm');
+  if (streamable && typeof WebAssembly.compileStreaming === 'function') {
+    return WebAssembly.compileStreaming(response);
+  }
+  return WebAssembly.compile(await response.arrayBuffer());
+}
+
+/**
+ * Fetch and compile a binary: from Cache Storage when present (Chromium also reuses
+ * its compiled code for cached responses), else from the network, storing the response.
+ */
+async function fetchAndCompile(url: string, persistentCache: boolean): Promise<ICompiledBinary> {
+  const fetchStart = performance.now();
+  const cache = persistentCache ? await openBinaryCache() : null;
+  let source: PdfiumModuleSource = 'network';
+  let response = await cache?.match(url);
+  if (response && cache) {
+    source = 'cache';
+    void revalidateCachedBinary(cache, url, response.clone());
+  } else {
+    response = await fetch(url, { credentials: 'same-origin' });
+    if (!response.ok) {
+      throw new Error(`Failed to fetch ${url}: HTTP ${response.status}`);
+    }
+    if (cache) {
+      void cache
+        .put(url, response.clone())
+        .then(() => pruneBinaryCache(cache))
+        .catch(() => undefined);
+    }
+  }
+  const fetchMs = performance.now() - fetchStart;
+
+  const compileStart = performance.now();
+  const module = await compileResponse(response);
+  return { module, source, fetchMs, compileMs: performance.now() - compileStart };
+}
+
+function compileBinary(build: PDFIUM_BUILD, persistentCache: boolean): Promise<ICompiledBinary> {
+  const url = binaryUrl(build);
+  const existing = compiledBinaries.get(url);
+  if (existing) {
+    return existing.then(
+      (compiled): ICompiledBinary => ({ ...compiled, source: 'memory', fetchMs: 0, compileMs: 0 }),
+    );
+  }
+  const pending = fetchAndCompile(url, persistentCache);
+  compiledBinaries.set(url, pending);
+  pending.catch(() => compiledBinaries.delete(url));
+  return pending;
+}
+
+async function loadFactory(build: PDFIUM_BUILD): Promise<PDFiumModuleFactory> {
+  if (build === PDFIUM_BUILD.SCALAR) return createPDFiumModuleFactory as PDFiumModuleFactory;
+  const variant = (await import(/* @vite-ignore */ variantLoaderUrl(build))) as {
+    default: PDFiumModuleFactory;
+  };
+  return variant.default;
+}
+
+function resolveBuild(options: ICreatePdfiumModuleOptions): PDFIUM_BUILD {
+  return !options.build || options.build === 'auto' ? selectPdfiumBuild() : options.build;
+}
+
+async function instantiateBuild(
+  build: PDFIUM_BUILD,
+  persistentCache: boolean,
+): Promise<IPDFiumModule> {
+  const startedAt = performance.now();
+  const [compiled, factory] = await Promise.all([
+    compileBinary(build, persistentCache),
+    loadFactory(build),
+  ]);
+
+  let instantiateMs = 0;
+  // The loader waits on receiveInstance forever if instantiation fails; race it
+  let failInstantiation: (error: unknown) => void = () => undefined;
+  const instantiationFailed = new Promise<never>((_, reject) => {
+    failInstantiation = reject;
+  });
+  const module = await Promise.race([
+    factory({
+      instantiateWasm: (imports, receiveInstance) => {
+        const instantiateStart = performance.now();
+        WebAssembly.instantiate(compiled.module, imports).then((instance) => {
+          instantiateMs = performance.now() - instantiateStart;
+          receiveInstance(instance, compiled.module);
+        }, failInstantiation);
+        return {};
+      },
+    }),
+    instantiationFailed,
+  ]);
+
+  loadedBuild = build;
+  lastStartupTimings = {
+    build,
+    source: compiled.source,
+    fetchMs: compiled.fetchMs,
+    compileMs: compiled.compileMs,
+    instantiateMs,
+    totalMs: performance.now() - startedAt,
+  };
   return module;
 }
 
+/**
+ * Fetch and compile the binary createPdfiumModule() will use, without instantiating
+ * it, e.g. at idle time before the user opens a file. Failures are left to the
+ * createPdfiumModule() call that follows.
+ * @returns The build that was compiled
+ */
+export async function preloadPdfiumModule(
+  options: ICreatePdfiumModuleOptions = {},
+): Promise<PDFIUM_BUILD> {
+  const build = resolveBuild(options);
+  const persistentCache = options.persistentCache ?? true;
+  try {
+    await compileBinary(build, persistentCache);
+    return build;
+  } catch {
+    if (build !== PDFIUM_BUILD.SCALAR) {
+      await compileBinary(PDFIUM_BUILD.SCALAR, persistentCache).catch(() => undefined);
+    }
+    return PDFIUM_BUILD.SCALAR;
+  }
+}
+
+/**
+ * Create and initialize a PDFium WASM module instance.
+ * The binary is compiled once per page (see preloadPdfiumModule) and streamed from
+ * Cache Storage on later visits. 'auto' only picks variants the package ships; a SIMD or
+ * lite build forced through options.build that is missing or fails to instantiate falls
+ * back to the scalar build.
+ * @returns Promise that resolves to an initialized IPDFiumModule
+ */
+export async function createPdfiumModule(
+  options: ICreatePdfiumModuleOptions = {},
+): Promise<IPDFiumModule> {
+  const build = resolveBuild(options);
+  const persistentCache = options.persistentCache ?? true;
+
+  if (build !== PDFIUM_BUILD.SCALAR) {
+    try {
+      return await instantiateBuild(build, persistentCache);
+    } catch (error) {
+      console.warn(`PDFium ${build} build unavailable, using the scalar build.`, error);
+    }
+  }
+  return instantiateBuild(PDFIUM_BUILD.SCALAR, persistentCache);
+}
+
 // Export the factory function as default for convenience
 export default createPdfiumModule;
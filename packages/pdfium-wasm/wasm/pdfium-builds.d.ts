@@ -0,0 +1,9 @@
+/**
+ * Type declaration for pdfium-builds.js, the manifest build/compile.sh writes next to
+ * the binaries it built
+ */
+
+/** PDFIUM_BUILD values of the variants present in wasm/ */
+declare const builds: readonly string[];
+
+export default builds;
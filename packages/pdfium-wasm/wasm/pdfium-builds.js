@@ -0,0 +1,2 @@
+// Generated by build/compile.sh: the PDFIUM_BUILD variants present in this directory
+export default ['scalar'];